@@ -7,6 +7,7 @@ param(
     [string]$BuildType = "Release",
     [string]$Platform = "x86_64",
     [string]$QtPath = "",
+    [string]$SqlitePath = "",
     [switch]$Clean = $false,
     [switch]$Install = $false,
     [switch]$Help = $false
@@ -30,6 +31,7 @@ if ($Help) {
     Write-Host "  -BuildType <type>    Build type: Release, Debug (default: Release)"
     Write-Host "  -Platform <arch>     Platform: x86_64 (default: x86_64)"
     Write-Host "  -QtPath <path>       Custom Qt installation path (auto-detected if not specified)"
+    Write-Host "  -SqlitePath <path>   SQLite 3 prefix with include\sqlite3.h and lib\sqlite3.lib (default: vcpkg)"
     Write-Host "  -Clean               Clean build directories before building"
     Write-Host "  -Install             Install after building"
     Write-Host "  -Run                 Run application after building"
@@ -98,11 +100,38 @@ function Find-QtInstallation {
     return $null
 }
 
+# Function to find SQLite development files (headers and import library)
+function Find-SqliteInstallation {
+    $sqlitePaths = @()
+    if ($env:SQLITE3_DIR) {
+        $sqlitePaths += $env:SQLITE3_DIR
+    }
+    if ($env:VCPKG_ROOT) {
+        $sqlitePaths += Join-Path $env:VCPKG_ROOT "installed\x64-windows"
+    }
+    $sqlitePaths += "C:\vcpkg\installed\x64-windows"
+
+    foreach ($sqliteRoot in $sqlitePaths) {
+        if (Test-Path (Join-Path $sqliteRoot "include\sqlite3.h")) {
+            Write-Host "Found SQLite at: $sqliteRoot" -ForegroundColor Green
+            return $sqliteRoot
+        }
+    }
+
+    Write-Host "Warning: SQLite development files not found. Install them with: vcpkg install sqlite3:x64-windows" -ForegroundColor Yellow
+    return $null
+}
+
 # Find Qt
 if ([string]::IsNullOrEmpty($QtPath)) {
     $QtPath = Find-QtInstallation
 }
 
+# Find SQLite
+if ([string]::IsNullOrEmpty($SqlitePath)) {
+    $SqlitePath = Find-SqliteInstallation
+}
+
 # Build directories
 $BuildDir = Join-Path $ProjectRoot "build\windows-$Platform"
 
@@ -134,8 +163,9 @@ function Build-Component {
             "-DCMAKE_BUILD_TYPE=$BuildType"
         )
         
-        if ($QtPath) {
-            $cmakeArgs += "-DCMAKE_PREFIX_PATH=$QtPath"
+        $prefixPaths = @($QtPath, $SqlitePath) | Where-Object { $_ }
+        if ($prefixPaths) {
+            $cmakeArgs += "-DCMAKE_PREFIX_PATH=$($prefixPaths -join ';')"
         }
         
         $cmakeArgs += "..\..\..\$ComponentPath"
@@ -228,6 +258,9 @@ Write-Host "Platform: $Platform" -ForegroundColor Yellow
 if ($QtPath) {
     Write-Host "Qt Path: $QtPath" -ForegroundColor Yellow
 }
+if ($SqlitePath) {
+    Write-Host "SQLite Path: $SqlitePath" -ForegroundColor Yellow
+}
 
 # Build targets
 switch ($Target.ToLower()) {
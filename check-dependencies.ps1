@@ -186,9 +186,19 @@ $qtOk = Test-Qt
 Write-Host ""
 
 Write-ColorOutput "Checking database..." "Cyan"
-$sqliteOk = Test-Command "sqlite3" "-version"
+# common links sqlite3 directly, so the headers and import library are needed
+$sqliteOk = $false
+$sqliteRoots = @($env:SQLITE3_DIR, $(if ($env:VCPKG_ROOT) { Join-Path $env:VCPKG_ROOT "installed\x64-windows" }),
+                 "C:\vcpkg\installed\x64-windows") | Where-Object { $_ }
+foreach ($sqliteRoot in $sqliteRoots) {
+    if ((Test-Path (Join-Path $sqliteRoot "include\sqlite3.h")) -and (Test-Path (Join-Path $sqliteRoot "lib\sqlite3.lib"))) {
+        Write-ColorOutput "✓ SQLite development files : $sqliteRoot" "Green"
+        $sqliteOk = $true
+        break
+    }
+}
 if (-not $sqliteOk) {
-    Write-ColorOutput "⚠ SQLite : Not found (may be bundled with Qt)" "Yellow"
+    Write-ColorOutput "✗ SQLite development files : Not found" "Red"
 }
 Write-Host ""
 
@@ -215,6 +225,15 @@ if (-not $qtOk) {
     Write-Host ""
 }
 
+if (-not $sqliteOk) {
+    $missingCritical = $true
+    Write-ColorOutput "Missing: SQLite 3 development files" "Red"
+    Write-Host "  Install via vcpkg: vcpkg install sqlite3:x64-windows"
+    Write-Host "  Or set SQLITE3_DIR to a prefix with include\sqlite3.h and lib\sqlite3.lib"
+    Write-Host "  Note: Qt installer builds bundle their own SQLite; native reads then fall back to QtSql"
+    Write-Host ""
+}
+
 if (-not $compilerFound) {
     $missingCritical = $true
     Write-ColorOutput "Missing: C++ Compiler" "Red"
@@ -131,14 +131,18 @@ check_qt() {
     fi
 }
 
-# Function to check SQLite
+# Function to check SQLite (headers and library; common links sqlite3 directly)
 check_sqlite() {
-    if command -v sqlite3 >/dev/null 2>&1; then
-        VERSION=$(sqlite3 --version | awk '{print $1}')
-        echo -e "${GREEN}✓${NC} SQLite: $VERSION"
+    if command -v pkg-config >/dev/null 2>&1 && pkg-config --exists sqlite3; then
+        VERSION=$(pkg-config --modversion sqlite3)
+        echo -e "${GREEN}✓${NC} SQLite development files: $VERSION"
+        return 0
+    elif [ -f /usr/include/sqlite3.h ] || [ -f /usr/local/include/sqlite3.h ] || \
+         [ -f /opt/homebrew/opt/sqlite/include/sqlite3.h ] || [ -f /usr/local/opt/sqlite/include/sqlite3.h ]; then
+        echo -e "${GREEN}✓${NC} SQLite development files: Found"
         return 0
     else
-        echo -e "${YELLOW}⚠${NC} SQLite: Not found (may be bundled with Qt)"
+        echo -e "${RED}✗${NC} SQLite development files: Not found"
         return 1
     fi
 }
@@ -230,7 +234,10 @@ fi
 echo ""
 
 echo -e "${BLUE}Checking database...${NC}"
-check_sqlite
+SQLITE_OK=false
+if check_sqlite; then
+    SQLITE_OK=true
+fi
 echo ""
 
 echo -e "${BLUE}Checking documentation tools (optional)...${NC}"
@@ -270,6 +277,21 @@ if [ "$QT_OK" = false ]; then
     echo ""
 fi
 
+if [ "$SQLITE_OK" = false ]; then
+    MISSING_CRITICAL=true
+    echo -e "${RED}Missing: SQLite 3 development files${NC}"
+    if [ "$UNAME_S" = "Darwin" ]; then
+        echo "  Install: brew install sqlite"
+    elif [ "$UNAME_S" = "Linux" ]; then
+        echo "  Install: sudo apt-get install libsqlite3-dev  # Debian/Ubuntu"
+        echo "           sudo dnf install sqlite-devel        # Fedora"
+        echo "           sudo pacman -S sqlite                # Arch"
+    fi
+    echo "  Native SQLite reads need Qt's QSQLITE plugin built against the same library"
+    echo "  (-system-sqlite); with a Qt that bundles SQLite they fall back to QtSql."
+    echo ""
+fi
+
 if [ "$MISSING_CRITICAL" = false ]; then
     echo -e "${GREEN}All critical dependencies are installed!${NC}"
     echo ""
@@ -0,0 +1,36 @@
+// Configure-time check: exits 0 if the QSQLITE plugin uses the SQLite
+// library this program is linked against (see NativeConnection)
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <sqlite3.h>
+#include <cstdio>
+
+namespace {
+bool s_opened = false;
+
+int markOpened(sqlite3*, char**, const sqlite3_api_routines*) {
+    s_opened = true;
+    return SQLITE_OK;
+}
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    sqlite3_auto_extension(reinterpret_cast<void (*)(void)>(markOpened));
+
+    bool opened = false;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "probe");
+        database.setDatabaseName(":memory:");
+        opened = database.open();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("probe");
+
+    if (!opened) {
+        std::puts("no QSQLITE driver");
+        return 2;
+    }
+    std::puts(s_opened ? "shared" : "separate");
+    return s_opened ? 0 : 1;
+}
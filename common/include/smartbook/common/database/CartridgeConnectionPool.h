@@ -0,0 +1,194 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_CARTRIDGECONNECTIONPOOL_H
+#define SMARTBOOK_COMMON_DATABASE_CARTRIDGECONNECTIONPOOL_H
+
+#include "smartbook/common/database/StatementCache.h"
+#include "smartbook/common/database/ConnectionProfile.h"
+#include <QSqlDatabase>
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QObject>
+#include <memory>
+
+class QThread;
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief How a cartridge file is opened
+ */
+enum class CartridgeOpenMode {
+    ReadWrite,  // Creator editing: WAL journal, User_Data created in the cartridge
+    ReadOnly,   // Reader: SQLITE_OPEN_READONLY + query_only, no journal or schema writes;
+                // falls back to Immutable if the file cannot be read that way (read-only media)
+    Immutable   // Read-only media: immutable=1 URI, SQLite skips locking and change detection
+};
+
+/**
+ * @brief Process-wide pool of configured cartridge connections
+ *
+ * Keeps one QSQLITE connection per (canonical cartridge path, open mode, role, thread)
+ * open across CartridgeDBConnector instances. Connections are leased with a
+ * reference count; after the last lease is released the connection stays
+ * open until it has been idle for the configured timeout, so reopening the
+ * same cartridge (page turns, settings loads, metadata edits) skips the
+ * SQLite open and PRAGMA configuration cycle.
+ *
+ * QtSql connections are thread-affine: leases never cross threads, and idle
+ * connections are only evicted from the thread that owns them.
+ */
+class CartridgeConnectionPool : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Get the singleton instance
+     * @return Reference to the CartridgeConnectionPool instance
+     */
+    static CartridgeConnectionPool& getInstance();
+
+    /**
+     * @brief Lease a connection to a cartridge for the calling thread
+     *
+     * A WAL cartridge whose -shm file does not exist and cannot be created
+     * (read-only directory or media) cannot be read with mode=ro. ReadOnly
+     * opens of such a file are retried as Immutable.
+     *
+     * @param cartridgePath Path to the .sqlite cartridge file
+     * @param mode Open mode; each mode gets its own pooled connection
+     * @param role Workload whose ConnectionProfile configures the connection
+     * @return Connection name of the leased connection, or empty string on failure
+     */
+    QString acquire(const QString& cartridgePath,
+                    CartridgeOpenMode mode = CartridgeOpenMode::ReadWrite,
+                    ConnectionRole role = ConnectionRole::Creator);
+
+    /**
+     * @brief Open and configure a connection outside the pool
+     *
+     * Does what acquire() does for a new pooled connection: the mode's URI
+     * and open options, the ReadOnly to Immutable retry and the role's
+     * ConnectionProfile. The caller owns (and removes) the connection.
+     *
+     * @param database Unopened connection from QSqlDatabase::addDatabase("QSQLITE", ...)
+     * @param cartridgePath Path to the .sqlite cartridge file
+     * @param mode Open mode
+     * @param role Workload whose ConnectionProfile configures the connection
+     * @return true if opened, false otherwise (error is logged)
+     */
+    static bool openConnection(QSqlDatabase& database, const QString& cartridgePath,
+                               CartridgeOpenMode mode, ConnectionRole role);
+
+    /**
+     * @brief Release a lease obtained from acquire()
+     * @param connectionName Connection name returned by acquire()
+     */
+    void release(const QString& connectionName);
+
+    /**
+     * @brief Close connections of the calling thread that have been idle too long
+     * @param maxIdleMs Minimum idle time in milliseconds before a connection is closed
+     * @return Number of connections closed
+     */
+    int evictIdle(int maxIdleMs);
+
+    /**
+     * @brief Get the prepared-statement cache of a leased connection
+     *
+     * The cache lives as long as the pooled connection, so statements
+     * prepared by one connector are reused by later leases.
+     *
+     * @param connectionName Connection name returned by acquire()
+     * @return Statement cache, or nullptr for an unknown connection
+     */
+    std::shared_ptr<StatementCache> statementCache(const QString& connectionName) const;
+
+    /**
+     * @brief Drop pooled connections for a cartridge file
+     *
+     * Idle connections owned by the calling thread are closed immediately;
+     * leased connections are closed when their last lease is released.
+     * Call this after replacing or deleting a cartridge file on disk.
+     *
+     * @param cartridgePath Path to the cartridge file
+     */
+    void invalidate(const QString& cartridgePath);
+
+    /**
+     * @brief Close every idle connection owned by the calling thread
+     *
+     * Worker threads must call this before they finish, since their
+     * connections cannot be closed from any other thread.
+     */
+    void closeThreadConnections();
+
+    /**
+     * @brief Set how long released connections stay open
+     * @param idleTimeoutMs Idle timeout in milliseconds (0 closes on last release)
+     */
+    void setIdleTimeout(int idleTimeoutMs);
+
+    /**
+     * @brief Get the idle timeout
+     * @return Idle timeout in milliseconds
+     */
+    int idleTimeout() const;
+
+    /**
+     * @brief Get the number of open pooled connections (all threads)
+     * @return Number of connections
+     */
+    int connectionCount() const;
+
+    /**
+     * @brief Get the number of active leases on a cartridge for the calling thread
+     * @param cartridgePath Path to the cartridge file
+     * @param mode Open mode of the pooled connection
+     * @param role Workload of the pooled connection
+     * @return Lease count, or 0 if no connection is pooled
+     */
+    int leaseCount(const QString& cartridgePath,
+                   CartridgeOpenMode mode = CartridgeOpenMode::ReadWrite,
+                   ConnectionRole role = ConnectionRole::Creator) const;
+
+private:
+    struct PooledConnection {
+        QString connectionName;
+        QString canonicalPath;
+        QThread* ownerThread = nullptr;
+        int refCount = 0;
+        qint64 lastReleasedMs = 0;
+        bool invalidated = false;
+        std::shared_ptr<StatementCache> statements;
+    };
+
+    CartridgeConnectionPool();
+    ~CartridgeConnectionPool() = default;
+    CartridgeConnectionPool(const CartridgeConnectionPool&) = delete;
+    CartridgeConnectionPool& operator=(const CartridgeConnectionPool&) = delete;
+
+    static QString canonicalPath(const QString& cartridgePath);
+    static QString poolKey(const QString& canonicalPath, CartridgeOpenMode mode,
+                           ConnectionRole role, QThread* thread);
+    static void configureConnection(QSqlDatabase& database, CartridgeOpenMode mode,
+                                    const ConnectionProfile& profile);
+    static void removeConnection(PooledConnection& entry);
+
+    void scheduleEviction();
+
+    mutable QMutex m_mutex;
+    QHash<QString, PooledConnection> m_connections;   // pool key -> connection
+    QHash<QString, QString> m_keysByConnectionName;   // connection name -> pool key
+    QElapsedTimer m_clock;
+    int m_idleTimeoutMs = 30000;
+    bool m_evictionScheduled = false;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_CARTRIDGECONNECTIONPOOL_H
@@ -1,11 +1,17 @@
 #ifndef SMARTBOOK_COMMON_DATABASE_CARTRIDGEDBCONNECTOR_H
 #define SMARTBOOK_COMMON_DATABASE_CARTRIDGEDBCONNECTOR_H
 
+#include "smartbook/common/database/StatementCache.h"
+#include "smartbook/common/database/CartridgeConnectionPool.h"
+#include "smartbook/common/database/WriteCoalescer.h"
+#include "smartbook/common/database/NativeSqlite.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QString>
 #include <QByteArray>
+#include <QVariantList>
 #include <QObject>
+#include <memory>
 
 namespace smartbook {
 namespace common {
@@ -17,6 +23,13 @@ namespace database {
  * Manages the connection and transactional persistence for one specific
  * cartridge's content and User_Data. Each Reader View Instance has its
  * own CartridgeDBConnector to ensure data isolation.
+ *
+ * The underlying SQLite connection is leased from CartridgeConnectionPool,
+ * so connectors opened on the same cartridge from the same thread share one
+ * configured connection (and therefore its transaction state).
+ *
+ * Cartridges opened read-only or immutable are never written to; form data
+ * for them is stored in the local database (Local_User_Data) instead.
  */
 class CartridgeDBConnector : public QObject {
     Q_OBJECT
@@ -28,9 +41,21 @@ public:
     /**
      * @brief Open a cartridge database file
      * @param cartridgePath Path to the .sqlite cartridge file
+     * @param mode Open mode (Reader uses ReadOnly, Creator uses ReadWrite)
      * @return true if opened successfully, false otherwise
+     *
+     * Uses the Creator profile for ReadWrite opens and the Reader profile otherwise.
      */
-    bool openCartridge(const QString& cartridgePath);
+    bool openCartridge(const QString& cartridgePath, CartridgeOpenMode mode = CartridgeOpenMode::ReadWrite);
+
+    /**
+     * @brief Open a cartridge database file tuned for a specific workload
+     * @param cartridgePath Path to the .sqlite cartridge file
+     * @param mode Open mode
+     * @param role Workload whose ConnectionProfile configures the connection
+     * @return true if opened successfully, false otherwise
+     */
+    bool openCartridge(const QString& cartridgePath, CartridgeOpenMode mode, ConnectionRole role);
 
     /**
      * @brief Close the cartridge database connection
@@ -48,6 +73,24 @@ public:
      */
     bool isOpen() const;
 
+    /**
+     * @brief Get the mode the cartridge was opened with
+     * @return Open mode
+     */
+    CartridgeOpenMode openMode() const;
+
+    /**
+     * @brief Check if the cartridge was opened without write access
+     * @return true for ReadOnly and Immutable opens
+     */
+    bool isReadOnly() const;
+
+    /**
+     * @brief Get the workload the connection was tuned for
+     * @return Connection role
+     */
+    ConnectionRole role() const;
+
     /**
      * @brief Get the cartridge GUID
      * @return Cartridge GUID or empty string if not loaded
@@ -61,6 +104,26 @@ public:
      */
     QSqlQuery executeQuery(const QString& queryString);
 
+    /**
+     * @brief Execute a cached prepared statement with bound parameters
+     *
+     * The statement is prepared once per pooled connection and reused on
+     * later calls with the same SQL text. Values are bound positionally and
+     * keep their QVariant type. The statement is reset when the returned
+     * handle goes out of scope.
+     *
+     * @param queryString SQL with positional (?) placeholders
+     * @param bindValues Values bound to the placeholders in order
+     * @return Handle to the executed statement (isPrepared() false on failure)
+     */
+    PreparedQuery executePrepared(const QString& queryString, const QVariantList& bindValues = QVariantList());
+
+    /**
+     * @brief Get prepared-statement cache counters for this connection
+     * @return Cache statistics (empty if not open)
+     */
+    StatementCache::Stats statementCacheStats() const;
+
     /**
      * @brief Begin a transaction
      * @return true if transaction started, false otherwise
@@ -85,14 +148,45 @@ public:
      */
     QSqlDatabase& getDatabase();
 
+    /**
+     * @brief Get a native sqlite3 connection for bulk reads
+     *
+     * Runs on the handle of the leased QtSql connection, so it sees a
+     * transaction begun through beginTransaction() and takes no locks of
+     * its own. Detached when the cartridge is closed. Use it for reads
+     * only, on the thread that uses getDatabase(). Callers fall back to
+     * getDatabase() when it is unavailable.
+     *
+     * @return Native connection, or nullptr if unavailable
+     */
+    NativeConnection* nativeReader();
+
     /**
      * @brief Save form data to User_Data table
+     *
+     * Read-only opens store the data in the local database keyed by
+     * cartridge GUID instead.
+     *
+     * Saves are write-behind: the latest data per form is buffered and
+     * committed in one transaction shortly after, or when the cartridge is
+     * closed. loadFormData() sees buffered data immediately. Call
+     * flushFormData() for an explicit save.
+     *
      * @param formId Form identifier
      * @param dataJson JSON string containing form data
-     * @return true if saved successfully, false otherwise
+     * @return true if accepted, false if the cartridge is not open
      */
     bool saveFormData(const QString& formId, const QString& dataJson);
 
+    /**
+     * @brief Durability barrier for buffered form data
+     *
+     * Commits all buffered saves and syncs the WAL before returning.
+     *
+     * @return true if everything buffered is on disk, false otherwise
+     */
+    bool flushFormData();
+
     /**
      * @brief Load form data from User_Data table
      * @param formId Form identifier
@@ -101,12 +195,21 @@ public:
     QString loadFormData(const QString& formId);
 
 private:
-    void configureConnection();
+    bool saveLocalFormData(const QString& formId, const QString& dataJson);
+    QString loadLocalFormData(const QString& formId);
+    QString localFormKey(const QString& formId) const;
 
     QSqlDatabase m_database;
+    QString m_connectionName;
+    std::shared_ptr<StatementCache> m_statements;
+    std::unique_ptr<WriteCoalescer> m_formWrites;   // Read-write opens only
+    std::unique_ptr<NativeConnection> m_nativeReader;  // Attached by nativeReader()
     QString m_cartridgeGuid;
     QString m_cartridgePath;
+    CartridgeOpenMode m_openMode = CartridgeOpenMode::ReadWrite;
+    ConnectionRole m_role = ConnectionRole::Creator;
     bool m_isOpen = false;
+    bool m_nativeReaderFailed = false;  // Do not retry a failed attach
 };
 
 } // namespace database
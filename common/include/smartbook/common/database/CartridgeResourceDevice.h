@@ -0,0 +1,116 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_CARTRIDGERESOURCEDEVICE_H
+#define SMARTBOOK_COMMON_DATABASE_CARTRIDGERESOURCEDEVICE_H
+
+#include "smartbook/common/database/NativeSqlite.h"
+#include <QIODevice>
+#include <QMutex>
+#include <QString>
+#include <memory>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Read-only connection to one cartridge, shared by its resource devices
+ *
+ * Opened on the first openResource() and kept with its lookup statement,
+ * so serving a page's resources costs one open, probe and PRAGMA cycle
+ * rather than one per request. Devices may be read on other threads than
+ * the one that opened them: all use of the connection is serialized.
+ */
+class CartridgeResources {
+public:
+    explicit CartridgeResources(const QString& cartridgePath);
+
+    /**
+     * @brief Get the cartridge the resources are read from
+     * @return Cartridge file path
+     */
+    QString cartridgePath() const { return m_path; }
+
+private:
+    friend class CartridgeResourceDevice;
+
+    QString m_path;
+    QMutex m_mutex;
+    NativeConnection m_connection;  // Opened on first use
+    NativeStatement m_lookup;
+};
+
+/**
+ * @brief Random-access device over one BLOB of a cartridge's Resources table
+ *
+ * Reads resource_data in place through sqlite3 incremental BLOB I/O, so a
+ * resource is never held in memory as a whole: a read at pos() reads just
+ * that range. The device is seekable and knows its size, which lets
+ * consumers such as QWebEngineUrlRequestJob answer range requests for
+ * audio and video by seeking.
+ *
+ * Devices opened from the same CartridgeResources share its connection,
+ * which stays open while any of them does. A device can be read from
+ * whichever thread its consumer uses, one at a time.
+ *
+ * Where NativeConnection falls back to QtSql, the BLOB is read into
+ * memory when the device is opened.
+ */
+class CartridgeResourceDevice : public QIODevice {
+    Q_OBJECT
+
+public:
+    explicit CartridgeResourceDevice(QObject* parent = nullptr);
+    ~CartridgeResourceDevice() override;
+
+    /**
+     * @brief Open a resource for reading
+     *
+     * The resource is looked up by resource_id first, then by resource_path,
+     * so pages can refer to it by either.
+     *
+     * @param resources Cartridge connection to read through
+     * @param resource resource_id or resource_path
+     * @return true if the resource exists and the device is open
+     */
+    bool openResource(const std::shared_ptr<CartridgeResources>& resources, const QString& resource);
+
+    /**
+     * @brief Open a resource on a connection of the device's own
+     * @param cartridgePath Path to the cartridge file
+     * @param resource resource_id or resource_path
+     * @return true if the resource exists and the device is open
+     */
+    bool openResource(const QString& cartridgePath, const QString& resource);
+
+    /**
+     * @brief Get the MIME type of the open resource
+     * @return Stored mime_type, or one guessed from resource_path if none was stored
+     */
+    QString mimeType() const { return m_mimeType; }
+
+    /**
+     * @brief Choose the MIME type to serve a resource with
+     * @param stored mime_type column value
+     * @param path resource_path column value
+     * @return stored unless empty or generic, else the type of path's extension
+     */
+    static QString mimeTypeFor(const QString& stored, const QString& path);
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override;
+    void close() override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    std::shared_ptr<CartridgeResources> m_resources;
+    NativeBlob m_blob;
+    QString m_mimeType;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_CARTRIDGERESOURCEDEVICE_H
@@ -0,0 +1,133 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_CARTRIDGESEARCHINDEX_H
+#define SMARTBOOK_COMMON_DATABASE_CARTRIDGESEARCHINDEX_H
+
+#include "smartbook/common/database/NativeSqlite.h"
+#include <QString>
+#include <QList>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Full-text index over a cartridge's pages
+ *
+ * Content_Search is an FTS5 table holding the chapter title and the text
+ * of every page of Content_Pages (rowid = page_id), with markup stripped
+ * by plainText(). Matches are ranked with bm25, weighting the chapter
+ * title over the page text.
+ *
+ * The index is written into the cartridge at export. Triggers installed
+ * with it empty Content_Search_State whenever Content_Pages changes
+ * afterwards, so an index that no longer matches the pages is never used.
+ * Cartridges without a current index are indexed into a sidecar database
+ * in the cache directory instead (buildSidecar()), stamped with the size
+ * and modification time of the cartridge it was built from.
+ *
+ * Content_Search is derived data and not part of the signed content hash.
+ *
+ * A NativeConnection is used from one thread at a time, so all functions
+ * may run on worker threads with their own connections.
+ */
+class CartridgeSearchIndex {
+public:
+    /**
+     * @brief One match within a page's text
+     */
+    struct Match {
+        int offset = 0;     // Position in plainText() of the page HTML
+        int length = 0;
+        QString text;       // Matched text as it appears on the page
+    };
+
+    /**
+     * @brief One page matching a search
+     */
+    struct Hit {
+        int pageId = -1;
+        QString chapterTitle;
+        QString snippet;        // HTML-escaped excerpt, matches wrapped in <mark>
+        QList<Match> matches;   // In page order; empty if only the title matched
+        double score = 0.0;     // bm25; lower is better
+    };
+
+    /**
+     * @brief Get the text of a page as it is indexed
+     *
+     * Tags are removed (block-level tags still separate words), script and
+     * style contents dropped, entities decoded and whitespace collapsed to
+     * single spaces. Match offsets are positions in this text.
+     *
+     * @param html Page HTML
+     * @return Plain text
+     */
+    static QString plainText(const QString& html);
+
+    /**
+     * @brief Check whether a database holds a current index
+     * @param connection Cartridge or sidecar connection
+     * @return true if Content_Search exists and matches Content_Pages
+     */
+    static bool hasIndex(NativeConnection& connection);
+
+    /**
+     * @brief (Re)build the index inside a cartridge
+     *
+     * Used at export; replaces any previous index in one transaction.
+     *
+     * @param connection Read-write connection to the cartridge
+     * @return true if the index was built
+     */
+    static bool buildIndex(NativeConnection& connection);
+
+    /**
+     * @brief Get where the sidecar index of a cartridge is stored
+     * @param cartridgePath Path to the cartridge file
+     * @return Path in the cache directory, unique per cartridge path
+     */
+    static QString sidecarPath(const QString& cartridgePath);
+
+    /**
+     * @brief Check whether a sidecar was built from the cartridge as it is now
+     * @param cartridgePath Path to the cartridge file
+     * @param sidecarPath Path to the sidecar
+     * @return true if the sidecar exists and its stamp matches the cartridge
+     */
+    static bool isSidecarCurrent(const QString& cartridgePath, const QString& sidecarPath);
+
+    /**
+     * @brief Index a cartridge into a sidecar database
+     *
+     * Does nothing if the sidecar is current. Otherwise the index is built
+     * in a temporary file that replaces the sidecar when complete, so
+     * readers of the old sidecar are never shown a partial index.
+     *
+     * @param cartridgePath Path to the cartridge file (opened read-only)
+     * @param sidecarPath Path to the sidecar
+     * @return true if the sidecar is current afterwards
+     */
+    static bool buildSidecar(const QString& cartridgePath, const QString& sidecarPath);
+
+    /**
+     * @brief Search the pages, best matches first
+     *
+     * Query syntax as in the library search: every word is a prefix term
+     * and all of them have to match.
+     *
+     * @param connection Connection to a database holding a current index
+     * @param text Text typed by the user
+     * @param limit Maximum number of hits
+     * @return Hits in rank order, empty if nothing matches
+     */
+    static QList<Hit> search(NativeConnection& connection, const QString& text, int limit);
+
+private:
+    static bool createTables(NativeConnection& connection, bool withTriggers);
+    static bool fillIndex(NativeStatement& pages, NativeConnection& target);
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_CARTRIDGESEARCHINDEX_H
@@ -0,0 +1,103 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_CONNECTIONPROFILE_H
+#define SMARTBOOK_COMMON_DATABASE_CONNECTIONPROFILE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+class QSettings;
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Workload a SQLite connection is tuned for
+ */
+enum class ConnectionRole {
+    Reader,        // Interactive page fetches: small working set, low latency
+    Creator,       // Cartridge editing: durable writes, larger cache for the editor
+    Verifier,      // Full-table hashing scans: large mmap, tiny cache, no cache pollution
+    BulkImport,    // Library imports: big cache, relaxed sync, exclusive lock
+    LocalLibrary   // Local reader database (manifest, trust registry, settings)
+};
+
+/**
+ * @brief SQLite tuning applied to a connection when it is opened
+ *
+ * Each ConnectionRole has built-in defaults; individual values can be
+ * overridden from the application settings under
+ * "database/profiles/<role>/<key>" (see loadOverrides()).
+ */
+struct ConnectionProfile {
+    QString name;                  // Role name, also the settings group
+    int cacheSizeKiB = 2000;       // PRAGMA cache_size (applied as -KiB)
+    qint64 mmapSizeBytes = 0;      // PRAGMA mmap_size (0 disables memory mapping)
+    QString synchronous = "NORMAL";  // OFF, NORMAL or FULL
+    QString lockingMode = "NORMAL";  // NORMAL or EXCLUSIVE
+    QString tempStore = "MEMORY";    // DEFAULT, FILE or MEMORY
+    int busyTimeoutMs = 5000;      // PRAGMA busy_timeout
+
+    /**
+     * @brief Get the effective profile for a role (defaults plus overrides)
+     * @param role Connection workload
+     * @return Profile to apply
+     */
+    static ConnectionProfile forRole(ConnectionRole role);
+
+    /**
+     * @brief Get the built-in profile for a role, ignoring overrides
+     * @param role Connection workload
+     * @return Default profile
+     */
+    static ConnectionProfile defaults(ConnectionRole role);
+
+    /**
+     * @brief Get the settings key name of a role
+     * @param role Connection workload
+     * @return "reader", "creator", "verifier", "bulk_import" or "local_library"
+     */
+    static QString roleName(ConnectionRole role);
+
+    /**
+     * @brief Load per-role overrides from application settings
+     *
+     * Recognized keys below "database/profiles/<role>/": cache_size_kib,
+     * mmap_size, synchronous, locking_mode, temp_store, busy_timeout_ms.
+     * Affects connections opened afterwards.
+     *
+     * @param settings Settings to read from
+     */
+    static void loadOverrides(QSettings& settings);
+
+    /**
+     * @brief Replace the effective profile of a role
+     * @param role Connection workload
+     * @param profile Profile used by later forRole() calls
+     */
+    static void setOverride(ConnectionRole role, const ConnectionProfile& profile);
+
+    /**
+     * @brief Drop all overrides and return to built-in defaults
+     */
+    static void clearOverrides();
+
+    /**
+     * @brief Build the PRAGMA statements for this profile
+     * @return PRAGMA statements in execution order
+     */
+    QStringList pragmas() const;
+
+    /**
+     * @brief Apply the profile to an open connection
+     * @param database Open connection
+     * @return true if every PRAGMA succeeded, false otherwise (failures are logged)
+     */
+    bool apply(QSqlDatabase& database) const;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_CONNECTIONPROFILE_H
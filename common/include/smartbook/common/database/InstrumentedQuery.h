@@ -0,0 +1,69 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_INSTRUMENTEDQUERY_H
+#define SMARTBOOK_COMMON_DATABASE_INSTRUMENTEDQUERY_H
+
+#include <QSqlQuery>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief QSqlQuery that reports its executions to QueryStats
+ *
+ * Drop-in replacement for QSqlQuery: exec(), next(), value() and finish()
+ * are shadowed to time the statement, count stepped rows and sum the size
+ * of values read. A sample is recorded when the result set is exhausted,
+ * the statement is re-executed or finished, or the query is destroyed.
+ * Statements that do not return rows are recorded right after exec().
+ *
+ * Calls made through a QSqlQuery reference or pointer bypass the
+ * instrumentation, so keep the InstrumentedQuery type at the call site.
+ */
+class InstrumentedQuery : public QSqlQuery {
+public:
+    explicit InstrumentedQuery(const QSqlDatabase& database);
+    ~InstrumentedQuery();
+
+    InstrumentedQuery(const InstrumentedQuery&) = delete;
+    InstrumentedQuery& operator=(const InstrumentedQuery&) = delete;
+
+    bool exec(const QString& query);
+    bool exec();
+    bool next();
+    QVariant value(int index) const;
+    QVariant value(const QString& name) const;
+    void finish();
+
+    /**
+     * @brief Record the current execution now
+     *
+     * Used before handing the underlying query to code that is not
+     * instrumented; later steps are not counted.
+     */
+    void finishTrace();
+
+    /**
+     * @brief Run EXPLAIN QUERY PLAN for the last executed statement
+     * @return Plan detail lines indented by nesting depth (empty on failure)
+     */
+    QStringList explainQueryPlan() const;
+
+private:
+    void beginTrace();
+
+    QString m_connectionName;
+    qint64 m_elapsedNs = 0;
+    qint64 m_rows = 0;
+    mutable qint64 m_bytes = 0;
+    bool m_tracing = false;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_INSTRUMENTEDQUERY_H
@@ -0,0 +1,160 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_LOCALDBEXECUTOR_H
+#define SMARTBOOK_COMMON_DATABASE_LOCALDBEXECUTOR_H
+
+#include "smartbook/common/database/ConnectionProfile.h"
+#include <QSqlDatabase>
+#include <QString>
+#include <QObject>
+#include <QFuture>
+#include <QPromise>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+class QThread;
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Worker thread that runs local database tasks off the GUI thread
+ *
+ * Owns a dedicated connection to the local reader database, opened and
+ * used only on the worker thread. Tasks are queued in two lanes:
+ * Interactive tasks (UI reads) always run before Background tasks
+ * (imports, trust updates), so a long queue of background writes never
+ * delays the next UI query by more than the task currently running.
+ * Long background tasks can poll hasPendingInteractive() and commit early
+ * to yield.
+ *
+ * Obtain the running executor from LocalDBManager::executor().
+ */
+class LocalDBExecutor : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Priority {
+        Interactive,   // UI-visible reads; run first
+        Background     // Bulk writes and maintenance; run when no interactive work is queued
+    };
+
+    explicit LocalDBExecutor(QObject* parent = nullptr);
+    ~LocalDBExecutor();
+
+    /**
+     * @brief Start the worker thread and open its connection
+     * @param databasePath Path to the local reader database file
+     * @param role Workload whose ConnectionProfile configures the connection
+     * @return true if the worker was started (or already running), false otherwise
+     */
+    bool start(const QString& databasePath, ConnectionRole role = ConnectionRole::LocalLibrary);
+
+    /**
+     * @brief Stop the worker thread
+     *
+     * Waits for the running task to finish. Queued tasks are dropped and
+     * their futures are canceled.
+     */
+    void stop();
+
+    /**
+     * @brief Check if the worker thread is running
+     * @return true if running, false otherwise
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Check if the calling thread is the executor's worker thread
+     * @return true when called from inside a task
+     */
+    bool isWorkerThread() const;
+
+    /**
+     * @brief Get the name of the worker connection
+     *
+     * Only usable with QSqlDatabase::database() on the worker thread.
+     *
+     * @return Connection name, or empty string if never started
+     */
+    QString connectionName() const;
+
+    /**
+     * @brief Check whether interactive tasks are waiting
+     *
+     * Background tasks that loop over many rows can call this between
+     * batches and return early so UI reads are not held up.
+     *
+     * @return true if at least one Interactive task is queued
+     */
+    bool hasPendingInteractive() const;
+
+    /**
+     * @brief Get the number of queued tasks in a lane
+     * @param priority Lane to inspect
+     * @return Number of tasks waiting (excluding the running one)
+     */
+    int pendingCount(Priority priority) const;
+
+    /**
+     * @brief Queue a task for the worker connection
+     *
+     * The task receives the worker's QSqlDatabase and runs on the worker
+     * thread; it must not touch GUI objects. Its return value becomes the
+     * future's result. Do not block on the future from inside another task.
+     *
+     * @param task Callable taking QSqlDatabase& (copyable)
+     * @param priority Lane to queue the task in
+     * @return Future for the task's result (canceled if the executor stops first)
+     */
+    template <typename Func>
+    auto submit(Func task, Priority priority = Priority::Interactive)
+        -> QFuture<std::invoke_result_t<Func, QSqlDatabase&>>
+    {
+        using Result = std::invoke_result_t<Func, QSqlDatabase&>;
+
+        auto promise = std::make_shared<QPromise<Result>>();
+        QFuture<Result> future = promise->future();
+        promise->start();
+
+        enqueue([promise, task = std::move(task)](QSqlDatabase& database) mutable {
+            if constexpr (std::is_void_v<Result>) {
+                task(database);
+            } else {
+                promise->addResult(task(database));
+            }
+            promise->finish();
+        }, priority);
+
+        return future;
+    }
+
+private:
+    using Task = std::function<void(QSqlDatabase&)>;
+
+    void enqueue(Task task, Priority priority);
+    void run();
+
+    QThread* m_thread = nullptr;
+    QString m_databasePath;
+    QString m_connectionName;
+    ConnectionRole m_role = ConnectionRole::LocalLibrary;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    QQueue<Task> m_interactive;
+    QQueue<Task> m_background;
+    bool m_stopping = false;
+    bool m_started = false;     // Worker finished opening its connection
+    bool m_openFailed = false;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_LOCALDBEXECUTOR_H
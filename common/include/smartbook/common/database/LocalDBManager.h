@@ -1,11 +1,21 @@
 #ifndef SMARTBOOK_COMMON_DATABASE_LOCALDBMANAGER_H
 #define SMARTBOOK_COMMON_DATABASE_LOCALDBMANAGER_H
 
+#include "smartbook/common/database/ConnectionProfile.h"
+#include "smartbook/common/database/LocalDBExecutor.h"
+#include "smartbook/common/database/WriteCoalescer.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include "smartbook/common/database/SchemaMigrator.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QString>
 #include <QObject>
+#include <QMutex>
+#include <QThreadStorage>
+#include <QFuture>
+#include <QDebug>
 #include <memory>
+#include <type_traits>
 
 namespace smartbook {
 namespace common {
@@ -17,7 +27,15 @@ namespace database {
  * Manages the single connection to the global manifest and trust registry.
  * Used by the Library Manager and the Signature Verifier.
  * 
- * Implements the Singleton pattern to ensure only one connection exists.
+ * Implements the Singleton pattern to ensure only one connection exists
+ * on the GUI thread. Work that should not block the event loop is queued
+ * on executor(), which owns a second connection on its own thread.
+ *
+ * Concurrency model (WAL): any thread may read through readConnection(),
+ * which hands out a query-only connection private to the calling thread.
+ * Writes are serialized through the executor connection via write() or
+ * executor().submit(), so readers never contend with each other and at
+ * most one writer holds the WAL write lock.
  */
 class LocalDBManager : public QObject {
     Q_OBJECT
@@ -32,9 +50,16 @@ public:
     /**
      * @brief Initialize the database connection
      * @param dbPath Path to the local reader database file
+     * @param role Workload whose ConnectionProfile configures the connection
      * @return true if initialization successful, false otherwise
      */
-    bool initializeConnection(const QString& dbPath);
+    bool initializeConnection(const QString& dbPath, ConnectionRole role = ConnectionRole::LocalLibrary);
+
+    /**
+     * @brief Get the workload the connection was opened for
+     * @return Connection role passed to initializeConnection()
+     */
+    ConnectionRole currentRole() const;
 
     /**
      * @brief Get the database connection
@@ -54,6 +79,119 @@ public:
      */
     void closeConnection();
 
+    /**
+     * @brief Get the database worker for asynchronous queries
+     *
+     * The worker is started on first use and stopped by closeConnection().
+     * If the database is not open the returned executor is not running and
+     * submitted tasks are canceled.
+     *
+     * @return Reference to the executor
+     */
+    LocalDBExecutor& executor();
+
+    /**
+     * @brief Get a read-only connection for the calling thread
+     *
+     * Each thread gets its own query-only connection to the database file,
+     * opened on first use and closed when the thread exits (or reopened
+     * after the database was closed and reinitialized). Safe to call from
+     * any thread, including QThreadPool workers.
+     *
+     * @return Open read connection, or an invalid QSqlDatabase if the
+     *         local database is not initialized
+     */
+    QSqlDatabase readConnection();
+
+    /**
+     * @brief Get a native sqlite3 read connection for the calling thread
+     *
+     * Like readConnection(), but bypassing QtSql for bulk row scans. It
+     * runs on the handle of the thread's readConnection(), so it sees
+     * committed data only: do not use it to read back writes of a
+     * transaction that is still open on the writer.
+     *
+     * @return Connection owned by the calling thread, or nullptr if the
+     *         local database is not initialized or cannot be opened
+     */
+    NativeConnection* nativeReadConnection();
+
+    /**
+     * @brief Run a write on the serialized writer connection and wait for it
+     *
+     * The task runs on the executor thread in the Interactive lane (the
+     * caller is blocked on it), or inline when already called from the
+     * executor thread. Do not call from a task that another thread is
+     * waiting on.
+     *
+     * Interactive tasks go ahead of every queued Background task but not
+     * of the one already running, so the worst-case wait is one Background
+     * task: an import batch (CartridgeImporter::Options::batchSize
+     * entries), a thumbnail backfill batch, or one background schema
+     * migration. The slowest of those is the search index rebuild, once
+     * after an upgrade, which reads the whole manifest. GUI code that must
+     * not stall uses executor().submit() or the *Async() methods instead.
+     *
+     * @param task Callable taking QSqlDatabase& (copyable)
+     * @return Task result, or a default-constructed value if the database is not open
+     */
+    template <typename Func>
+    auto write(Func task) -> std::invoke_result_t<Func, QSqlDatabase&>
+    {
+        using Result = std::invoke_result_t<Func, QSqlDatabase&>;
+
+        LocalDBExecutor& writer = executor();
+        if (writer.isWorkerThread()) {
+            QSqlDatabase database = QSqlDatabase::database(writer.connectionName(), false);
+            return task(database);
+        }
+
+        QFuture<Result> future = writer.submit(std::move(task), LocalDBExecutor::Priority::Interactive);
+        future.waitForFinished();
+
+        if constexpr (std::is_void_v<Result>) {
+            return;
+        } else {
+            if (future.isCanceled() || future.resultCount() == 0) {
+                qWarning() << "Local database write not executed: database not open";
+                return Result();
+            }
+            return future.result();
+        }
+    }
+
+    /**
+     * @brief Get the write-behind buffer for small local writes
+     *
+     * Settings overrides and read-only form data are buffered here and
+     * flushed in one transaction on the writer connection. Timer and
+     * threshold flushes are submitted without waiting; only
+     * Durability::Full flushes block, through write(). Readers of those
+     * tables must check pendingValue() first. Created by
+     * initializeConnection() and flushed by closeConnection() and at
+     * application exit.
+     *
+     * @return Coalescer, or nullptr if the database is not open
+     */
+    WriteCoalescer* writeCoalescer();
+
+    /**
+     * @brief Get the path of the open database file
+     * @return Database file path, or empty string if not initialized
+     */
+    QString databasePath() const;
+
+    /**
+     * @brief Apply the standard local database PRAGMAs to a connection
+     *
+     * Used for the main connection and for every additional connection
+     * opened on the same file (WAL, page size, role profile, foreign keys).
+     *
+     * @param database Open connection to the local database file
+     * @param role Workload whose ConnectionProfile should be applied
+     */
+    static void configureConnection(QSqlDatabase& database, ConnectionRole role);
+
     /**
      * @brief Check if database is open
      * @return true if database is open, false otherwise
@@ -61,18 +199,78 @@ public:
     bool isOpen() const;
 
     /**
-     * @brief Create database schema if it doesn't exist
-     * @return true if schema creation successful, false otherwise
+     * @brief Bring the database schema up to date
+     *
+     * Applies pending schemaMigrations() according to PRAGMA user_version;
+     * no DDL runs when the schema is current. On an existing database,
+     * trailing Background (index-only) migrations are left for
+     * initializeConnection() to run on the executor; a new database gets
+     * every migration immediately.
+     *
+     * @return true if the blocking migrations succeeded, false otherwise
      */
     bool createSchema();
 
+    /**
+     * @brief Get the schema version of the open database
+     * @return PRAGMA user_version, or -1 if not open
+     */
+    int schemaVersion();
+
+    /**
+     * @brief Get the schema version this build migrates to
+     * @return Latest migration version
+     */
+    static int latestSchemaVersion();
+
+    /**
+     * @brief Get the ordered migrations of the local database schema
+     * @return Migrator holding every schema version
+     */
+    static SchemaMigrator schemaMigrations();
+
+    /**
+     * @brief Set a callback for migration progress
+     *
+     * Called on the GUI thread for startup migrations and on the executor
+     * thread for background ones. Set before initializeConnection().
+     *
+     * @param handler Progress callback
+     */
+    void setMigrationProgressHandler(const SchemaMigrator::ProgressCallback& handler);
+
 private:
+    // Per-thread read connection, closed on the owning thread when it exits
+    struct ReadConnection {
+        QString connectionName;
+        quint64 generation = 0;
+        ~ReadConnection();
+    };
+
+    // Attached to the thread's ReadConnection
+    struct NativeReadConnection {
+        NativeConnection connection;
+        quint64 generation = 0;
+    };
+
     LocalDBManager() = default;
     ~LocalDBManager() = default;
+
+    static void flushPendingWritesOnExit();
+    static bool createBaselineSchema(QSqlDatabase& database);
     LocalDBManager(const LocalDBManager&) = delete;
     LocalDBManager& operator=(const LocalDBManager&) = delete;
 
     QSqlDatabase m_database;
+    QString m_databasePath;
+    quint64 m_generation = 0;           // Bumped on every open/close to retire stale readers
+    mutable QMutex m_stateMutex;        // Guards m_databasePath and m_generation
+    QThreadStorage<ReadConnection*> m_readConnections;
+    QThreadStorage<NativeReadConnection*> m_nativeReadConnections;
+    LocalDBExecutor m_executor;
+    std::unique_ptr<WriteCoalescer> m_coalescer;  // Flushed through m_executor, so declared after it
+    ConnectionRole m_role = ConnectionRole::LocalLibrary;
+    SchemaMigrator::ProgressCallback m_migrationProgress;
     bool m_initialized = false;
 };
 
@@ -0,0 +1,411 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_NATIVESQLITE_H
+#define SMARTBOOK_COMMON_DATABASE_NATIVESQLITE_H
+
+#include "smartbook/common/database/CartridgeConnectionPool.h"
+#include "smartbook/common/database/ConnectionProfile.h"
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QUtf8StringView>
+#include <QVariant>
+#include <QList>
+#include <memory>
+
+class QSqlQuery;
+
+struct sqlite3;
+struct sqlite3_stmt;
+struct sqlite3_blob;
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Prepared statement on a NativeConnection
+ *
+ * Column accessors read straight from the sqlite3 result row without a
+ * QVariant per value. columnText() and columnBlob() return views into
+ * SQLite's row buffer: they are valid until the next step(), reset() or
+ * destruction of the statement, so copy what must outlive the row.
+ *
+ * Bind and column indexes are 0-based, as with QSqlQuery. Executions are
+ * reported to QueryStats like InstrumentedQuery.
+ *
+ * On a connection that fell back to QtSql the statement wraps a
+ * forward-only QSqlQuery; the views then point into a copy of the row.
+ */
+class NativeStatement {
+public:
+    /**
+     * @brief Storage class of a column value in the current row
+     */
+    enum class ColumnType {
+        Integer,
+        Float,
+        Text,
+        Blob,
+        Null
+    };
+
+    NativeStatement() = default;
+    ~NativeStatement();
+
+    NativeStatement(NativeStatement&& other) noexcept;
+    NativeStatement& operator=(NativeStatement&& other) noexcept;
+    NativeStatement(const NativeStatement&) = delete;
+    NativeStatement& operator=(const NativeStatement&) = delete;
+
+    /**
+     * @brief Check whether the statement was prepared
+     * @return true if prepared successfully
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Get the SQL text of the statement
+     * @return SQL as prepared
+     */
+    QString sql() const;
+
+    bool bindNull(int index);
+    bool bindInt64(int index, qint64 value);
+    bool bindDouble(int index, double value);
+    bool bindText(int index, const QString& value);
+    bool bindBlob(int index, QByteArrayView value);
+
+    /**
+     * @brief Advance to the next row
+     * @return true if a row is available, false when done or on error (see hasError())
+     */
+    bool step();
+
+    /**
+     * @brief Check whether the last step() failed
+     * @return true if the statement stopped with an error
+     */
+    bool hasError() const;
+
+    /**
+     * @brief Get the error message of the last failed step()
+     * @return SQLite error message, or empty string
+     */
+    QString lastError() const;
+
+    /**
+     * @brief Rewind the statement so it can be stepped again; bindings are kept
+     * @return true on success
+     */
+    bool reset();
+
+    /**
+     * @brief Set all bound parameters back to NULL
+     */
+    void clearBindings();
+
+    int columnCount() const;
+    QString columnName(int column) const;
+
+    /**
+     * @brief Look up a result column by name
+     * @param name Column name
+     * @return Column index, or -1 if there is no such column
+     */
+    int columnIndex(const QString& name) const;
+
+    ColumnType columnType(int column) const;
+    bool isNull(int column) const;
+    qint64 columnInt64(int column) const;
+    int columnInt(int column) const;
+    double columnDouble(int column) const;
+
+    /**
+     * @brief Get a text column without copying
+     * @param column Column index
+     * @return UTF-8 view, valid until the next step() (empty for NULL)
+     */
+    QUtf8StringView columnText(int column) const;
+
+    /**
+     * @brief Get a blob column without copying
+     * @param column Column index
+     * @return Byte view, valid until the next step() (empty for NULL)
+     */
+    QByteArrayView columnBlob(int column) const;
+
+    /**
+     * @brief Get a text column as an owned QString
+     * @param column Column index
+     * @return Decoded text (null QString for NULL)
+     */
+    QString columnString(int column) const;
+
+    /**
+     * @brief Get a blob column as an owned QByteArray
+     * @param column Column index
+     * @return Copy of the bytes (null QByteArray for NULL)
+     */
+    QByteArray columnBytes(int column) const;
+
+private:
+    friend class NativeConnection;
+    NativeStatement(sqlite3_stmt* statement, const QString& connectionName);
+    NativeStatement(std::unique_ptr<QSqlQuery> query, const QSqlDatabase& database,
+                    const QString& sql, const QString& connectionName);
+
+    bool bindValue(int index, const QVariant& value);
+    bool execute() const;
+    void loadRow();
+    const QByteArray& rowBytes(int column) const;
+    void finishTrace();
+    QStringList explainQueryPlan() const;
+
+    sqlite3_stmt* m_statement = nullptr;
+    QString m_connectionName;
+
+    // QtSql fallback
+    std::unique_ptr<QSqlQuery> m_query;
+    QSqlDatabase m_database;
+    QString m_sql;
+    QList<QVariant> m_row;
+    mutable QList<QByteArray> m_rowBytes;   // UTF-8 or raw bytes behind the views, filled on demand
+    mutable bool m_executed = false;
+
+    qint64 m_elapsedNs = 0;
+    qint64 m_rows = 0;
+    mutable qint64 m_bytes = 0;
+    bool m_tracing = false;
+    bool m_error = false;
+};
+
+/**
+ * @brief Incremental I/O handle on one BLOB value (sqlite3_blob_open)
+ *
+ * Reads and writes a BLOB in place without materializing it in a result
+ * row. The size of the value is fixed while the handle is open; a write
+ * cannot grow it. The handle becomes invalid if the row is modified or
+ * deleted through another statement.
+ *
+ * On a connection that fell back to QtSql the value is selected into
+ * memory when the handle is opened, and write() is not available.
+ */
+class NativeBlob {
+public:
+    NativeBlob() = default;
+    ~NativeBlob();
+
+    NativeBlob(NativeBlob&& other) noexcept;
+    NativeBlob& operator=(NativeBlob&& other) noexcept;
+    NativeBlob(const NativeBlob&) = delete;
+    NativeBlob& operator=(const NativeBlob&) = delete;
+
+    /**
+     * @brief Check whether the BLOB was opened
+     * @return true if open
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Get the size of the BLOB
+     * @return Size in bytes, or 0 if not open
+     */
+    int size() const;
+
+    /**
+     * @brief Read a range of the BLOB
+     * @param buffer Destination, at least length bytes
+     * @param length Number of bytes to read
+     * @param offset Byte offset to start from
+     * @return true if the whole range was read
+     */
+    bool read(char* buffer, int length, int offset = 0) const;
+
+    /**
+     * @brief Read the whole BLOB into a single allocation
+     * @return BLOB contents, or a null QByteArray on failure
+     */
+    QByteArray readAll() const;
+
+    /**
+     * @brief Overwrite a range of the BLOB (handle must be writable)
+     * @param data Bytes to write; offset + size must not exceed size()
+     * @param offset Byte offset to start at
+     * @return true if written
+     */
+    bool write(QByteArrayView data, int offset = 0);
+
+    /**
+     * @brief Move the handle to the same column of another row
+     * @param rowid Row to point at
+     * @return true if the row exists and holds a BLOB or text value
+     */
+    bool reopen(qint64 rowid);
+
+    void close();
+
+private:
+    friend class NativeConnection;
+    explicit NativeBlob(sqlite3_blob* blob);
+    NativeBlob(const QSqlDatabase& database, const QString& table, const QString& column);
+
+    bool select(qint64 rowid);
+
+    sqlite3_blob* m_blob = nullptr;
+
+    // QtSql fallback
+    QSqlDatabase m_database;
+    QString m_table;
+    QString m_column;
+    QByteArray m_data;
+    bool m_buffered = false;
+};
+
+/**
+ * @brief Direct sqlite3 connection for hot read paths
+ *
+ * Bypasses the QtSql driver, which wraps every value of every row in a
+ * QVariant (and converts text to UTF-16). Used where rows are scanned in
+ * bulk: content hashing, library load, page and resource listing.
+ *
+ * There must be one SQLite library in the process: two copies do not see
+ * each other's POSIX locks, and closing a file in one drops the locks the
+ * other holds on it. The sqlite3 path therefore needs a QSQLITE plugin
+ * built against the SQLite linked here (Qt configured with -system-sqlite).
+ * When it is not (sharesQtSqlLibrary(), e.g. the Qt installer builds, which
+ * bundle SQLite), or when SMARTBOOK_NATIVE_SQLITE=0 is set, the connection
+ * runs the same API on a QtSql connection instead (usesQtSql()): callers
+ * keep working, only without the speedup.
+ *
+ * attach() runs on the handle of an open QtSql connection, so it also sees
+ * that connection's open transaction. open() creates a separate
+ * connection, which in WAL mode sees committed data only.
+ *
+ * A connection (and its statements and blobs) must be used from one
+ * thread at a time; statements and blobs must not outlive it.
+ */
+class NativeConnection {
+public:
+    NativeConnection() = default;
+    ~NativeConnection();
+
+    NativeConnection(const NativeConnection&) = delete;
+    NativeConnection& operator=(const NativeConnection&) = delete;
+
+    /**
+     * @brief Open a database file
+     *
+     * Mirrors CartridgeConnectionPool: ReadOnly opens with mode=ro and
+     * query_only, Immutable adds immutable=1. ReadOnly falls back to
+     * Immutable for files mode=ro cannot read (WAL on read-only media). The role's ConnectionProfile
+     * PRAGMAs are applied after opening.
+     *
+     * @param path Database file path
+     * @param mode Open mode
+     * @param role Workload whose ConnectionProfile configures the connection
+     * @return true if opened, false otherwise (error is logged)
+     */
+    bool open(const QString& path, CartridgeOpenMode mode, ConnectionRole role);
+
+    /**
+     * @brief Use the sqlite3 handle of an open QtSql connection
+     *
+     * The handle stays owned by the QSqlDatabase: close() only detaches,
+     * and the QtSql connection must stay open while this one is used. Use
+     * it on the thread that uses the QSqlDatabase.
+     *
+     * @param database Open QSQLITE connection
+     * @return true if attached, false otherwise (error is logged)
+     */
+    bool attach(const QSqlDatabase& database);
+
+    /**
+     * @brief Check whether the QSQLITE plugin uses the SQLite linked here
+     *
+     * Probed once, by opening an in-memory QtSql connection and checking
+     * that it ran an auto extension registered with this library.
+     *
+     * @return true if there is one SQLite library in the process
+     */
+    static bool sharesQtSqlLibrary();
+
+    /**
+     * @brief Check whether open() and attach() fall back to QtSql
+     *
+     * Checked on each open() and attach(), so SMARTBOOK_NATIVE_SQLITE can
+     * be changed at run time (tests do).
+     *
+     * @return true if the plugin has its own SQLite or SMARTBOOK_NATIVE_SQLITE=0
+     */
+    static bool qtSqlFallbackRequired();
+
+    void close();
+    bool isOpen() const;
+
+    /**
+     * @brief Check whether this connection runs on QtSql
+     * @return true if open() or attach() fell back to QtSql
+     */
+    bool usesQtSql() const;
+
+    /**
+     * @brief Get the path the connection was opened on
+     * @return Database file path, or empty string if not open
+     */
+    QString path() const;
+
+    /**
+     * @brief Get the name the connection reports to QueryStats
+     * @return "native:<file name>"
+     */
+    QString connectionName() const;
+
+    /**
+     * @brief Get the most recent SQLite error message
+     * @return Error message
+     */
+    QString lastError() const;
+
+    /**
+     * @brief Execute statements that return no rows (e.g. PRAGMA)
+     * @param sql One or more SQL statements
+     * @return true on success
+     */
+    bool exec(const QString& sql);
+
+    /**
+     * @brief Prepare a statement
+     * @param sql SQL with positional (?) placeholders
+     * @return Statement (isValid() false on failure; error is logged)
+     */
+    NativeStatement prepare(const QString& sql);
+
+    /**
+     * @brief Open a BLOB for incremental I/O
+     * @param table Table name
+     * @param column Column name
+     * @param rowid Row of the value
+     * @param writable Open for writing (not possible on read-only connections)
+     * @return Blob handle (isValid() false on failure)
+     */
+    NativeBlob openBlob(const QString& table, const QString& column, qint64 rowid, bool writable = false);
+
+private:
+    bool openQtSql(const QString& path, CartridgeOpenMode mode, ConnectionRole role);
+
+    sqlite3* m_handle = nullptr;
+    bool m_attached = false;    // m_handle or m_database belongs to the caller's QSqlDatabase
+    QString m_path;
+    QString m_connectionName;
+
+    // QtSql fallback
+    QSqlDatabase m_database;
+    QString m_lastError;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_NATIVESQLITE_H
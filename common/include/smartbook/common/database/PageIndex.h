@@ -0,0 +1,109 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_PAGEINDEX_H
+#define SMARTBOOK_COMMON_DATABASE_PAGEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+class NativeConnection;
+
+/**
+ * @brief Reading order of a cartridge's pages, held in memory
+ *
+ * Loaded once when a cartridge is opened: one scan of page_id,
+ * page_order and chapter_title over the page_order index. Page turns,
+ * jumps and position lookups are then array and hash lookups instead of
+ * a query per navigation.
+ *
+ * Entries are 12 bytes: chapter titles are stored once and referred to
+ * by number, as consecutive pages mostly share one.
+ */
+class PageIndex {
+public:
+    /**
+     * @brief Load the index of a cartridge
+     * @param connection Connection to the cartridge
+     * @return true if loaded (the cartridge may have no pages)
+     */
+    bool load(NativeConnection& connection);
+
+    void clear();
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    int size() const { return static_cast<int>(m_entries.size()); }
+    bool contains(int pageId) const { return m_positions.contains(pageId); }
+
+    /**
+     * @brief Get the position of a page in reading order
+     * @param pageId Page
+     * @return 0-based position, -1 if there is no such page
+     */
+    int positionOf(int pageId) const { return m_positions.value(pageId, -1); }
+
+    /**
+     * @brief Get the page at a position in reading order
+     * @param position 0-based position
+     * @return page_id, -1 if out of range
+     */
+    int pageAt(int position) const;
+
+    int firstPage() const { return pageAt(0); }
+    int lastPage() const { return pageAt(size() - 1); }
+
+    /**
+     * @brief Get the page after or before another
+     * @param pageId Page
+     * @param step Pages to move, negative to go back
+     * @return page_id, -1 if pageId is unknown or the move leaves the cartridge
+     */
+    int neighbour(int pageId, int step) const;
+
+    /**
+     * @brief Get the page at a fraction of the cartridge
+     * @param percent 0 (first page) to 100 (last page); clamped
+     * @return page_id, -1 if there are no pages
+     */
+    int pageAtPercent(double percent) const;
+
+    /**
+     * @brief Get how far into the cartridge a page is
+     * @param pageId Page
+     * @return 0 to 100, -1 if there is no such page
+     */
+    double percentOf(int pageId) const;
+
+    /**
+     * @brief Get the chapter of a page
+     * @param pageId Page
+     * @return chapter_title, empty if none or no such page
+     */
+    QString chapterTitle(int pageId) const;
+
+    /**
+     * @brief Get the first page of a chapter
+     * @param chapterTitle chapter_title as stored
+     * @return page_id, -1 if no page has that chapter
+     */
+    int firstPageOfChapter(const QString& chapterTitle) const;
+
+private:
+    struct Entry {
+        int pageId;
+        int pageOrder;
+        int chapter;        // Into m_chapters, -1 for none
+    };
+
+    QList<Entry> m_entries;             // In page_order
+    QHash<int, int> m_positions;        // page_id -> position
+    QStringList m_chapters;             // Distinct titles, in first appearance
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_PAGEINDEX_H
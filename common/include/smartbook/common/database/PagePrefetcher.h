@@ -0,0 +1,141 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_PAGEPREFETCHER_H
+#define SMARTBOOK_COMMON_DATABASE_PAGEPREFETCHER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QCache>
+#include <atomic>
+#include <memory>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+class NativeConnection;
+
+/**
+ * @brief Reads the pages around the current one ahead of the reader
+ *
+ * prefetchAround() reads the neighbours of a page by page_order, the
+ * given depth each way, on a worker thread with its own read-only
+ * connection. Their Content_Pages rows are kept in a cache bounded by a
+ * memory budget (least recently used pages go first), so turning to one
+ * of them costs no query. The resources the pages refer to are read once
+ * without being kept, which brings them into the OS page cache for the
+ * renderer's requests.
+ *
+ * Each prefetchAround() cancels the one before: a jump elsewhere in the
+ * cartridge stops the worker at the next page or resource and drops what
+ * it read.
+ */
+class PagePrefetcher : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief One prefetched Content_Pages row
+     *
+     * Text is kept as stored (UTF-8), ready to be copied into a document.
+     */
+    struct Page {
+        int pageId = -1;
+        int pageOrder = 0;
+        QByteArray htmlContent;
+        QByteArray associatedCss;
+        QStringList resources;      // resource_id or resource_path, as referenced
+
+        qint64 cost() const { return htmlContent.size() + associatedCss.size(); }
+    };
+
+    explicit PagePrefetcher(QObject* parent = nullptr);
+    ~PagePrefetcher() override;
+
+    /**
+     * @brief Set the cartridge to prefetch from
+     *
+     * Cancels running work and empties the cache.
+     *
+     * @param cartridgePath Path to the cartridge file; empty to stop
+     */
+    void setCartridge(const QString& cartridgePath);
+
+    /**
+     * @brief Set how much page content is kept
+     * @param bytes Budget for the cached pages (default 8 MB)
+     */
+    void setMemoryBudget(qint64 bytes);
+
+    /**
+     * @brief Set how many pages are read on each side of the current one
+     * @param ahead Pages after it (default 2)
+     * @param behind Pages before it (default 1)
+     */
+    void setDepth(int ahead, int behind);
+
+    /**
+     * @brief Read the neighbours of a page in the background
+     * @param pageId Page being shown
+     */
+    void prefetchAround(int pageId);
+
+    /**
+     * @brief Stop running work; already cached pages are kept
+     */
+    void cancel();
+
+    /**
+     * @brief Get a cached page
+     * @param pageId Page
+     * @return Copy of the row, or a Page with pageId -1 if it is not cached
+     */
+    Page page(int pageId) const;
+
+    /**
+     * @brief Check whether a page is cached
+     */
+    bool contains(int pageId) const { return m_pages.contains(pageId); }
+
+    /**
+     * @brief Get the resources a page refers to
+     *
+     * Reads src, href, poster and data attributes and CSS url() values that
+     * resolve to smartbook://<cartridge>/resource/... from a page URL, or
+     * are DDD 11 smartbook://resource/... links.
+     *
+     * @param html Page HTML
+     * @param css Page CSS
+     * @return Referenced resource_id or resource_path values, without duplicates
+     */
+    static QStringList referencedResources(const QString& html, const QString& css = QString());
+
+signals:
+    /**
+     * @brief Emitted on the prefetcher's thread when a page was added to the cache
+     */
+    void pageReady(int pageId);
+
+private:
+    struct Options {
+        int ahead = 2;
+        int behind = 1;
+        qint64 budget = 8 * 1024 * 1024;
+    };
+
+    static QList<Page> fetch(const QString& cartridgePath, int pageId, const Options& options,
+                             const std::atomic_bool& cancelled);
+    static qint64 warmResources(NativeConnection& connection, const QStringList& resources,
+                                qint64 budget, const std::atomic_bool& cancelled);
+
+    QString m_cartridgePath;
+    Options m_options;
+    QCache<int, Page> m_pages;
+    std::shared_ptr<std::atomic_bool> m_cancelled;      // Of the running prefetch
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_PAGEPREFETCHER_H
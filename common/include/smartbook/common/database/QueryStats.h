@@ -0,0 +1,183 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_QUERYSTATS_H
+#define SMARTBOOK_COMMON_DATABASE_QUERYSTATS_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <array>
+#include <atomic>
+
+class QSettings;
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Process-wide per-statement query statistics and slow-query log
+ *
+ * Statements are grouped by their normalized SQL text (literals replaced
+ * by "?", whitespace collapsed), so the same query with different values
+ * shares one entry. Each entry keeps call, row and byte counters plus a
+ * log-linear latency histogram from which p50/p95/p99 are derived.
+ *
+ * Executions at or above the slow-query threshold are appended to a
+ * bounded slow-query log together with their EXPLAIN QUERY PLAN output.
+ *
+ * Samples are fed by InstrumentedQuery; this class is thread-safe.
+ */
+class QueryStats {
+public:
+    /**
+     * @brief Aggregated statistics for one normalized statement
+     */
+    struct StatementStats {
+        QString sql;             // Normalized SQL
+        qint64 calls = 0;
+        qint64 totalNs = 0;      // Time spent in exec() and next()
+        qint64 maxNs = 0;
+        qint64 rows = 0;         // Rows stepped with next()
+        qint64 bytes = 0;        // Approximate size of values read
+        qint64 p50Ns = 0;
+        qint64 p95Ns = 0;
+        qint64 p99Ns = 0;
+        QStringList plan;        // Captured on the first slow execution
+    };
+
+    /**
+     * @brief One entry of the slow-query log
+     */
+    struct SlowQuery {
+        QString sql;             // Normalized SQL
+        QString connectionName;
+        qint64 elapsedNs = 0;
+        qint64 rows = 0;
+        QDateTime timestamp;
+        QStringList plan;
+    };
+
+    static QueryStats& getInstance();
+
+    /**
+     * @brief Normalize SQL text for grouping
+     * @param sql Raw SQL
+     * @return SQL with literals replaced by "?" and whitespace collapsed
+     */
+    static QString normalize(const QString& sql);
+
+    /**
+     * @brief Read diagnostics settings
+     *
+     * Keys: diagnostics/query_stats_enabled (bool),
+     * diagnostics/slow_query_ms (int).
+     *
+     * @param settings Application settings
+     */
+    void loadSettings(QSettings& settings);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    void setSlowQueryThresholdMs(int thresholdMs);
+    int slowQueryThresholdMs() const;
+
+    /**
+     * @brief Record one statement execution
+     * @param sql Raw SQL as executed
+     * @param connectionName Connection the statement ran on
+     * @param elapsedNs Time spent executing and stepping
+     * @param rows Rows stepped
+     * @param bytes Approximate bytes read from result values
+     * @return true if the execution was slow and the statement has no
+     *         captured plan yet; the caller should then supply one with
+     *         attachPlan()
+     */
+    bool record(const QString& sql, const QString& connectionName,
+                qint64 elapsedNs, qint64 rows, qint64 bytes);
+
+    /**
+     * @brief Store the query plan for a statement
+     *
+     * Also fills in the plan of the most recent slow-query log entry for
+     * the statement.
+     *
+     * @param sql Raw SQL as executed
+     * @param plan EXPLAIN QUERY PLAN detail lines
+     */
+    void attachPlan(const QString& sql, const QStringList& plan);
+
+    /**
+     * @brief Get statistics for all statements
+     * @return Entries sorted by total time, highest first
+     */
+    QList<StatementStats> statements() const;
+
+    /**
+     * @brief Get the slow-query log
+     * @return Entries oldest first
+     */
+    QList<SlowQuery> slowQueries() const;
+
+    /**
+     * @brief Serialize statistics and slow-query log
+     * @return JSON object with "statements" and "slow_queries" arrays
+     */
+    QJsonObject toJson() const;
+
+    /**
+     * @brief Write toJson() to a file
+     * @param filePath Output path
+     * @return true if written, false otherwise
+     */
+    bool dumpJson(const QString& filePath) const;
+
+    /**
+     * @brief Clear all statistics and the slow-query log
+     */
+    void reset();
+
+private:
+    QueryStats() = default;
+    ~QueryStats() = default;
+    QueryStats(const QueryStats&) = delete;
+    QueryStats& operator=(const QueryStats&) = delete;
+
+    // Four buckets per power of two of microseconds, up to ~4.5 minutes
+    static constexpr int kBucketCount = 112;
+    static constexpr int kSlowLogCapacity = 100;
+    static constexpr int kNormalizedCacheCapacity = 1024;
+
+    struct Entry {
+        qint64 calls = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+        qint64 rows = 0;
+        qint64 bytes = 0;
+        std::array<qint64, kBucketCount> histogram{};
+        QStringList plan;
+    };
+
+    static int bucketFor(qint64 elapsedNs);
+    static qint64 bucketUpperBoundNs(int bucket);
+    static qint64 percentile(const Entry& entry, double fraction);
+
+    QString normalizedLocked(const QString& sql);
+
+    std::atomic<bool> m_enabled{true};
+    std::atomic<int> m_slowThresholdMs{25};
+
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;         // Keyed by normalized SQL
+    QHash<QString, QString> m_normalized;    // Raw SQL -> normalized SQL
+    QList<SlowQuery> m_slowQueries;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_QUERYSTATS_H
@@ -0,0 +1,161 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_SCHEMAMIGRATOR_H
+#define SMARTBOOK_COMMON_DATABASE_SCHEMAMIGRATOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <functional>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Ordered schema migrations keyed by PRAGMA user_version
+ *
+ * Each migration moves the schema to its version. Pending migrations run
+ * in ascending order, each in its own transaction together with the
+ * user_version update, so a failed migration leaves the schema at the
+ * previous version. When user_version already equals latestVersion() no
+ * DDL is executed at all.
+ *
+ * Migrations that only add or drop indexes can be marked Background: the
+ * caller may apply everything up to them at startup (Scope::Blocking) and
+ * run the rest later on another connection while readers continue. Since
+ * user_version is a single number, a Background migration followed by a
+ * Blocking one still runs at startup; register slow ones after the last
+ * Blocking migration.
+ *
+ * Foreign key enforcement is switched off while migrating (as required
+ * for table rebuilds) and PRAGMA foreign_key_check is run before each
+ * commit instead.
+ */
+class SchemaMigrator {
+public:
+    /**
+     * @brief When a migration may run
+     */
+    enum class Mode {
+        Blocking,   // Must be applied before the database is used
+        Background  // Index changes only; may run after startup
+    };
+
+    /**
+     * @brief Which pending migrations migrate() applies
+     */
+    enum class Scope {
+        Blocking,   // Stop at the trailing run of Background migrations
+        Next,       // Only the first pending migration
+        All
+    };
+
+    /**
+     * @brief Progress of the running migration
+     */
+    struct Progress {
+        int version = 0;        // Version being migrated to
+        QString description;
+        qint64 done = 0;        // Units of work done (rows for table rebuilds)
+        qint64 total = 0;       // Total units, 0 if unknown
+    };
+
+    using ProgressCallback = std::function<void(const Progress& progress)>;
+
+    /**
+     * @brief Reports work done inside one migration
+     */
+    using Reporter = std::function<void(qint64 done, qint64 total)>;
+
+    /**
+     * @brief Migration body; runs inside the migration's transaction
+     */
+    using Step = std::function<bool(QSqlDatabase& database, const Reporter& report)>;
+
+    /**
+     * @brief Register a migration
+     * @param version Schema version after the migration (unique, > 0)
+     * @param description Shown in logs and progress reports
+     * @param step Migration body
+     * @param mode When the migration may run
+     */
+    void addMigration(int version, const QString& description, Step step, Mode mode = Mode::Blocking);
+
+    /**
+     * @brief Register a migration made of plain SQL statements
+     * @param version Schema version after the migration (unique, > 0)
+     * @param description Shown in logs and progress reports
+     * @param statements Statements executed in order; progress is reported per statement
+     * @param mode When the migration may run
+     */
+    void addMigration(int version, const QString& description, const QStringList& statements,
+                      Mode mode = Mode::Blocking);
+
+    /**
+     * @brief Get the version the registered migrations lead to
+     * @return Highest registered version, 0 if none
+     */
+    int latestVersion() const;
+
+    /**
+     * @brief Read PRAGMA user_version
+     * @param database Open connection
+     * @return Stored schema version (0 for a new database), -1 on error
+     */
+    static int currentVersion(QSqlDatabase& database);
+
+    /**
+     * @brief Check whether no migrations are pending
+     * @param database Open connection
+     * @return true if user_version is at least latestVersion()
+     */
+    bool isCurrent(QSqlDatabase& database) const;
+
+    /**
+     * @brief Apply pending migrations
+     * @param database Open connection, not inside a transaction
+     * @param scope Which pending migrations to apply
+     * @param progress Optional progress callback (called on the calling thread)
+     * @return true if every migration in scope was applied, false otherwise
+     */
+    bool migrate(QSqlDatabase& database, Scope scope = Scope::All,
+                 const ProgressCallback& progress = ProgressCallback()) const;
+
+    /**
+     * @brief Rebuild a table with a new definition, keeping its rows
+     *
+     * Implements SQLite's generalized ALTER TABLE procedure for use inside
+     * a migration step: create the new table under a temporary name, copy
+     * the rows in rowid batches (reporting progress), drop the old table
+     * and rename the new one. Indexes and triggers on the old table are
+     * dropped with it and must be recreated by the caller.
+     *
+     * @param database Connection inside the migration's transaction
+     * @param table Table to rebuild
+     * @param createSql CREATE TABLE statement for the new definition, using %1 as the table name
+     * @param columns Columns copied from the old table (same names in the new one)
+     * @param report Progress reporter of the migration step
+     * @param batchSize Rows copied per statement
+     * @return true on success
+     */
+    static bool rebuildTable(QSqlDatabase& database, const QString& table, const QString& createSql,
+                             const QStringList& columns, const Reporter& report, int batchSize = 5000);
+
+private:
+    struct Migration {
+        int version = 0;
+        QString description;
+        Step step;
+        Mode mode = Mode::Blocking;
+    };
+
+    bool apply(QSqlDatabase& database, const Migration& migration, const ProgressCallback& progress) const;
+
+    QList<Migration> m_migrations;   // Sorted by version
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_SCHEMAMIGRATOR_H
@@ -0,0 +1,102 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_STATEMENTCACHE_H
+#define SMARTBOOK_COMMON_DATABASE_STATEMENTCACHE_H
+
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <memory>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Handle to a prepared statement borrowed from a StatementCache
+ *
+ * The statement is reset (QSqlQuery::finish) when the handle is destroyed,
+ * which releases SQLite read locks while keeping the compiled statement
+ * for the next use. Handles are move-only. Statements are
+ * InstrumentedQuery objects, so stepping through the handle is recorded
+ * in QueryStats.
+ */
+class PreparedQuery {
+public:
+    PreparedQuery() = default;
+    explicit PreparedQuery(std::shared_ptr<InstrumentedQuery> query);
+    ~PreparedQuery();
+
+    PreparedQuery(PreparedQuery&& other) noexcept = default;
+    PreparedQuery& operator=(PreparedQuery&& other) noexcept;
+    PreparedQuery(const PreparedQuery&) = delete;
+    PreparedQuery& operator=(const PreparedQuery&) = delete;
+
+    /**
+     * @brief Check whether the handle refers to a prepared statement
+     * @return false if preparation failed or the connector was not open
+     */
+    bool isPrepared() const { return m_query != nullptr; }
+
+    InstrumentedQuery* operator->() const { return m_query.get(); }
+    InstrumentedQuery& operator*() const { return *m_query; }
+
+private:
+    std::shared_ptr<InstrumentedQuery> m_query;
+};
+
+/**
+ * @brief Per-connection cache of prepared statements keyed by SQL text
+ *
+ * Statements are prepared once and reused for the lifetime of the
+ * connection, so repeated queries skip SQL parsing and planning. When
+ * full, the least recently used statement is evicted.
+ * A cache belongs to one QtSql connection and must only be used from the
+ * thread that owns that connection.
+ */
+class StatementCache {
+public:
+    /**
+     * @brief Statement cache counters
+     */
+    struct Stats {
+        qint64 hits = 0;        // Statement reused without re-preparing
+        qint64 prepares = 0;    // Statement compiled by SQLite
+        int cachedStatements = 0;
+    };
+
+    explicit StatementCache(const QString& connectionName, int capacity = 64);
+    ~StatementCache();
+
+    /**
+     * @brief Get a prepared, reset statement for the given SQL
+     * @param queryString SQL with positional (?) placeholders
+     * @return Prepared statement, or nullptr if preparation failed
+     */
+    std::shared_ptr<InstrumentedQuery> statement(const QString& queryString);
+
+    /**
+     * @brief Drop all cached statements (required before removing the connection)
+     */
+    void clear();
+
+    /**
+     * @brief Get cache counters
+     * @return Hits, prepares and current cache size
+     */
+    Stats stats() const;
+
+private:
+    void touch(const QString& queryString);
+
+    QString m_connectionName;
+    int m_capacity;
+    QHash<QString, std::shared_ptr<InstrumentedQuery>> m_statements;
+    QStringList m_order;  // Least recently used first, for eviction
+    Stats m_stats;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_STATEMENTCACHE_H
@@ -0,0 +1,213 @@
+#ifndef SMARTBOOK_COMMON_DATABASE_WRITECOALESCER_H
+#define SMARTBOOK_COMMON_DATABASE_WRITECOALESCER_H
+
+#include <QObject>
+#include <QFuture>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QHash>
+#include <functional>
+#include <memory>
+
+class QTimer;
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+/**
+ * @brief Write-behind buffer for frequent small keyed writes
+ *
+ * Form autosave and settings changes can arrive many times a second.
+ * Instead of one autocommit transaction per call, writes are buffered per
+ * key (only the latest value of a key is kept) and flushed together in a
+ * single transaction when the flush interval elapses, when maxPending()
+ * distinct keys are buffered, on flush(), on destruction, or when the
+ * application is about to quit.
+ *
+ * Readers must consult pendingValue() before the database so that
+ * buffered values are visible immediately. That includes a batch that has
+ * been submitted but has not committed yet.
+ *
+ * A coalescer is used from the thread that created it; the runner decides
+ * which connection (and thread) the batch executes on. With a submitter
+ * (setSubmitter()) only Durability::Full flushes wait for the runner;
+ * the others hand the batch over and return.
+ */
+class WriteCoalescer : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief One buffered write; returns false if the statement failed
+     */
+    using Write = std::function<bool(QSqlDatabase&)>;
+
+    /**
+     * @brief Executes a batch on the target connection and returns its result
+     */
+    using Runner = std::function<bool(const Write& batch)>;
+
+    /**
+     * @brief Starts a batch on the target connection without waiting; the future reports whether it committed
+     */
+    using Submitter = std::function<QFuture<bool>(const Write& batch)>;
+
+    /**
+     * @brief Durability of a flush
+     */
+    enum class Durability {
+        Normal,  // Connection's synchronous setting (NORMAL: durable at next checkpoint)
+        Full     // Barrier: WAL is synced before flush() returns
+    };
+
+    /**
+     * @brief Coalescing counters
+     */
+    struct Stats {
+        qint64 enqueued = 0;     // Calls to enqueue()
+        qint64 coalesced = 0;    // Writes replaced by a newer value before flushing
+        qint64 written = 0;      // Writes executed
+        qint64 failed = 0;       // Writes dropped because their statement failed
+        qint64 flushes = 0;      // Transactions committed
+    };
+
+    explicit WriteCoalescer(Runner runner, QObject* parent = nullptr);
+    ~WriteCoalescer();
+
+    /**
+     * @brief Flush without waiting, except for Durability::Full
+     *
+     * Timer, threshold and Durability::Normal flushes submit the batch and
+     * return. When it completes its counters are added to stats(), or, if
+     * it failed, its writes are buffered again (newer values win) and
+     * retried after the flush interval. One batch is in flight at a time;
+     * a Full flush first waits for it.
+     *
+     * @param submitter Starts a batch; the runner still executes Full flushes
+     */
+    void setSubmitter(Submitter submitter);
+
+    /**
+     * @brief Set how long a write may stay buffered
+     * @param milliseconds Delay between the first buffered write and the flush
+     */
+    void setFlushInterval(int milliseconds);
+    int flushInterval() const;
+
+    /**
+     * @brief Set the number of distinct buffered keys that forces a flush
+     * @param count Key threshold
+     */
+    void setMaxPending(int count);
+    int maxPending() const;
+
+    /**
+     * @brief Buffer a write, replacing any pending write for the same key
+     * @param key Identifies what is written (e.g. "form/<guid>/<form id>")
+     * @param value Value being written, returned by pendingValue() until flushed
+     * @param write Statement(s) to run on the target connection
+     */
+    void enqueue(const QString& key, const QVariant& value, Write write);
+
+    /**
+     * @brief Check whether a write for the key is buffered or in flight
+     * @param key Write key
+     * @return true if pending
+     */
+    bool hasPending(const QString& key) const;
+
+    /**
+     * @brief Get the buffered (or in-flight) value for a key
+     * @param key Write key
+     * @return Pending value, or an invalid QVariant if nothing is buffered
+     */
+    QVariant pendingValue(const QString& key) const;
+
+    /**
+     * @brief Get all buffered values whose key starts with a prefix
+     * @param prefix Key prefix
+     * @return Map of key suffix (after the prefix) -> pending value
+     */
+    QHash<QString, QVariant> pendingWithPrefix(const QString& prefix) const;
+
+    /**
+     * @brief Drop buffered writes whose key starts with a prefix
+     *
+     * Used when the rows they would write are about to be deleted. A
+     * batch in flight still runs; it only stops reporting those values,
+     * so the delete must be queued behind it on the same connection.
+     *
+     * @param prefix Key prefix
+     * @return Number of writes dropped
+     */
+    int discard(const QString& prefix);
+
+    /**
+     * @brief Get the number of buffered writes
+     * @return Number of distinct pending keys, not counting a batch in flight
+     */
+    int pendingCount() const;
+
+    /**
+     * @brief Write all buffered values in one transaction
+     *
+     * With Durability::Full this is a durability barrier for explicit
+     * saves: the WAL is synced before returning. Writes whose statement
+     * fails are logged and dropped; if the transaction itself fails the
+     * writes stay buffered for the next flush.
+     *
+     * With a submitter, a Normal flush only submits the batch (or leaves
+     * it for when the batch in flight completes).
+     *
+     * @param durability Sync level for this transaction
+     * @return true if nothing was pending, the batch was submitted, or the transaction committed
+     */
+    bool flush(Durability durability = Durability::Normal);
+
+    /**
+     * @brief Get coalescing counters
+     * @return Counters since construction
+     */
+    Stats stats() const;
+
+private:
+    struct Pending {
+        QVariant value;
+        Write write;
+    };
+
+    // One flushed batch; the worker reads batch and order and sets the counters
+    struct Batch {
+        QHash<QString, Pending> batch;
+        QStringList order;
+        QHash<QString, QVariant> visible;   // What readers still see; coalescer thread only
+        qint64 written = 0;
+        qint64 failed = 0;
+        QFuture<bool> future;
+        bool completed = false;
+    };
+
+    void onTimeout();
+    Write batchWrite(const std::shared_ptr<Batch>& batch, Durability durability) const;
+    bool complete(const std::shared_ptr<Batch>& batch, bool committed);
+    void waitForInFlight();
+
+    Runner m_runner;
+    Submitter m_submitter;
+    std::shared_ptr<Batch> m_inFlight;
+    QTimer* m_timer;
+    int m_maxPending = 64;
+    QHash<QString, Pending> m_pending;
+    QStringList m_order;    // Keys in first-enqueued order
+    Stats m_stats;
+    bool m_flushing = false;
+};
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_DATABASE_WRITECOALESCER_H
@@ -0,0 +1,181 @@
+#ifndef SMARTBOOK_COMMON_MANIFEST_CARTRIDGEIMPORTER_H
+#define SMARTBOOK_COMMON_MANIFEST_CARTRIDGEIMPORTER_H
+
+#include "smartbook/common/manifest/ManifestManager.h"
+#include <QObject>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <atomic>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+class CartridgeImportJob;
+
+/**
+ * @brief Imports many cartridges into the library at once
+ *
+ * Each cartridge is processed by a job on a private thread pool: metadata
+ * extraction, content hashing and signature verification (each on its own
+ * read-only connection), then cover thumbnail rendering. Reading is capped
+ * separately from the worker count, so a slow disk is not swamped with
+ * competing reads while decoding still uses every core.
+ *
+ * Finished cartridges are collected on the importer's thread and written
+ * with ManifestManager::importManifestEntriesAsync() in batches, one
+ * transaction per batch on the database executor. Cartridges are
+ * registered where they are; nothing is copied.
+ *
+ * Re-importing a cartridge whose hash and location are unchanged writes
+ * nothing. A file that cannot be read, lacks required metadata or fails
+ * verification is reported through fileFinished() and does not stop the
+ * import.
+ */
+class CartridgeImporter : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        int workerCount = 0;            // Processing threads; 0 = one per core
+        int maxConcurrentReads = 0;     // Cartridges read at once; 0 = workerCount
+        int batchSize = 200;            // Cartridges per manifest transaction
+    };
+
+    /**
+     * @brief Outcome of one file
+     */
+    struct FileResult {
+        QString path;
+        QString cartridgeGuid;
+        ManifestManager::ImportOutcome outcome = ManifestManager::ImportOutcome::Failed;
+        QString errorMessage;           // Set when outcome is Failed
+    };
+
+    /**
+     * @brief Totals of the last import
+     */
+    struct Summary {
+        int total = 0;                  // Cartridges found
+        int created = 0;
+        int updated = 0;
+        int unchanged = 0;
+        int failed = 0;
+        bool cancelled = false;         // Cartridges not processed are in none of the counts
+        qint64 elapsedMs = 0;
+        QList<FileResult> failures;
+    };
+
+    explicit CartridgeImporter(QObject* parent = nullptr);
+    ~CartridgeImporter();
+
+    /**
+     * @brief Set concurrency and batching for the next import
+     * @param options Import options
+     */
+    void setOptions(const Options& options);
+    Options options() const { return m_options; }
+
+    /**
+     * @brief Expand files and directories into cartridge files
+     *
+     * Directories are searched recursively for *.sqlite files; files given
+     * explicitly are taken whatever their extension. Duplicates are
+     * dropped, the order is kept.
+     *
+     * @param paths Files and directories
+     * @return Absolute paths of the cartridge files
+     */
+    static QStringList collectCartridges(const QStringList& paths);
+
+    /**
+     * @brief Start importing
+     * @param paths Files and directories (see collectCartridges())
+     * @return false if an import is already running
+     */
+    bool start(const QStringList& paths);
+
+    /**
+     * @brief Stop importing
+     *
+     * Jobs not yet started are dropped. Cartridges already processed are
+     * still written, then finished() is emitted.
+     */
+    void cancel();
+
+    /**
+     * @brief Check whether an import is running
+     * @return true between start() and finished()
+     */
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief Get the totals of the current or last import
+     * @return Summary
+     */
+    Summary summary() const { return m_summary; }
+
+signals:
+    /**
+     * @brief Files processed so far
+     * @param processed Files read, verified and rendered (or failed)
+     * @param total Files found
+     */
+    void progress(int processed, int total);
+
+    /**
+     * @brief One file's outcome is final
+     * @param path Cartridge file
+     * @param success false if the file was not imported
+     * @param errorMessage Why the file was not imported
+     */
+    void fileFinished(const QString& path, bool success, const QString& errorMessage);
+
+    /**
+     * @brief All processed cartridges are written; see summary()
+     * @param cancelled true if cancel() stopped the import early
+     */
+    void finished(bool cancelled);
+
+private:
+    friend class CartridgeImportJob;
+
+    // Work done on a pool thread for one file
+    struct Processed {
+        QString path;
+        ManifestManager::ImportItem item;
+        QString errorMessage;       // Empty on success
+        bool skipped = false;       // Cancelled before it started reading
+    };
+
+    static Processed process(const QString& path, QSemaphore& readSlots, const std::atomic_bool& cancelled);
+
+    void jobFinished(const Processed& processed);
+    void flushBatch();
+    void recordResult(const FileResult& result);
+    void finishIfDone();
+
+    Options m_options;
+    QThreadPool m_pool;
+    QSemaphore m_readSlots;
+    std::atomic_bool m_cancelled{false};
+    ManifestManager* m_manifestManager;
+
+    bool m_running = false;
+    int m_processed = 0;
+    int m_batchesInFlight = 0;
+    QList<ManifestManager::ImportItem> m_batch;
+    QStringList m_batchPaths;
+    Summary m_summary;
+    QElapsedTimer m_timer;
+};
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_MANIFEST_CARTRIDGEIMPORTER_H
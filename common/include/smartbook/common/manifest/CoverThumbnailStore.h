@@ -0,0 +1,198 @@
+#ifndef SMARTBOOK_COMMON_MANIFEST_COVERTHUMBNAILSTORE_H
+#define SMARTBOOK_COMMON_MANIFEST_COVERTHUMBNAILSTORE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <QList>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+/**
+ * @brief Pre-scaled cover thumbnails in Local_Cover_Thumbnails
+ *
+ * The Bookshelf view shows covers at a fixed logical size. Instead of
+ * decoding and scaling the full cover_image_data on every refresh, each
+ * cover is rendered once per supported device pixel ratio and stored as a
+ * small image keyed by (cartridge_guid, scale).
+ *
+ * Every thumbnail records the cartridge_hash it was rendered from; a
+ * thumbnail whose hash no longer matches the manifest row is stale and
+ * ignored by readers. A trigger drops thumbnails when the hash changes and
+ * the foreign key cascades them away with the manifest row.
+ *
+ * Covers that cannot be decoded get an empty thumbnail so they are not
+ * retried on every refresh.
+ *
+ * All functions are static and run on whichever connection the caller owns
+ * (QImage is safe to use off the GUI thread).
+ */
+class CoverThumbnailStore {
+public:
+    /**
+     * @brief One encoded thumbnail, rendered ahead of storing it
+     */
+    struct Thumbnail {
+        int scale = 1;
+        QSize size;             // Pixel size; empty if the cover did not decode
+        QByteArray imageData;   // Encoded image, empty if the cover did not decode
+    };
+
+    /**
+     * @brief A cover without current thumbnails, as read by pendingCovers()
+     */
+    struct PendingCover {
+        QString cartridgeGuid;
+        QByteArray cartridgeHash;   // Hash the cover was read at
+        QByteArray coverImage;      // Encoded full-size cover
+        QList<Thumbnail> thumbnails; // Set by the caller from renderAll()
+    };
+
+    /**
+     * @brief Logical size of a Bookshelf cover
+     * @return Thumbnail size at scale 1
+     */
+    static QSize thumbnailSize();
+
+    /**
+     * @brief Device pixel ratios thumbnails are rendered for
+     * @return Supported scales in ascending order
+     */
+    static QList<int> scales();
+
+    /**
+     * @brief Pick the stored scale for a screen
+     * @param devicePixelRatio Device pixel ratio of the view
+     * @return Smallest supported scale covering the ratio (largest if none does)
+     */
+    static int scaleFor(qreal devicePixelRatio);
+
+    /**
+     * @brief Decode an image directly at a reduced size
+     *
+     * Uses QImageReader::setScaledSize, so formats that support it (JPEG)
+     * decode at a fraction of the full resolution instead of decoding the
+     * whole image and scaling afterwards. Safe to call from any thread.
+     *
+     * @param data Encoded image
+     * @param maxSize Box the result is fitted into (aspect ratio kept)
+     * @return Decoded image, null if the data cannot be decoded
+     */
+    static QImage decodeScaled(const QByteArray& data, const QSize& maxSize);
+
+    /**
+     * @brief Decode a cover and scale it to thumbnail size
+     * @param coverImage Encoded cover image
+     * @param scale Device pixel ratio to render for
+     * @return Scaled image (aspect ratio kept), null if the cover cannot be decoded
+     */
+    static QImage render(const QByteArray& coverImage, int scale);
+
+    /**
+     * @brief Encode a rendered thumbnail for storage
+     * @param thumbnail Image returned by render()
+     * @return Encoded image, empty if the image is null
+     */
+    static QByteArray encode(const QImage& thumbnail);
+
+    /**
+     * @brief Render and encode thumbnails of one cover at every scale
+     *
+     * The CPU-heavy half of store(), for callers that render on worker
+     * threads and store on the writer connection with storeRendered().
+     *
+     * @param coverImage Encoded cover image
+     * @return One thumbnail per scale(), empty if there is no cover
+     */
+    static QList<Thumbnail> renderAll(const QByteArray& coverImage);
+
+    /**
+     * @brief Store thumbnails returned by renderAll()
+     * @param database Writer connection
+     * @param cartridgeGuid Cartridge GUID
+     * @param cartridgeHash Hash the thumbnails are valid for
+     * @param thumbnails Rendered thumbnails (empty removes the thumbnails)
+     * @return true on success
+     */
+    static bool storeRendered(QSqlDatabase& database, const QString& cartridgeGuid,
+                              const QByteArray& cartridgeHash, const QList<Thumbnail>& thumbnails);
+
+    /**
+     * @brief Render and store thumbnails of one cover at every scale
+     *
+     * Does nothing when thumbnails for the same cartridge hash already exist.
+     *
+     * @param database Writer connection
+     * @param cartridgeGuid Cartridge GUID
+     * @param cartridgeHash Hash the thumbnails are valid for
+     * @param coverImage Encoded cover image (empty removes the thumbnails)
+     * @return true on success
+     */
+    static bool store(QSqlDatabase& database, const QString& cartridgeGuid,
+                      const QByteArray& cartridgeHash, const QByteArray& coverImage);
+
+    /**
+     * @brief Get a stored thumbnail
+     * @param database Open connection
+     * @param cartridgeGuid Cartridge GUID
+     * @param scale Scale as returned by scaleFor()
+     * @return Encoded thumbnail, empty if missing, stale or not decodable
+     */
+    static QByteArray thumbnail(QSqlDatabase& database, const QString& cartridgeGuid, int scale);
+
+    /**
+     * @brief Read covers that have no thumbnails or stale ones
+     *
+     * The read half of a backfill: the caller renders the covers with
+     * renderAll() off the database thread and stores them with
+     * storeRendered(database, covers).
+     *
+     * @param database Open connection
+     * @param limit Maximum number of covers to read, <= 0 for all
+     * @return Covers to render, empty if none or on error
+     */
+    static QList<PendingCover> pendingCovers(QSqlDatabase& database, int limit = 0);
+
+    /**
+     * @brief Store rendered covers in one transaction
+     *
+     * Covers whose manifest row was deleted or changed hash since
+     * pendingCovers() are skipped.
+     *
+     * @param database Writer connection
+     * @param covers Covers with thumbnails set
+     * @return Number of covers stored, -1 on error
+     */
+    static int storeRendered(QSqlDatabase& database, const QList<PendingCover>& covers);
+
+    /**
+     * @brief Render thumbnails for covers that have none or a stale one
+     *
+     * pendingCovers(), renderAll() and storeRendered() on the calling
+     * thread. Callers on the executor should split the steps so rendering
+     * does not hold the connection.
+     *
+     * @param database Writer connection
+     * @param limit Maximum number of covers to process, <= 0 for all
+     * @return Number of covers processed, -1 on error
+     */
+    static int backfill(QSqlDatabase& database, int limit = 0);
+
+    /**
+     * @brief Remove every thumbnail of a cartridge
+     * @param database Writer connection
+     * @param cartridgeGuid Cartridge GUID
+     * @return true on success
+     */
+    static bool remove(QSqlDatabase& database, const QString& cartridgeGuid);
+};
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_MANIFEST_COVERTHUMBNAILSTORE_H
@@ -0,0 +1,142 @@
+#ifndef SMARTBOOK_COMMON_MANIFEST_LIBRARYGROUPS_H
+#define SMARTBOOK_COMMON_MANIFEST_LIBRARYGROUPS_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVariant>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+/**
+ * @brief Series, edition and collection views of the library
+ *
+ * Groups are answered from counts kept by triggers (schema version 7):
+ * Local_Series_Counts holds one row per series and edition pair and
+ * Local_Cartridge_Groups.member_count the size of each collection, so
+ * listing the groups reads one row per group however large the library.
+ * Members are read a page at a time when a group is expanded, in index
+ * order (idx_manifest_series_edition for series and editions).
+ *
+ * The series view is series -> editions -> cartridges. Cartridges without
+ * an edition sit directly under their series; cartridges without a series
+ * are in a last group with an empty seriesName. Collections are the
+ * user's custom_collection groups (DDD 4.1).
+ *
+ * All functions are static and run on whichever connection the caller owns.
+ */
+class LibraryGroups {
+public:
+    enum class Kind {
+        Series,
+        Edition,
+        Collection
+    };
+
+    struct Group {
+        Kind kind = Kind::Series;
+        QString seriesName;         // Series and Edition; empty for "no series"
+        QString editionName;        // Edition only
+        qint64 collectionId = 0;    // Collection only
+        QString name;               // Display name, empty for "no series"
+        int cartridgeCount = 0;     // Cartridges in the group and its editions
+    };
+
+    struct Member {
+        QString cartridgeGuid;
+        QString title;
+        QString author;
+        QString version;
+        QString publicationYear;
+        QVariant sortOrder;         // series_order, or display_order in a collection; null if unordered
+    };
+
+    // group_type of user collections in Local_Cartridge_Groups
+    static constexpr const char* COLLECTION_TYPE = "custom_collection";
+
+    /**
+     * @brief List every series, plus "no series" last if any cartridge has none
+     * @param database Open connection
+     * @return Series groups by name
+     */
+    static QList<Group> seriesGroups(QSqlDatabase& database);
+
+    /**
+     * @brief List the named editions of a series
+     * @param database Open connection
+     * @param seriesName Series, empty for cartridges without one
+     * @return Edition groups by name
+     */
+    static QList<Group> editionGroups(QSqlDatabase& database, const QString& seriesName);
+
+    /**
+     * @brief List the user's collections
+     * @param database Open connection
+     * @return Collection groups by name
+     */
+    static QList<Group> collections(QSqlDatabase& database);
+
+    /**
+     * @brief Read a page of the cartridges directly in a group
+     *
+     * Series: cartridges without an edition, by series_order (unnumbered
+     * first), then title. Edition: its cartridges in the same order.
+     * Collection: by display_order (unordered last), then title. Ties are
+     * ordered by cartridge_guid, so the next page seeks past the last
+     * member of the previous one.
+     *
+     * @param database Open connection
+     * @param group Group to read
+     * @param limit Maximum number of members
+     * @param after Last member of the previous page; default for the first page
+     * @return Members, fewer than limit at the end
+     */
+    static QList<Member> members(QSqlDatabase& database, const Group& group, int limit,
+                                 const Member& after = Member());
+
+    /**
+     * @brief Create a collection
+     * @param database Open connection
+     * @param name Collection name
+     * @param description Optional description
+     * @return group_id of the collection, 0 on error
+     */
+    static qint64 createCollection(QSqlDatabase& database, const QString& name,
+                                   const QString& description = QString());
+
+    /**
+     * @brief Rename a collection
+     * @return true if the collection exists and was renamed
+     */
+    static bool renameCollection(QSqlDatabase& database, qint64 collectionId, const QString& name);
+
+    /**
+     * @brief Delete a collection and its memberships (not the cartridges)
+     * @return true if the collection existed
+     */
+    static bool deleteCollection(QSqlDatabase& database, qint64 collectionId);
+
+    /**
+     * @brief Add cartridges to a collection, after its current members
+     * @param database Open connection
+     * @param collectionId Collection
+     * @param cartridgeGuids Cartridges to add; members already in it are skipped
+     * @return Number added, -1 on error (nothing is added then)
+     */
+    static int addToCollection(QSqlDatabase& database, qint64 collectionId, const QStringList& cartridgeGuids);
+
+    /**
+     * @brief Remove cartridges from a collection
+     * @return Number removed, -1 on error
+     */
+    static int removeFromCollection(QSqlDatabase& database, qint64 collectionId, const QStringList& cartridgeGuids);
+};
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_MANIFEST_LIBRARYGROUPS_H
@@ -0,0 +1,55 @@
+#ifndef SMARTBOOK_COMMON_MANIFEST_LIBRARYSEARCH_H
+#define SMARTBOOK_COMMON_MANIFEST_LIBRARYSEARCH_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+/**
+ * @brief Full-text search over library metadata
+ *
+ * Local_Library_Search is an FTS5 index over the title, author,
+ * publisher, series_name and edition_name of Local_Library_Manifest. It is
+ * an external content table (the manifest holds the text, the index only
+ * the tokens) kept in sync by triggers, with prefix indexes for one to
+ * three characters so search-as-you-type stays a single index lookup.
+ * Tokens are case- and diacritic-insensitive.
+ *
+ * Matches are ranked with bm25, weighting title over author over series,
+ * publisher and edition.
+ *
+ * All functions are static and run on whichever connection the caller owns.
+ */
+class LibrarySearch {
+public:
+    /**
+     * @brief Turn user input into an FTS5 query
+     *
+     * Every whitespace-separated word becomes a quoted prefix term and all
+     * of them have to match, so FTS5 syntax in the input is never
+     * interpreted ("C++" or "AND" are searched for literally).
+     *
+     * @param text Text typed by the user
+     * @return MATCH expression, empty if the text has no words
+     */
+    static QString matchExpression(const QString& text);
+
+    /**
+     * @brief Find cartridges by metadata, best matches first
+     * @param database Open connection
+     * @param text Text typed by the user
+     * @param limit Maximum number of results
+     * @return Cartridge GUIDs in rank order, empty if nothing matches
+     */
+    static QStringList search(QSqlDatabase& database, const QString& text, int limit);
+};
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_MANIFEST_LIBRARYSEARCH_H
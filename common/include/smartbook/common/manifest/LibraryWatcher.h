@@ -0,0 +1,132 @@
+#ifndef SMARTBOOK_COMMON_MANIFEST_LIBRARYWATCHER_H
+#define SMARTBOOK_COMMON_MANIFEST_LIBRARYWATCHER_H
+
+#include "smartbook/common/manifest/ManifestManager.h"
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+class CartridgeImporter;
+
+/**
+ * @brief Keeps manifest entries in step with their cartridge files
+ *
+ * Watches the directories holding library cartridges and rescans them
+ * when they change, plus every rescanInterval() as a fallback for
+ * file systems that do not report changes (network shares). A scan only
+ * stats files: the FileFingerprint of each file is compared with the one
+ * recorded when it was last hashed, and only files whose fingerprint
+ * changed are rehashed and re-extracted (through a CartridgeImporter).
+ *
+ * Files that disappear are marked LOCATION_MISSING. A missing file whose
+ * fingerprint (including the inode) turns up under another name in a
+ * scanned directory is taken as moved and its local_path updated, without
+ * rehashing. Entries without a recorded fingerprint (imported before
+ * fingerprints existed) adopt the file's current one.
+ *
+ * Stat calls run on a pool thread and writes on the database executor,
+ * so neither blocks the GUI thread.
+ */
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LibraryWatcher(QObject* parent = nullptr);
+    ~LibraryWatcher();
+
+    /**
+     * @brief Start watching; checks every entry once in the background
+     */
+    void start();
+
+    /**
+     * @brief Stop watching and rescanning
+     */
+    void stop();
+
+    /**
+     * @brief Check every entry now
+     */
+    void rescan();
+
+    /**
+     * @brief Set how often every entry is checked without a change notification
+     * @param milliseconds Interval; 0 disables periodic rescans
+     */
+    void setRescanInterval(int milliseconds);
+    int rescanInterval() const;
+
+    /**
+     * @brief Check whether a scan or rehash is in progress
+     * @return true while scanning or rehashing
+     */
+    bool isBusy() const;
+
+signals:
+    /**
+     * @brief A scan's results are written
+     *
+     * Rehashing of changed files may still be running; rehashFinished()
+     * follows when it is done.
+     *
+     * @param missing Entries newly marked missing
+     * @param moved Entries whose file was found under a new path
+     * @param changed Files queued for rehashing
+     */
+    void scanFinished(int missing, int moved, int changed);
+
+    /**
+     * @brief Changed files have been rehashed and their entries updated
+     */
+    void rehashFinished();
+
+private slots:
+    void onDirectoryChanged(const QString& directory);
+    void onRehashFinished();
+
+private:
+    struct ScanResult {
+        QList<ManifestManager::FileState> updates;
+        QStringList rehash;             // Paths whose fingerprint changed
+        QStringList directories;        // Existing directories holding entries
+        int missing = 0;
+        int moved = 0;
+    };
+
+    static ScanResult scan(const QList<ManifestManager::FileState>& states,
+                           const QSet<QString>& directories, bool all);
+
+    void scheduleScan();
+    void runScan();
+    void applyScan(const ScanResult& result);
+    void watchDirectories(const QStringList& directories);
+    void startRehash();
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounceTimer;
+    QTimer m_rescanTimer;
+    ManifestManager* m_manifestManager;
+    CartridgeImporter* m_importer;
+
+    int m_rescanIntervalMs = 15 * 60 * 1000;
+    bool m_running = false;
+    bool m_scanning = false;
+    bool m_pendingAll = false;
+    QSet<QString> m_pendingDirectories;
+
+    QStringList m_pendingRehash;
+};
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_MANIFEST_LIBRARYWATCHER_H
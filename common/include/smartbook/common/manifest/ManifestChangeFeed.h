@@ -0,0 +1,100 @@
+#ifndef SMARTBOOK_COMMON_MANIFEST_MANIFESTCHANGEFEED_H
+#define SMARTBOOK_COMMON_MANIFEST_MANIFESTCHANGEFEED_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QList>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+/**
+ * @brief Change events for Local_Library_Manifest
+ *
+ * Every insert, update and delete of a manifest row is recorded in
+ * Local_Manifest_Changes by triggers, so the log also covers writes that
+ * bypass ManifestManager. change_id is monotonic; a consumer remembers the
+ * last id it has applied and reads what follows with changesSince().
+ * The log keeps at least the last LOG_RETENTION changes; a consumer that
+ * fell further behind has to reload.
+ *
+ * ManifestManager additionally publishes each write through entryChanged()
+ * so consumers do not have to poll. The signal is emitted on the thread
+ * that wrote (usually the database executor), so receivers in other
+ * threads get it queued.
+ */
+class ManifestChangeFeed : public QObject {
+    Q_OBJECT
+
+public:
+    enum class ChangeType {
+        Created = 1,
+        Updated = 2,
+        Deleted = 3
+    };
+    Q_ENUM(ChangeType)
+
+    struct Change {
+        qint64 changeId = 0;
+        QString cartridgeGuid;
+        ChangeType type = ChangeType::Updated;
+    };
+
+    // Minimum number of changes kept in Local_Manifest_Changes (pruned by trigger)
+    static constexpr int LOG_RETENTION = 1000;
+
+    /**
+     * @brief Get the singleton instance
+     * @return Reference to the ManifestChangeFeed instance
+     */
+    static ManifestChangeFeed& getInstance();
+
+    /**
+     * @brief Publish a manifest write
+     *
+     * Thread-safe. Called by ManifestManager after a successful write.
+     *
+     * @param type Kind of change
+     * @param cartridgeGuid Changed cartridge
+     */
+    void publish(ChangeType type, const QString& cartridgeGuid);
+
+    /**
+     * @brief Get the id of the newest logged change
+     * @param database Open connection
+     * @return Change id, 0 if nothing was logged, -1 on error
+     */
+    static qint64 latestChangeId(QSqlDatabase& database);
+
+    /**
+     * @brief Read the changes logged after a given id
+     * @param database Open connection
+     * @param changeId Last change id the caller has applied
+     * @param changes Receives the changes in change_id order
+     * @return false on error or if changes after changeId were already pruned
+     */
+    static bool changesSince(QSqlDatabase& database, qint64 changeId, QList<Change>& changes);
+
+signals:
+    /**
+     * @brief A manifest row was created, updated or deleted
+     * @param type Kind of change
+     * @param cartridgeGuid Changed cartridge
+     */
+    void entryChanged(smartbook::common::manifest::ManifestChangeFeed::ChangeType type,
+                      const QString& cartridgeGuid);
+
+private:
+    ManifestChangeFeed() = default;
+    ~ManifestChangeFeed() = default;
+    ManifestChangeFeed(const ManifestChangeFeed&) = delete;
+    ManifestChangeFeed& operator=(const ManifestChangeFeed&) = delete;
+};
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_MANIFEST_MANIFESTCHANGEFEED_H
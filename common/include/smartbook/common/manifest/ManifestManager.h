@@ -2,12 +2,20 @@
 #define SMARTBOOK_COMMON_MANIFEST_MANIFESTMANAGER_H
 
 #include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include "smartbook/common/utils/FileFingerprint.h"
 #include <QString>
 #include <QByteArray>
 #include <QObject>
+#include <QFuture>
+#include <QList>
 
 namespace smartbook {
 namespace common {
+namespace database {
+class InstrumentedQuery;
+}
+
 namespace manifest {
 
 /**
@@ -17,11 +25,17 @@ namespace manifest {
  * for imported cartridges.
  * 
  * Implements FR-2.5.1 (Manifest Creation) and related requirements.
+ *
+ * Each operation has a blocking form (GUI-thread connection) and an
+ * ...Async form that runs on the LocalDBManager executor thread. Async
+ * reads default to the Interactive lane, async writes to Background.
  */
 class ManifestManager : public QObject {
     Q_OBJECT
 
 public:
+    using Priority = database::LocalDBExecutor::Priority;
+
     struct ManifestEntry {
         QString cartridgeGuid;
         QByteArray cartridgeHash;
@@ -32,10 +46,47 @@ public:
         QString version;
         QString publicationYear;
         QByteArray coverImageData;
+        QString seriesName;
+        QString editionName;
+        int seriesOrder = 0;        // 0 when not part of a series
+        utils::FileFingerprint fingerprint;     // Of localPath when cartridgeHash was taken
+        QString locationStatus;     // LOCATION_LOCAL when empty
         
         bool isValid() const { return !cartridgeGuid.isEmpty() && !title.isEmpty(); }
     };
 
+    // location_status values (DDD 4.1); NULL in entries that were never checked
+    static constexpr const char* LOCATION_LOCAL = "local_only";
+    static constexpr const char* LOCATION_MISSING = "missing";
+
+    /**
+     * @brief Where an entry's file is and what state it was last seen in
+     */
+    struct FileState {
+        QString cartridgeGuid;
+        QString localPath;
+        utils::FileFingerprint fingerprint;     // !exists() if never recorded
+        QString locationStatus;
+    };
+
+    /**
+     * @brief What importManifestEntriesAsync() did with one entry
+     */
+    enum class ImportOutcome {
+        Created,
+        Updated,    // Same GUID, different hash or location
+        Unchanged,  // Same GUID, hash and location; at most the fingerprint written
+        Failed
+    };
+
+    /**
+     * @brief One cartridge of an import batch
+     */
+    struct ImportItem {
+        ManifestEntry entry;
+        QList<CoverThumbnailStore::Thumbnail> thumbnails;   // From CoverThumbnailStore::renderAll()
+    };
+
     explicit ManifestManager(QObject* parent = nullptr);
     
     /**
@@ -73,7 +124,113 @@ public:
      */
     bool deleteManifestEntry(const QString& cartridgeGuid);
 
+    /**
+     * @brief Record that a cartridge was opened now (last_opened)
+     * @param cartridgeGuid Cartridge GUID
+     * @return true if the entry exists and was updated
+     */
+    bool recordOpened(const QString& cartridgeGuid);
+
+    /**
+     * @brief Create a manifest entry on the database executor thread
+     * @param entry Manifest entry data
+     * @param priority Executor lane
+     * @return Future resolving to true if creation succeeded
+     */
+    QFuture<bool> createManifestEntryAsync(const ManifestEntry& entry, Priority priority = Priority::Background);
+
+    /**
+     * @brief Look up a manifest entry on the database executor thread
+     * @param cartridgeGuid Cartridge GUID to look up
+     * @param priority Executor lane
+     * @return Future resolving to the entry (invalid if not found)
+     */
+    QFuture<ManifestEntry> getManifestEntryAsync(const QString& cartridgeGuid, Priority priority = Priority::Interactive);
+
+    /**
+     * @brief Update a manifest entry on the database executor thread
+     * @param entry Manifest entry data (must have valid cartridgeGuid)
+     * @param priority Executor lane
+     * @return Future resolving to true if update succeeded
+     */
+    QFuture<bool> updateManifestEntryAsync(const ManifestEntry& entry, Priority priority = Priority::Background);
+
+    /**
+     * @brief Check for a manifest entry on the database executor thread
+     * @param cartridgeGuid Cartridge GUID to check
+     * @param priority Executor lane
+     * @return Future resolving to true if the entry exists
+     */
+    QFuture<bool> manifestEntryExistsAsync(const QString& cartridgeGuid, Priority priority = Priority::Interactive);
+
+    /**
+     * @brief Delete a manifest entry on the database executor thread
+     * @param cartridgeGuid Cartridge GUID to delete
+     * @param priority Executor lane
+     * @return Future resolving to true if deletion succeeded
+     */
+    QFuture<bool> deleteManifestEntryAsync(const QString& cartridgeGuid, Priority priority = Priority::Background);
+
+    /**
+     * @brief Record that a cartridge was opened now, on the database executor thread
+     * @param cartridgeGuid Cartridge GUID
+     * @param priority Executor lane
+     * @return Future resolving to true if the entry was updated
+     */
+    QFuture<bool> recordOpenedAsync(const QString& cartridgeGuid, Priority priority = Priority::Background);
+
+    /**
+     * @brief Create or update many entries in one transaction
+     *
+     * Used by bulk imports. Thumbnails are rendered by the caller, so the
+     * executor thread only writes. Changes are published once the
+     * transaction has committed; if it fails, every entry is Failed.
+     *
+     * @param items Entries with their pre-rendered thumbnails
+     * @param priority Executor lane
+     * @return Future resolving to one outcome per item, in order
+     */
+    QFuture<QList<ImportOutcome>> importManifestEntriesAsync(const QList<ImportItem>& items,
+                                                             Priority priority = Priority::Background);
+
+    /**
+     * @brief Read the file state of every entry on the database executor thread
+     * @param priority Executor lane
+     * @return Future resolving to one state per entry
+     */
+    QFuture<QList<FileState>> fileStatesAsync(Priority priority = Priority::Background);
+
+    /**
+     * @brief Record where entries' files are, in one transaction
+     *
+     * Writes local_path, the fingerprint and location_status only; the
+     * cartridge hash and metadata are left alone. Changes are published
+     * after commit.
+     *
+     * @param states New states, matched by cartridgeGuid
+     * @param priority Executor lane
+     * @return Future resolving to the number of entries updated, -1 on error
+     */
+    QFuture<int> updateFileStatesAsync(const QList<FileState>& states, Priority priority = Priority::Background);
+
 private:
+    // Shared implementations; run on whichever connection the caller owns
+    static bool createManifestEntry(QSqlDatabase& database, const ManifestEntry& entry);
+    static ManifestEntry getManifestEntry(QSqlDatabase& database, const QString& cartridgeGuid);
+    static bool updateManifestEntry(QSqlDatabase& database, const ManifestEntry& entry);
+    static bool manifestEntryExists(QSqlDatabase& database, const QString& cartridgeGuid);
+    static bool deleteManifestEntry(QSqlDatabase& database, const QString& cartridgeGuid);
+    static bool recordOpened(QSqlDatabase& database, const QString& cartridgeGuid);
+    static QList<ImportOutcome> importManifestEntries(QSqlDatabase& database, const QList<ImportItem>& items);
+    static QList<FileState> fileStates(QSqlDatabase& database);
+    static int updateFileStates(QSqlDatabase& database, const QList<FileState>& states);
+
+    // Row writes without thumbnails or change notifications
+    static bool insertManifestRow(QSqlDatabase& database, const ManifestEntry& entry);
+    static int updateManifestRow(QSqlDatabase& database, const ManifestEntry& entry);
+    static void prepareFileStateUpdate(database::InstrumentedQuery& query);
+    static bool updateFileStateRow(database::InstrumentedQuery& query, const FileState& state);
+
     database::LocalDBManager* m_dbManager;
 };
 
@@ -5,6 +5,7 @@
 #include "smartbook/common/security/SignatureVerifier.h"
 #include <QString>
 #include <QObject>
+#include <QFuture>
 
 namespace smartbook {
 namespace common {
@@ -15,11 +16,15 @@ namespace security {
  * 
  * Handles persistent trust storage and retrieval for cartridges.
  * Implements FR-2.4.1 (Persistent Trust) and FR-2.4.3 (Trust Revocation).
+ *
+ * The ...Async forms run on the LocalDBManager executor thread.
  */
 class TrustRegistry : public QObject {
     Q_OBJECT
 
 public:
+    using Priority = database::LocalDBExecutor::Priority;
+
     enum class TrustPolicy {
         PERSISTENT,     // Always trust (across sessions)
         SESSION,        // Trust for current session only
@@ -57,11 +62,51 @@ public:
      */
     bool hasPersistentTrust(const QString& cartridgeGuid);
 
+    /**
+     * @brief Store a trust decision on the database executor thread
+     * @param cartridgeGuid Cartridge GUID
+     * @param policy Trust policy
+     * @param priority Executor lane
+     * @return Future resolving to true if stored successfully
+     */
+    QFuture<bool> storeTrustDecisionAsync(const QString& cartridgeGuid, TrustPolicy policy,
+                                          Priority priority = Priority::Background);
+
+    /**
+     * @brief Get a trust decision on the database executor thread
+     * @param cartridgeGuid Cartridge GUID
+     * @param priority Executor lane
+     * @return Future resolving to the policy (PERSISTENT if not found)
+     */
+    QFuture<TrustPolicy> getTrustDecisionAsync(const QString& cartridgeGuid,
+                                               Priority priority = Priority::Interactive);
+
+    /**
+     * @brief Revoke trust on the database executor thread
+     * @param cartridgeGuid Cartridge GUID
+     * @param priority Executor lane
+     * @return Future resolving to true if revoked successfully
+     */
+    QFuture<bool> revokeTrustAsync(const QString& cartridgeGuid, Priority priority = Priority::Interactive);
+
+    /**
+     * @brief Check for persistent trust on the database executor thread
+     * @param cartridgeGuid Cartridge GUID
+     * @param priority Executor lane
+     * @return Future resolving to true if PERSISTENT trust exists
+     */
+    QFuture<bool> hasPersistentTrustAsync(const QString& cartridgeGuid,
+                                          Priority priority = Priority::Interactive);
+
 private:
     database::LocalDBManager* m_dbManager;
     
-    QString trustPolicyToString(TrustPolicy policy);
-    TrustPolicy stringToTrustPolicy(const QString& policyString);
+    // Shared implementations; run on whichever connection the caller owns
+    static bool storeTrustDecision(QSqlDatabase& database, const QString& cartridgeGuid, TrustPolicy policy);
+    static TrustPolicy getTrustDecision(QSqlDatabase& database, const QString& cartridgeGuid);
+
+    static QString trustPolicyToString(TrustPolicy policy);
+    static TrustPolicy stringToTrustPolicy(const QString& policyString);
 };
 
 } // namespace security
@@ -0,0 +1,74 @@
+#ifndef SMARTBOOK_COMMON_SETTINGS_PAGETEMPLATE_H
+#define SMARTBOOK_COMMON_SETTINGS_PAGETEMPLATE_H
+
+#include <QByteArray>
+#include <QUtf8StringView>
+
+namespace smartbook {
+namespace common {
+namespace settings {
+
+class SettingsManager;
+
+/**
+ * @brief Page document skeleton with the rendering settings compiled in
+ *
+ * A page document is the page's HTML and CSS placed into a fixed HTML
+ * skeleton, with the resolved rendering settings (font size and family,
+ * line spacing, text alignment) as CSS after the page's own. compile()
+ * formats the settings once and keeps the skeleton as three UTF-8
+ * fragments around the two page parts; render() then only copies: it
+ * allocates the document at its final size and writes each part once.
+ *
+ * A template stays valid until the SettingsManager it was compiled from
+ * moves to another generation (isCurrent()).
+ */
+class PageTemplate {
+public:
+    /**
+     * @brief Template without settings CSS
+     */
+    PageTemplate();
+
+    /**
+     * @brief Compile the template for the current settings
+     * @param settings Settings of the open cartridge
+     * @return Template for settings.generation()
+     */
+    static PageTemplate compile(const SettingsManager& settings);
+
+    /**
+     * @brief Check whether the template matches the settings
+     * @param settings Settings it was compiled from
+     * @return false if it was never compiled or the settings changed since
+     */
+    bool isCurrent(const SettingsManager& settings) const;
+
+    /**
+     * @brief Build a page document
+     * @param htmlContent Content_Pages.html_content, UTF-8
+     * @param css Content_Pages.associated_css, UTF-8 (may be empty)
+     * @return Complete HTML document, UTF-8
+     */
+    QByteArray render(QUtf8StringView htmlContent, QUtf8StringView css) const;
+
+    /**
+     * @brief Get the compiled settings CSS
+     * @return CSS block placed after the page's CSS, UTF-8
+     */
+    QByteArray settingsCss() const { return m_settingsCss; }
+
+private:
+    QByteArray m_head;          // Up to the page CSS
+    QByteArray m_settingsCss;
+    QByteArray m_body;          // From the page CSS to the page HTML
+    QByteArray m_tail;
+    quint64 m_generation = 0;
+    bool m_compiled = false;
+};
+
+} // namespace settings
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_SETTINGS_PAGETEMPLATE_H
@@ -59,9 +59,14 @@ public:
     
     /**
      * @brief Set user override for a setting
+     *
+     * The override takes effect immediately; the database write is
+     * buffered in LocalDBManager::writeCoalescer() and committed with other
+     * pending writes.
+     *
      * @param settingKey Setting key
      * @param value Override value
-     * @return true if saved successfully, false otherwise
+     * @return true if accepted, false if no cartridge or database is open
      */
     bool setUserOverride(const QString& settingKey, const QString& value);
     
@@ -77,7 +82,24 @@ public:
      */
     QMap<QString, QString> getAllSettings() const;
 
+    /**
+     * @brief Get the generation of the resolved settings
+     *
+     * Changes whenever a resolved value may have changed (load, override,
+     * reset), so values derived from the settings can be kept until then.
+     *
+     * @return Generation counter
+     */
+    quint64 generation() const { return m_generation; }
+
+signals:
+    /**
+     * @brief Emitted when the resolved settings may have changed
+     */
+    void settingsChanged();
+
 private:
+    void bumpGeneration();
     void loadAuthorSettings(const QString& cartridgePath);
     void loadUserOverrides(const QString& cartridgeGuid);
     QString resolveSetting(const QString& settingKey, const QString& appDefault) const;
@@ -85,6 +107,7 @@ private:
     QString m_cartridgeGuid;
     QMap<QString, SettingValue> m_authorSettings;  // From cartridge Settings table
     QMap<QString, QString> m_userOverrides;      // From Local_User_Settings
+    quint64 m_generation = 0;
 };
 
 } // namespace settings
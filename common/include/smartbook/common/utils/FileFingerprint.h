@@ -0,0 +1,48 @@
+#ifndef SMARTBOOK_COMMON_UTILS_FILEFINGERPRINT_H
+#define SMARTBOOK_COMMON_UTILS_FILEFINGERPRINT_H
+
+#include <QString>
+#include <QtGlobal>
+
+namespace smartbook {
+namespace common {
+namespace utils {
+
+/**
+ * @brief Cheap identity of a file's current state
+ *
+ * Size, modification time and file id (inode on Unix) from a single
+ * stat, used to tell whether a cartridge may have changed without hashing
+ * its content. Equal fingerprints are taken to mean unchanged content;
+ * the file id also recognizes a file that was moved or renamed.
+ */
+struct FileFingerprint {
+    qint64 size = -1;           // -1 if the file does not exist
+    qint64 modifiedMs = 0;      // Last modification, ms since the epoch (UTC)
+    qint64 fileId = 0;          // Inode; 0 where the platform has none
+
+    bool exists() const { return size >= 0; }
+
+    /**
+     * @brief Check whether two fingerprints describe the same file state
+     *
+     * A file id of 0 on either side is unknown and not compared.
+     *
+     * @param other Fingerprint to compare with
+     * @return true if size, modification time and known file ids match
+     */
+    bool matches(const FileFingerprint& other) const;
+
+    /**
+     * @brief Take the fingerprint of a file
+     * @param path File path
+     * @return Fingerprint; !exists() if the file is missing or not a file
+     */
+    static FileFingerprint of(const QString& path);
+};
+
+} // namespace utils
+} // namespace common
+} // namespace smartbook
+
+#endif // SMARTBOOK_COMMON_UTILS_FILEFINGERPRINT_H
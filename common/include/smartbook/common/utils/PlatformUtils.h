@@ -2,6 +2,7 @@
 #define SMARTBOOK_COMMON_UTILS_PLATFORMUTILS_H
 
 #include <QString>
+#include <QtGlobal>
 
 namespace smartbook {
 namespace common {
@@ -24,6 +25,12 @@ public:
      */
     static QString getArchitecture();
 
+    /**
+     * @brief Get the installed physical memory
+     * @return Size in bytes, 0 if it cannot be determined
+     */
+    static qint64 getPhysicalMemory();
+
     /**
      * @brief Get application data directory
      * @return Platform-specific application data directory path
@@ -0,0 +1,376 @@
+#include "smartbook/common/database/CartridgeConnectionPool.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QThread>
+#include <QTimer>
+#include <QUuid>
+#include <QUrl>
+#include <QList>
+#include <QDebug>
+#include <sqlite3.h>
+#include <utility>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+namespace {
+QString readOnlyUri(const QString& path, CartridgeOpenMode mode) {
+    // URI form carries mode=ro / immutable=1 down to sqlite3_open_v2
+    QString uri = QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded);
+    uri += (mode == CartridgeOpenMode::Immutable) ? "?mode=ro&immutable=1" : "?mode=ro";
+    return uri;
+}
+
+// Opening is lazy; the first read shows whether mode=ro can use the file
+bool needsImmutableOpen(const QSqlDatabase& database) {
+    QSqlQuery probe(database);
+    if (probe.exec("SELECT COUNT(*) FROM sqlite_master")) {
+        return false;
+    }
+    const int code = probe.lastError().nativeErrorCode().toInt() & 0xff;
+    return code == SQLITE_CANTOPEN || code == SQLITE_READONLY;
+}
+}
+
+CartridgeConnectionPool& CartridgeConnectionPool::getInstance() {
+    static CartridgeConnectionPool instance;
+    return instance;
+}
+
+CartridgeConnectionPool::CartridgeConnectionPool()
+    : QObject(nullptr)
+{
+    m_clock.start();
+
+    // Idle eviction timers run on the application thread
+    QCoreApplication* app = QCoreApplication::instance();
+    if (app && thread() != app->thread()) {
+        moveToThread(app->thread());
+    }
+}
+
+QString CartridgeConnectionPool::acquire(const QString& cartridgePath, CartridgeOpenMode mode,
+                                         ConnectionRole role) {
+    const QString path = canonicalPath(cartridgePath);
+    QThread* currentThread = QThread::currentThread();
+    const QString key = poolKey(path, mode, role, currentThread);
+
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_connections.find(key);
+    if (it != m_connections.end()) {
+        // Reuse the pooled connection unless the file disappeared while it was idle
+        if (it->refCount > 0 || QFileInfo::exists(path)) {
+            it->refCount++;
+            return it->connectionName;
+        }
+
+        removeConnection(*it);
+        m_keysByConnectionName.remove(it->connectionName);
+        m_connections.erase(it);
+    }
+
+    PooledConnection entry;
+    entry.connectionName = QString("CartridgeDB_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    entry.canonicalPath = path;
+    entry.ownerThread = currentThread;
+    entry.refCount = 1;
+    entry.statements = std::make_shared<StatementCache>(entry.connectionName);
+
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", entry.connectionName);
+        if (!openConnection(database, path, mode, role)) {
+            database = QSqlDatabase();
+            QSqlDatabase::removeDatabase(entry.connectionName);
+            return QString();
+        }
+    }
+
+    m_connections.insert(key, entry);
+    m_keysByConnectionName.insert(entry.connectionName, key);
+    return entry.connectionName;
+}
+
+bool CartridgeConnectionPool::openConnection(QSqlDatabase& database, const QString& cartridgePath,
+                                             CartridgeOpenMode mode, ConnectionRole role) {
+    if (mode == CartridgeOpenMode::ReadWrite) {
+        database.setDatabaseName(cartridgePath);
+    } else {
+        database.setDatabaseName(readOnlyUri(cartridgePath, mode));
+        database.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_OPEN_URI");
+    }
+
+    bool opened = database.open();
+    if (opened && mode == CartridgeOpenMode::ReadOnly && needsImmutableOpen(database)) {
+        // Nothing can change the file while its directory is read-only
+        qInfo() << "Cartridge cannot be read with mode=ro, opening as immutable:" << cartridgePath;
+        database.close();
+        database.setDatabaseName(readOnlyUri(cartridgePath, CartridgeOpenMode::Immutable));
+        opened = database.open();
+    }
+
+    if (!opened) {
+        qCritical() << "Failed to open cartridge database:" << database.lastError().text();
+        return false;
+    }
+
+    // Configure once per physical connection, not once per lease
+    configureConnection(database, mode, ConnectionProfile::forRole(role));
+    return true;
+}
+
+void CartridgeConnectionPool::release(const QString& connectionName) {
+    QMutexLocker locker(&m_mutex);
+
+    auto keyIt = m_keysByConnectionName.find(connectionName);
+    if (keyIt == m_keysByConnectionName.end()) {
+        qWarning() << "Release of unknown cartridge connection:" << connectionName;
+        return;
+    }
+
+    auto it = m_connections.find(keyIt.value());
+    if (it == m_connections.end()) {
+        return;
+    }
+
+    if (it->refCount > 0) {
+        it->refCount--;
+    }
+    if (it->refCount > 0) {
+        return;
+    }
+
+    it->lastReleasedMs = m_clock.elapsed();
+
+    if ((it->invalidated || m_idleTimeoutMs == 0) && it->ownerThread == QThread::currentThread()) {
+        removeConnection(*it);
+        m_keysByConnectionName.erase(keyIt);
+        m_connections.erase(it);
+        return;
+    }
+
+    const int idleTimeoutMs = m_idleTimeoutMs;
+    locker.unlock();
+
+    // Opportunistically close other connections this thread stopped using
+    evictIdle(idleTimeoutMs);
+    scheduleEviction();
+}
+
+int CartridgeConnectionPool::evictIdle(int maxIdleMs) {
+    QMutexLocker locker(&m_mutex);
+
+    QThread* currentThread = QThread::currentThread();
+    const qint64 now = m_clock.elapsed();
+    int evicted = 0;
+
+    for (auto it = m_connections.begin(); it != m_connections.end();) {
+        if (it->ownerThread == currentThread && it->refCount == 0
+            && now - it->lastReleasedMs >= maxIdleMs) {
+            removeConnection(*it);
+            m_keysByConnectionName.remove(it->connectionName);
+            it = m_connections.erase(it);
+            ++evicted;
+        } else {
+            ++it;
+        }
+    }
+
+    return evicted;
+}
+
+std::shared_ptr<StatementCache> CartridgeConnectionPool::statementCache(const QString& connectionName) const {
+    QMutexLocker locker(&m_mutex);
+
+    auto keyIt = m_keysByConnectionName.constFind(connectionName);
+    if (keyIt == m_keysByConnectionName.constEnd()) {
+        return nullptr;
+    }
+
+    auto it = m_connections.constFind(keyIt.value());
+    return it != m_connections.constEnd() ? it->statements : nullptr;
+}
+
+void CartridgeConnectionPool::invalidate(const QString& cartridgePath) {
+    const QString path = canonicalPath(cartridgePath);
+    QThread* currentThread = QThread::currentThread();
+
+    QMutexLocker locker(&m_mutex);
+
+    QList<QString> matchingKeys;
+    for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it) {
+        if (it->canonicalPath == path && !it->invalidated) {
+            matchingKeys.append(it.key());
+        }
+    }
+
+    for (const QString& key : matchingKeys) {
+        PooledConnection entry = m_connections.take(key);
+
+        if (entry.refCount == 0 && entry.ownerThread == currentThread) {
+            removeConnection(entry);
+            m_keysByConnectionName.remove(entry.connectionName);
+            continue;
+        }
+
+        // Retire under a private key so the next acquire() opens a fresh connection
+        entry.invalidated = true;
+        const QString retiredKey = key + "#retired:" + entry.connectionName;
+        m_connections.insert(retiredKey, entry);
+        m_keysByConnectionName.insert(entry.connectionName, retiredKey);
+    }
+}
+
+void CartridgeConnectionPool::closeThreadConnections() {
+    evictIdle(0);
+}
+
+void CartridgeConnectionPool::setIdleTimeout(int idleTimeoutMs) {
+    QMutexLocker locker(&m_mutex);
+    m_idleTimeoutMs = qMax(0, idleTimeoutMs);
+}
+
+int CartridgeConnectionPool::idleTimeout() const {
+    QMutexLocker locker(&m_mutex);
+    return m_idleTimeoutMs;
+}
+
+int CartridgeConnectionPool::connectionCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_connections.size();
+}
+
+int CartridgeConnectionPool::leaseCount(const QString& cartridgePath, CartridgeOpenMode mode,
+                                        ConnectionRole role) const {
+    const QString key = poolKey(canonicalPath(cartridgePath), mode, role, QThread::currentThread());
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_connections.constFind(key);
+    return it != m_connections.constEnd() ? it->refCount : 0;
+}
+
+QString CartridgeConnectionPool::canonicalPath(const QString& cartridgePath) {
+    QFileInfo fileInfo(cartridgePath);
+    QString path = fileInfo.canonicalFilePath();
+    if (path.isEmpty()) {
+        // File does not exist (yet); fall back to the absolute path
+        path = fileInfo.absoluteFilePath();
+    }
+    return path;
+}
+
+QString CartridgeConnectionPool::poolKey(const QString& canonicalPath, CartridgeOpenMode mode,
+                                         ConnectionRole role, QThread* thread) {
+    return QString("%1|%2|%3|%4").arg(canonicalPath)
+        .arg(static_cast<int>(mode))
+        .arg(static_cast<int>(role))
+        .arg(reinterpret_cast<quintptr>(thread));
+}
+
+void CartridgeConnectionPool::configureConnection(QSqlDatabase& database, CartridgeOpenMode mode,
+                                                  const ConnectionProfile& profile) {
+    QSqlQuery query(database);
+
+    if (mode != CartridgeOpenMode::ReadWrite) {
+        // Read-only opens never touch the journal or schema, so no
+        // -wal/-shm files are created and no write transaction is taken
+        if (!query.exec("PRAGMA query_only=ON")) {
+            qWarning() << "Failed to enable query-only mode:" << query.lastError().text();
+        }
+
+        // Cache, mmap, locking and busy handling come from the role profile
+        profile.apply(database);
+        return;
+    }
+
+    // Enable WAL mode
+    if (!query.exec("PRAGMA journal_mode=WAL")) {
+        qWarning() << "Failed to enable WAL mode:" << query.lastError().text();
+    }
+
+    // Set page size to 4096 bytes
+    if (!query.exec("PRAGMA page_size=4096")) {
+        qWarning() << "Failed to set page size:" << query.lastError().text();
+    }
+
+    // Cache, mmap, synchronous, locking and busy handling come from the role profile
+    profile.apply(database);
+
+    // Enable foreign keys
+    if (!query.exec("PRAGMA foreign_keys=ON")) {
+        qWarning() << "Failed to enable foreign keys:" << query.lastError().text();
+    }
+
+    // Create User_Data table if it doesn't exist
+    query.exec(R"(
+        CREATE TABLE IF NOT EXISTS User_Data (
+            data_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            form_id TEXT NOT NULL,
+            data_json TEXT NOT NULL,
+            saved_timestamp INTEGER NOT NULL,
+            UNIQUE(form_id)
+        )
+    )");
+}
+
+void CartridgeConnectionPool::removeConnection(PooledConnection& entry) {
+    const QString connectionName = entry.connectionName;
+
+    // Cached statements must be finalized before the connection goes away
+    if (entry.statements) {
+        entry.statements->clear();
+        entry.statements.reset();
+    }
+
+    {
+        QSqlDatabase database = QSqlDatabase::database(connectionName, false);
+        if (database.isOpen()) {
+            database.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void CartridgeConnectionPool::scheduleEviction() {
+    if (!QCoreApplication::instance() || QThread::currentThread() != thread()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_evictionScheduled) {
+        return;
+    }
+    m_evictionScheduled = true;
+    const int idleTimeoutMs = m_idleTimeoutMs;
+    locker.unlock();
+
+    QTimer::singleShot(idleTimeoutMs, this, [this]() {
+        {
+            QMutexLocker timerLocker(&m_mutex);
+            m_evictionScheduled = false;
+        }
+        evictIdle(idleTimeout());
+
+        // Re-arm while released connections are still waiting to expire
+        bool idleRemaining = false;
+        {
+            QMutexLocker timerLocker(&m_mutex);
+            for (const PooledConnection& entry : std::as_const(m_connections)) {
+                if (entry.ownerThread == thread() && entry.refCount == 0) {
+                    idleRemaining = true;
+                    break;
+                }
+            }
+        }
+        if (idleRemaining) {
+            scheduleEviction();
+        }
+    });
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
@@ -1,7 +1,8 @@
 #include "smartbook/common/database/CartridgeDBConnector.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
 #include <QSqlError>
 #include <QDebug>
-#include <QUuid>
 #include <QDateTime>
 
 namespace smartbook {
@@ -17,27 +18,30 @@ CartridgeDBConnector::~CartridgeDBConnector() {
     closeConnection();
 }
 
-bool CartridgeDBConnector::openCartridge(const QString& cartridgePath) {
+bool CartridgeDBConnector::openCartridge(const QString& cartridgePath, CartridgeOpenMode mode) {
+    const ConnectionRole role = (mode == CartridgeOpenMode::ReadWrite)
+        ? ConnectionRole::Creator
+        : ConnectionRole::Reader;
+    return openCartridge(cartridgePath, mode, role);
+}
+
+bool CartridgeDBConnector::openCartridge(const QString& cartridgePath, CartridgeOpenMode mode,
+                                         ConnectionRole role) {
     if (m_isOpen) {
         closeConnection();
     }
 
     m_cartridgePath = cartridgePath;
+    m_openMode = mode;
+    m_role = role;
 
-    // Create unique connection name for this instance
-    QString connectionName = QString("CartridgeDB_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
-
-    // Add SQLite driver with unique connection name
-    m_database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
-    m_database.setDatabaseName(cartridgePath);
-
-    if (!m_database.open()) {
-        qCritical() << "Failed to open cartridge database:" << m_database.lastError().text();
+    // Lease a configured connection from the process-wide pool
+    m_connectionName = CartridgeConnectionPool::getInstance().acquire(cartridgePath, mode, role);
+    if (m_connectionName.isEmpty()) {
         return false;
     }
-
-    // Configure connection
-    configureConnection();
+    m_database = QSqlDatabase::database(m_connectionName, false);
+    m_statements = CartridgeConnectionPool::getInstance().statementCache(m_connectionName);
 
     // Extract cartridge GUID
     QSqlQuery query(m_database);
@@ -47,15 +51,29 @@ bool CartridgeDBConnector::openCartridge(const QString& cartridgePath) {
         }
     }
 
+    // Read-only opens buffer form data in the local database's coalescer
+    if (mode == CartridgeOpenMode::ReadWrite) {
+        m_formWrites = std::make_unique<WriteCoalescer>([this](const WriteCoalescer::Write& batch) {
+            return m_database.isOpen() && batch(m_database);
+        });
+    }
+
     m_isOpen = true;
     return true;
 }
 
 void CartridgeDBConnector::closeConnection() {
-    if (m_database.isOpen()) {
-        m_database.close();
+    // Write buffered form data while the connection is still leased
+    m_formWrites.reset();
+    m_nativeReader.reset();
+    m_nativeReaderFailed = false;
+    m_statements.reset();
+    m_database = QSqlDatabase(); // Drop our handle before returning the lease
+    if (!m_connectionName.isEmpty()) {
+        // Connection stays open in the pool until it has been idle long enough
+        CartridgeConnectionPool::getInstance().release(m_connectionName);
+        m_connectionName.clear();
     }
-    m_database = QSqlDatabase(); // Remove connection
     m_isOpen = false;
     m_cartridgeGuid.clear();
 }
@@ -64,17 +82,59 @@ bool CartridgeDBConnector::isOpen() const {
     return m_isOpen && m_database.isOpen();
 }
 
+CartridgeOpenMode CartridgeDBConnector::openMode() const {
+    return m_openMode;
+}
+
+bool CartridgeDBConnector::isReadOnly() const {
+    return m_openMode != CartridgeOpenMode::ReadWrite;
+}
+
+ConnectionRole CartridgeDBConnector::role() const {
+    return m_role;
+}
+
 QString CartridgeDBConnector::getCartridgeGuid() const {
     return m_cartridgeGuid;
 }
 
 QSqlQuery CartridgeDBConnector::executeQuery(const QString& queryString) {
-    QSqlQuery query(m_database);
+    InstrumentedQuery query(m_database);
     if (!query.exec(queryString)) {
         qWarning() << "Query failed:" << queryString;
         qWarning() << "Error:" << query.lastError().text();
     }
-    return query;
+    // Rows stepped by the caller are not counted once the query is returned
+    query.finishTrace();
+    QSqlQuery result(std::move(query));
+    return result;
+}
+
+PreparedQuery CartridgeDBConnector::executePrepared(const QString& queryString, const QVariantList& bindValues) {
+    if (!m_statements) {
+        qWarning() << "Cannot execute prepared query: cartridge not open";
+        return PreparedQuery();
+    }
+
+    std::shared_ptr<InstrumentedQuery> query = m_statements->statement(queryString);
+    if (!query) {
+        return PreparedQuery();
+    }
+
+    for (int i = 0; i < bindValues.size(); ++i) {
+        query->bindValue(i, bindValues.at(i));
+    }
+
+    if (!query->exec()) {
+        qWarning() << "Prepared query failed:" << queryString;
+        qWarning() << "Error:" << query->lastError().text();
+    }
+
+    return PreparedQuery(query);
+}
+
+StatementCache::Stats CartridgeDBConnector::statementCacheStats() const {
+    return m_statements ? m_statements->stats() : StatementCache::Stats();
 }
 
 bool CartridgeDBConnector::beginTransaction() {
@@ -93,98 +153,167 @@ QSqlDatabase& CartridgeDBConnector::getDatabase() {
     return m_database;
 }
 
-void CartridgeDBConnector::configureConnection() {
-    QSqlQuery query(m_database);
-
-    // Enable WAL mode
-    if (!query.exec("PRAGMA journal_mode=WAL")) {
-        qWarning() << "Failed to enable WAL mode:" << query.lastError().text();
+NativeConnection* CartridgeDBConnector::nativeReader() {
+    if (!isOpen()) {
+        return nullptr;
     }
 
-    // Set page size to 4096 bytes
-    if (!query.exec("PRAGMA page_size=4096")) {
-        qWarning() << "Failed to set page size:" << query.lastError().text();
+    // The leased connection's own handle: no second connection to the file
+    if (!m_nativeReader && !m_nativeReaderFailed) {
+        auto connection = std::make_unique<NativeConnection>();
+        if (connection->attach(m_database)) {
+            m_nativeReader = std::move(connection);
+        } else {
+            m_nativeReaderFailed = true;
+        }
     }
+    return m_nativeReader.get();
+}
 
-    // Set cache size (1000 pages for cartridge)
-    if (!query.exec("PRAGMA cache_size=-1000")) {
-        qWarning() << "Failed to set cache size:" << query.lastError().text();
+bool CartridgeDBConnector::saveFormData(const QString& formId, const QString& dataJson)
+{
+    if (!m_isOpen || !m_database.isOpen()) {
+        qWarning() << "Cannot save form data: cartridge not open";
+        return false;
     }
 
-    // Set synchronous mode to NORMAL (safe with WAL)
-    if (!query.exec("PRAGMA synchronous=NORMAL")) {
-        qWarning() << "Failed to set synchronous mode:" << query.lastError().text();
+    if (isReadOnly()) {
+        return saveLocalFormData(formId, dataJson);
     }
+    
+    // Buffered per form; one transaction writes the latest data of every
+    // form changed since the last flush
+    const qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+    m_formWrites->enqueue(formId, dataJson, [this, formId, dataJson, timestamp](QSqlDatabase&) {
+        // Use INSERT OR REPLACE to handle updates
+        PreparedQuery query = executePrepared(R"(
+            INSERT OR REPLACE INTO User_Data (form_id, data_json, saved_timestamp)
+            VALUES (?, ?, ?)
+        )", {formId, dataJson, timestamp});
+        
+        if (!query.isPrepared() || !query->isActive()) {
+            qCritical() << "Failed to save form data for form:" << formId;
+            return false;
+        }
+        return true;
+    });
+    
+    return true;
+}
 
-    // Enable foreign keys
-    if (!query.exec("PRAGMA foreign_keys=ON")) {
-        qWarning() << "Failed to enable foreign keys:" << query.lastError().text();
+bool CartridgeDBConnector::flushFormData()
+{
+    if (!m_isOpen) {
+        return false;
     }
 
-    // Set busy timeout (5 seconds)
-    if (!query.exec("PRAGMA busy_timeout=5000")) {
-        qWarning() << "Failed to set busy timeout:" << query.lastError().text();
+    if (isReadOnly()) {
+        WriteCoalescer* pending = LocalDBManager::getInstance().writeCoalescer();
+        return pending && pending->flush(WriteCoalescer::Durability::Full);
     }
-    
-    // Create User_Data table if it doesn't exist
-    query.exec(R"(
-        CREATE TABLE IF NOT EXISTS User_Data (
-            data_id INTEGER PRIMARY KEY AUTOINCREMENT,
-            form_id TEXT NOT NULL,
-            data_json TEXT NOT NULL,
-            saved_timestamp INTEGER NOT NULL,
-            UNIQUE(form_id)
-        )
-    )");
+
+    return m_formWrites->flush(WriteCoalescer::Durability::Full);
 }
 
-bool CartridgeDBConnector::saveFormData(const QString& formId, const QString& dataJson)
+QString CartridgeDBConnector::loadFormData(const QString& formId)
 {
     if (!m_isOpen || !m_database.isOpen()) {
-        qWarning() << "Cannot save form data: cartridge not open";
-        return false;
+        qWarning() << "Cannot load form data: cartridge not open";
+        return QString();
+    }
+
+    if (isReadOnly()) {
+        return loadLocalFormData(formId);
     }
     
-    QSqlQuery query(m_database);
+    if (m_formWrites->hasPending(formId)) {
+        return m_formWrites->pendingValue(formId).toString();
+    }
     
-    // Use INSERT OR REPLACE to handle updates
-    query.prepare(R"(
-        INSERT OR REPLACE INTO User_Data (form_id, data_json, saved_timestamp)
-        VALUES (?, ?, ?)
-    )");
+    PreparedQuery query = executePrepared("SELECT data_json FROM User_Data WHERE form_id = ?", {formId});
     
-    query.addBindValue(formId);
-    query.addBindValue(dataJson);
-    query.addBindValue(QDateTime::currentSecsSinceEpoch());
+    if (!query.isPrepared() || !query->isActive()) {
+        qWarning() << "Failed to load form data for form:" << formId;
+        return QString();
+    }
     
-    if (!query.exec()) {
-        qCritical() << "Failed to save form data:" << query.lastError().text();
-        return false;
+    if (query->next()) {
+        return query->value(0).toString();
     }
     
+    return QString(); // Not found
+}
+
+bool CartridgeDBConnector::saveLocalFormData(const QString& formId, const QString& dataJson)
+{
+    if (m_cartridgeGuid.isEmpty()) {
+        qWarning() << "Cannot save form data: cartridge has no GUID";
+        return false;
+    }
+
+    WriteCoalescer* pending = LocalDBManager::getInstance().writeCoalescer();
+    if (!pending) {
+        qWarning() << "Cannot save form data: local database not open";
+        return false;
+    }
+
+    const QString cartridgeGuid = m_cartridgeGuid;
+    const qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+
+    // Buffered, then written through the single writer connection
+    pending->enqueue(localFormKey(formId), dataJson,
+                     [cartridgeGuid, formId, dataJson, timestamp](QSqlDatabase& database) {
+        InstrumentedQuery query(database);
+        query.prepare(R"(
+            INSERT OR REPLACE INTO Local_User_Data
+            (cartridge_guid, form_id, data_json, saved_timestamp)
+            VALUES (?, ?, ?, ?)
+        )");
+        query.addBindValue(cartridgeGuid);
+        query.addBindValue(formId);
+        query.addBindValue(dataJson);
+        query.addBindValue(timestamp);
+
+        if (!query.exec()) {
+            qCritical() << "Failed to save form data for form:" << formId << query.lastError().text();
+            return false;
+        }
+        return true;
+    });
     return true;
 }
 
-QString CartridgeDBConnector::loadFormData(const QString& formId)
+QString CartridgeDBConnector::localFormKey(const QString& formId) const
 {
-    if (!m_isOpen || !m_database.isOpen()) {
-        qWarning() << "Cannot load form data: cartridge not open";
+    return QString("form/%1/%2").arg(m_cartridgeGuid, formId);
+}
+
+QString CartridgeDBConnector::loadLocalFormData(const QString& formId)
+{
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    if (m_cartridgeGuid.isEmpty() || !dbManager.isOpen()) {
         return QString();
     }
-    
-    QSqlQuery query(m_database);
-    query.prepare("SELECT data_json FROM User_Data WHERE form_id = ?");
+
+    WriteCoalescer* pending = dbManager.writeCoalescer();
+    if (pending && pending->hasPending(localFormKey(formId))) {
+        return pending->pendingValue(localFormKey(formId)).toString();
+    }
+
+    InstrumentedQuery query(dbManager.readConnection());
+    query.prepare("SELECT data_json FROM Local_User_Data WHERE cartridge_guid = ? AND form_id = ?");
+    query.addBindValue(m_cartridgeGuid);
     query.addBindValue(formId);
-    
+
     if (!query.exec()) {
-        qWarning() << "Failed to load form data:" << query.lastError().text();
+        qWarning() << "Failed to load form data for form:" << formId << query.lastError().text();
         return QString();
     }
-    
+
     if (query.next()) {
         return query.value(0).toString();
     }
-    
+
     return QString(); // Not found
 }
 
@@ -0,0 +1,123 @@
+#include "smartbook/common/database/CartridgeResourceDevice.h"
+#include <QMimeDatabase>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+CartridgeResources::CartridgeResources(const QString& cartridgePath)
+    : m_path(cartridgePath)
+{
+}
+
+CartridgeResourceDevice::CartridgeResourceDevice(QObject* parent)
+    : QIODevice(parent)
+{
+}
+
+CartridgeResourceDevice::~CartridgeResourceDevice() {
+    close();
+}
+
+bool CartridgeResourceDevice::openResource(const QString& cartridgePath, const QString& resource) {
+    return openResource(std::make_shared<CartridgeResources>(cartridgePath), resource);
+}
+
+bool CartridgeResourceDevice::openResource(const std::shared_ptr<CartridgeResources>& resources,
+                                           const QString& resource) {
+    close();
+    if (!resources || resource.isEmpty()) {
+        return false;
+    }
+
+    QMutexLocker locker(&resources->m_mutex);
+    NativeConnection& connection = resources->m_connection;
+    if (!connection.isOpen()) {
+        if (!connection.open(resources->m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader)) {
+            return false;
+        }
+
+        // resource_id is the primary key; resource_path is how pages written
+        // with relative paths refer to it
+        resources->m_lookup = connection.prepare(R"(
+            SELECT rowid, mime_type, resource_path FROM Resources WHERE resource_id = ?1
+            UNION ALL
+            SELECT rowid, mime_type, resource_path FROM Resources WHERE resource_path = ?1
+            LIMIT 1
+        )");
+    }
+
+    NativeStatement& lookup = resources->m_lookup;
+    if (!lookup.isValid()) {
+        return false;
+    }
+    lookup.bindText(0, resource);
+    if (!lookup.step()) {
+        lookup.reset();
+        return false;
+    }
+    const qint64 rowid = lookup.columnInt64(0);
+    const QString mimeType = mimeTypeFor(lookup.columnString(1), lookup.columnString(2));
+    lookup.reset();
+
+    NativeBlob blob = connection.openBlob("Resources", "resource_data", rowid);
+    if (!blob.isValid()) {
+        qWarning() << "Failed to open resource" << resource << "in" << resources->m_path;
+        return false;
+    }
+    locker.unlock();
+
+    m_resources = resources;
+    m_blob = std::move(blob);
+    m_mimeType = mimeType;
+
+    // Unbuffered: every read is already a direct copy out of the page cache
+    return QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+QString CartridgeResourceDevice::mimeTypeFor(const QString& stored, const QString& path) {
+    if (!stored.isEmpty() && stored != QLatin1String("application/octet-stream")) {
+        return stored;
+    }
+    const QMimeType guessed = QMimeDatabase().mimeTypeForFile(path, QMimeDatabase::MatchExtension);
+    return guessed.isDefault() && !stored.isEmpty() ? stored : guessed.name();
+}
+
+qint64 CartridgeResourceDevice::size() const {
+    return m_blob.isValid() ? m_blob.size() : 0;
+}
+
+void CartridgeResourceDevice::close() {
+    if (isOpen()) {
+        QIODevice::close();
+    }
+    if (m_resources) {
+        QMutexLocker locker(&m_resources->m_mutex);
+        m_blob.close();
+    }
+    m_resources.reset();
+    m_mimeType.clear();
+}
+
+qint64 CartridgeResourceDevice::readData(char* data, qint64 maxSize) {
+    const qint64 offset = pos();
+    const qint64 length = qMin(maxSize, size() - offset);
+    if (length <= 0) {
+        return 0;
+    }
+    QMutexLocker locker(&m_resources->m_mutex);
+    if (!m_blob.read(data, static_cast<int>(length), static_cast<int>(offset))) {
+        setErrorString(QStringLiteral("Failed to read resource"));
+        return -1;
+    }
+    return length;
+}
+
+qint64 CartridgeResourceDevice::writeData(const char* /* data */, qint64 /* maxSize */) {
+    return -1;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
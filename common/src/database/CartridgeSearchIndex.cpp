@@ -0,0 +1,388 @@
+#include "smartbook/common/database/CartridgeSearchIndex.h"
+#include "smartbook/common/manifest/LibrarySearch.h"
+#include "smartbook/common/utils/PlatformUtils.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QUuid>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+namespace {
+
+// Match markers for snippet() and highlight(); never part of page text
+const QChar MATCH_START(0x02);
+const QChar MATCH_END(0x03);
+
+// Tags that separate words; inline tags (b, em, span, a, ...) do not
+const QSet<QString>& blockTags() {
+    static const QSet<QString> tags = {
+        "address", "article", "aside", "blockquote", "br", "caption", "dd", "div",
+        "dl", "dt", "figcaption", "figure", "footer", "h1", "h2", "h3", "h4", "h5",
+        "h6", "header", "hr", "img", "li", "nav", "ol", "p", "pre", "section",
+        "table", "td", "th", "tr", "ul"
+    };
+    return tags;
+}
+
+QString decodeEntity(const QString& entity) {
+    static const QHash<QString, QString> named = {
+        {"amp", "&"}, {"lt", "<"}, {"gt", ">"}, {"quot", "\""},
+        {"apos", "'"}, {"nbsp", " "}
+    };
+    if (entity.startsWith('#')) {
+        bool ok = false;
+        const uint code = entity.startsWith("#x", Qt::CaseInsensitive)
+            ? entity.mid(2).toUInt(&ok, 16)
+            : entity.mid(1).toUInt(&ok, 10);
+        if (ok && code > 0 && QChar::requiresSurrogates(code)) {
+            const QChar pair[2] = {QChar(QChar::highSurrogate(code)), QChar(QChar::lowSurrogate(code))};
+            return QString(pair, 2);
+        }
+        return ok && code > 0 && code <= 0xFFFF ? QString(QChar(code)) : QString();
+    }
+    return named.value(entity.toLower());
+}
+
+} // namespace
+
+QString CartridgeSearchIndex::plainText(const QString& html) {
+    QString text;
+    text.reserve(html.size());
+    bool pendingSpace = false;
+
+    auto append = [&](const QString& value) {
+        for (const QChar c : value) {
+            if (c.isSpace()) {
+                pendingSpace = true;
+                continue;
+            }
+            if (pendingSpace && !text.isEmpty()) {
+                text.append(' ');
+            }
+            pendingSpace = false;
+            text.append(c);
+        }
+    };
+
+    int i = 0;
+    while (i < html.size()) {
+        const QChar c = html.at(i);
+
+        if (c == '<') {
+            if (html.mid(i, 4) == "<!--") {
+                const int end = html.indexOf("-->", i + 4);
+                i = end < 0 ? html.size() : end + 3;
+                continue;
+            }
+            const int end = html.indexOf('>', i);
+            if (end < 0) {
+                break;  // Unterminated tag: nothing readable follows
+            }
+
+            int nameStart = i + 1;
+            const bool closing = nameStart < end && html.at(nameStart) == '/';
+            if (closing) {
+                ++nameStart;
+            }
+            int nameEnd = nameStart;
+            while (nameEnd < end && html.at(nameEnd).isLetterOrNumber()) {
+                ++nameEnd;
+            }
+            const QString name = html.mid(nameStart, nameEnd - nameStart).toLower();
+            i = end + 1;
+
+            if (!closing && (name == "script" || name == "style")) {
+                const int close = html.indexOf("</" + name, i, Qt::CaseInsensitive);
+                const int closeEnd = close < 0 ? -1 : html.indexOf('>', close);
+                i = closeEnd < 0 ? html.size() : closeEnd + 1;
+                pendingSpace = true;
+            } else if (blockTags().contains(name)) {
+                pendingSpace = true;
+            }
+            continue;
+        }
+
+        if (c == '&') {
+            const int end = html.indexOf(';', i);
+            if (end > i + 1 && end - i <= 10) {
+                const QString decoded = decodeEntity(html.mid(i + 1, end - i - 1));
+                if (!decoded.isEmpty()) {
+                    append(decoded);
+                    i = end + 1;
+                    continue;
+                }
+            }
+        }
+
+        if (c == MATCH_START || c == MATCH_END) {
+            ++i;    // Reserved for match markers
+            continue;
+        }
+
+        append(QString(c));
+        ++i;
+    }
+    return text;
+}
+
+bool CartridgeSearchIndex::createTables(NativeConnection& connection, bool withTriggers) {
+    // chapter_title ranks five times the page text
+    QString sql = R"(
+        DROP TRIGGER IF EXISTS trg_content_search_insert;
+        DROP TRIGGER IF EXISTS trg_content_search_update;
+        DROP TRIGGER IF EXISTS trg_content_search_delete;
+        DROP TABLE IF EXISTS Content_Search;
+        DROP TABLE IF EXISTS Content_Search_State;
+        CREATE VIRTUAL TABLE Content_Search USING fts5(
+            chapter_title, body,
+            tokenize='unicode61 remove_diacritics 2'
+        );
+        INSERT INTO Content_Search (Content_Search, rank) VALUES ('rank', 'bm25(5.0, 1.0)');
+        CREATE TABLE Content_Search_State (
+            source_size INTEGER,
+            source_modified INTEGER
+        );
+    )";
+
+    // Page edits after export leave the index stale; reordering does not
+    if (withTriggers) {
+        sql += R"(
+            CREATE TRIGGER trg_content_search_insert AFTER INSERT ON Content_Pages
+            BEGIN
+                DELETE FROM Content_Search_State;
+            END;
+            CREATE TRIGGER trg_content_search_update AFTER UPDATE OF page_id, chapter_title, html_content ON Content_Pages
+            BEGIN
+                DELETE FROM Content_Search_State;
+            END;
+            CREATE TRIGGER trg_content_search_delete AFTER DELETE ON Content_Pages
+            BEGIN
+                DELETE FROM Content_Search_State;
+            END;
+        )";
+    }
+
+    if (!connection.exec(sql)) {
+        qWarning() << "Failed to create search index tables:" << connection.lastError();
+        return false;
+    }
+    return true;
+}
+
+bool CartridgeSearchIndex::fillIndex(NativeStatement& pages, NativeConnection& target) {
+    NativeStatement insert = target.prepare(
+        "INSERT INTO Content_Search (rowid, chapter_title, body) VALUES (?, ?, ?)");
+    if (!insert.isValid()) {
+        return false;
+    }
+
+    while (pages.step()) {
+        insert.bindInt64(0, pages.columnInt64(0));
+        insert.bindText(1, pages.columnString(1));
+        insert.bindText(2, plainText(pages.columnString(2)));
+        insert.step();
+        if (insert.hasError()) {
+            qWarning() << "Failed to index page" << pages.columnInt64(0) << ":" << insert.lastError();
+            return false;
+        }
+        insert.reset();
+    }
+    if (pages.hasError()) {
+        qWarning() << "Failed to read pages for the search index:" << pages.lastError();
+        return false;
+    }
+    return true;
+}
+
+bool CartridgeSearchIndex::hasIndex(NativeConnection& connection) {
+    if (!connection.isOpen()) {
+        return false;
+    }
+
+    // Checked first so a missing table is not logged as a failed prepare
+    NativeStatement tables = connection.prepare(
+        "SELECT COUNT(*) FROM sqlite_master WHERE name IN ('Content_Search', 'Content_Search_State')");
+    if (!tables.step() || tables.columnInt(0) != 2) {
+        return false;
+    }
+
+    NativeStatement state = connection.prepare("SELECT 1 FROM Content_Search_State");
+    return state.step();
+}
+
+bool CartridgeSearchIndex::buildIndex(NativeConnection& connection) {
+    if (!connection.exec("BEGIN IMMEDIATE")) {
+        qWarning() << "Failed to start search index build:" << connection.lastError();
+        return false;
+    }
+
+    bool built = createTables(connection, true);
+    if (built) {
+        NativeStatement pages = connection.prepare(
+            "SELECT page_id, chapter_title, html_content FROM Content_Pages");
+        built = pages.isValid() && fillIndex(pages, connection);
+    }
+    built = built
+        && connection.exec("INSERT INTO Content_Search_State (source_size, source_modified) VALUES (NULL, NULL)")
+        && connection.exec("COMMIT");
+    if (!built) {
+        qWarning() << "Failed to build search index:" << connection.lastError();
+        connection.exec("ROLLBACK");
+        return false;
+    }
+
+    // Merge the segments written during the build into one b-tree per term
+    connection.exec("INSERT INTO Content_Search (Content_Search) VALUES ('optimize')");
+    return true;
+}
+
+QString CartridgeSearchIndex::sidecarPath(const QString& cartridgePath) {
+    const QString directory = utils::PlatformUtils::getCacheDirectory() + "/search";
+    QDir().mkpath(directory);
+
+    const QByteArray key = QCryptographicHash::hash(
+        QFileInfo(cartridgePath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return directory + "/" + QString::fromLatin1(key) + ".sqlite";
+}
+
+bool CartridgeSearchIndex::isSidecarCurrent(const QString& cartridgePath, const QString& sidecarPath) {
+    const QFileInfo cartridge(cartridgePath);
+    if (!cartridge.exists() || !QFileInfo::exists(sidecarPath)) {
+        return false;
+    }
+
+    NativeConnection sidecar;
+    if (!sidecar.open(sidecarPath, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader) || !hasIndex(sidecar)) {
+        return false;
+    }
+    NativeStatement state = sidecar.prepare("SELECT source_size, source_modified FROM Content_Search_State");
+    return state.step()
+        && state.columnInt64(0) == cartridge.size()
+        && state.columnInt64(1) == cartridge.lastModified().toMSecsSinceEpoch();
+}
+
+bool CartridgeSearchIndex::buildSidecar(const QString& cartridgePath, const QString& sidecarPath) {
+    if (isSidecarCurrent(cartridgePath, sidecarPath)) {
+        return true;
+    }
+
+    // Stamped before reading, so a change during the build leaves it stale
+    const QFileInfo cartridge(cartridgePath);
+    const qint64 size = cartridge.size();
+    const qint64 modified = cartridge.lastModified().toMSecsSinceEpoch();
+    const QString temporary = sidecarPath + "." + QUuid::createUuid().toString(QUuid::Id128) + ".tmp";
+
+    bool built = false;
+    {
+        NativeConnection source;
+        NativeConnection target;
+        if (!source.open(cartridgePath, CartridgeOpenMode::ReadOnly, ConnectionRole::Verifier)
+            || !target.open(temporary, CartridgeOpenMode::ReadWrite, ConnectionRole::BulkImport)) {
+            QFile::remove(temporary);
+            return false;
+        }
+
+        NativeStatement pages = source.prepare(
+            "SELECT page_id, chapter_title, html_content FROM Content_Pages");
+        built = pages.isValid()
+            && target.exec("BEGIN")
+            && createTables(target, false)
+            && fillIndex(pages, target);
+        if (built) {
+            NativeStatement stamp = target.prepare(
+                "INSERT INTO Content_Search_State (source_size, source_modified) VALUES (?, ?)");
+            stamp.bindInt64(0, size);
+            stamp.bindInt64(1, modified);
+            stamp.step();
+            built = stamp.isValid() && !stamp.hasError();
+        }
+        built = built
+            && target.exec("COMMIT")
+            && target.exec("INSERT INTO Content_Search (Content_Search) VALUES ('optimize')");
+    }
+
+    if (!built) {
+        qWarning() << "Failed to build search sidecar for" << cartridgePath;
+        QFile::remove(temporary);
+        return false;
+    }
+
+    QFile::remove(sidecarPath);
+    if (!QFile::rename(temporary, sidecarPath)) {
+        qWarning() << "Failed to move search sidecar into place:" << sidecarPath;
+        QFile::remove(temporary);
+        return false;
+    }
+    return true;
+}
+
+QList<CartridgeSearchIndex::Hit> CartridgeSearchIndex::search(NativeConnection& connection,
+                                                              const QString& text, int limit) {
+    QList<Hit> hits;
+    const QString match = manifest::LibrarySearch::matchExpression(text);
+    if (!connection.isOpen() || match.isEmpty() || limit <= 0) {
+        return hits;
+    }
+
+    // ORDER BY rank is resolved inside FTS5, so snippet() and highlight()
+    // only run for the pages returned, not for every page that matches
+    NativeStatement query = connection.prepare(R"(
+        SELECT rowid, chapter_title, rank,
+               snippet(Content_Search, -1, char(2), char(3), '...', 24),
+               highlight(Content_Search, 1, char(2), char(3))
+        FROM Content_Search
+        WHERE Content_Search MATCH ?
+        ORDER BY rank
+        LIMIT ?
+    )");
+    query.bindText(0, match);
+    query.bindInt64(1, limit);
+
+    while (query.step()) {
+        Hit hit;
+        hit.pageId = query.columnInt(0);
+        hit.chapterTitle = query.columnString(1);
+        hit.score = query.columnDouble(2);
+        hit.snippet = query.columnString(3).toHtmlEscaped()
+            .replace(MATCH_START, "<mark>")
+            .replace(MATCH_END, "</mark>");
+
+        // Markers are not part of the text, so offsets skip over them
+        const QString highlighted = query.columnString(4);
+        int offset = 0;
+        Match current;
+        bool inMatch = false;
+        for (const QChar c : highlighted) {
+            if (c == MATCH_START) {
+                current = Match();
+                current.offset = offset;
+                inMatch = true;
+            } else if (c == MATCH_END) {
+                current.length = offset - current.offset;
+                hit.matches.append(current);
+                inMatch = false;
+            } else {
+                if (inMatch) {
+                    current.text.append(c);
+                }
+                ++offset;
+            }
+        }
+        hits.append(hit);
+    }
+    if (query.hasError()) {
+        qWarning() << "Cartridge search failed:" << query.lastError();
+    }
+    return hits;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
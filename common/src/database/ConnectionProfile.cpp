@@ -0,0 +1,187 @@
+#include "smartbook/common/database/ConnectionProfile.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSettings>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+namespace {
+
+QMutex s_overridesMutex;
+QHash<int, ConnectionProfile> s_overrides;
+
+const QList<ConnectionRole> kAllRoles = {
+    ConnectionRole::Reader,
+    ConnectionRole::Creator,
+    ConnectionRole::Verifier,
+    ConnectionRole::BulkImport,
+    ConnectionRole::LocalLibrary
+};
+
+// Settings values end up in PRAGMA text, so only accept known keywords
+QString validatedKeyword(const QString& value, const QStringList& allowed, const QString& fallback) {
+    const QString upper = value.trimmed().toUpper();
+    if (allowed.contains(upper)) {
+        return upper;
+    }
+    qWarning() << "Ignoring invalid connection profile value:" << value;
+    return fallback;
+}
+
+} // namespace
+
+ConnectionProfile ConnectionProfile::defaults(ConnectionRole role) {
+    ConnectionProfile profile;
+    profile.name = roleName(role);
+
+    switch (role) {
+    case ConnectionRole::Reader:
+        // Page fetches touch a few rows; keep the cache at the FR-SQL-6.8
+        // cartridge size and let mmap serve repeated reads without copies
+        profile.cacheSizeKiB = 1000;
+        profile.mmapSizeBytes = 256LL * 1024 * 1024;
+        profile.synchronous = "NORMAL";
+        profile.lockingMode = "NORMAL";
+        profile.tempStore = "MEMORY";
+        profile.busyTimeoutMs = 5000;
+        break;
+    case ConnectionRole::Creator:
+        // Editor writes through WAL; a larger cache keeps edited pages hot
+        profile.cacheSizeKiB = 8000;
+        profile.mmapSizeBytes = 64LL * 1024 * 1024;
+        profile.synchronous = "NORMAL";
+        profile.lockingMode = "NORMAL";
+        profile.tempStore = "MEMORY";
+        profile.busyTimeoutMs = 5000;
+        break;
+    case ConnectionRole::Verifier:
+        // Hashing reads every row once: map the whole file and keep the page
+        // cache tiny, since nothing is read twice
+        profile.cacheSizeKiB = 256;
+        profile.mmapSizeBytes = 1024LL * 1024 * 1024;
+        profile.synchronous = "NORMAL";
+        profile.lockingMode = "NORMAL";
+        profile.tempStore = "MEMORY";
+        profile.busyTimeoutMs = 5000;
+        break;
+    case ConnectionRole::BulkImport:
+        // Many inserts in few transactions: big cache and an exclusive lock
+        // skip per-statement shared-memory traffic. synchronous stays NORMAL
+        // (FR-SQL-6.9), so WAL commits remain crash-safe
+        profile.cacheSizeKiB = 64000;
+        profile.mmapSizeBytes = 256LL * 1024 * 1024;
+        profile.synchronous = "NORMAL";
+        profile.lockingMode = "EXCLUSIVE";
+        profile.tempStore = "MEMORY";
+        profile.busyTimeoutMs = 30000;
+        break;
+    case ConnectionRole::LocalLibrary:
+        // Local database: 2000 pages per FR-SQL-6.8, small mmap for manifest scans
+        profile.cacheSizeKiB = 2000;
+        profile.mmapSizeBytes = 64LL * 1024 * 1024;
+        profile.synchronous = "NORMAL";
+        profile.lockingMode = "NORMAL";
+        profile.tempStore = "MEMORY";
+        profile.busyTimeoutMs = 5000;
+        break;
+    }
+
+    return profile;
+}
+
+ConnectionProfile ConnectionProfile::forRole(ConnectionRole role) {
+    QMutexLocker locker(&s_overridesMutex);
+    auto it = s_overrides.constFind(static_cast<int>(role));
+    if (it != s_overrides.constEnd()) {
+        return it.value();
+    }
+    locker.unlock();
+
+    return defaults(role);
+}
+
+QString ConnectionProfile::roleName(ConnectionRole role) {
+    switch (role) {
+    case ConnectionRole::Reader:
+        return "reader";
+    case ConnectionRole::Creator:
+        return "creator";
+    case ConnectionRole::Verifier:
+        return "verifier";
+    case ConnectionRole::BulkImport:
+        return "bulk_import";
+    case ConnectionRole::LocalLibrary:
+        return "local_library";
+    }
+    return QString();
+}
+
+void ConnectionProfile::loadOverrides(QSettings& settings) {
+    for (ConnectionRole role : kAllRoles) {
+        ConnectionProfile profile = defaults(role);
+
+        settings.beginGroup(QString("database/profiles/%1").arg(profile.name));
+        const bool hasOverrides = !settings.childKeys().isEmpty();
+
+        profile.cacheSizeKiB = settings.value("cache_size_kib", profile.cacheSizeKiB).toInt();
+        profile.mmapSizeBytes = settings.value("mmap_size", profile.mmapSizeBytes).toLongLong();
+        profile.synchronous = validatedKeyword(settings.value("synchronous", profile.synchronous).toString(),
+                                               {"OFF", "NORMAL", "FULL"}, profile.synchronous);
+        profile.lockingMode = validatedKeyword(settings.value("locking_mode", profile.lockingMode).toString(),
+                                               {"NORMAL", "EXCLUSIVE"}, profile.lockingMode);
+        profile.tempStore = validatedKeyword(settings.value("temp_store", profile.tempStore).toString(),
+                                             {"DEFAULT", "FILE", "MEMORY"}, profile.tempStore);
+        profile.busyTimeoutMs = settings.value("busy_timeout_ms", profile.busyTimeoutMs).toInt();
+        settings.endGroup();
+
+        if (hasOverrides) {
+            setOverride(role, profile);
+        }
+    }
+}
+
+void ConnectionProfile::setOverride(ConnectionRole role, const ConnectionProfile& profile) {
+    QMutexLocker locker(&s_overridesMutex);
+    ConnectionProfile stored = profile;
+    stored.name = roleName(role);
+    s_overrides.insert(static_cast<int>(role), stored);
+}
+
+void ConnectionProfile::clearOverrides() {
+    QMutexLocker locker(&s_overridesMutex);
+    s_overrides.clear();
+}
+
+QStringList ConnectionProfile::pragmas() const {
+    return {
+        QString("PRAGMA cache_size=%1").arg(-qMax(0, cacheSizeKiB)),
+        QString("PRAGMA mmap_size=%1").arg(qMax<qint64>(0, mmapSizeBytes)),
+        QString("PRAGMA synchronous=%1").arg(synchronous),
+        QString("PRAGMA locking_mode=%1").arg(lockingMode),
+        QString("PRAGMA temp_store=%1").arg(tempStore),
+        QString("PRAGMA busy_timeout=%1").arg(qMax(0, busyTimeoutMs))
+    };
+}
+
+bool ConnectionProfile::apply(QSqlDatabase& database) const {
+    QSqlQuery query(database);
+    bool ok = true;
+
+    for (const QString& pragma : pragmas()) {
+        if (!query.exec(pragma)) {
+            qWarning() << "Failed to apply" << name << "profile:" << pragma << query.lastError().text();
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,165 @@
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include "smartbook/common/database/QueryStats.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMetaType>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+namespace {
+
+// Approximate in-memory size of a result value
+qint64 approximateSize(const QVariant& value) {
+    if (value.isNull()) {
+        return 0;
+    }
+    switch (value.typeId()) {
+    case QMetaType::QByteArray:
+        return value.toByteArray().size();
+    case QMetaType::QString:
+        return value.toString().size() * static_cast<qint64>(sizeof(QChar));
+    default:
+        return 8;
+    }
+}
+
+} // namespace
+
+InstrumentedQuery::InstrumentedQuery(const QSqlDatabase& database)
+    : QSqlQuery(database)
+    , m_connectionName(database.connectionName())
+{
+}
+
+InstrumentedQuery::~InstrumentedQuery() {
+    finishTrace();
+}
+
+bool InstrumentedQuery::exec(const QString& query) {
+    finishTrace();
+    if (!QueryStats::getInstance().isEnabled()) {
+        return QSqlQuery::exec(query);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = QSqlQuery::exec(query);
+    m_elapsedNs = timer.nsecsElapsed();
+    beginTrace();
+    return ok;
+}
+
+bool InstrumentedQuery::exec() {
+    finishTrace();
+    if (!QueryStats::getInstance().isEnabled()) {
+        return QSqlQuery::exec();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = QSqlQuery::exec();
+    m_elapsedNs = timer.nsecsElapsed();
+    beginTrace();
+    return ok;
+}
+
+void InstrumentedQuery::beginTrace() {
+    m_rows = 0;
+    m_bytes = 0;
+    m_tracing = true;
+
+    // Writes and failed statements have nothing left to step
+    if (!isActive() || !isSelect()) {
+        finishTrace();
+    }
+}
+
+bool InstrumentedQuery::next() {
+    if (!m_tracing) {
+        return QSqlQuery::next();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool hasRow = QSqlQuery::next();
+    m_elapsedNs += timer.nsecsElapsed();
+
+    if (hasRow) {
+        m_rows++;
+    } else {
+        finishTrace();
+    }
+    return hasRow;
+}
+
+QVariant InstrumentedQuery::value(int index) const {
+    QVariant result = QSqlQuery::value(index);
+    if (m_tracing) {
+        m_bytes += approximateSize(result);
+    }
+    return result;
+}
+
+QVariant InstrumentedQuery::value(const QString& name) const {
+    QVariant result = QSqlQuery::value(name);
+    if (m_tracing) {
+        m_bytes += approximateSize(result);
+    }
+    return result;
+}
+
+void InstrumentedQuery::finish() {
+    finishTrace();
+    QSqlQuery::finish();
+}
+
+void InstrumentedQuery::finishTrace() {
+    if (!m_tracing) {
+        return;
+    }
+    m_tracing = false;
+
+    QueryStats& stats = QueryStats::getInstance();
+    const QString sql = lastQuery();
+    if (stats.record(sql, m_connectionName, m_elapsedNs, m_rows, m_bytes)) {
+        stats.attachPlan(sql, explainQueryPlan());
+    }
+}
+
+QStringList InstrumentedQuery::explainQueryPlan() const {
+    QSqlDatabase database = QSqlDatabase::database(m_connectionName, false);
+    if (!database.isOpen()) {
+        return QStringList();
+    }
+
+    // Plain QSqlQuery so the plan lookup is not itself recorded
+    QSqlQuery explain(database);
+    if (!explain.prepare("EXPLAIN QUERY PLAN " + lastQuery())) {
+        return QStringList();
+    }
+    const QVariantList values = boundValues();
+    for (int i = 0; i < values.size(); ++i) {
+        explain.bindValue(i, values.at(i));
+    }
+    if (!explain.exec()) {
+        return QStringList();
+    }
+
+    // Rows are (id, parent, notused, detail); indent children under parents
+    QStringList plan;
+    QHash<int, int> depths;
+    while (explain.next()) {
+        const int id = explain.value(0).toInt();
+        const int parent = explain.value(1).toInt();
+        const int depth = depths.contains(parent) ? depths.value(parent) + 1 : 0;
+        depths.insert(id, depth);
+        plan.append(QString(depth * 2, QChar(' ')) + explain.value(3).toString());
+    }
+    return plan;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
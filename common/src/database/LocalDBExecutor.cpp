@@ -0,0 +1,164 @@
+#include "smartbook/common/database/LocalDBExecutor.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include <QSqlError>
+#include <QThread>
+#include <QUuid>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+LocalDBExecutor::LocalDBExecutor(QObject* parent)
+    : QObject(parent)
+{
+}
+
+LocalDBExecutor::~LocalDBExecutor() {
+    stop();
+}
+
+bool LocalDBExecutor::start(const QString& databasePath, ConnectionRole role) {
+    QMutexLocker locker(&m_mutex);
+    if (m_thread) {
+        return true;
+    }
+
+    m_databasePath = databasePath;
+    m_role = role;
+    m_connectionName = QString("LocalReaderDB_Executor_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    m_stopping = false;
+    m_started = false;
+    m_openFailed = false;
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("LocalDBExecutor");
+    m_thread->start();
+
+    // Wait until the worker has opened (or failed to open) its connection
+    while (!m_started) {
+        m_condition.wait(&m_mutex);
+    }
+
+    if (m_openFailed) {
+        QThread* thread = m_thread;
+        m_thread = nullptr;
+        locker.unlock();
+        thread->wait();
+        delete thread;
+        return false;
+    }
+
+    return true;
+}
+
+void LocalDBExecutor::stop() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_thread) {
+        return;
+    }
+
+    m_stopping = true;
+    QThread* thread = m_thread;
+    m_thread = nullptr;
+    m_condition.wakeAll();
+    locker.unlock();
+
+    thread->wait();
+    delete thread;
+
+    // Destroying the dropped tasks cancels their futures; do it outside the
+    // lock since cancellation can run continuations synchronously
+    QQueue<Task> droppedInteractive;
+    QQueue<Task> droppedBackground;
+    locker.relock();
+    droppedInteractive.swap(m_interactive);
+    droppedBackground.swap(m_background);
+    locker.unlock();
+}
+
+bool LocalDBExecutor::isRunning() const {
+    QMutexLocker locker(&m_mutex);
+    return m_thread != nullptr;
+}
+
+bool LocalDBExecutor::isWorkerThread() const {
+    QMutexLocker locker(&m_mutex);
+    return m_thread != nullptr && QThread::currentThread() == m_thread;
+}
+
+QString LocalDBExecutor::connectionName() const {
+    QMutexLocker locker(&m_mutex);
+    return m_connectionName;
+}
+
+bool LocalDBExecutor::hasPendingInteractive() const {
+    QMutexLocker locker(&m_mutex);
+    return !m_interactive.isEmpty();
+}
+
+int LocalDBExecutor::pendingCount(Priority priority) const {
+    QMutexLocker locker(&m_mutex);
+    return priority == Priority::Interactive ? m_interactive.size() : m_background.size();
+}
+
+void LocalDBExecutor::enqueue(Task task, Priority priority) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_thread || m_stopping) {
+        qWarning() << "Local database executor not running; task dropped";
+        return; // task (and its promise) destroyed here, canceling the future
+    }
+
+    if (priority == Priority::Interactive) {
+        m_interactive.enqueue(std::move(task));
+    } else {
+        m_background.enqueue(std::move(task));
+    }
+    m_condition.wakeOne();
+}
+
+void LocalDBExecutor::run() {
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        database.setDatabaseName(m_databasePath);
+
+        const bool opened = database.open();
+        if (opened) {
+            LocalDBManager::configureConnection(database, m_role);
+        } else {
+            qCritical() << "Failed to open local database on executor thread:" << database.lastError().text();
+        }
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_started = true;
+            m_openFailed = !opened;
+            m_condition.wakeAll();
+        }
+
+        while (opened) {
+            Task task;
+            {
+                QMutexLocker locker(&m_mutex);
+                while (!m_stopping && m_interactive.isEmpty() && m_background.isEmpty()) {
+                    m_condition.wait(&m_mutex);
+                }
+                if (m_stopping) {
+                    break;
+                }
+
+                // Interactive lane always drains first
+                task = !m_interactive.isEmpty() ? m_interactive.dequeue() : m_background.dequeue();
+            }
+
+            task(database);
+        }
+
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
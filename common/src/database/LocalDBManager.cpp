@@ -1,19 +1,39 @@
 #include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
 #include <QSqlError>
 #include <QStandardPaths>
 #include <QDir>
+#include <QThread>
+#include <QCoreApplication>
 #include <QDebug>
 
 namespace smartbook {
 namespace common {
 namespace database {
 
+namespace {
+
+// One migration per task, so a write() from the GUI thread waits for at
+// most one index build instead of the whole background pass
+void migrateInBackground(LocalDBExecutor& executor, const SchemaMigrator& migrator,
+                         const SchemaMigrator::ProgressCallback& progress) {
+    executor.submit([&executor, migrator, progress](QSqlDatabase& database) {
+        const bool ok = migrator.migrate(database, SchemaMigrator::Scope::Next, progress);
+        if (ok && !migrator.isCurrent(database)) {
+            migrateInBackground(executor, migrator, progress);
+        }
+        return ok;
+    }, LocalDBExecutor::Priority::Background);
+}
+
+} // namespace
+
 LocalDBManager& LocalDBManager::getInstance() {
     static LocalDBManager instance;
     return instance;
 }
 
-bool LocalDBManager::initializeConnection(const QString& dbPath) {
+bool LocalDBManager::initializeConnection(const QString& dbPath, ConnectionRole role) {
     if (m_initialized && m_database.isOpen()) {
         return true;
     }
@@ -36,8 +56,63 @@ bool LocalDBManager::initializeConnection(const QString& dbPath) {
         return false;
     }
 
-    // Configure SQLite settings (WAL mode, page size, etc.)
-    QSqlQuery query(m_database);
+    // Configure SQLite settings (WAL mode, page size, role profile, etc.)
+    m_role = role;
+    configureConnection(m_database, role);
+
+    // Apply pending schema migrations; no DDL runs when the schema is current
+    if (!createSchema()) {
+        qCritical() << "Failed to create database schema";
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_databasePath = actualPath;
+        m_generation++;
+    }
+
+    // Index-only migrations on an existing library run on the worker
+    // connection; WAL readers keep working while they build
+    const SchemaMigrator migrator = schemaMigrations();
+    if (!migrator.isCurrent(m_database)) {
+        migrateInBackground(executor(), migrator, m_migrationProgress);
+    }
+
+    // Small frequent writes are batched into one writer transaction. The
+    // GUI thread only waits for durable flushes (explicit saves, exit);
+    // timer flushes are queued on the writer and complete asynchronously
+    m_coalescer = std::make_unique<WriteCoalescer>([this](const WriteCoalescer::Write& batch) {
+        return write([batch](QSqlDatabase& database) {
+            return batch(database);
+        });
+    });
+    m_coalescer->setSubmitter([this](const WriteCoalescer::Write& batch) {
+        return executor().submit([batch](QSqlDatabase& database) {
+            return batch(database);
+        }, LocalDBExecutor::Priority::Interactive);
+    });
+
+    // Test runners and apps that never enter exec() do not emit aboutToQuit
+    static bool postRoutineAdded = false;
+    if (!postRoutineAdded && QCoreApplication::instance()) {
+        qAddPostRoutine(&LocalDBManager::flushPendingWritesOnExit);
+        postRoutineAdded = true;
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+void LocalDBManager::flushPendingWritesOnExit() {
+    LocalDBManager& instance = getInstance();
+    if (instance.m_coalescer) {
+        instance.m_coalescer->flush(WriteCoalescer::Durability::Full);
+    }
+}
+
+void LocalDBManager::configureConnection(QSqlDatabase& database, ConnectionRole role) {
+    QSqlQuery query(database);
     
     // Enable WAL mode
     if (!query.exec("PRAGMA journal_mode=WAL")) {
@@ -49,24 +124,13 @@ bool LocalDBManager::initializeConnection(const QString& dbPath) {
         qWarning() << "Failed to set page size:" << query.lastError().text();
     }
 
-    // Set cache size (2000 pages for local DB)
-    if (!query.exec("PRAGMA cache_size=-2000")) {
-        qWarning() << "Failed to set cache size:" << query.lastError().text();
-    }
+    // Cache, mmap, synchronous and locking settings come from the role profile
+    ConnectionProfile::forRole(role).apply(database);
 
     // Enable foreign keys
     if (!query.exec("PRAGMA foreign_keys=ON")) {
         qWarning() << "Failed to enable foreign keys:" << query.lastError().text();
     }
-
-    // Create schema if needed
-    if (!createSchema()) {
-        qCritical() << "Failed to create database schema";
-        return false;
-    }
-
-    m_initialized = true;
-    return true;
 }
 
 QSqlDatabase& LocalDBManager::getDatabase() {
@@ -74,27 +138,420 @@ QSqlDatabase& LocalDBManager::getDatabase() {
 }
 
 QSqlQuery LocalDBManager::executeQuery(const QString& queryString) {
-    QSqlQuery query(m_database);
+    InstrumentedQuery query(m_database);
     if (!query.exec(queryString)) {
         qWarning() << "Query failed:" << queryString;
         qWarning() << "Error:" << query.lastError().text();
     }
-    return query;
+    // Rows stepped by the caller are not counted once the query is returned
+    query.finishTrace();
+    QSqlQuery result(std::move(query));
+    return result;
+}
+
+LocalDBExecutor& LocalDBManager::executor() {
+    if (!m_executor.isRunning()) {
+        const QString path = databasePath();
+        if (!path.isEmpty()) {
+            m_executor.start(path, m_role);
+        }
+    }
+    return m_executor;
+}
+
+QSqlDatabase LocalDBManager::readConnection() {
+    QString path;
+    quint64 generation = 0;
+    {
+        QMutexLocker locker(&m_stateMutex);
+        path = m_databasePath;
+        generation = m_generation;
+    }
+
+    if (path.isEmpty()) {
+        return QSqlDatabase();
+    }
+
+    ReadConnection* reader = m_readConnections.localData();
+    if (reader && reader->generation == generation) {
+        return QSqlDatabase::database(reader->connectionName, false);
+    }
+
+    // Replacing the local data deletes (and closes) a stale connection
+    reader = new ReadConnection;
+    reader->connectionName = QString("LocalReaderDB_Read_%1_%2")
+        .arg(reinterpret_cast<quintptr>(QThread::currentThread()))
+        .arg(generation);
+    reader->generation = generation;
+    m_readConnections.setLocalData(reader);
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", reader->connectionName);
+    database.setDatabaseName(path);
+    if (!database.open()) {
+        qWarning() << "Failed to open local read connection:" << database.lastError().text();
+        return database;
+    }
+
+    // Readers never write, so they never take the WAL write lock
+    QSqlQuery query(database);
+    if (!query.exec("PRAGMA query_only=ON")) {
+        qWarning() << "Failed to enable query-only mode:" << query.lastError().text();
+    }
+    ConnectionProfile::forRole(ConnectionRole::LocalLibrary).apply(database);
+
+    return database;
+}
+
+NativeConnection* LocalDBManager::nativeReadConnection() {
+    QString path;
+    quint64 generation = 0;
+    {
+        QMutexLocker locker(&m_stateMutex);
+        path = m_databasePath;
+        generation = m_generation;
+    }
+
+    if (path.isEmpty()) {
+        return nullptr;
+    }
+
+    NativeReadConnection* reader = m_nativeReadConnections.localData();
+    if (reader && reader->generation == generation) {
+        return reader->connection.isOpen() ? &reader->connection : nullptr;
+    }
+
+    reader = new NativeReadConnection;
+    reader->generation = generation;
+    m_nativeReadConnections.setLocalData(reader);
+
+    // The thread's QtSql reader, so no second connection holds the file
+    const QSqlDatabase database = readConnection();
+    if (!database.isOpen() || !reader->connection.attach(database)) {
+        return nullptr;
+    }
+    return &reader->connection;
+}
+
+LocalDBManager::ReadConnection::~ReadConnection() {
+    {
+        QSqlDatabase database = QSqlDatabase::database(connectionName, false);
+        if (database.isOpen()) {
+            database.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+QString LocalDBManager::databasePath() const {
+    QMutexLocker locker(&m_stateMutex);
+    return m_databasePath;
+}
+
+WriteCoalescer* LocalDBManager::writeCoalescer() {
+    return m_coalescer.get();
 }
 
 void LocalDBManager::closeConnection() {
+    // Buffered writes go out through the executor, so flush before stopping it
+    m_coalescer.reset();
+
+    // Worker connection must be closed before the database can be reopened elsewhere
+    m_executor.stop();
+
     if (m_database.isOpen()) {
         m_database.close();
     }
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_databasePath.clear();
+        m_generation++;
+    }
+    // Other threads drop their readers on next use or when they exit;
+    // native readers first, as they run on the QtSql readers' handles
+    m_nativeReadConnections.setLocalData(nullptr);
+    m_readConnections.setLocalData(nullptr);
     m_initialized = false;
 }
 
+ConnectionRole LocalDBManager::currentRole() const {
+    return m_role;
+}
+
 bool LocalDBManager::isOpen() const {
     return m_database.isOpen();
 }
 
 bool LocalDBManager::createSchema() {
     QSqlQuery query(m_database);
+    bool isNewDatabase = false;
+    if (query.exec("SELECT COUNT(*) FROM sqlite_master") && query.next()) {
+        isNewDatabase = query.value(0).toInt() == 0;
+    }
+    query.finish();
+
+    // Empty tables index instantly, so a new database is brought fully current
+    const SchemaMigrator::Scope scope = isNewDatabase
+        ? SchemaMigrator::Scope::All
+        : SchemaMigrator::Scope::Blocking;
+    return schemaMigrations().migrate(m_database, scope, m_migrationProgress);
+}
+
+int LocalDBManager::schemaVersion() {
+    if (!m_database.isOpen()) {
+        return -1;
+    }
+    return SchemaMigrator::currentVersion(m_database);
+}
+
+int LocalDBManager::latestSchemaVersion() {
+    return schemaMigrations().latestVersion();
+}
+
+void LocalDBManager::setMigrationProgressHandler(const SchemaMigrator::ProgressCallback& handler) {
+    m_migrationProgress = handler;
+}
+
+SchemaMigrator LocalDBManager::schemaMigrations() {
+    SchemaMigrator migrator;
+
+    // Version 1 is the schema created before versioning; IF NOT EXISTS
+    // adopts databases that already have it
+    migrator.addMigration(1, "Baseline library schema",
+                          [](QSqlDatabase& database, const SchemaMigrator::Reporter&) {
+        return createBaselineSchema(database);
+    });
+
+    // The dropped indexes duplicate UNIQUE constraints and only cost writes.
+    // The indexes this version used to build are created by version 8:
+    // Scope::Blocking only defers Background migrations after the last
+    // Blocking one, so index builds must not come before versions 3 to 7
+    migrator.addMigration(2, "Drop redundant indexes", QStringList{
+        "DROP INDEX IF EXISTS idx_manifest_guid",
+        "DROP INDEX IF EXISTS idx_trust_guid",
+        "DROP INDEX IF EXISTS idx_members_group",
+        "DROP INDEX IF EXISTS idx_user_settings_guid",
+        "DROP INDEX IF EXISTS idx_user_data_guid"
+    });
+
+    // Bookshelf covers pre-scaled per device pixel ratio (see CoverThumbnailStore).
+    // Rows are keyed to the cartridge_hash they were rendered from; the trigger
+    // drops them as soon as the hash or cover changes
+    migrator.addMigration(3, "Cover thumbnail cache", QStringList{
+        R"(CREATE TABLE IF NOT EXISTS Local_Cover_Thumbnails (
+            cartridge_guid TEXT NOT NULL,
+            scale INTEGER NOT NULL,
+            cartridge_hash BLOB NOT NULL,
+            width INTEGER NOT NULL,
+            height INTEGER NOT NULL,
+            image_data BLOB,
+            PRIMARY KEY (cartridge_guid, scale),
+            FOREIGN KEY (cartridge_guid) REFERENCES Local_Library_Manifest(cartridge_guid) ON DELETE CASCADE
+        ) WITHOUT ROWID)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_cover_changed
+            AFTER UPDATE OF cartridge_hash, cover_image_data ON Local_Library_Manifest
+            WHEN OLD.cartridge_hash IS NOT NEW.cartridge_hash
+              OR OLD.cover_image_data IS NOT NEW.cover_image_data
+            BEGIN
+                DELETE FROM Local_Cover_Thumbnails WHERE cartridge_guid = NEW.cartridge_guid;
+            END)"
+    });
+
+    // Manifest change log read by ManifestChangeFeed consumers. change_type
+    // is ManifestChangeFeed::ChangeType; every 1000th change prunes the log
+    // to the last 1000 (ManifestChangeFeed::LOG_RETENTION)
+    migrator.addMigration(4, "Manifest change log", QStringList{
+        R"(CREATE TABLE IF NOT EXISTS Local_Manifest_Changes (
+            change_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            cartridge_guid TEXT NOT NULL,
+            change_type INTEGER NOT NULL
+        ))",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_log_insert
+            AFTER INSERT ON Local_Library_Manifest
+            BEGIN
+                INSERT INTO Local_Manifest_Changes (cartridge_guid, change_type) VALUES (NEW.cartridge_guid, 1);
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_log_update
+            AFTER UPDATE ON Local_Library_Manifest
+            BEGIN
+                INSERT INTO Local_Manifest_Changes (cartridge_guid, change_type)
+                    SELECT OLD.cartridge_guid, 3 WHERE OLD.cartridge_guid IS NOT NEW.cartridge_guid;
+                INSERT INTO Local_Manifest_Changes (cartridge_guid, change_type)
+                    VALUES (NEW.cartridge_guid, CASE WHEN OLD.cartridge_guid IS NOT NEW.cartridge_guid THEN 1 ELSE 2 END);
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_log_delete
+            AFTER DELETE ON Local_Library_Manifest
+            BEGIN
+                INSERT INTO Local_Manifest_Changes (cartridge_guid, change_type) VALUES (OLD.cartridge_guid, 3);
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_log_prune
+            AFTER INSERT ON Local_Manifest_Changes
+            WHEN NEW.change_id % 1000 = 0
+            BEGIN
+                DELETE FROM Local_Manifest_Changes WHERE change_id <= NEW.change_id - 1000;
+            END)"
+    });
+
+    // Search-as-you-type index (see LibrarySearch). External content: the
+    // manifest keeps the text, version 9 adds the triggers that keep the
+    // tokens in sync and indexes libraries that existed before. Until then
+    // the index is empty and searches find nothing. rank is bm25 weighting
+    // title, author, publisher, series_name, edition_name
+    migrator.addMigration(5, "Library search index", QStringList{
+        R"(CREATE VIRTUAL TABLE IF NOT EXISTS Local_Library_Search USING fts5(
+            title, author, publisher, series_name, edition_name,
+            content='Local_Library_Manifest', content_rowid='manifest_id',
+            tokenize='unicode61 remove_diacritics 2', prefix='1 2 3'
+        ))",
+        R"(INSERT INTO Local_Library_Search (Local_Library_Search, rank)
+            VALUES ('rank', 'bm25(10.0, 5.0, 2.0, 3.0, 1.0)'))"
+    });
+
+    // Fingerprint of each entry's file (size, mtime in ms, inode) when it
+    // was last hashed; LibraryWatcher rehashes only files whose fingerprint
+    // changed. NULL until the file has been seen
+    migrator.addMigration(6, "Manifest file fingerprints", QStringList{
+        "ALTER TABLE Local_Library_Manifest ADD COLUMN file_size INTEGER",
+        "ALTER TABLE Local_Library_Manifest ADD COLUMN file_modified INTEGER",
+        "ALTER TABLE Local_Library_Manifest ADD COLUMN file_id INTEGER"
+    });
+
+    // Group sizes for the grouped library views (see LibraryGroups), kept
+    // by triggers so opening a view reads one row per group instead of
+    // counting the manifest. Local_Series_Counts has a row per series and
+    // edition pair ('' for none); member_count counts a group's members.
+    // The series index serves the cartridges of one series and edition in
+    // display order and replaces idx_manifest_series. Memberships go with
+    // their cartridge, which the foreign key otherwise refuses
+    migrator.addMigration(7, "Library group counts", QStringList{
+        R"(CREATE TABLE IF NOT EXISTS Local_Series_Counts (
+            series_name TEXT NOT NULL,
+            edition_name TEXT NOT NULL,
+            cartridge_count INTEGER NOT NULL,
+            PRIMARY KEY (series_name, edition_name)
+        ) WITHOUT ROWID)",
+        R"(INSERT OR REPLACE INTO Local_Series_Counts (series_name, edition_name, cartridge_count)
+            SELECT IFNULL(series_name, ''), IFNULL(edition_name, ''), COUNT(*)
+            FROM Local_Library_Manifest
+            GROUP BY 1, 2)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_series_insert
+            AFTER INSERT ON Local_Library_Manifest
+            BEGIN
+                INSERT INTO Local_Series_Counts (series_name, edition_name, cartridge_count)
+                VALUES (IFNULL(NEW.series_name, ''), IFNULL(NEW.edition_name, ''), 1)
+                ON CONFLICT (series_name, edition_name) DO UPDATE SET cartridge_count = cartridge_count + 1;
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_series_delete
+            AFTER DELETE ON Local_Library_Manifest
+            BEGIN
+                UPDATE Local_Series_Counts SET cartridge_count = cartridge_count - 1
+                WHERE series_name = IFNULL(OLD.series_name, '') AND edition_name = IFNULL(OLD.edition_name, '');
+                DELETE FROM Local_Series_Counts
+                WHERE series_name = IFNULL(OLD.series_name, '') AND edition_name = IFNULL(OLD.edition_name, '')
+                  AND cartridge_count <= 0;
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_series_update
+            AFTER UPDATE OF series_name, edition_name ON Local_Library_Manifest
+            WHEN IFNULL(OLD.series_name, '') IS NOT IFNULL(NEW.series_name, '')
+              OR IFNULL(OLD.edition_name, '') IS NOT IFNULL(NEW.edition_name, '')
+            BEGIN
+                UPDATE Local_Series_Counts SET cartridge_count = cartridge_count - 1
+                WHERE series_name = IFNULL(OLD.series_name, '') AND edition_name = IFNULL(OLD.edition_name, '');
+                DELETE FROM Local_Series_Counts
+                WHERE series_name = IFNULL(OLD.series_name, '') AND edition_name = IFNULL(OLD.edition_name, '')
+                  AND cartridge_count <= 0;
+                INSERT INTO Local_Series_Counts (series_name, edition_name, cartridge_count)
+                VALUES (IFNULL(NEW.series_name, ''), IFNULL(NEW.edition_name, ''), 1)
+                ON CONFLICT (series_name, edition_name) DO UPDATE SET cartridge_count = cartridge_count + 1;
+            END)",
+        "ALTER TABLE Local_Cartridge_Groups ADD COLUMN member_count INTEGER NOT NULL DEFAULT 0",
+        R"(UPDATE Local_Cartridge_Groups SET member_count =
+            (SELECT COUNT(*) FROM Local_Cartridge_Group_Members gm WHERE gm.group_id = Local_Cartridge_Groups.group_id))",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_members_count_insert
+            AFTER INSERT ON Local_Cartridge_Group_Members
+            BEGIN
+                UPDATE Local_Cartridge_Groups SET member_count = member_count + 1 WHERE group_id = NEW.group_id;
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_members_count_delete
+            AFTER DELETE ON Local_Cartridge_Group_Members
+            BEGIN
+                UPDATE Local_Cartridge_Groups SET member_count = member_count - 1 WHERE group_id = OLD.group_id;
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_members_count_update
+            AFTER UPDATE OF group_id ON Local_Cartridge_Group_Members
+            WHEN OLD.group_id IS NOT NEW.group_id
+            BEGIN
+                UPDATE Local_Cartridge_Groups SET member_count = member_count - 1 WHERE group_id = OLD.group_id;
+                UPDATE Local_Cartridge_Groups SET member_count = member_count + 1 WHERE group_id = NEW.group_id;
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_members_delete
+            BEFORE DELETE ON Local_Library_Manifest
+            BEGIN
+                DELETE FROM Local_Cartridge_Group_Members WHERE cartridge_guid = OLD.cartridge_guid;
+            END)",
+        "DROP INDEX IF EXISTS idx_manifest_series",
+        R"(CREATE INDEX IF NOT EXISTS idx_manifest_series_edition
+            ON Local_Library_Manifest(series_name, edition_name, series_order, title))"
+    });
+
+    // One index per library sort key in the form LibraryModel orders by,
+    // (key, cartridge_guid), so a page seeks to the last row it loaded and
+    // reads on without sorting. idx_manifest_title keeps its name. The
+    // publisher index serves the publisher filter; author and year filters
+    // use their sort indexes. members.cartridge_guid backs the foreign key
+    // check when a manifest row is deleted
+    migrator.addMigration(8, "Library sort indexes", QStringList{
+        "CREATE INDEX IF NOT EXISTS idx_members_guid ON Local_Cartridge_Group_Members(cartridge_guid)",
+        "DROP INDEX IF EXISTS idx_manifest_title",
+        "CREATE INDEX IF NOT EXISTS idx_manifest_title ON Local_Library_Manifest(title, cartridge_guid)",
+        "CREATE INDEX IF NOT EXISTS idx_manifest_author ON Local_Library_Manifest(author, cartridge_guid)",
+        "CREATE INDEX IF NOT EXISTS idx_manifest_year ON Local_Library_Manifest(publication_year, cartridge_guid)",
+        R"(CREATE INDEX IF NOT EXISTS idx_manifest_version
+            ON Local_Library_Manifest(IFNULL(version, ''), cartridge_guid))",
+        R"(CREATE INDEX IF NOT EXISTS idx_manifest_last_opened
+            ON Local_Library_Manifest(IFNULL(last_opened, 0), cartridge_guid))",
+        "CREATE INDEX IF NOT EXISTS idx_manifest_publisher ON Local_Library_Manifest(publisher)"
+    }, SchemaMigrator::Mode::Background);
+
+    // Fills the search index of version 5 and keeps it in sync. 'rebuild'
+    // reads the whole manifest, so it runs after startup; databases that
+    // already had the triggers from an earlier version 5 reindex once
+    migrator.addMigration(9, "Library search index rebuild", QStringList{
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_search_insert
+            AFTER INSERT ON Local_Library_Manifest
+            BEGIN
+                INSERT INTO Local_Library_Search (rowid, title, author, publisher, series_name, edition_name)
+                VALUES (NEW.manifest_id, NEW.title, NEW.author, NEW.publisher, NEW.series_name, NEW.edition_name);
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_search_delete
+            AFTER DELETE ON Local_Library_Manifest
+            BEGIN
+                INSERT INTO Local_Library_Search (Local_Library_Search, rowid, title, author, publisher, series_name, edition_name)
+                VALUES ('delete', OLD.manifest_id, OLD.title, OLD.author, OLD.publisher, OLD.series_name, OLD.edition_name);
+            END)",
+        R"(CREATE TRIGGER IF NOT EXISTS trg_manifest_search_update
+            AFTER UPDATE OF title, author, publisher, series_name, edition_name ON Local_Library_Manifest
+            BEGIN
+                INSERT INTO Local_Library_Search (Local_Library_Search, rowid, title, author, publisher, series_name, edition_name)
+                VALUES ('delete', OLD.manifest_id, OLD.title, OLD.author, OLD.publisher, OLD.series_name, OLD.edition_name);
+                INSERT INTO Local_Library_Search (rowid, title, author, publisher, series_name, edition_name)
+                VALUES (NEW.manifest_id, NEW.title, NEW.author, NEW.publisher, NEW.series_name, NEW.edition_name);
+            END)",
+        "INSERT INTO Local_Library_Search (Local_Library_Search) VALUES ('rebuild')"
+    }, SchemaMigrator::Mode::Background);
+
+    // cartridge_guid makes the member order of a series or edition total,
+    // so LibraryGroups::members() seeks to the last member it loaded
+    migrator.addMigration(10, "Series member order index", QStringList{
+        "DROP INDEX IF EXISTS idx_manifest_series_edition",
+        R"(CREATE INDEX IF NOT EXISTS idx_manifest_series_edition
+            ON Local_Library_Manifest(series_name, edition_name, series_order, title, cartridge_guid))"
+    }, SchemaMigrator::Mode::Background);
+
+    return migrator;
+}
+
+bool LocalDBManager::createBaselineSchema(QSqlDatabase& database) {
+    QSqlQuery query(database);
 
     // Create Local_Library_Manifest table
     QString manifestTable = R"(
@@ -193,6 +650,24 @@ bool LocalDBManager::createSchema() {
         return false;
     }
 
+    // Create Local_User_Data table (form data for cartridges opened read-only)
+    QString userDataTable = R"(
+        CREATE TABLE IF NOT EXISTS Local_User_Data (
+            user_data_id INTEGER PRIMARY KEY AUTOINCREMENT,
+            cartridge_guid TEXT NOT NULL,
+            form_id TEXT NOT NULL,
+            data_json TEXT NOT NULL,
+            saved_timestamp INTEGER NOT NULL,
+            FOREIGN KEY (cartridge_guid) REFERENCES Local_Library_Manifest(cartridge_guid),
+            UNIQUE(cartridge_guid, form_id)
+        )
+    )";
+
+    if (!query.exec(userDataTable)) {
+        qCritical() << "Failed to create Local_User_Data table:" << query.lastError().text();
+        return false;
+    }
+
     // Create indexes for performance
     query.exec("CREATE INDEX IF NOT EXISTS idx_manifest_guid ON Local_Library_Manifest(cartridge_guid)");
     query.exec("CREATE INDEX IF NOT EXISTS idx_trust_guid ON Local_Trust_Registry(cartridge_guid)");
@@ -201,6 +676,7 @@ bool LocalDBManager::createSchema() {
     query.exec("CREATE INDEX IF NOT EXISTS idx_manifest_series ON Local_Library_Manifest(series_name)");
     query.exec("CREATE INDEX IF NOT EXISTS idx_manifest_edition ON Local_Library_Manifest(edition_name)");
     query.exec("CREATE INDEX IF NOT EXISTS idx_user_settings_guid ON Local_User_Settings(cartridge_guid, setting_key)");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_user_data_guid ON Local_User_Data(cartridge_guid, form_id)");
 
     return true;
 }
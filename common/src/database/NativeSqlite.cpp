@@ -0,0 +1,924 @@
+#include "smartbook/common/database/NativeSqlite.h"
+#include "smartbook/common/database/QueryStats.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QUrl>
+#include <QUuid>
+#include <QDebug>
+#include <sqlite3.h>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+namespace {
+std::atomic<bool> s_probeOpened{false};
+
+int markProbeOpened(sqlite3*, char**, const sqlite3_api_routines*) {
+    s_probeOpened = true;
+    return SQLITE_OK;
+}
+
+bool probeQtSqlLibrary() {
+    // Auto extensions are per library: this one only runs on connections
+    // the plugin opens if the plugin uses this library
+    sqlite3_auto_extension(reinterpret_cast<void (*)(void)>(markProbeOpened));
+    const QString connectionName = QStringLiteral("NativeSqliteProbe");
+    bool opened = false;
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(":memory:");
+        opened = database.open();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    sqlite3_cancel_auto_extension(reinterpret_cast<void (*)(void)>(markProbeOpened));
+
+    // Without the plugin there are no QtSql connections to conflict with
+    if (!opened) {
+        return true;
+    }
+    if (!s_probeOpened) {
+        qWarning() << "The QSQLITE plugin uses its own SQLite library, not" << sqlite3_libversion()
+                   << "- native SQLite reads fall back to QtSql. Build Qt with -system-sqlite.";
+    }
+    return s_probeOpened;
+}
+
+NativeStatement::ColumnType columnTypeOf(const QVariant& value) {
+    if (value.isNull()) {
+        return NativeStatement::ColumnType::Null;
+    }
+    switch (value.typeId()) {
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+        return NativeStatement::ColumnType::Integer;
+    case QMetaType::Double:
+        return NativeStatement::ColumnType::Float;
+    case QMetaType::QByteArray:
+        return NativeStatement::ColumnType::Blob;
+    default:
+        return NativeStatement::ColumnType::Text;
+    }
+}
+}
+
+// ---------------------------------------------------------------------------
+// NativeStatement
+// ---------------------------------------------------------------------------
+
+NativeStatement::NativeStatement(sqlite3_stmt* statement, const QString& connectionName)
+    : m_statement(statement)
+    , m_connectionName(connectionName)
+{
+}
+
+NativeStatement::NativeStatement(std::unique_ptr<QSqlQuery> query, const QSqlDatabase& database,
+                                 const QString& sql, const QString& connectionName)
+    : m_connectionName(connectionName)
+    , m_query(std::move(query))
+    , m_database(database)
+    , m_sql(sql)
+{
+}
+
+NativeStatement::~NativeStatement() {
+    finishTrace();
+    sqlite3_finalize(m_statement);
+}
+
+NativeStatement::NativeStatement(NativeStatement&& other) noexcept
+    : m_statement(std::exchange(other.m_statement, nullptr))
+    , m_connectionName(std::move(other.m_connectionName))
+    , m_query(std::move(other.m_query))
+    , m_database(std::move(other.m_database))
+    , m_sql(std::move(other.m_sql))
+    , m_row(std::move(other.m_row))
+    , m_rowBytes(std::move(other.m_rowBytes))
+    , m_executed(std::exchange(other.m_executed, false))
+    , m_elapsedNs(other.m_elapsedNs)
+    , m_rows(other.m_rows)
+    , m_bytes(other.m_bytes)
+    , m_tracing(std::exchange(other.m_tracing, false))
+    , m_error(other.m_error)
+{
+}
+
+NativeStatement& NativeStatement::operator=(NativeStatement&& other) noexcept {
+    if (this != &other) {
+        finishTrace();
+        sqlite3_finalize(m_statement);
+        m_statement = std::exchange(other.m_statement, nullptr);
+        m_connectionName = std::move(other.m_connectionName);
+        m_query = std::move(other.m_query);
+        m_database = std::move(other.m_database);
+        m_sql = std::move(other.m_sql);
+        m_row = std::move(other.m_row);
+        m_rowBytes = std::move(other.m_rowBytes);
+        m_executed = std::exchange(other.m_executed, false);
+        m_elapsedNs = other.m_elapsedNs;
+        m_rows = other.m_rows;
+        m_bytes = other.m_bytes;
+        m_tracing = std::exchange(other.m_tracing, false);
+        m_error = other.m_error;
+    }
+    return *this;
+}
+
+bool NativeStatement::isValid() const {
+    return m_statement != nullptr || m_query != nullptr;
+}
+
+QString NativeStatement::sql() const {
+    if (m_query) {
+        return m_sql;
+    }
+    return m_statement ? QString::fromUtf8(sqlite3_sql(m_statement)) : QString();
+}
+
+bool NativeStatement::bindNull(int index) {
+    if (m_query) {
+        return bindValue(index, QVariant());
+    }
+    return m_statement && sqlite3_bind_null(m_statement, index + 1) == SQLITE_OK;
+}
+
+bool NativeStatement::bindInt64(int index, qint64 value) {
+    if (m_query) {
+        return bindValue(index, value);
+    }
+    return m_statement && sqlite3_bind_int64(m_statement, index + 1, value) == SQLITE_OK;
+}
+
+bool NativeStatement::bindDouble(int index, double value) {
+    if (m_query) {
+        return bindValue(index, value);
+    }
+    return m_statement && sqlite3_bind_double(m_statement, index + 1, value) == SQLITE_OK;
+}
+
+bool NativeStatement::bindText(int index, const QString& value) {
+    if (m_query) {
+        return bindValue(index, value.isNull() ? QVariant() : QVariant(value));
+    }
+    if (!m_statement) {
+        return false;
+    }
+    if (value.isNull()) {
+        return bindNull(index);
+    }
+    const QByteArray utf8 = value.toUtf8();
+    return sqlite3_bind_text64(m_statement, index + 1, utf8.constData(),
+                               static_cast<sqlite3_uint64>(utf8.size()),
+                               SQLITE_TRANSIENT, SQLITE_UTF8) == SQLITE_OK;
+}
+
+bool NativeStatement::bindBlob(int index, QByteArrayView value) {
+    if (m_query) {
+        return bindValue(index, value.isNull() ? QVariant() : QVariant(value.toByteArray()));
+    }
+    if (!m_statement) {
+        return false;
+    }
+    if (value.isNull()) {
+        return bindNull(index);
+    }
+    return sqlite3_bind_blob64(m_statement, index + 1, value.data(),
+                               static_cast<sqlite3_uint64>(value.size()),
+                               SQLITE_TRANSIENT) == SQLITE_OK;
+}
+
+bool NativeStatement::bindValue(int index, const QVariant& value) {
+    // Like sqlite3_bind_*, a new binding applies to the next execution
+    if (m_executed) {
+        m_query->finish();
+        m_executed = false;
+    }
+    m_query->bindValue(index, value);
+    return true;
+}
+
+bool NativeStatement::execute() const {
+    if (!m_executed) {
+        m_executed = true;
+        return m_query->exec();
+    }
+    return true;
+}
+
+void NativeStatement::loadRow() {
+    const int count = m_query->record().count();
+    m_row.resize(count);
+    m_rowBytes.fill(QByteArray(), count);
+    for (int column = 0; column < count; ++column) {
+        m_row[column] = m_query->value(column);
+    }
+}
+
+const QByteArray& NativeStatement::rowBytes(int column) const {
+    QByteArray& bytes = m_rowBytes[column];
+    const QVariant& value = m_row.at(column);
+    if (bytes.isNull() && !value.isNull()) {
+        bytes = value.typeId() == QMetaType::QByteArray ? value.toByteArray() : value.toString().toUtf8();
+    }
+    return bytes;
+}
+
+bool NativeStatement::step() {
+    if (!m_statement && !m_query) {
+        return false;
+    }
+
+    if (!m_tracing) {
+        // First step of a new execution
+        m_elapsedNs = 0;
+        m_rows = 0;
+        m_bytes = 0;
+        m_error = false;
+        m_tracing = QueryStats::getInstance().isEnabled();
+    }
+
+    if (m_query) {
+        QElapsedTimer timer;
+        timer.start();
+        const bool executed = execute();
+        const bool row = executed && m_query->next();
+        if (m_tracing) {
+            m_elapsedNs += timer.nsecsElapsed();
+        }
+        if (row) {
+            loadRow();
+            m_rows++;
+            return true;
+        }
+
+        // As sqlite3_step() after SQLITE_DONE, the next step() runs the statement again
+        m_executed = false;
+        if (!executed || m_query->lastError().isValid()) {
+            m_error = true;
+            qWarning() << "Native statement failed:" << lastError();
+        }
+        finishTrace();
+        return false;
+    }
+
+    int rc = SQLITE_ERROR;
+    if (m_tracing) {
+        QElapsedTimer timer;
+        timer.start();
+        rc = sqlite3_step(m_statement);
+        m_elapsedNs += timer.nsecsElapsed();
+    } else {
+        rc = sqlite3_step(m_statement);
+    }
+
+    if (rc == SQLITE_ROW) {
+        m_rows++;
+        return true;
+    }
+
+    if (rc != SQLITE_DONE) {
+        m_error = true;
+        qWarning() << "Native statement failed:" << lastError();
+    }
+    finishTrace();
+    return false;
+}
+
+bool NativeStatement::hasError() const {
+    return m_error;
+}
+
+QString NativeStatement::lastError() const {
+    if (!m_error) {
+        return QString();
+    }
+    if (m_query) {
+        return m_query->lastError().text();
+    }
+    if (!m_statement) {
+        return QString();
+    }
+    return QString::fromUtf8(sqlite3_errmsg(sqlite3_db_handle(m_statement)));
+}
+
+bool NativeStatement::reset() {
+    if (!m_statement && !m_query) {
+        return false;
+    }
+    finishTrace();
+    m_error = false;
+    if (m_query) {
+        m_query->finish();
+        m_executed = false;
+        return true;
+    }
+    return sqlite3_reset(m_statement) == SQLITE_OK;
+}
+
+void NativeStatement::clearBindings() {
+    if (m_query) {
+        const int count = static_cast<int>(m_query->boundValues().size());
+        for (int index = 0; index < count; ++index) {
+            bindValue(index, QVariant());
+        }
+    } else if (m_statement) {
+        sqlite3_clear_bindings(m_statement);
+    }
+}
+
+int NativeStatement::columnCount() const {
+    if (m_query) {
+        // QSqlQuery knows its columns once executed
+        execute();
+        return m_query->record().count();
+    }
+    return m_statement ? sqlite3_column_count(m_statement) : 0;
+}
+
+QString NativeStatement::columnName(int column) const {
+    if (m_query) {
+        execute();
+        return m_query->record().fieldName(column);
+    }
+    return m_statement ? QString::fromUtf8(sqlite3_column_name(m_statement, column)) : QString();
+}
+
+int NativeStatement::columnIndex(const QString& name) const {
+    const int count = columnCount();
+    for (int column = 0; column < count; ++column) {
+        if (columnName(column).compare(name, Qt::CaseInsensitive) == 0) {
+            return column;
+        }
+    }
+    return -1;
+}
+
+NativeStatement::ColumnType NativeStatement::columnType(int column) const {
+    if (m_query) {
+        return columnTypeOf(m_row.value(column));
+    }
+    switch (sqlite3_column_type(m_statement, column)) {
+    case SQLITE_INTEGER:
+        return ColumnType::Integer;
+    case SQLITE_FLOAT:
+        return ColumnType::Float;
+    case SQLITE_TEXT:
+        return ColumnType::Text;
+    case SQLITE_BLOB:
+        return ColumnType::Blob;
+    default:
+        return ColumnType::Null;
+    }
+}
+
+bool NativeStatement::isNull(int column) const {
+    if (m_query) {
+        return m_row.value(column).isNull();
+    }
+    return sqlite3_column_type(m_statement, column) == SQLITE_NULL;
+}
+
+qint64 NativeStatement::columnInt64(int column) const {
+    if (m_tracing) {
+        m_bytes += 8;
+    }
+    if (m_query) {
+        return m_row.value(column).toLongLong();
+    }
+    return sqlite3_column_int64(m_statement, column);
+}
+
+int NativeStatement::columnInt(int column) const {
+    if (m_tracing) {
+        m_bytes += 8;
+    }
+    if (m_query) {
+        return m_row.value(column).toInt();
+    }
+    return sqlite3_column_int(m_statement, column);
+}
+
+double NativeStatement::columnDouble(int column) const {
+    if (m_tracing) {
+        m_bytes += 8;
+    }
+    if (m_query) {
+        return m_row.value(column).toDouble();
+    }
+    return sqlite3_column_double(m_statement, column);
+}
+
+QUtf8StringView NativeStatement::columnText(int column) const {
+    if (m_query) {
+        const QByteArray& text = rowBytes(column);
+        if (m_tracing) {
+            m_bytes += text.size();
+        }
+        return QUtf8StringView(text.constData(), text.size());
+    }
+
+    // Pointer first, then size: fetching the size may not convert afterwards
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(m_statement, column));
+    const qsizetype size = sqlite3_column_bytes(m_statement, column);
+    if (m_tracing) {
+        m_bytes += size;
+    }
+    return QUtf8StringView(text, text ? size : 0);
+}
+
+QByteArrayView NativeStatement::columnBlob(int column) const {
+    if (m_query) {
+        const QByteArray& data = rowBytes(column);
+        if (m_tracing) {
+            m_bytes += data.size();
+        }
+        return QByteArrayView(data);
+    }
+
+    const char* data = static_cast<const char*>(sqlite3_column_blob(m_statement, column));
+    const qsizetype size = sqlite3_column_bytes(m_statement, column);
+    if (m_tracing) {
+        m_bytes += size;
+    }
+    return QByteArrayView(data, data ? size : 0);
+}
+
+QString NativeStatement::columnString(int column) const {
+    if (isNull(column)) {
+        return QString();
+    }
+    if (m_query) {
+        return m_row.at(column).toString();
+    }
+    return columnText(column).toString();
+}
+
+QByteArray NativeStatement::columnBytes(int column) const {
+    if (isNull(column)) {
+        return QByteArray();
+    }
+    return columnBlob(column).toByteArray();
+}
+
+void NativeStatement::finishTrace() {
+    if (!m_tracing) {
+        return;
+    }
+    m_tracing = false;
+
+    QueryStats& stats = QueryStats::getInstance();
+    const QString statementSql = sql();
+    if (stats.record(statementSql, m_connectionName, m_elapsedNs, m_rows, m_bytes)) {
+        stats.attachPlan(statementSql, explainQueryPlan());
+    }
+}
+
+QStringList NativeStatement::explainQueryPlan() const {
+    if (m_query) {
+        QSqlQuery explain(m_database);
+        if (!explain.exec("EXPLAIN QUERY PLAN " + m_sql)) {
+            return QStringList();
+        }
+        QStringList plan;
+        QHash<int, int> depths;
+        while (explain.next()) {
+            const int id = explain.value(0).toInt();
+            const int parent = explain.value(1).toInt();
+            const int depth = depths.contains(parent) ? depths.value(parent) + 1 : 0;
+            depths.insert(id, depth);
+            plan.append(QString(depth * 2, QChar(' ')) + explain.value(3).toString());
+        }
+        return plan;
+    }
+    if (!m_statement) {
+        return QStringList();
+    }
+
+    // Parameters are left unbound (NULL); plans rarely depend on their values
+    const QByteArray explainSql = "EXPLAIN QUERY PLAN " + QByteArray(sqlite3_sql(m_statement));
+    sqlite3_stmt* explain = nullptr;
+    if (sqlite3_prepare_v2(sqlite3_db_handle(m_statement), explainSql.constData(),
+                           static_cast<int>(explainSql.size()), &explain, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(explain);
+        return QStringList();
+    }
+
+    // Rows are (id, parent, notused, detail); indent children under parents
+    QStringList plan;
+    QHash<int, int> depths;
+    while (sqlite3_step(explain) == SQLITE_ROW) {
+        const int id = sqlite3_column_int(explain, 0);
+        const int parent = sqlite3_column_int(explain, 1);
+        const int depth = depths.contains(parent) ? depths.value(parent) + 1 : 0;
+        depths.insert(id, depth);
+        plan.append(QString(depth * 2, QChar(' '))
+                    + QString::fromUtf8(reinterpret_cast<const char*>(sqlite3_column_text(explain, 3))));
+    }
+    sqlite3_finalize(explain);
+    return plan;
+}
+
+// ---------------------------------------------------------------------------
+// NativeBlob
+// ---------------------------------------------------------------------------
+
+NativeBlob::NativeBlob(sqlite3_blob* blob)
+    : m_blob(blob)
+{
+}
+
+NativeBlob::NativeBlob(const QSqlDatabase& database, const QString& table, const QString& column)
+    : m_database(database)
+    , m_table(table)
+    , m_column(column)
+{
+}
+
+NativeBlob::~NativeBlob() {
+    close();
+}
+
+NativeBlob::NativeBlob(NativeBlob&& other) noexcept
+    : m_blob(std::exchange(other.m_blob, nullptr))
+    , m_database(std::move(other.m_database))
+    , m_table(std::move(other.m_table))
+    , m_column(std::move(other.m_column))
+    , m_data(std::move(other.m_data))
+    , m_buffered(std::exchange(other.m_buffered, false))
+{
+}
+
+NativeBlob& NativeBlob::operator=(NativeBlob&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_blob = std::exchange(other.m_blob, nullptr);
+        m_database = std::move(other.m_database);
+        m_table = std::move(other.m_table);
+        m_column = std::move(other.m_column);
+        m_data = std::move(other.m_data);
+        m_buffered = std::exchange(other.m_buffered, false);
+    }
+    return *this;
+}
+
+bool NativeBlob::isValid() const {
+    return m_blob != nullptr || m_buffered;
+}
+
+int NativeBlob::size() const {
+    if (m_buffered) {
+        return static_cast<int>(m_data.size());
+    }
+    return m_blob ? sqlite3_blob_bytes(m_blob) : 0;
+}
+
+bool NativeBlob::read(char* buffer, int length, int offset) const {
+    if (m_buffered) {
+        if (offset < 0 || length < 0 || offset + length > m_data.size()) {
+            return false;
+        }
+        std::memcpy(buffer, m_data.constData() + offset, static_cast<size_t>(length));
+        return true;
+    }
+    return m_blob && sqlite3_blob_read(m_blob, buffer, length, offset) == SQLITE_OK;
+}
+
+QByteArray NativeBlob::readAll() const {
+    if (m_buffered) {
+        return m_data;
+    }
+    if (!m_blob) {
+        return QByteArray();
+    }
+
+    // Read straight into the final buffer; no intermediate row copy
+    QByteArray data(size(), Qt::Uninitialized);
+    if (!read(data.data(), static_cast<int>(data.size()))) {
+        qWarning() << "Failed to read BLOB";
+        return QByteArray();
+    }
+    return data;
+}
+
+bool NativeBlob::write(QByteArrayView data, int offset) {
+    if (m_buffered) {
+        qWarning() << "BLOB writes need the sqlite3 library; not available on the QtSql fallback";
+        return false;
+    }
+    return m_blob && sqlite3_blob_write(m_blob, data.data(), static_cast<int>(data.size()), offset) == SQLITE_OK;
+}
+
+bool NativeBlob::reopen(qint64 rowid) {
+    if (m_buffered) {
+        return select(rowid);
+    }
+    // On failure SQLite leaves the handle aborted; only close() is valid
+    return m_blob && sqlite3_blob_reopen(m_blob, rowid) == SQLITE_OK;
+}
+
+void NativeBlob::close() {
+    if (m_blob) {
+        sqlite3_blob_close(m_blob);
+        m_blob = nullptr;
+    }
+    m_buffered = false;
+    m_data.clear();
+}
+
+bool NativeBlob::select(qint64 rowid) {
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT %1 FROM %2 WHERE rowid = ?").arg(m_column, m_table));
+    query.addBindValue(rowid);
+
+    // Same condition as sqlite3_blob_open: the row exists and holds a BLOB or text value
+    const QVariant value = (query.exec() && query.next()) ? query.value(0) : QVariant();
+    if (value.isNull() || columnTypeOf(value) == NativeStatement::ColumnType::Integer
+        || columnTypeOf(value) == NativeStatement::ColumnType::Float) {
+        m_buffered = false;
+        m_data.clear();
+        return false;
+    }
+    m_data = value.typeId() == QMetaType::QByteArray ? value.toByteArray() : value.toString().toUtf8();
+    m_buffered = true;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// NativeConnection
+// ---------------------------------------------------------------------------
+
+NativeConnection::~NativeConnection() {
+    close();
+}
+
+bool NativeConnection::open(const QString& path, CartridgeOpenMode mode, ConnectionRole role) {
+    close();
+    if (qtSqlFallbackRequired()) {
+        return openQtSql(path, mode, role);
+    }
+
+    // Same URI parameters as the QtSql connections in CartridgeConnectionPool
+    QByteArray target = path.toUtf8();
+    int flags = SQLITE_OPEN_NOMUTEX;
+    if (mode == CartridgeOpenMode::ReadWrite) {
+        flags |= SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    } else {
+        QString uri = QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded);
+        uri += (mode == CartridgeOpenMode::Immutable) ? "?mode=ro&immutable=1" : "?mode=ro";
+        target = uri.toUtf8();
+        flags |= SQLITE_OPEN_READONLY | SQLITE_OPEN_URI;
+    }
+
+    sqlite3* handle = nullptr;
+    const int rc = sqlite3_open_v2(target.constData(), &handle, flags, nullptr);
+    if (rc != SQLITE_OK) {
+        qWarning() << "Failed to open native connection to" << path << ":"
+                   << (handle ? sqlite3_errmsg(handle) : sqlite3_errstr(rc));
+        sqlite3_close_v2(handle);
+        return false;
+    }
+    sqlite3_extended_result_codes(handle, 1);
+
+    // As in CartridgeConnectionPool: a WAL file on read-only media is only
+    // readable as immutable
+    if (mode == CartridgeOpenMode::ReadOnly) {
+        const int probe = sqlite3_exec(handle, "SELECT COUNT(*) FROM sqlite_master", nullptr, nullptr, nullptr) & 0xff;
+        if (probe == SQLITE_CANTOPEN || probe == SQLITE_READONLY) {
+            sqlite3_close_v2(handle);
+            return open(path, CartridgeOpenMode::Immutable, role);
+        }
+    }
+
+    m_handle = handle;
+    m_path = path;
+    m_connectionName = "native:" + QFileInfo(path).fileName();
+
+    if (mode != CartridgeOpenMode::ReadWrite && !exec("PRAGMA query_only=ON")) {
+        qWarning() << "Failed to enable query-only mode on native connection:" << lastError();
+    }
+    for (const QString& pragma : ConnectionProfile::forRole(role).pragmas()) {
+        if (!exec(pragma)) {
+            qWarning() << "Failed to apply" << pragma << "on native connection:" << lastError();
+        }
+    }
+    return true;
+}
+
+bool NativeConnection::openQtSql(const QString& path, CartridgeOpenMode mode, ConnectionRole role) {
+    // A name of its own, so connections opened on worker threads never collide
+    const QString name = QString("NativeFallback_%1").arg(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+    bool opened = false;
+    if (mode == CartridgeOpenMode::ReadWrite) {
+        // Not a cartridge connection: no WAL switch or User_Data table, as on the sqlite3 path
+        database.setDatabaseName(path);
+        opened = database.open();
+    } else {
+        opened = CartridgeConnectionPool::openConnection(database, path, mode, role);
+    }
+    if (!opened) {
+        qWarning() << "Failed to open native connection to" << path << ":" << database.lastError().text();
+        database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        return false;
+    }
+
+    m_database = database;
+    m_path = path;
+    m_connectionName = "native:" + QFileInfo(path).fileName();
+
+    if (mode == CartridgeOpenMode::ReadWrite) {
+        for (const QString& pragma : ConnectionProfile::forRole(role).pragmas()) {
+            if (!exec(pragma)) {
+                qWarning() << "Failed to apply" << pragma << "on native connection:" << lastError();
+            }
+        }
+    }
+    return true;
+}
+
+bool NativeConnection::attach(const QSqlDatabase& database) {
+    close();
+    if (!database.isOpen() || !database.driver()) {
+        qWarning() << "Cannot attach native connection: QtSql connection not open";
+        return false;
+    }
+    if (qtSqlFallbackRequired()) {
+        m_database = database;
+        m_attached = true;
+        m_path = database.databaseName();
+        m_connectionName = "native:" + database.connectionName();
+        return true;
+    }
+
+    const QVariant handle = database.driver()->handle();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0) {
+        qWarning() << "Cannot attach native connection: not a QSQLITE connection";
+        return false;
+    }
+    sqlite3* attached = *static_cast<sqlite3* const*>(handle.constData());
+    if (!attached) {
+        return false;
+    }
+
+    m_handle = attached;
+    m_attached = true;
+    m_path = database.databaseName();
+    m_connectionName = "native:" + database.connectionName();
+    return true;
+}
+
+void NativeConnection::close() {
+    if (m_handle && !m_attached) {
+        // _v2 defers the close if a statement or blob is still alive
+        sqlite3_close_v2(m_handle);
+    }
+    if (m_database.isValid() && !m_attached) {
+        const QString name = m_database.connectionName();
+        m_database.close();
+        m_database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+    m_database = QSqlDatabase();
+    m_handle = nullptr;
+    m_attached = false;
+    m_path.clear();
+    m_lastError.clear();
+}
+
+bool NativeConnection::sharesQtSqlLibrary() {
+    static const bool shared = probeQtSqlLibrary();
+    return shared;
+}
+
+bool NativeConnection::qtSqlFallbackRequired() {
+    const QByteArray setting = qgetenv("SMARTBOOK_NATIVE_SQLITE");
+    return setting == "0" || !sharesQtSqlLibrary();
+}
+
+bool NativeConnection::isOpen() const {
+    return m_handle != nullptr || m_database.isOpen();
+}
+
+bool NativeConnection::usesQtSql() const {
+    return m_database.isValid();
+}
+
+QString NativeConnection::path() const {
+    return m_path;
+}
+
+QString NativeConnection::connectionName() const {
+    return m_connectionName;
+}
+
+QString NativeConnection::lastError() const {
+    if (m_database.isValid()) {
+        return m_lastError.isEmpty() ? m_database.lastError().text() : m_lastError;
+    }
+    return m_handle ? QString::fromUtf8(sqlite3_errmsg(m_handle)) : QString("Connection not open");
+}
+
+bool NativeConnection::exec(const QString& sql) {
+    if (m_database.isValid()) {
+        // QSqlQuery runs one statement at a time; sqlite3_complete() finds
+        // where each ends (a trigger body holds semicolons of its own)
+        const QStringList parts = sql.split(';');
+        QString statement;
+        for (int i = 0; i < parts.size(); ++i) {
+            statement += parts.at(i);
+            const bool last = i + 1 == parts.size();
+            if (!last) {
+                statement += ';';
+                if (!sqlite3_complete(statement.toUtf8().constData())) {
+                    continue;
+                }
+            }
+            if (!QString(statement).remove(';').trimmed().isEmpty()) {
+                QSqlQuery query(m_database);
+                if (!query.exec(statement)) {
+                    m_lastError = query.lastError().text();
+                    return false;
+                }
+            }
+            statement.clear();
+        }
+        m_lastError.clear();
+        return true;
+    }
+    if (!m_handle) {
+        return false;
+    }
+    return sqlite3_exec(m_handle, sql.toUtf8().constData(), nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+NativeStatement NativeConnection::prepare(const QString& sql) {
+    if (m_database.isValid()) {
+        auto query = std::make_unique<QSqlQuery>(m_database);
+        query->setForwardOnly(true);
+        if (!query->prepare(sql)) {
+            m_lastError = query->lastError().text();
+            qWarning() << "Failed to prepare native statement:" << m_lastError << "SQL:" << sql;
+            return NativeStatement();
+        }
+        return NativeStatement(std::move(query), m_database, sql, m_connectionName);
+    }
+    if (!m_handle) {
+        qWarning() << "Cannot prepare native statement: connection not open";
+        return NativeStatement();
+    }
+
+    const QByteArray utf8 = sql.toUtf8();
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(m_handle, utf8.constData(), static_cast<int>(utf8.size()),
+                           &statement, nullptr) != SQLITE_OK) {
+        qWarning() << "Failed to prepare native statement:" << lastError() << "SQL:" << sql;
+        sqlite3_finalize(statement);
+        return NativeStatement();
+    }
+    return NativeStatement(statement, m_connectionName);
+}
+
+NativeBlob NativeConnection::openBlob(const QString& table, const QString& column, qint64 rowid, bool writable) {
+    if (m_database.isValid()) {
+        if (writable) {
+            qWarning() << "BLOB writes need the sqlite3 library; not available on the QtSql fallback";
+            return NativeBlob();
+        }
+        NativeBlob blob(m_database, table, column);
+        if (!blob.select(rowid)) {
+            qWarning() << "Failed to open BLOB" << table << column << rowid;
+            return NativeBlob();
+        }
+        return blob;
+    }
+    if (!m_handle) {
+        return NativeBlob();
+    }
+
+    sqlite3_blob* blob = nullptr;
+    if (sqlite3_blob_open(m_handle, "main", table.toUtf8().constData(), column.toUtf8().constData(),
+                          rowid, writable ? 1 : 0, &blob) != SQLITE_OK) {
+        qWarning() << "Failed to open BLOB" << table << column << rowid << ":" << lastError();
+        sqlite3_blob_close(blob);
+        return NativeBlob();
+    }
+    return NativeBlob(blob);
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
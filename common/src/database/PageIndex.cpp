@@ -0,0 +1,113 @@
+#include "smartbook/common/database/PageIndex.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include <cmath>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+bool PageIndex::load(NativeConnection& connection) {
+    clear();
+
+    // chapter_title comes before html_content, so the page text is not read
+    NativeStatement pages = connection.prepare(R"(
+        SELECT page_id, page_order, chapter_title
+        FROM Content_Pages
+        ORDER BY page_order ASC
+    )");
+    if (!pages.isValid()) {
+        return false;
+    }
+
+    QHash<QString, int> chapters;
+    int lastChapter = -1;
+    while (pages.step()) {
+        Entry entry;
+        entry.pageId = pages.columnInt(0);
+        entry.pageOrder = pages.columnInt(1);
+        entry.chapter = -1;
+
+        // Consecutive pages mostly share a chapter; compare before hashing
+        const QUtf8StringView title = pages.columnText(2);
+        if (!title.isEmpty()) {
+            if (lastChapter >= 0 && QAnyStringView::equal(m_chapters.at(lastChapter), title)) {
+                entry.chapter = lastChapter;
+            } else {
+                const QString chapter = title.toString();
+                entry.chapter = chapters.value(chapter, -1);
+                if (entry.chapter < 0) {
+                    entry.chapter = static_cast<int>(m_chapters.size());
+                    chapters.insert(chapter, entry.chapter);
+                    m_chapters.append(chapter);
+                }
+            }
+            lastChapter = entry.chapter;
+        }
+
+        m_positions.insert(entry.pageId, static_cast<int>(m_entries.size()));
+        m_entries.append(entry);
+    }
+    if (pages.hasError()) {
+        clear();
+        return false;
+    }
+
+    m_entries.squeeze();
+    return true;
+}
+
+void PageIndex::clear() {
+    m_entries.clear();
+    m_positions.clear();
+    m_chapters.clear();
+}
+
+int PageIndex::pageAt(int position) const {
+    return position >= 0 && position < m_entries.size() ? m_entries.at(position).pageId : -1;
+}
+
+int PageIndex::neighbour(int pageId, int step) const {
+    const int position = positionOf(pageId);
+    return position < 0 ? -1 : pageAt(position + step);
+}
+
+int PageIndex::pageAtPercent(double percent) const {
+    if (m_entries.isEmpty()) {
+        return -1;
+    }
+    const double fraction = qBound(0.0, percent, 100.0) / 100.0;
+    return pageAt(static_cast<int>(std::lround(fraction * (m_entries.size() - 1))));
+}
+
+double PageIndex::percentOf(int pageId) const {
+    const int position = positionOf(pageId);
+    if (position < 0) {
+        return -1.0;
+    }
+    return m_entries.size() > 1 ? position * 100.0 / (m_entries.size() - 1) : 0.0;
+}
+
+QString PageIndex::chapterTitle(int pageId) const {
+    const int position = positionOf(pageId);
+    if (position < 0 || m_entries.at(position).chapter < 0) {
+        return QString();
+    }
+    return m_chapters.at(m_entries.at(position).chapter);
+}
+
+int PageIndex::firstPageOfChapter(const QString& chapterTitle) const {
+    const int chapter = m_chapters.indexOf(chapterTitle);
+    if (chapter < 0) {
+        return -1;
+    }
+    for (const Entry& entry : m_entries) {
+        if (entry.chapter == chapter) {
+            return entry.pageId;
+        }
+    }
+    return -1;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,242 @@
+#include "smartbook/common/database/PagePrefetcher.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <QRegularExpression>
+#include <QUrl>
+#include <QSet>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+namespace {
+// Base the renderer resolves relative references of a page against
+const QUrl PAGE_BASE(QStringLiteral("smartbook://cartridge/page/0"));
+const int WARM_CHUNK = 64 * 1024;
+
+QString resourceOf(const QString& reference) {
+    const QString trimmed = reference.trimmed();
+    if (trimmed.isEmpty() || trimmed.startsWith('#')) {
+        return QString();
+    }
+    const QUrl url = PAGE_BASE.resolved(QUrl(trimmed));
+    if (url.scheme() != QLatin1String("smartbook")) {
+        return QString();
+    }
+
+    // DDD 11 links name the kind as the host
+    const QString path = url.path(QUrl::FullyDecoded);
+    if (url.host() == QLatin1String("resource")) {
+        return path.mid(1);
+    }
+    return path.startsWith(QLatin1String("/resource/")) ? path.mid(10) : QString();
+}
+}
+
+PagePrefetcher::PagePrefetcher(QObject* parent)
+    : QObject(parent)
+{
+    m_pages.setMaxCost(m_options.budget);
+}
+
+PagePrefetcher::~PagePrefetcher() {
+    // The worker only reads; its result is dropped with this object
+    cancel();
+}
+
+void PagePrefetcher::setCartridge(const QString& cartridgePath) {
+    cancel();
+    m_pages.clear();
+    m_cartridgePath = cartridgePath;
+}
+
+void PagePrefetcher::setMemoryBudget(qint64 bytes) {
+    m_options.budget = qMax<qint64>(0, bytes);
+    m_pages.setMaxCost(m_options.budget);
+}
+
+void PagePrefetcher::setDepth(int ahead, int behind) {
+    m_options.ahead = qMax(0, ahead);
+    m_options.behind = qMax(0, behind);
+}
+
+void PagePrefetcher::cancel() {
+    if (m_cancelled) {
+        *m_cancelled = true;
+        m_cancelled.reset();
+    }
+}
+
+void PagePrefetcher::prefetchAround(int pageId) {
+    cancel();
+    if (m_cartridgePath.isEmpty() || m_options.budget == 0) {
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic_bool>(false);
+    m_cancelled = cancelled;
+
+    auto promise = std::make_shared<QPromise<QList<Page>>>();
+    QFuture<QList<Page>> fetched = promise->future();
+    promise->start();
+    QThreadPool::globalInstance()->start([promise, cancelled, path = m_cartridgePath, pageId,
+                                          options = m_options]() {
+        promise->addResult(fetch(path, pageId, options, *cancelled));
+        promise->finish();
+    });
+
+    fetched.then(this, [this, cancelled](const QList<Page>& pages) {
+        if (*cancelled) {
+            return;
+        }
+        if (m_cancelled == cancelled) {
+            m_cancelled.reset();
+        }
+        // Farthest first, so the budget evicts those before the next page
+        for (auto it = pages.crbegin(); it != pages.crend(); ++it) {
+            if (m_pages.insert(it->pageId, new Page(*it), it->cost())) {
+                emit pageReady(it->pageId);
+            }
+        }
+    });
+}
+
+PagePrefetcher::Page PagePrefetcher::page(int pageId) const {
+    const Page* cached = m_pages.object(pageId);
+    return cached ? *cached : Page();
+}
+
+QStringList PagePrefetcher::referencedResources(const QString& html, const QString& css) {
+    static const QRegularExpression attribute(
+        QStringLiteral(R"re(\b(?:src|href|poster|data)\s*=\s*(["'])(.*?)\1)re"),
+        QRegularExpression::CaseInsensitiveOption | QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression cssUrl(QStringLiteral(R"re(url\(\s*(["']?)(.*?)\1\s*\))re"),
+                                           QRegularExpression::CaseInsensitiveOption);
+
+    QStringList resources;
+    QSet<QString> seen;
+    auto collect = [&resources, &seen](const QRegularExpression& pattern, const QString& text) {
+        QRegularExpressionMatchIterator it = pattern.globalMatch(text);
+        while (it.hasNext()) {
+            const QString resource = resourceOf(it.next().captured(2));
+            if (!resource.isEmpty() && !seen.contains(resource)) {
+                seen.insert(resource);
+                resources.append(resource);
+            }
+        }
+    };
+    collect(attribute, html);
+    collect(cssUrl, html);      // Inline style attributes and <style> blocks
+    collect(cssUrl, css);
+    return resources;
+}
+
+QList<PagePrefetcher::Page> PagePrefetcher::fetch(const QString& cartridgePath, int pageId,
+                                                  const Options& options, const std::atomic_bool& cancelled) {
+    QList<Page> pages;
+    NativeConnection connection;
+    if (!connection.open(cartridgePath, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader)) {
+        return pages;
+    }
+
+    // Following pages nearest first, then preceding ones, each a seek on page_order
+    NativeStatement neighbours = connection.prepare(R"(
+        SELECT * FROM (
+            SELECT page_id, page_order, html_content, associated_css
+            FROM Content_Pages
+            WHERE page_order > (SELECT page_order FROM Content_Pages WHERE page_id = ?1)
+            ORDER BY page_order ASC
+            LIMIT ?2
+        )
+        UNION ALL
+        SELECT * FROM (
+            SELECT page_id, page_order, html_content, associated_css
+            FROM Content_Pages
+            WHERE page_order < (SELECT page_order FROM Content_Pages WHERE page_id = ?1)
+            ORDER BY page_order DESC
+            LIMIT ?3
+        )
+    )");
+    if (!neighbours.isValid()) {
+        return pages;
+    }
+    neighbours.bindInt64(0, pageId);
+    neighbours.bindInt64(1, options.ahead);
+    neighbours.bindInt64(2, options.behind);
+
+    qint64 cost = 0;
+    while (!cancelled && cost < options.budget && neighbours.step()) {
+        Page page;
+        page.pageId = neighbours.columnInt(0);
+        page.pageOrder = neighbours.columnInt(1);
+        const QUtf8StringView html = neighbours.columnText(2);
+        const QUtf8StringView css = neighbours.columnText(3);
+        page.htmlContent = QByteArray(html.data(), html.size());
+        page.associatedCss = QByteArray(css.data(), css.size());
+        page.resources = referencedResources(html.toString(), css.toString());
+        cost += page.cost();
+        pages.append(page);
+    }
+    neighbours = NativeStatement();
+
+    // Resources of the next page first; what is left of the budget bounds the reads
+    for (const Page& page : std::as_const(pages)) {
+        if (cancelled || cost >= options.budget) {
+            break;
+        }
+        cost += warmResources(connection, page.resources, options.budget - cost, cancelled);
+    }
+    return pages;
+}
+
+qint64 PagePrefetcher::warmResources(NativeConnection& connection, const QStringList& resources,
+                                     qint64 budget, const std::atomic_bool& cancelled) {
+    if (resources.isEmpty()) {
+        return 0;
+    }
+
+    // Looked up the way CartridgeResourceDevice serves them
+    NativeStatement lookup = connection.prepare(R"(
+        SELECT rowid FROM Resources WHERE resource_id = ?1
+        UNION ALL
+        SELECT rowid FROM Resources WHERE resource_path = ?1
+        LIMIT 1
+    )");
+    if (!lookup.isValid()) {
+        return 0;
+    }
+
+    QByteArray chunk(WARM_CHUNK, Qt::Uninitialized);
+    qint64 remaining = budget;
+    for (const QString& resource : resources) {
+        if (cancelled || remaining <= 0) {
+            break;
+        }
+        lookup.reset();
+        lookup.bindText(0, resource);
+        if (!lookup.step()) {
+            continue;
+        }
+
+        NativeBlob blob = connection.openBlob("Resources", "resource_data", lookup.columnInt64(0));
+        if (!blob.isValid()) {
+            continue;
+        }
+        for (int offset = 0; offset < blob.size() && remaining > 0 && !cancelled; offset += WARM_CHUNK) {
+            const int length = qMin(WARM_CHUNK, blob.size() - offset);
+            if (!blob.read(chunk.data(), length, offset)) {
+                qWarning() << "Failed to prefetch resource" << resource;
+                break;
+            }
+            remaining -= length;
+        }
+    }
+    return budget - remaining;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
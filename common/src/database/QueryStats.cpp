@@ -0,0 +1,269 @@
+#include "smartbook/common/database/QueryStats.h"
+#include <QRegularExpression>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSettings>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+namespace {
+
+double toMs(qint64 ns) {
+    return static_cast<double>(ns) / 1000000.0;
+}
+
+QJsonArray toJsonArray(const QStringList& list) {
+    QJsonArray array;
+    for (const QString& item : list) {
+        array.append(item);
+    }
+    return array;
+}
+
+} // namespace
+
+QueryStats& QueryStats::getInstance() {
+    static QueryStats instance;
+    return instance;
+}
+
+QString QueryStats::normalize(const QString& sql) {
+    static const QRegularExpression stringLiteral(R"('(?:[^']|'')*')");
+    static const QRegularExpression numberLiteral(R"(\b\d+(?:\.\d+)?\b)");
+    static const QRegularExpression placeholderList(R"(\(\s*\?(?:\s*,\s*\?)+\s*\))");
+    static const QRegularExpression whitespace(R"(\s+)");
+
+    QString result = sql;
+    result.replace(stringLiteral, "?");
+    result.replace(numberLiteral, "?");
+    result.replace(placeholderList, "(?)");  // IN lists of any length group together
+    result.replace(whitespace, " ");
+    return result.trimmed();
+}
+
+void QueryStats::loadSettings(QSettings& settings) {
+    setEnabled(settings.value("diagnostics/query_stats_enabled", isEnabled()).toBool());
+    setSlowQueryThresholdMs(settings.value("diagnostics/slow_query_ms", slowQueryThresholdMs()).toInt());
+}
+
+void QueryStats::setEnabled(bool enabled) {
+    m_enabled = enabled;
+}
+
+bool QueryStats::isEnabled() const {
+    return m_enabled;
+}
+
+void QueryStats::setSlowQueryThresholdMs(int thresholdMs) {
+    m_slowThresholdMs = qMax(0, thresholdMs);
+}
+
+int QueryStats::slowQueryThresholdMs() const {
+    return m_slowThresholdMs;
+}
+
+int QueryStats::bucketFor(qint64 elapsedNs) {
+    const double micros = static_cast<double>(elapsedNs) / 1000.0;
+    if (micros <= 1.0) {
+        return 0;
+    }
+    const int bucket = static_cast<int>(std::ceil(std::log2(micros) * 4.0));
+    return qBound(0, bucket, kBucketCount - 1);
+}
+
+qint64 QueryStats::bucketUpperBoundNs(int bucket) {
+    return static_cast<qint64>(std::pow(2.0, bucket / 4.0) * 1000.0);
+}
+
+qint64 QueryStats::percentile(const Entry& entry, double fraction) {
+    if (entry.calls == 0) {
+        return 0;
+    }
+
+    const qint64 target = qMax<qint64>(1, static_cast<qint64>(std::ceil(fraction * entry.calls)));
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += entry.histogram[bucket];
+        if (seen >= target) {
+            // Bucket bounds overshoot by up to 19%; never report past the max
+            return qMin(bucketUpperBoundNs(bucket), entry.maxNs);
+        }
+    }
+    return entry.maxNs;
+}
+
+QString QueryStats::normalizedLocked(const QString& sql) {
+    auto it = m_normalized.constFind(sql);
+    if (it != m_normalized.constEnd()) {
+        return it.value();
+    }
+
+    if (m_normalized.size() >= kNormalizedCacheCapacity) {
+        m_normalized.clear();
+    }
+    const QString normalized = normalize(sql);
+    m_normalized.insert(sql, normalized);
+    return normalized;
+}
+
+bool QueryStats::record(const QString& sql, const QString& connectionName,
+                        qint64 elapsedNs, qint64 rows, qint64 bytes) {
+    if (!m_enabled || sql.isEmpty()) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const QString key = normalizedLocked(sql);
+    Entry& entry = m_entries[key];
+    entry.calls++;
+    entry.totalNs += elapsedNs;
+    entry.maxNs = qMax(entry.maxNs, elapsedNs);
+    entry.rows += rows;
+    entry.bytes += bytes;
+    entry.histogram[bucketFor(elapsedNs)]++;
+
+    const qint64 thresholdNs = static_cast<qint64>(m_slowThresholdMs.load()) * 1000000;
+    if (elapsedNs < thresholdNs) {
+        return false;
+    }
+
+    SlowQuery slow;
+    slow.sql = key;
+    slow.connectionName = connectionName;
+    slow.elapsedNs = elapsedNs;
+    slow.rows = rows;
+    slow.timestamp = QDateTime::currentDateTimeUtc();
+    slow.plan = entry.plan;
+
+    if (m_slowQueries.size() >= kSlowLogCapacity) {
+        m_slowQueries.removeFirst();
+    }
+    m_slowQueries.append(slow);
+
+    qWarning() << "Slow query" << QString::number(toMs(elapsedNs), 'f', 1) << "ms:" << key;
+    return entry.plan.isEmpty();
+}
+
+void QueryStats::attachPlan(const QString& sql, const QStringList& plan) {
+    if (plan.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const QString key = normalizedLocked(sql);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    it->plan = plan;
+
+    for (auto slow = m_slowQueries.rbegin(); slow != m_slowQueries.rend(); ++slow) {
+        if (slow->sql == key) {
+            if (slow->plan.isEmpty()) {
+                slow->plan = plan;
+            }
+            break;
+        }
+    }
+}
+
+QList<QueryStats::StatementStats> QueryStats::statements() const {
+    QMutexLocker locker(&m_mutex);
+    QList<StatementStats> result;
+    result.reserve(m_entries.size());
+
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const Entry& entry = it.value();
+        StatementStats stats;
+        stats.sql = it.key();
+        stats.calls = entry.calls;
+        stats.totalNs = entry.totalNs;
+        stats.maxNs = entry.maxNs;
+        stats.rows = entry.rows;
+        stats.bytes = entry.bytes;
+        stats.p50Ns = percentile(entry, 0.50);
+        stats.p95Ns = percentile(entry, 0.95);
+        stats.p99Ns = percentile(entry, 0.99);
+        stats.plan = entry.plan;
+        result.append(stats);
+    }
+    locker.unlock();
+
+    std::sort(result.begin(), result.end(), [](const StatementStats& a, const StatementStats& b) {
+        return a.totalNs > b.totalNs;
+    });
+    return result;
+}
+
+QList<QueryStats::SlowQuery> QueryStats::slowQueries() const {
+    QMutexLocker locker(&m_mutex);
+    return m_slowQueries;
+}
+
+QJsonObject QueryStats::toJson() const {
+    QJsonArray statementArray;
+    for (const StatementStats& stats : statements()) {
+        QJsonObject object;
+        object["sql"] = stats.sql;
+        object["calls"] = stats.calls;
+        object["total_ms"] = toMs(stats.totalNs);
+        object["mean_ms"] = stats.calls > 0 ? toMs(stats.totalNs / stats.calls) : 0.0;
+        object["max_ms"] = toMs(stats.maxNs);
+        object["p50_ms"] = toMs(stats.p50Ns);
+        object["p95_ms"] = toMs(stats.p95Ns);
+        object["p99_ms"] = toMs(stats.p99Ns);
+        object["rows"] = stats.rows;
+        object["bytes"] = stats.bytes;
+        if (!stats.plan.isEmpty()) {
+            object["plan"] = toJsonArray(stats.plan);
+        }
+        statementArray.append(object);
+    }
+
+    QJsonArray slowArray;
+    for (const SlowQuery& slow : slowQueries()) {
+        QJsonObject object;
+        object["sql"] = slow.sql;
+        object["connection"] = slow.connectionName;
+        object["elapsed_ms"] = toMs(slow.elapsedNs);
+        object["rows"] = slow.rows;
+        object["timestamp"] = slow.timestamp.toString(Qt::ISODateWithMs);
+        object["plan"] = toJsonArray(slow.plan);
+        slowArray.append(object);
+    }
+
+    QJsonObject root;
+    root["enabled"] = isEnabled();
+    root["slow_query_threshold_ms"] = slowQueryThresholdMs();
+    root["statements"] = statementArray;
+    root["slow_queries"] = slowArray;
+    return root;
+}
+
+bool QueryStats::dumpJson(const QString& filePath) const {
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write query statistics to" << filePath << ":" << file.errorString();
+        return false;
+    }
+
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+void QueryStats::reset() {
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_normalized.clear();
+    m_slowQueries.clear();
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,247 @@
+#include "smartbook/common/database/SchemaMigrator.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+void SchemaMigrator::addMigration(int version, const QString& description, Step step, Mode mode) {
+    Migration migration;
+    migration.version = version;
+    migration.description = description;
+    migration.step = std::move(step);
+    migration.mode = mode;
+
+    auto it = std::lower_bound(m_migrations.begin(), m_migrations.end(), version,
+                               [](const Migration& existing, int v) { return existing.version < v; });
+    if (it != m_migrations.end() && it->version == version) {
+        qWarning() << "Replacing duplicate schema migration for version" << version;
+        *it = migration;
+        return;
+    }
+    m_migrations.insert(it, migration);
+}
+
+void SchemaMigrator::addMigration(int version, const QString& description, const QStringList& statements, Mode mode) {
+    addMigration(version, description, [statements](QSqlDatabase& database, const Reporter& report) {
+        QSqlQuery query(database);
+        for (int i = 0; i < statements.size(); ++i) {
+            if (!query.exec(statements.at(i))) {
+                qCritical() << "Migration statement failed:" << query.lastError().text()
+                            << "SQL:" << statements.at(i);
+                return false;
+            }
+            report(i + 1, statements.size());
+        }
+        return true;
+    }, mode);
+}
+
+int SchemaMigrator::latestVersion() const {
+    return m_migrations.isEmpty() ? 0 : m_migrations.last().version;
+}
+
+int SchemaMigrator::currentVersion(QSqlDatabase& database) {
+    QSqlQuery query(database);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        qWarning() << "Failed to read schema version:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+bool SchemaMigrator::isCurrent(QSqlDatabase& database) const {
+    return currentVersion(database) >= latestVersion();
+}
+
+bool SchemaMigrator::migrate(QSqlDatabase& database, Scope scope, const ProgressCallback& progress) const {
+    const int current = currentVersion(database);
+    if (current < 0) {
+        return false;
+    }
+
+    // Fast path: nothing to do, no DDL executed
+    if (current >= latestVersion()) {
+        if (current > latestVersion()) {
+            qWarning() << "Database schema version" << current
+                       << "is newer than this build supports (" << latestVersion() << ")";
+        }
+        return true;
+    }
+
+    QList<Migration> pending;
+    for (const Migration& migration : m_migrations) {
+        if (migration.version > current) {
+            pending.append(migration);
+        }
+    }
+
+    // Background migrations are only deferred when nothing blocking follows them
+    int end = pending.size();
+    if (scope == Scope::Blocking) {
+        while (end > 0 && pending.at(end - 1).mode == Mode::Background) {
+            end--;
+        }
+    } else if (scope == Scope::Next) {
+        end = 1;
+    }
+    if (end == 0) {
+        return true;
+    }
+
+    // Table rebuilds need foreign keys off; the pragma is a no-op inside a transaction
+    QSqlQuery pragma(database);
+    bool foreignKeys = false;
+    if (pragma.exec("PRAGMA foreign_keys") && pragma.next()) {
+        foreignKeys = pragma.value(0).toBool();
+    }
+    pragma.finish();
+    if (foreignKeys) {
+        pragma.exec("PRAGMA foreign_keys=OFF");
+    }
+
+    bool ok = true;
+    for (int i = 0; i < end && ok; ++i) {
+        ok = apply(database, pending.at(i), progress);
+    }
+
+    if (foreignKeys) {
+        pragma.exec("PRAGMA foreign_keys=ON");
+    }
+    return ok;
+}
+
+bool SchemaMigrator::apply(QSqlDatabase& database, const Migration& migration,
+                           const ProgressCallback& progress) const {
+    QElapsedTimer timer;
+    timer.start();
+
+    const Reporter report = [&](qint64 done, qint64 total) {
+        if (progress) {
+            Progress state;
+            state.version = migration.version;
+            state.description = migration.description;
+            state.done = done;
+            state.total = total;
+            progress(state);
+        }
+    };
+    report(0, 0);
+
+    if (!database.transaction()) {
+        qCritical() << "Cannot begin schema migration to version" << migration.version << ":"
+                    << database.lastError().text();
+        return false;
+    }
+
+    bool ok = migration.step(database, report);
+
+    QSqlQuery query(database);
+    if (ok && query.exec("PRAGMA foreign_key_check") && query.next()) {
+        qCritical() << "Schema migration to version" << migration.version
+                    << "left a foreign key violation in" << query.value(0).toString();
+        ok = false;
+    }
+    query.finish();
+
+    // user_version is part of the transaction, so it only moves if the migration commits
+    if (ok && !query.exec(QString("PRAGMA user_version=%1").arg(migration.version))) {
+        qCritical() << "Failed to set schema version:" << query.lastError().text();
+        ok = false;
+    }
+
+    if (!ok || !database.commit()) {
+        database.rollback();
+        qCritical() << "Schema migration to version" << migration.version
+                    << "(" << migration.description << ") failed; schema left unchanged";
+        return false;
+    }
+
+    qDebug() << "Migrated schema to version" << migration.version << "(" << migration.description << ") in"
+             << timer.elapsed() << "ms";
+    return true;
+}
+
+bool SchemaMigrator::rebuildTable(QSqlDatabase& database, const QString& table, const QString& createSql,
+                                  const QStringList& columns, const Reporter& report, int batchSize) {
+    const QString temporary = table + "_migrating";
+    const QString columnList = columns.join(", ");
+    QSqlQuery query(database);
+
+    qint64 total = 0;
+    if (query.exec(QString("SELECT COUNT(*) FROM %1").arg(table)) && query.next()) {
+        total = query.value(0).toLongLong();
+    }
+    query.finish();
+
+    if (!query.exec(createSql.arg(temporary))) {
+        qCritical() << "Failed to create rebuilt table for" << table << ":" << query.lastError().text();
+        return false;
+    }
+
+    // Copy in rowid ranges so progress can be reported between batches
+    QSqlQuery boundary(database);
+    boundary.prepare(QString("SELECT rowid FROM %1 WHERE rowid > ? ORDER BY rowid LIMIT 1 OFFSET ?").arg(table));
+    QSqlQuery copyRange(database);
+    copyRange.prepare(QString("INSERT INTO %1 (%2) SELECT %2 FROM %3 WHERE rowid > ? AND rowid <= ? ORDER BY rowid")
+                          .arg(temporary, columnList, table));
+    QSqlQuery copyRest(database);
+    copyRest.prepare(QString("INSERT INTO %1 (%2) SELECT %2 FROM %3 WHERE rowid > ? ORDER BY rowid")
+                         .arg(temporary, columnList, table));
+
+    qint64 lastRowid = std::numeric_limits<qint64>::min();
+    qint64 copied = 0;
+    report(copied, total);
+    for (;;) {
+        boundary.bindValue(0, lastRowid);
+        boundary.bindValue(1, qMax(0, batchSize - 1));
+        if (!boundary.exec()) {
+            qCritical() << "Failed to scan" << table << ":" << boundary.lastError().text();
+            return false;
+        }
+
+        if (!boundary.next()) {
+            copyRest.bindValue(0, lastRowid);
+            if (!copyRest.exec()) {
+                qCritical() << "Failed to copy rows of" << table << ":" << copyRest.lastError().text();
+                return false;
+            }
+            copied += copyRest.numRowsAffected();
+            break;
+        }
+
+        const qint64 upper = boundary.value(0).toLongLong();
+        boundary.finish();
+        copyRange.bindValue(0, lastRowid);
+        copyRange.bindValue(1, upper);
+        if (!copyRange.exec()) {
+            qCritical() << "Failed to copy rows of" << table << ":" << copyRange.lastError().text();
+            return false;
+        }
+        copied += copyRange.numRowsAffected();
+        lastRowid = upper;
+        report(copied, total);
+    }
+    report(copied, total);
+
+    // Active statements on the old table would block the DROP
+    boundary.finish();
+    copyRange.finish();
+    copyRest.finish();
+
+    if (!query.exec(QString("DROP TABLE %1").arg(table))
+        || !query.exec(QString("ALTER TABLE %1 RENAME TO %2").arg(temporary, table))) {
+        qCritical() << "Failed to replace" << table << ":" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,101 @@
+#include "smartbook/common/database/StatementCache.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QDebug>
+#include <utility>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+PreparedQuery::PreparedQuery(std::shared_ptr<InstrumentedQuery> query)
+    : m_query(std::move(query))
+{
+}
+
+PreparedQuery::~PreparedQuery() {
+    if (m_query) {
+        m_query->finish();
+    }
+}
+
+PreparedQuery& PreparedQuery::operator=(PreparedQuery&& other) noexcept {
+    if (this != &other) {
+        if (m_query) {
+            m_query->finish();
+        }
+        m_query = std::move(other.m_query);
+    }
+    return *this;
+}
+
+StatementCache::StatementCache(const QString& connectionName, int capacity)
+    : m_connectionName(connectionName)
+    , m_capacity(capacity)
+{
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+std::shared_ptr<InstrumentedQuery> StatementCache::statement(const QString& queryString) {
+    auto it = m_statements.find(queryString);
+    bool borrowed = false;
+
+    if (it != m_statements.end()) {
+        // Only hand out the cached statement if no outer handle still holds it
+        if (it.value().use_count() == 1) {
+            m_stats.hits++;
+            touch(queryString);
+            it.value()->finish();
+            return it.value();
+        }
+        borrowed = true;
+    }
+
+    auto query = std::make_shared<InstrumentedQuery>(QSqlDatabase::database(m_connectionName, false));
+    query->setForwardOnly(true);
+
+    if (!query->prepare(queryString)) {
+        qWarning() << "Failed to prepare statement:" << queryString;
+        qWarning() << "Error:" << query->lastError().text();
+        return nullptr;
+    }
+    m_stats.prepares++;
+
+    // Nested use of a borrowed statement gets a one-off copy
+    if (borrowed) {
+        touch(queryString);
+        return query;
+    }
+
+    if (m_statements.size() >= m_capacity && !m_order.isEmpty()) {
+        m_statements.remove(m_order.takeFirst());
+    }
+
+    m_statements.insert(queryString, query);
+    m_order.append(queryString);
+    return query;
+}
+
+void StatementCache::touch(const QString& queryString) {
+    // Capacity is small, so a linear move beats a linked hash here
+    m_order.removeOne(queryString);
+    m_order.append(queryString);
+}
+
+void StatementCache::clear() {
+    m_statements.clear();
+    m_order.clear();
+}
+
+StatementCache::Stats StatementCache::stats() const {
+    Stats result = m_stats;
+    result.cachedStatements = m_statements.size();
+    return result;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,285 @@
+#include "smartbook/common/database/WriteCoalescer.h"
+#include <QCoreApplication>
+#include <QSqlQuery>
+#include <QTimer>
+#include <QDebug>
+#include <utility>
+
+namespace smartbook {
+namespace common {
+namespace database {
+
+WriteCoalescer::WriteCoalescer(Runner runner, QObject* parent)
+    : QObject(parent)
+    , m_runner(std::move(runner))
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(500);
+    connect(m_timer, &QTimer::timeout, this, &WriteCoalescer::onTimeout);
+
+    // Buffered writes must not be lost when the last window closes
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+        connect(app, &QCoreApplication::aboutToQuit, this, [this]() {
+            flush(Durability::Full);
+        });
+    }
+}
+
+WriteCoalescer::~WriteCoalescer() {
+    if (!m_pending.isEmpty() || m_inFlight) {
+        flush(Durability::Full);
+    }
+}
+
+void WriteCoalescer::setSubmitter(Submitter submitter) {
+    m_submitter = std::move(submitter);
+}
+
+void WriteCoalescer::setFlushInterval(int milliseconds) {
+    m_timer->setInterval(qMax(0, milliseconds));
+}
+
+int WriteCoalescer::flushInterval() const {
+    return m_timer->interval();
+}
+
+void WriteCoalescer::setMaxPending(int count) {
+    m_maxPending = qMax(1, count);
+}
+
+int WriteCoalescer::maxPending() const {
+    return m_maxPending;
+}
+
+void WriteCoalescer::enqueue(const QString& key, const QVariant& value, Write write) {
+    m_stats.enqueued++;
+
+    auto it = m_pending.find(key);
+    if (it != m_pending.end()) {
+        // Only the latest value of a key is ever written
+        m_stats.coalesced++;
+        it->value = value;
+        it->write = std::move(write);
+    } else {
+        m_pending.insert(key, Pending{value, std::move(write)});
+        m_order.append(key);
+    }
+
+    if (m_pending.size() >= m_maxPending) {
+        flush();
+        return;
+    }
+
+    // Interval counts from the oldest buffered write, so steady typing
+    // cannot postpone the flush indefinitely
+    if (!m_timer->isActive()) {
+        m_timer->start();
+    }
+}
+
+bool WriteCoalescer::hasPending(const QString& key) const {
+    return m_pending.contains(key) || (m_inFlight && m_inFlight->visible.contains(key));
+}
+
+QVariant WriteCoalescer::pendingValue(const QString& key) const {
+    auto it = m_pending.constFind(key);
+    if (it != m_pending.constEnd()) {
+        return it->value;
+    }
+    return m_inFlight ? m_inFlight->visible.value(key) : QVariant();
+}
+
+QHash<QString, QVariant> WriteCoalescer::pendingWithPrefix(const QString& prefix) const {
+    QHash<QString, QVariant> result;
+    if (m_inFlight) {
+        for (auto it = m_inFlight->visible.constBegin(); it != m_inFlight->visible.constEnd(); ++it) {
+            if (it.key().startsWith(prefix)) {
+                result.insert(it.key().mid(prefix.size()), it.value());
+            }
+        }
+    }
+    for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+        if (it.key().startsWith(prefix)) {
+            result.insert(it.key().mid(prefix.size()), it->value);
+        }
+    }
+    return result;
+}
+
+int WriteCoalescer::discard(const QString& prefix) {
+    int dropped = 0;
+    if (m_inFlight) {
+        m_inFlight->visible.removeIf([&prefix](const auto& entry) {
+            return entry.key().startsWith(prefix);
+        });
+    }
+    for (auto it = m_order.begin(); it != m_order.end();) {
+        if (it->startsWith(prefix)) {
+            m_pending.remove(*it);
+            it = m_order.erase(it);
+            dropped++;
+        } else {
+            ++it;
+        }
+    }
+
+    if (m_pending.isEmpty()) {
+        m_timer->stop();
+    }
+    return dropped;
+}
+
+int WriteCoalescer::pendingCount() const {
+    return m_pending.size();
+}
+
+void WriteCoalescer::onTimeout() {
+    if (!flush()) {
+        // Keep the writes and try again on the next interval
+        m_timer->start();
+    }
+}
+
+bool WriteCoalescer::flush(Durability durability) {
+    if (m_flushing) {
+        return false;
+    }
+    m_timer->stop();
+
+    const bool async = m_submitter && durability == Durability::Normal;
+    if (m_inFlight) {
+        if (async) {
+            // Goes out when the batch in flight completes
+            return true;
+        }
+        waitForInFlight();
+    }
+    if (m_pending.isEmpty()) {
+        return true;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->batch.swap(m_pending);
+    batch->order.swap(m_order);
+
+    if (async) {
+        for (auto it = batch->batch.constBegin(); it != batch->batch.constEnd(); ++it) {
+            batch->visible.insert(it.key(), it->value);
+        }
+        m_inFlight = batch;
+        batch->future = m_submitter(batchWrite(batch, durability));
+        batch->future
+            .then(this, [this, batch](bool committed) {
+                complete(batch, committed);
+            })
+            .onCanceled(this, [this, batch]() {
+                complete(batch, false);
+            });
+        return true;
+    }
+
+    m_flushing = true;
+    const bool committed = m_runner(batchWrite(batch, durability));
+    m_flushing = false;
+    return complete(batch, committed);
+}
+
+WriteCoalescer::Write WriteCoalescer::batchWrite(const std::shared_ptr<Batch>& batch, Durability durability) const {
+    // Runs on the runner's connection, possibly on another thread; only
+    // touches the batch, which the coalescer leaves alone until complete()
+    return [batch, durability](QSqlDatabase& database) {
+        batch->written = 0;
+        batch->failed = 0;
+
+        QSqlQuery pragma(database);
+        QString previousSynchronous;
+        if (durability == Durability::Full) {
+            if (pragma.exec("PRAGMA synchronous") && pragma.next()) {
+                previousSynchronous = pragma.value(0).toString();
+            }
+            pragma.finish();
+            pragma.exec("PRAGMA synchronous=FULL");
+        }
+
+        // Joins the caller's transaction if one is already open
+        const bool ownTransaction = database.transaction();
+
+        for (const QString& key : std::as_const(batch->order)) {
+            if (batch->batch.value(key).write(database)) {
+                batch->written++;
+            } else {
+                // A failed statement only rolls back itself; keep the rest
+                qWarning() << "Dropping buffered write that failed:" << key;
+                batch->failed++;
+            }
+        }
+
+        bool committed = true;
+        if (ownTransaction && !database.commit()) {
+            database.rollback();
+            committed = false;
+        }
+
+        if (!previousSynchronous.isEmpty()) {
+            pragma.exec(QString("PRAGMA synchronous=%1").arg(previousSynchronous.toInt()));
+        }
+        return committed;
+    };
+}
+
+void WriteCoalescer::waitForInFlight() {
+    const std::shared_ptr<Batch> batch = m_inFlight;
+    batch->future.waitForFinished();
+    const bool committed = !batch->future.isCanceled() && batch->future.resultCount() > 0
+                           && batch->future.result();
+    complete(batch, committed);
+}
+
+bool WriteCoalescer::complete(const std::shared_ptr<Batch>& batch, bool committed) {
+    // A Full flush may have completed the batch before its continuation ran
+    if (batch->completed) {
+        return committed;
+    }
+    batch->completed = true;
+    const bool wasInFlight = batch == m_inFlight;
+    if (wasInFlight) {
+        m_inFlight.reset();
+    }
+
+    if (!committed) {
+        qWarning() << "Failed to flush" << batch->order.size() << "buffered writes; will retry";
+
+        // Newer values enqueued since the swap win over the failed batch;
+        // writes discarded while it was in flight stay dropped
+        for (int i = batch->order.size() - 1; i >= 0; --i) {
+            const QString& key = batch->order.at(i);
+            if (!m_pending.contains(key) && (!wasInFlight || batch->visible.contains(key))) {
+                m_pending.insert(key, batch->batch.value(key));
+                m_order.prepend(key);
+            }
+        }
+        if (wasInFlight && !m_timer->isActive()) {
+            m_timer->start();
+        }
+        return false;
+    }
+
+    m_stats.written += batch->written;
+    m_stats.failed += batch->failed;
+    m_stats.flushes++;
+
+    // Writes enqueued meanwhile (or by the runner from a nested event loop) wait for the next interval
+    if (!m_pending.isEmpty() && !m_timer->isActive()) {
+        m_timer->start();
+    }
+    return true;
+}
+
+WriteCoalescer::Stats WriteCoalescer::stats() const {
+    return m_stats;
+}
+
+} // namespace database
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,320 @@
+#include "smartbook/common/manifest/CartridgeImporter.h"
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include "smartbook/common/metadata/MetadataExtractor.h"
+#include "smartbook/common/security/SignatureVerifier.h"
+#include <QRunnable>
+#include <QThread>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+class CartridgeImportJob : public QRunnable {
+public:
+    CartridgeImportJob(CartridgeImporter* importer, const QString& path)
+        : m_importer(importer)
+        , m_path(path)
+    {
+    }
+
+    void run() override {
+        CartridgeImporter::Processed processed =
+            CartridgeImporter::process(m_path, m_importer->m_readSlots, m_importer->m_cancelled);
+
+        // Collected on the importer's thread; dropped if the importer is gone
+        CartridgeImporter* importer = m_importer;
+        QMetaObject::invokeMethod(importer, [importer, processed]() {
+            importer->jobFinished(processed);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    CartridgeImporter* m_importer;
+    QString m_path;
+};
+
+CartridgeImporter::CartridgeImporter(QObject* parent)
+    : QObject(parent)
+    , m_manifestManager(new ManifestManager(this))
+{
+    setOptions(Options());
+}
+
+CartridgeImporter::~CartridgeImporter() {
+    // Running jobs only read; their results are discarded with this object
+    m_cancelled = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void CartridgeImporter::setOptions(const Options& options) {
+    if (m_running) {
+        qWarning() << "Import options cannot change while an import is running";
+        return;
+    }
+
+    m_options = options;
+    const int workers = options.workerCount > 0 ? options.workerCount : QThread::idealThreadCount();
+    m_pool.setMaxThreadCount(qMax(1, workers));
+
+    // No job holds a read slot between imports
+    const int reads = qBound(1, options.maxConcurrentReads > 0 ? options.maxConcurrentReads : workers, workers);
+    const int available = m_readSlots.available();
+    if (reads > available) {
+        m_readSlots.release(reads - available);
+    } else if (reads < available) {
+        m_readSlots.acquire(available - reads);
+    }
+}
+
+QStringList CartridgeImporter::collectCartridges(const QStringList& paths) {
+    QStringList cartridges;
+    QSet<QString> seen;
+
+    auto add = [&cartridges, &seen](const QString& path) {
+        const QString absolute = QFileInfo(path).absoluteFilePath();
+        if (!seen.contains(absolute)) {
+            seen.insert(absolute);
+            cartridges.append(absolute);
+        }
+    };
+
+    for (const QString& path : paths) {
+        const QFileInfo info(path);
+        if (!info.isDir()) {
+            add(path);
+            continue;
+        }
+
+        // Sorted per directory so repeated imports process files in the same order
+        QStringList found;
+        QDirIterator it(info.absoluteFilePath(), QStringList() << "*.sqlite",
+                        QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            found.append(it.next());
+        }
+        std::sort(found.begin(), found.end());
+        for (const QString& file : found) {
+            add(file);
+        }
+    }
+
+    return cartridges;
+}
+
+bool CartridgeImporter::start(const QStringList& paths) {
+    if (m_running) {
+        qWarning() << "Cartridge import already running";
+        return false;
+    }
+
+    m_running = true;
+    m_cancelled = false;
+    m_processed = 0;
+    m_batchesInFlight = 0;
+    m_batch.clear();
+    m_batchPaths.clear();
+    m_summary = Summary();
+    m_timer.start();
+
+    const QStringList cartridges = collectCartridges(paths);
+    m_summary.total = cartridges.size();
+    emit progress(0, m_summary.total);
+
+    for (const QString& path : cartridges) {
+        m_pool.start(new CartridgeImportJob(this, path));
+    }
+
+    // Nothing found: finish from the event loop, as for a real import
+    if (cartridges.isEmpty()) {
+        QMetaObject::invokeMethod(this, &CartridgeImporter::finishIfDone, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void CartridgeImporter::cancel() {
+    if (!m_running) {
+        return;
+    }
+    // Queued jobs still run, but return at once without reading
+    m_cancelled = true;
+    m_summary.cancelled = true;
+}
+
+CartridgeImporter::Processed CartridgeImporter::process(const QString& path, QSemaphore& readSlots,
+                                                        const std::atomic_bool& cancelled) {
+    Processed processed;
+    processed.path = path;
+
+    if (cancelled) {
+        processed.skipped = true;
+        return processed;
+    }
+
+    // Reading: metadata, then the full-content hash and signature check
+    readSlots.acquire();
+    if (cancelled) {
+        readSlots.release();
+        processed.skipped = true;
+        return processed;
+    }
+
+    // Taken before reading, so a write during the read shows up as a
+    // changed fingerprint on the next library scan
+    const utils::FileFingerprint fingerprint = utils::FileFingerprint::of(path);
+    const metadata::CartridgeMetadata metadata = metadata::MetadataExtractor::extractMetadata(path);
+    security::VerificationResult verification;
+    if (!metadata.cartridgeGuid.isEmpty()) {
+        security::SignatureVerifier verifier;
+        verification = verifier.verifyCartridge(path, metadata.cartridgeGuid);
+    }
+    readSlots.release();
+
+    if (metadata.cartridgeGuid.isEmpty()) {
+        processed.errorMessage = "Not a cartridge or no cartridge GUID";
+        return processed;
+    }
+    if (metadata.title.isEmpty() || metadata.publicationYear.isEmpty()) {
+        processed.errorMessage = "Missing required metadata (title or publication year)";
+        return processed;
+    }
+    if (!verification.errorMessage.isEmpty()) {
+        processed.errorMessage = verification.errorMessage;
+        return processed;
+    }
+    if (verification.isTampered) {
+        processed.errorMessage = "Cartridge content does not match its signature";
+        return processed;
+    }
+    if (verification.effectivePolicy == security::TrustPolicy::REJECTED) {
+        processed.errorMessage = "Cartridge trust has been revoked";
+        return processed;
+    }
+
+    ManifestManager::ManifestEntry& entry = processed.item.entry;
+    entry.cartridgeGuid = metadata.cartridgeGuid;
+    entry.cartridgeHash = verification.h2Hash;
+    entry.localPath = path;
+    entry.title = metadata.title;
+    entry.author = metadata.author;
+    entry.publisher = metadata.publisher;
+    entry.version = metadata.version;
+    entry.publicationYear = metadata.publicationYear;
+    entry.coverImageData = metadata.coverImageData;
+    entry.seriesName = metadata.seriesName;
+    entry.editionName = metadata.editionName;
+    entry.seriesOrder = metadata.seriesOrder;
+    entry.fingerprint = fingerprint;
+    entry.locationStatus = ManifestManager::LOCATION_LOCAL;
+
+    // CPU only, so outside the read slot
+    processed.item.thumbnails = CoverThumbnailStore::renderAll(metadata.coverImageData);
+    return processed;
+}
+
+void CartridgeImporter::jobFinished(const Processed& processed) {
+    if (!m_running) {
+        return;
+    }
+    ++m_processed;
+
+    if (!processed.skipped) {
+        if (processed.errorMessage.isEmpty()) {
+            m_batch.append(processed.item);
+            m_batchPaths.append(processed.path);
+        } else {
+            FileResult result;
+            result.path = processed.path;
+            result.errorMessage = processed.errorMessage;
+            recordResult(result);
+        }
+        emit progress(m_processed, m_summary.total);
+    }
+
+    if (m_batch.size() >= m_options.batchSize || m_processed == m_summary.total) {
+        flushBatch();
+    }
+    finishIfDone();
+}
+
+void CartridgeImporter::flushBatch() {
+    if (m_batch.isEmpty()) {
+        return;
+    }
+
+    const QList<ManifestManager::ImportItem> items = m_batch;
+    const QStringList paths = m_batchPaths;
+    m_batch.clear();
+    m_batchPaths.clear();
+    ++m_batchesInFlight;
+
+    QFuture<QList<ManifestManager::ImportOutcome>> written = m_manifestManager->importManifestEntriesAsync(items);
+    written.then(this, [this, items, paths](const QList<ManifestManager::ImportOutcome>& outcomes) {
+        for (int i = 0; i < items.size(); ++i) {
+            FileResult result;
+            result.path = paths.at(i);
+            result.cartridgeGuid = items.at(i).entry.cartridgeGuid;
+            result.outcome = i < outcomes.size() ? outcomes.at(i) : ManifestManager::ImportOutcome::Failed;
+            if (result.outcome == ManifestManager::ImportOutcome::Failed) {
+                result.errorMessage = "Failed to write library entry";
+            }
+            recordResult(result);
+        }
+        --m_batchesInFlight;
+        finishIfDone();
+    }).onCanceled(this, [this, items, paths]() {
+        // Database closed before the batch ran
+        for (int i = 0; i < items.size(); ++i) {
+            FileResult result;
+            result.path = paths.at(i);
+            result.cartridgeGuid = items.at(i).entry.cartridgeGuid;
+            result.errorMessage = "Library database not available";
+            recordResult(result);
+        }
+        --m_batchesInFlight;
+        finishIfDone();
+    });
+}
+
+void CartridgeImporter::recordResult(const FileResult& result) {
+    switch (result.outcome) {
+    case ManifestManager::ImportOutcome::Created:
+        ++m_summary.created;
+        break;
+    case ManifestManager::ImportOutcome::Updated:
+        ++m_summary.updated;
+        break;
+    case ManifestManager::ImportOutcome::Unchanged:
+        ++m_summary.unchanged;
+        break;
+    case ManifestManager::ImportOutcome::Failed:
+        ++m_summary.failed;
+        m_summary.failures.append(result);
+        break;
+    }
+
+    const bool success = result.outcome != ManifestManager::ImportOutcome::Failed;
+    emit fileFinished(result.path, success, result.errorMessage);
+}
+
+void CartridgeImporter::finishIfDone() {
+    if (!m_running || m_processed < m_summary.total || m_batchesInFlight > 0) {
+        return;
+    }
+
+    m_running = false;
+    m_summary.elapsedMs = m_timer.elapsed();
+    qDebug() << "Cartridge import finished:" << m_summary.created << "created," << m_summary.updated << "updated,"
+             << m_summary.unchanged << "unchanged," << m_summary.failed << "failed in" << m_summary.elapsedMs << "ms";
+    emit finished(m_summary.cancelled);
+}
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
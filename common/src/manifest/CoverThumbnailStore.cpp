@@ -0,0 +1,306 @@
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include <QImageReader>
+#include <QImageWriter>
+#include <QBuffer>
+#include <QSqlError>
+#include <QDebug>
+#include <cmath>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+namespace {
+// Photographic covers compress far better as JPEG; PNG keeps transparency
+constexpr int JPEG_QUALITY = 85;
+}
+
+QSize CoverThumbnailStore::thumbnailSize() {
+    return QSize(120, 160);
+}
+
+QList<int> CoverThumbnailStore::scales() {
+    return QList<int>{1, 2};
+}
+
+int CoverThumbnailStore::scaleFor(qreal devicePixelRatio) {
+    const QList<int> supported = scales();
+    for (int scale : supported) {
+        if (scale >= std::ceil(devicePixelRatio - 0.01)) {
+            return scale;
+        }
+    }
+    return supported.last();
+}
+
+QImage CoverThumbnailStore::decodeScaled(const QByteArray& data, const QSize& maxSize) {
+    if (data.isEmpty()) {
+        return QImage();
+    }
+
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    reader.setAutoTransform(true);
+
+    // The scaled size applies before the EXIF rotation
+    QSize box = maxSize;
+    if (reader.transformation() & QImageIOHandler::TransformationRotate90) {
+        box.transpose();
+    }
+    const QSize size = reader.size();
+    if (size.isValid()) {
+        reader.setScaledSize(size.scaled(box, Qt::KeepAspectRatio));
+    }
+
+    QImage image;
+    if (!reader.read(&image)) {
+        qWarning() << "Failed to decode cover image:" << reader.errorString();
+        return QImage();
+    }
+
+    // Handlers that cannot report the size up front decode at full size
+    if (!size.isValid()) {
+        image = image.scaled(maxSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+QImage CoverThumbnailStore::render(const QByteArray& coverImage, int scale) {
+    return decodeScaled(coverImage, thumbnailSize() * scale);
+}
+
+QByteArray CoverThumbnailStore::encode(const QImage& thumbnail) {
+    if (thumbnail.isNull()) {
+        return QByteArray();
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    if (!thumbnail.hasAlphaChannel()) {
+        QImageWriter writer(&buffer, "jpeg");
+        writer.setQuality(JPEG_QUALITY);
+        if (writer.write(thumbnail)) {
+            return data;
+        }
+        // No JPEG plugin available; fall through to PNG
+        buffer.seek(0);
+        data.clear();
+    }
+
+    QImageWriter writer(&buffer, "png");
+    if (!writer.write(thumbnail)) {
+        qWarning() << "Failed to encode cover thumbnail:" << writer.errorString();
+        return QByteArray();
+    }
+    return data;
+}
+
+bool CoverThumbnailStore::store(QSqlDatabase& database, const QString& cartridgeGuid,
+                                const QByteArray& cartridgeHash, const QByteArray& coverImage) {
+    if (!database.isOpen()) {
+        qWarning() << "Database not open for cover thumbnail update";
+        return false;
+    }
+
+    if (coverImage.isEmpty()) {
+        return remove(database, cartridgeGuid);
+    }
+
+    const QList<int> supported = scales();
+    database::InstrumentedQuery existing(database);
+    existing.prepare("SELECT COUNT(*) FROM Local_Cover_Thumbnails WHERE cartridge_guid = ? AND cartridge_hash = ?");
+    existing.addBindValue(cartridgeGuid);
+    existing.addBindValue(cartridgeHash);
+    if (existing.exec() && existing.next() && existing.value(0).toInt() >= supported.size()) {
+        return true; // Already rendered from this cartridge version
+    }
+    existing.finish();
+
+    return storeRendered(database, cartridgeGuid, cartridgeHash, renderAll(coverImage));
+}
+
+QList<CoverThumbnailStore::Thumbnail> CoverThumbnailStore::renderAll(const QByteArray& coverImage) {
+    QList<Thumbnail> thumbnails;
+    if (coverImage.isEmpty()) {
+        return thumbnails;
+    }
+
+    for (int scale : scales()) {
+        // A cover that fails to decode is stored without image data so it is not retried
+        const QImage image = render(coverImage, scale);
+        Thumbnail thumbnail;
+        thumbnail.scale = scale;
+        thumbnail.size = image.size();
+        thumbnail.imageData = encode(image);
+        thumbnails.append(thumbnail);
+    }
+    return thumbnails;
+}
+
+bool CoverThumbnailStore::storeRendered(QSqlDatabase& database, const QString& cartridgeGuid,
+                                        const QByteArray& cartridgeHash, const QList<Thumbnail>& thumbnails) {
+    if (!database.isOpen()) {
+        qWarning() << "Database not open for cover thumbnail update";
+        return false;
+    }
+
+    if (thumbnails.isEmpty()) {
+        return remove(database, cartridgeGuid);
+    }
+
+    database::InstrumentedQuery insert(database);
+    insert.prepare(R"(
+        INSERT OR REPLACE INTO Local_Cover_Thumbnails
+        (cartridge_guid, scale, cartridge_hash, width, height, image_data)
+        VALUES (?, ?, ?, ?, ?, ?)
+    )");
+
+    for (const Thumbnail& thumbnail : thumbnails) {
+        insert.bindValue(0, cartridgeGuid);
+        insert.bindValue(1, thumbnail.scale);
+        insert.bindValue(2, cartridgeHash);
+        insert.bindValue(3, thumbnail.size.width());
+        insert.bindValue(4, thumbnail.size.height());
+        insert.bindValue(5, thumbnail.imageData.isEmpty() ? QVariant() : QVariant(thumbnail.imageData));
+        if (!insert.exec()) {
+            qCritical() << "Failed to store cover thumbnail:" << insert.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QByteArray CoverThumbnailStore::thumbnail(QSqlDatabase& database, const QString& cartridgeGuid, int scale) {
+    if (!database.isOpen()) {
+        return QByteArray();
+    }
+
+    database::InstrumentedQuery query(database);
+    query.prepare(R"(
+        SELECT t.image_data
+        FROM Local_Cover_Thumbnails t
+        JOIN Local_Library_Manifest m
+          ON m.cartridge_guid = t.cartridge_guid AND m.cartridge_hash = t.cartridge_hash
+        WHERE t.cartridge_guid = ? AND t.scale = ?
+    )");
+    query.addBindValue(cartridgeGuid);
+    query.addBindValue(scale);
+
+    if (query.exec() && query.next()) {
+        return query.value(0).toByteArray();
+    }
+    return QByteArray();
+}
+
+QList<CoverThumbnailStore::PendingCover> CoverThumbnailStore::pendingCovers(QSqlDatabase& database, int limit) {
+    QList<PendingCover> covers;
+    if (!database.isOpen()) {
+        return covers;
+    }
+
+    database::InstrumentedQuery pending(database);
+    pending.setForwardOnly(true);
+    pending.prepare(R"(
+        SELECT m.cartridge_guid, m.cartridge_hash, m.cover_image_data
+        FROM Local_Library_Manifest m
+        WHERE length(m.cover_image_data) > 0
+          AND (SELECT COUNT(*) FROM Local_Cover_Thumbnails t
+               WHERE t.cartridge_guid = m.cartridge_guid
+                 AND t.cartridge_hash = m.cartridge_hash) < ?
+        LIMIT ?
+    )");
+    pending.addBindValue(scales().size());
+    pending.addBindValue(limit > 0 ? limit : -1);
+    if (!pending.exec()) {
+        qWarning() << "Failed to find covers without thumbnails:" << pending.lastError().text();
+        return covers;
+    }
+
+    while (pending.next()) {
+        PendingCover cover;
+        cover.cartridgeGuid = pending.value(0).toString();
+        cover.cartridgeHash = pending.value(1).toByteArray();
+        cover.coverImage = pending.value(2).toByteArray();
+        covers.append(cover);
+    }
+    return covers;
+}
+
+int CoverThumbnailStore::storeRendered(QSqlDatabase& database, const QList<PendingCover>& covers) {
+    if (!database.isOpen()) {
+        qWarning() << "Database not open for cover thumbnail update";
+        return -1;
+    }
+
+    // One commit for the batch instead of one per thumbnail
+    const bool ownTransaction = database.transaction();
+
+    database::InstrumentedQuery current(database);
+    current.prepare("SELECT cartridge_hash FROM Local_Library_Manifest WHERE cartridge_guid = ?");
+
+    int processed = 0;
+    for (const PendingCover& cover : covers) {
+        current.bindValue(0, cover.cartridgeGuid);
+        const bool unchanged = current.exec() && current.next() && current.value(0).toByteArray() == cover.cartridgeHash;
+        current.finish();
+        if (!unchanged) {
+            continue; // Deleted or replaced since it was read
+        }
+
+        if (!storeRendered(database, cover.cartridgeGuid, cover.cartridgeHash, cover.thumbnails)) {
+            if (ownTransaction) {
+                database.rollback();
+            }
+            return -1;
+        }
+        processed++;
+    }
+
+    if (ownTransaction && !database.commit()) {
+        qCritical() << "Failed to commit cover thumbnails:" << database.lastError().text();
+        database.rollback();
+        return -1;
+    }
+
+    if (processed > 0) {
+        qDebug() << "Rendered cover thumbnails for" << processed << "cartridges";
+    }
+    return processed;
+}
+
+int CoverThumbnailStore::backfill(QSqlDatabase& database, int limit) {
+    if (!database.isOpen()) {
+        return -1;
+    }
+
+    QList<PendingCover> covers = pendingCovers(database, limit);
+    for (PendingCover& cover : covers) {
+        cover.thumbnails = renderAll(cover.coverImage);
+    }
+    return storeRendered(database, covers);
+}
+
+bool CoverThumbnailStore::remove(QSqlDatabase& database, const QString& cartridgeGuid) {
+    if (!database.isOpen()) {
+        return false;
+    }
+
+    database::InstrumentedQuery query(database);
+    query.prepare("DELETE FROM Local_Cover_Thumbnails WHERE cartridge_guid = ?");
+    query.addBindValue(cartridgeGuid);
+    if (!query.exec()) {
+        qCritical() << "Failed to remove cover thumbnails:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,371 @@
+#include "smartbook/common/manifest/LibraryGroups.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include <QDateTime>
+#include <QSqlError>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+namespace {
+// Empty names are stored as NULL; IS ? with a NULL value still uses the index
+QVariant nameValue(const QString& name) {
+    return name.isEmpty() ? QVariant(QMetaType::fromType<QString>()) : QVariant(name);
+}
+
+bool touchCollection(QSqlDatabase& database, qint64 collectionId) {
+    database::InstrumentedQuery query(database);
+    query.prepare("UPDATE Local_Cartridge_Groups SET last_modified_timestamp = ? WHERE group_id = ?");
+    query.addBindValue(QDateTime::currentSecsSinceEpoch());
+    query.addBindValue(collectionId);
+    return query.exec();
+}
+}
+
+QList<LibraryGroups::Group> LibraryGroups::seriesGroups(QSqlDatabase& database) {
+    QList<Group> groups;
+    if (!database.isOpen()) {
+        return groups;
+    }
+
+    // One row per series and edition, not per cartridge
+    database::InstrumentedQuery query(database);
+    query.setForwardOnly(true);
+    if (!query.exec(R"(
+        SELECT series_name, SUM(cartridge_count)
+        FROM Local_Series_Counts
+        GROUP BY series_name
+        ORDER BY series_name = '', series_name COLLATE NOCASE
+    )")) {
+        qWarning() << "Failed to list series:" << query.lastError().text();
+        return groups;
+    }
+
+    while (query.next()) {
+        Group group;
+        group.kind = Kind::Series;
+        group.seriesName = query.value(0).toString();
+        group.name = group.seriesName;
+        group.cartridgeCount = query.value(1).toInt();
+        groups.append(group);
+    }
+    return groups;
+}
+
+QList<LibraryGroups::Group> LibraryGroups::editionGroups(QSqlDatabase& database, const QString& seriesName) {
+    QList<Group> groups;
+    if (!database.isOpen()) {
+        return groups;
+    }
+
+    database::InstrumentedQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare(R"(
+        SELECT edition_name, cartridge_count
+        FROM Local_Series_Counts
+        WHERE series_name = ? AND edition_name <> ''
+        ORDER BY edition_name COLLATE NOCASE
+    )");
+    query.addBindValue(seriesName);
+    if (!query.exec()) {
+        qWarning() << "Failed to list editions:" << query.lastError().text();
+        return groups;
+    }
+
+    while (query.next()) {
+        Group group;
+        group.kind = Kind::Edition;
+        group.seriesName = seriesName;
+        group.editionName = query.value(0).toString();
+        group.name = group.editionName;
+        group.cartridgeCount = query.value(1).toInt();
+        groups.append(group);
+    }
+    return groups;
+}
+
+QList<LibraryGroups::Group> LibraryGroups::collections(QSqlDatabase& database) {
+    QList<Group> groups;
+    if (!database.isOpen()) {
+        return groups;
+    }
+
+    database::InstrumentedQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare(R"(
+        SELECT group_id, group_name, member_count
+        FROM Local_Cartridge_Groups
+        WHERE group_type = ?
+        ORDER BY group_name COLLATE NOCASE
+    )");
+    query.addBindValue(QString::fromLatin1(COLLECTION_TYPE));
+    if (!query.exec()) {
+        qWarning() << "Failed to list collections:" << query.lastError().text();
+        return groups;
+    }
+
+    while (query.next()) {
+        Group group;
+        group.kind = Kind::Collection;
+        group.collectionId = query.value(0).toLongLong();
+        group.name = query.value(1).toString();
+        group.cartridgeCount = query.value(2).toInt();
+        groups.append(group);
+    }
+    return groups;
+}
+
+QList<LibraryGroups::Member> LibraryGroups::members(QSqlDatabase& database, const Group& group,
+                                                    int limit, const Member& after) {
+    QList<Member> members;
+    if (!database.isOpen() || limit <= 0) {
+        return members;
+    }
+
+    // A page seeks past the last member it was given instead of counting
+    // an OFFSET, as LibraryModel does. Row values compare NULL as unknown,
+    // so the unordered members (first in a series, last in a collection)
+    // get their own clause. The plain bound lets SQLite seek the index
+    const bool seek = !after.cartridgeGuid.isEmpty();
+    const bool afterOrdered = !after.sortOrder.isNull();
+    QVariantList values;
+
+    // Series and editions are read straight off idx_manifest_series_edition,
+    // so a page costs the same as a page of the flat list
+    QString sql;
+    if (group.kind == Kind::Collection) {
+        QString bound;
+        if (seek && afterOrdered) {
+            bound = "AND (gm.display_order IS NULL OR (gm.display_order, m.title, m.cartridge_guid) > (?, ?, ?))";
+            values << after.sortOrder << after.title << after.cartridgeGuid;
+        } else if (seek) {
+            bound = "AND gm.display_order IS NULL AND (m.title, m.cartridge_guid) > (?, ?)";
+            values << after.title << after.cartridgeGuid;
+        }
+        sql = QString(R"(
+            SELECT m.cartridge_guid, m.title, m.author, m.version, m.publication_year, gm.display_order
+            FROM Local_Cartridge_Group_Members gm
+            JOIN Local_Library_Manifest m ON m.cartridge_guid = gm.cartridge_guid
+            WHERE gm.group_id = ? %1
+            ORDER BY gm.display_order IS NULL, gm.display_order, m.title, m.cartridge_guid
+            LIMIT ?
+        )").arg(bound);
+        values.prepend(group.collectionId);
+    } else {
+        QString bound;
+        if (seek && afterOrdered) {
+            bound = "AND series_order >= ? AND (series_order, title, cartridge_guid) > (?, ?, ?)";
+            values << after.sortOrder << after.sortOrder << after.title << after.cartridgeGuid;
+        } else if (seek) {
+            bound = "AND (series_order IS NOT NULL OR (title, cartridge_guid) > (?, ?))";
+            values << after.title << after.cartridgeGuid;
+        }
+        sql = QString(R"(
+            SELECT cartridge_guid, title, author, version, publication_year, series_order
+            FROM Local_Library_Manifest
+            WHERE series_name IS ? AND edition_name IS ? %1
+            ORDER BY series_order, title, cartridge_guid
+            LIMIT ?
+        )").arg(bound);
+        values.prepend(nameValue(group.kind == Kind::Edition ? group.editionName : QString()));
+        values.prepend(nameValue(group.seriesName));
+    }
+    values.append(limit);
+
+    database::InstrumentedQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    for (const QVariant& value : values) {
+        query.addBindValue(value);
+    }
+
+    if (!query.exec()) {
+        qWarning() << "Failed to read group members:" << query.lastError().text();
+        return members;
+    }
+    while (query.next()) {
+        Member member;
+        member.cartridgeGuid = query.value(0).toString();
+        member.title = query.value(1).toString();
+        member.author = query.value(2).toString();
+        member.version = query.value(3).toString();
+        member.publicationYear = query.value(4).toString();
+        member.sortOrder = query.value(5);
+        members.append(member);
+    }
+    return members;
+}
+
+qint64 LibraryGroups::createCollection(QSqlDatabase& database, const QString& name, const QString& description) {
+    if (!database.isOpen() || name.trimmed().isEmpty()) {
+        return 0;
+    }
+
+    const qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+    database::InstrumentedQuery query(database);
+    query.prepare(R"(
+        INSERT INTO Local_Cartridge_Groups (group_name, group_type, created_timestamp, last_modified_timestamp, description)
+        VALUES (?, ?, ?, ?, ?)
+    )");
+    query.addBindValue(name.trimmed());
+    query.addBindValue(QString::fromLatin1(COLLECTION_TYPE));
+    query.addBindValue(timestamp);
+    query.addBindValue(timestamp);
+    query.addBindValue(description.isEmpty() ? QVariant(QMetaType::fromType<QString>()) : QVariant(description));
+    if (!query.exec()) {
+        qCritical() << "Failed to create collection:" << query.lastError().text();
+        return 0;
+    }
+    return query.lastInsertId().toLongLong();
+}
+
+bool LibraryGroups::renameCollection(QSqlDatabase& database, qint64 collectionId, const QString& name) {
+    if (!database.isOpen() || name.trimmed().isEmpty()) {
+        return false;
+    }
+
+    database::InstrumentedQuery query(database);
+    query.prepare(R"(
+        UPDATE Local_Cartridge_Groups SET group_name = ?, last_modified_timestamp = ?
+        WHERE group_id = ? AND group_type = ?
+    )");
+    query.addBindValue(name.trimmed());
+    query.addBindValue(QDateTime::currentSecsSinceEpoch());
+    query.addBindValue(collectionId);
+    query.addBindValue(QString::fromLatin1(COLLECTION_TYPE));
+    if (!query.exec()) {
+        qCritical() << "Failed to rename collection:" << query.lastError().text();
+        return false;
+    }
+    return query.numRowsAffected() > 0;
+}
+
+bool LibraryGroups::deleteCollection(QSqlDatabase& database, qint64 collectionId) {
+    if (!database.isOpen()) {
+        return false;
+    }
+
+    const bool ownTransaction = database.transaction();
+
+    database::InstrumentedQuery query(database);
+    query.prepare("DELETE FROM Local_Cartridge_Group_Members WHERE group_id = ?");
+    query.addBindValue(collectionId);
+    bool deleted = query.exec();
+    if (deleted) {
+        query.prepare("DELETE FROM Local_Cartridge_Groups WHERE group_id = ? AND group_type = ?");
+        query.addBindValue(collectionId);
+        query.addBindValue(QString::fromLatin1(COLLECTION_TYPE));
+        deleted = query.exec() && query.numRowsAffected() > 0;
+    }
+
+    if (!deleted) {
+        if (ownTransaction) {
+            database.rollback();
+        }
+        return false;
+    }
+    if (ownTransaction && !database.commit()) {
+        qCritical() << "Failed to commit collection deletion:" << database.lastError().text();
+        database.rollback();
+        return false;
+    }
+    return true;
+}
+
+int LibraryGroups::addToCollection(QSqlDatabase& database, qint64 collectionId, const QStringList& cartridgeGuids) {
+    if (!database.isOpen()) {
+        return -1;
+    }
+    if (cartridgeGuids.isEmpty()) {
+        return 0;
+    }
+
+    const bool ownTransaction = database.transaction();
+    auto fail = [&database, ownTransaction](const QString& error) {
+        qCritical() << "Failed to add to collection:" << error;
+        if (ownTransaction) {
+            database.rollback();
+        }
+        return -1;
+    };
+
+    // New members go after the current ones, in the order given
+    database::InstrumentedQuery query(database);
+    query.prepare("SELECT IFNULL(MAX(display_order), 0) FROM Local_Cartridge_Group_Members WHERE group_id = ?");
+    query.addBindValue(collectionId);
+    if (!query.exec() || !query.next()) {
+        return fail(query.lastError().text());
+    }
+    int displayOrder = query.value(0).toInt();
+    query.finish();
+
+    const qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+    query.prepare(R"(
+        INSERT OR IGNORE INTO Local_Cartridge_Group_Members (group_id, cartridge_guid, added_timestamp, display_order)
+        VALUES (?, ?, ?, ?)
+    )");
+    int added = 0;
+    for (const QString& guid : cartridgeGuids) {
+        query.addBindValue(collectionId);
+        query.addBindValue(guid);
+        query.addBindValue(timestamp);
+        query.addBindValue(displayOrder + 1);
+        if (!query.exec()) {
+            return fail(query.lastError().text());     // Unknown collection or cartridge
+        }
+        if (query.numRowsAffected() > 0) {
+            ++added;
+            ++displayOrder;
+        }
+    }
+
+    if (added > 0 && !touchCollection(database, collectionId)) {
+        return fail(database.lastError().text());
+    }
+    if (ownTransaction && !database.commit()) {
+        return fail(database.lastError().text());
+    }
+    return added;
+}
+
+int LibraryGroups::removeFromCollection(QSqlDatabase& database, qint64 collectionId, const QStringList& cartridgeGuids) {
+    if (!database.isOpen()) {
+        return -1;
+    }
+    if (cartridgeGuids.isEmpty()) {
+        return 0;
+    }
+
+    const bool ownTransaction = database.transaction();
+
+    database::InstrumentedQuery query(database);
+    query.prepare("DELETE FROM Local_Cartridge_Group_Members WHERE group_id = ? AND cartridge_guid = ?");
+    int removed = 0;
+    for (const QString& guid : cartridgeGuids) {
+        query.addBindValue(collectionId);
+        query.addBindValue(guid);
+        if (!query.exec()) {
+            qCritical() << "Failed to remove from collection:" << query.lastError().text();
+            if (ownTransaction) {
+                database.rollback();
+            }
+            return -1;
+        }
+        removed += query.numRowsAffected();
+    }
+
+    if (removed > 0) {
+        touchCollection(database, collectionId);
+    }
+    if (ownTransaction && !database.commit()) {
+        qCritical() << "Failed to commit collection removal:" << database.lastError().text();
+        database.rollback();
+        return -1;
+    }
+    return removed;
+}
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
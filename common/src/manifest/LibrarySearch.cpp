@@ -0,0 +1,57 @@
+#include "smartbook/common/manifest/LibrarySearch.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+QString LibrarySearch::matchExpression(const QString& text) {
+    static const QRegularExpression whitespace("\\s+");
+
+    QStringList terms;
+    const QStringList words = text.split(whitespace, Qt::SkipEmptyParts);
+    for (QString word : words) {
+        // Inside a string FTS5 only treats '"' specially, escaped by doubling
+        word.replace('"', "\"\"");
+        terms.append(QString("\"%1\"*").arg(word));
+    }
+    return terms.join(' ');
+}
+
+QStringList LibrarySearch::search(QSqlDatabase& database, const QString& text, int limit) {
+    QStringList guids;
+    const QString match = matchExpression(text);
+    if (!database.isOpen() || match.isEmpty() || limit <= 0) {
+        return guids;
+    }
+
+    // rank is bm25 with the column weights configured by the migration
+    database::InstrumentedQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare(R"(
+        SELECT m.cartridge_guid
+        FROM Local_Library_Search
+        JOIN Local_Library_Manifest m ON m.manifest_id = Local_Library_Search.rowid
+        WHERE Local_Library_Search MATCH ?
+        ORDER BY Local_Library_Search.rank
+        LIMIT ?
+    )");
+    query.addBindValue(match);
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        qWarning() << "Library search failed:" << query.lastError().text();
+        return guids;
+    }
+    while (query.next()) {
+        guids.append(query.value(0).toString());
+    }
+    return guids;
+}
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
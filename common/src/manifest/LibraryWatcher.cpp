@@ -0,0 +1,379 @@
+#include "smartbook/common/manifest/LibraryWatcher.h"
+#include "smartbook/common/manifest/CartridgeImporter.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QPair>
+#include <QPromise>
+#include <QThreadPool>
+#include <QDebug>
+#include <memory>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+namespace {
+// Directory events come in bursts (a copy writes many times)
+constexpr int DEBOUNCE_MS = 1000;
+}
+
+LibraryWatcher::LibraryWatcher(QObject* parent)
+    : QObject(parent)
+    , m_manifestManager(new ManifestManager(this))
+    , m_importer(new CartridgeImporter(this))
+{
+    m_debounceTimer.setSingleShot(true);
+    m_debounceTimer.setInterval(DEBOUNCE_MS);
+    connect(&m_debounceTimer, &QTimer::timeout, this, &LibraryWatcher::runScan);
+
+    m_rescanTimer.setInterval(m_rescanIntervalMs);
+    connect(&m_rescanTimer, &QTimer::timeout, this, &LibraryWatcher::rescan);
+
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &LibraryWatcher::onDirectoryChanged);
+
+    // Rehashing competes with reading; keep it to a couple of files at once
+    CartridgeImporter::Options options;
+    options.maxConcurrentReads = 2;
+    m_importer->setOptions(options);
+    connect(m_importer, &CartridgeImporter::finished, this, &LibraryWatcher::onRehashFinished);
+}
+
+LibraryWatcher::~LibraryWatcher() {
+    stop();
+}
+
+void LibraryWatcher::start() {
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    if (m_rescanIntervalMs > 0) {
+        m_rescanTimer.start();
+    }
+    rescan();
+}
+
+void LibraryWatcher::stop() {
+    m_running = false;
+    m_debounceTimer.stop();
+    m_rescanTimer.stop();
+    m_pendingAll = false;
+    m_pendingDirectories.clear();
+    m_pendingRehash.clear();
+
+    const QStringList watched = m_watcher.directories();
+    if (!watched.isEmpty()) {
+        m_watcher.removePaths(watched);
+    }
+    m_importer->cancel();
+}
+
+void LibraryWatcher::rescan() {
+    if (!m_running) {
+        return;
+    }
+    m_pendingAll = true;
+    runScan();
+}
+
+void LibraryWatcher::setRescanInterval(int milliseconds) {
+    m_rescanIntervalMs = qMax(0, milliseconds);
+    if (m_rescanIntervalMs == 0) {
+        m_rescanTimer.stop();
+        return;
+    }
+    m_rescanTimer.setInterval(m_rescanIntervalMs);
+    if (m_running) {
+        m_rescanTimer.start();
+    }
+}
+
+int LibraryWatcher::rescanInterval() const {
+    return m_rescanIntervalMs;
+}
+
+bool LibraryWatcher::isBusy() const {
+    return m_scanning || m_importer->isRunning() || !m_pendingRehash.isEmpty();
+}
+
+void LibraryWatcher::onDirectoryChanged(const QString& directory) {
+    if (!m_running) {
+        return;
+    }
+    m_pendingDirectories.insert(QDir::cleanPath(directory));
+    scheduleScan();
+}
+
+void LibraryWatcher::scheduleScan() {
+    m_debounceTimer.start();
+}
+
+void LibraryWatcher::runScan() {
+    if (!m_running || m_scanning) {
+        return; // A running scan picks pending work up when it finishes
+    }
+    if (!m_pendingAll && m_pendingDirectories.isEmpty()) {
+        return;
+    }
+
+    const bool all = m_pendingAll;
+    const QSet<QString> directories = m_pendingDirectories;
+    m_pendingAll = false;
+    m_pendingDirectories.clear();
+    m_debounceTimer.stop();
+    m_scanning = true;
+
+    // Fresh states each time, so entries imported meanwhile are covered
+    QFuture<QList<ManifestManager::FileState>> loaded = m_manifestManager->fileStatesAsync();
+    loaded.then(this, [this, all, directories](const QList<ManifestManager::FileState>& states) {
+        auto promise = std::make_shared<QPromise<ScanResult>>();
+        QFuture<ScanResult> scanned = promise->future();
+        promise->start();
+        QThreadPool::globalInstance()->start([promise, states, directories, all]() {
+            promise->addResult(scan(states, directories, all));
+            promise->finish();
+        });
+
+        scanned.then(this, [this](const ScanResult& result) {
+            applyScan(result);
+        });
+    }).onCanceled(this, [this]() {
+        // Database closed
+        m_scanning = false;
+    });
+}
+
+LibraryWatcher::ScanResult LibraryWatcher::scan(const QList<ManifestManager::FileState>& states,
+                                                const QSet<QString>& directories, bool all) {
+    ScanResult result;
+
+    QHash<QString, QList<int>> byPath;
+    QSet<QString> allDirectories;
+    for (int i = 0; i < states.size(); ++i) {
+        const QString path = QDir::cleanPath(states.at(i).localPath);
+        byPath[path].append(i);
+        allDirectories.insert(QFileInfo(path).absolutePath());
+    }
+
+    for (const QString& directory : allDirectories) {
+        if (QFileInfo(directory).isDir()) {
+            result.directories.append(directory);
+        }
+    }
+
+    auto update = [&result](const ManifestManager::FileState& state, const QString& path,
+                            const utils::FileFingerprint& fingerprint, const char* status) {
+        ManifestManager::FileState updated = state;
+        updated.localPath = path;
+        updated.fingerprint = fingerprint;
+        updated.locationStatus = QString::fromLatin1(status);
+        result.updates.append(updated);
+    };
+
+    QList<int> gone;
+    QSet<QString> scanned;
+    QSet<QString> changed;
+    for (int i = 0; i < states.size(); ++i) {
+        const ManifestManager::FileState& state = states.at(i);
+        const QString path = QDir::cleanPath(state.localPath);
+        const QString directory = QFileInfo(path).absolutePath();
+        if (!all && !directories.contains(directory)) {
+            continue;
+        }
+        scanned.insert(directory);
+
+        const utils::FileFingerprint current = utils::FileFingerprint::of(path);
+        if (!current.exists()) {
+            gone.append(i);
+            continue;
+        }
+
+        // Imported before fingerprints were recorded: adopt, do not rehash
+        if (!state.fingerprint.exists()) {
+            update(state, state.localPath, current, ManifestManager::LOCATION_LOCAL);
+            continue;
+        }
+
+        if (state.fingerprint.matches(current)) {
+            if (state.locationStatus == ManifestManager::LOCATION_MISSING) {
+                update(state, state.localPath, current, ManifestManager::LOCATION_LOCAL);
+            }
+            continue;
+        }
+
+        // Another entry already describes what is at this path now: this
+        // entry's cartridge was replaced by it
+        bool replaced = false;
+        for (int other : byPath.value(path)) {
+            if (other != i && states.at(other).fingerprint.matches(current)) {
+                replaced = true;
+                break;
+            }
+        }
+        if (replaced) {
+            gone.append(i);
+        } else if (!changed.contains(path)) {
+            changed.insert(path);
+            result.rehash.append(path);
+        }
+    }
+
+    if (gone.isEmpty()) {
+        return result;
+    }
+
+    // Untracked cartridges in the scanned directories may be moved entries
+    QList<QPair<QString, utils::FileFingerprint>> untracked;
+    for (const QString& directory : scanned) {
+        const QFileInfoList files = QDir(directory).entryInfoList(QStringList() << "*.sqlite", QDir::Files);
+        for (const QFileInfo& file : files) {
+            const QString path = QDir::cleanPath(file.absoluteFilePath());
+            if (!byPath.contains(path)) {
+                untracked.append(qMakePair(path, utils::FileFingerprint::of(path)));
+            }
+        }
+    }
+
+    for (int i : gone) {
+        const ManifestManager::FileState& state = states.at(i);
+
+        // Only an unambiguous match with a known inode counts as a move
+        int match = -1;
+        if (state.fingerprint.exists() && state.fingerprint.fileId != 0) {
+            for (int candidate = 0; candidate < untracked.size(); ++candidate) {
+                if (untracked.at(candidate).second.fileId != 0
+                    && untracked.at(candidate).second.matches(state.fingerprint)) {
+                    match = (match == -1) ? candidate : -2;
+                }
+            }
+        }
+
+        if (match >= 0) {
+            update(state, untracked.at(match).first, untracked.at(match).second, ManifestManager::LOCATION_LOCAL);
+            untracked.removeAt(match);
+            ++result.moved;
+        } else if (state.locationStatus != ManifestManager::LOCATION_MISSING) {
+            update(state, state.localPath, state.fingerprint, ManifestManager::LOCATION_MISSING);
+            ++result.missing;
+        }
+    }
+
+    return result;
+}
+
+void LibraryWatcher::applyScan(const ScanResult& result) {
+    if (!m_running) {
+        m_scanning = false;
+        return;
+    }
+
+    watchDirectories(result.directories);
+
+    for (const QString& path : result.rehash) {
+        if (!m_pendingRehash.contains(path)) {
+            m_pendingRehash.append(path);
+        }
+    }
+
+    auto done = [this, result]() {
+        m_scanning = false;
+        if (result.missing > 0 || result.moved > 0 || !result.rehash.isEmpty()) {
+            qDebug() << "Library scan:" << result.missing << "missing," << result.moved << "moved,"
+                     << result.rehash.size() << "changed";
+        }
+        emit scanFinished(result.missing, result.moved, result.rehash.size());
+
+        startRehash();
+        if (m_pendingAll || !m_pendingDirectories.isEmpty()) {
+            runScan();
+        }
+    };
+
+    if (result.updates.isEmpty()) {
+        done();
+        return;
+    }
+
+    QFuture<int> written = m_manifestManager->updateFileStatesAsync(result.updates);
+    written.then(this, [done](int) {
+        done();
+    }).onCanceled(this, [this]() {
+        m_scanning = false;
+    });
+}
+
+void LibraryWatcher::watchDirectories(const QStringList& directories) {
+    const QStringList watched = m_watcher.directories();
+    const QSet<QString> wanted(directories.cbegin(), directories.cend());
+
+    QStringList removed;
+    for (const QString& directory : watched) {
+        if (!wanted.contains(QDir::cleanPath(directory))) {
+            removed.append(directory);
+        }
+    }
+    if (!removed.isEmpty()) {
+        m_watcher.removePaths(removed);
+    }
+
+    QStringList added;
+    for (const QString& directory : directories) {
+        if (!watched.contains(directory)) {
+            added.append(directory);
+        }
+    }
+    if (!added.isEmpty()) {
+        // Paths the platform cannot watch are still covered by rescans
+        m_watcher.addPaths(added);
+    }
+}
+
+void LibraryWatcher::startRehash() {
+    if (m_pendingRehash.isEmpty() || m_importer->isRunning()) {
+        return;
+    }
+
+    const QStringList paths = m_pendingRehash;
+    m_pendingRehash.clear();
+    m_importer->start(paths);
+}
+
+void LibraryWatcher::onRehashFinished() {
+    // A file that no longer imports keeps its old entry. Record its
+    // fingerprint anyway, so it is not rehashed on every scan; opening it
+    // verifies the content again
+    const CartridgeImporter::Summary summary = m_importer->summary();
+    if (m_running && !summary.failures.isEmpty()) {
+        QStringList failed;
+        for (const CartridgeImporter::FileResult& failure : summary.failures) {
+            qWarning() << "Changed cartridge could not be re-read:" << failure.path << failure.errorMessage;
+            failed.append(QDir::cleanPath(failure.path));
+        }
+
+        QFuture<QList<ManifestManager::FileState>> loaded = m_manifestManager->fileStatesAsync();
+        loaded.then(this, [this, failed](const QList<ManifestManager::FileState>& states) {
+            QList<ManifestManager::FileState> updates;
+            for (ManifestManager::FileState state : states) {
+                if (failed.contains(QDir::cleanPath(state.localPath))) {
+                    state.fingerprint = utils::FileFingerprint::of(state.localPath);
+                    if (state.fingerprint.exists()) {
+                        updates.append(state);
+                    }
+                }
+            }
+            if (!updates.isEmpty()) {
+                m_manifestManager->updateFileStatesAsync(updates);
+            }
+        });
+    }
+
+    emit rehashFinished();
+    if (m_running) {
+        startRehash();
+    }
+}
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
@@ -0,0 +1,75 @@
+#include "smartbook/common/manifest/ManifestChangeFeed.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include <QSqlError>
+#include <QDebug>
+
+namespace smartbook {
+namespace common {
+namespace manifest {
+
+ManifestChangeFeed& ManifestChangeFeed::getInstance() {
+    static ManifestChangeFeed instance;
+    return instance;
+}
+
+void ManifestChangeFeed::publish(ChangeType type, const QString& cartridgeGuid) {
+    // Emitting from a non-owner thread is fine; connections decide how to deliver
+    emit entryChanged(type, cartridgeGuid);
+}
+
+qint64 ManifestChangeFeed::latestChangeId(QSqlDatabase& database) {
+    if (!database.isOpen()) {
+        return -1;
+    }
+
+    database::InstrumentedQuery query(database);
+    if (!query.exec("SELECT IFNULL(MAX(change_id), 0) FROM Local_Manifest_Changes") || !query.next()) {
+        qWarning() << "Failed to read manifest change log:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toLongLong();
+}
+
+bool ManifestChangeFeed::changesSince(QSqlDatabase& database, qint64 changeId, QList<Change>& changes) {
+    changes.clear();
+    if (!database.isOpen()) {
+        return false;
+    }
+
+    // Pruned past the caller's position: some changes are lost
+    database::InstrumentedQuery oldest(database);
+    if (!oldest.exec("SELECT MIN(change_id) FROM Local_Manifest_Changes") || !oldest.next()) {
+        qWarning() << "Failed to read manifest change log:" << oldest.lastError().text();
+        return false;
+    }
+    if (!oldest.value(0).isNull() && oldest.value(0).toLongLong() > changeId + 1) {
+        return false;
+    }
+
+    database::InstrumentedQuery query(database);
+    query.setForwardOnly(true);
+    query.prepare(R"(
+        SELECT change_id, cartridge_guid, change_type
+        FROM Local_Manifest_Changes
+        WHERE change_id > ?
+        ORDER BY change_id
+    )");
+    query.addBindValue(changeId);
+    if (!query.exec()) {
+        qWarning() << "Failed to read manifest change log:" << query.lastError().text();
+        return false;
+    }
+
+    while (query.next()) {
+        Change change;
+        change.changeId = query.value(0).toLongLong();
+        change.cartridgeGuid = query.value(1).toString();
+        change.type = static_cast<ChangeType>(query.value(2).toInt());
+        changes.append(change);
+    }
+    return true;
+}
+
+} // namespace manifest
+} // namespace common
+} // namespace smartbook
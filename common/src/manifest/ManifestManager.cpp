@@ -1,5 +1,8 @@
 #include "smartbook/common/manifest/ManifestManager.h"
-#include <QSqlQuery>
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include "smartbook/common/manifest/ManifestChangeFeed.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include <QDateTime>
 #include <QSqlError>
 #include <QDebug>
 
@@ -7,6 +10,21 @@ namespace smartbook {
 namespace common {
 namespace manifest {
 
+namespace {
+// Fingerprint columns are NULL until the file has been seen
+void bindFingerprint(QSqlQuery& query, const utils::FileFingerprint& fingerprint)
+{
+    query.addBindValue(fingerprint.exists() ? QVariant(fingerprint.size) : QVariant());
+    query.addBindValue(fingerprint.exists() ? QVariant(fingerprint.modifiedMs) : QVariant());
+    query.addBindValue(fingerprint.exists() && fingerprint.fileId != 0 ? QVariant(fingerprint.fileId) : QVariant());
+}
+
+QString locationStatusOf(const QString& status)
+{
+    return status.isEmpty() ? QString(ManifestManager::LOCATION_LOCAL) : status;
+}
+}
+
 ManifestManager::ManifestManager(QObject* parent)
     : QObject(parent)
     , m_dbManager(&database::LocalDBManager::getInstance())
@@ -15,7 +33,112 @@ ManifestManager::ManifestManager(QObject* parent)
 
 bool ManifestManager::createManifestEntry(const ManifestEntry& entry)
 {
-    if (!m_dbManager->isOpen()) {
+    // Serialized through the single writer connection
+    return m_dbManager->write([entry](QSqlDatabase& database) {
+        return createManifestEntry(database, entry);
+    });
+}
+
+ManifestManager::ManifestEntry ManifestManager::getManifestEntry(const QString& cartridgeGuid)
+{
+    QSqlDatabase database = m_dbManager->readConnection();
+    return getManifestEntry(database, cartridgeGuid);
+}
+
+bool ManifestManager::updateManifestEntry(const ManifestEntry& entry)
+{
+    return m_dbManager->write([entry](QSqlDatabase& database) {
+        return updateManifestEntry(database, entry);
+    });
+}
+
+bool ManifestManager::manifestEntryExists(const QString& cartridgeGuid)
+{
+    QSqlDatabase database = m_dbManager->readConnection();
+    return manifestEntryExists(database, cartridgeGuid);
+}
+
+bool ManifestManager::deleteManifestEntry(const QString& cartridgeGuid)
+{
+    return m_dbManager->write([cartridgeGuid](QSqlDatabase& database) {
+        return deleteManifestEntry(database, cartridgeGuid);
+    });
+}
+
+bool ManifestManager::recordOpened(const QString& cartridgeGuid)
+{
+    return m_dbManager->write([cartridgeGuid](QSqlDatabase& database) {
+        return recordOpened(database, cartridgeGuid);
+    });
+}
+
+QFuture<bool> ManifestManager::createManifestEntryAsync(const ManifestEntry& entry, Priority priority)
+{
+    return m_dbManager->executor().submit([entry](QSqlDatabase& database) {
+        return createManifestEntry(database, entry);
+    }, priority);
+}
+
+QFuture<ManifestManager::ManifestEntry> ManifestManager::getManifestEntryAsync(const QString& cartridgeGuid, Priority priority)
+{
+    return m_dbManager->executor().submit([cartridgeGuid](QSqlDatabase& database) {
+        return getManifestEntry(database, cartridgeGuid);
+    }, priority);
+}
+
+QFuture<bool> ManifestManager::updateManifestEntryAsync(const ManifestEntry& entry, Priority priority)
+{
+    return m_dbManager->executor().submit([entry](QSqlDatabase& database) {
+        return updateManifestEntry(database, entry);
+    }, priority);
+}
+
+QFuture<bool> ManifestManager::manifestEntryExistsAsync(const QString& cartridgeGuid, Priority priority)
+{
+    return m_dbManager->executor().submit([cartridgeGuid](QSqlDatabase& database) {
+        return manifestEntryExists(database, cartridgeGuid);
+    }, priority);
+}
+
+QFuture<bool> ManifestManager::deleteManifestEntryAsync(const QString& cartridgeGuid, Priority priority)
+{
+    return m_dbManager->executor().submit([cartridgeGuid](QSqlDatabase& database) {
+        return deleteManifestEntry(database, cartridgeGuid);
+    }, priority);
+}
+
+QFuture<bool> ManifestManager::recordOpenedAsync(const QString& cartridgeGuid, Priority priority)
+{
+    return m_dbManager->executor().submit([cartridgeGuid](QSqlDatabase& database) {
+        return recordOpened(database, cartridgeGuid);
+    }, priority);
+}
+
+QFuture<QList<ManifestManager::ImportOutcome>> ManifestManager::importManifestEntriesAsync(const QList<ImportItem>& items,
+                                                                                         Priority priority)
+{
+    return m_dbManager->executor().submit([items](QSqlDatabase& database) {
+        return importManifestEntries(database, items);
+    }, priority);
+}
+
+QFuture<QList<ManifestManager::FileState>> ManifestManager::fileStatesAsync(Priority priority)
+{
+    return m_dbManager->executor().submit([](QSqlDatabase& database) {
+        return fileStates(database);
+    }, priority);
+}
+
+QFuture<int> ManifestManager::updateFileStatesAsync(const QList<FileState>& states, Priority priority)
+{
+    return m_dbManager->executor().submit([states](QSqlDatabase& database) {
+        return updateFileStates(database, states);
+    }, priority);
+}
+
+bool ManifestManager::createManifestEntry(QSqlDatabase& database, const ManifestEntry& entry)
+{
+    if (!database.isOpen()) {
         qWarning() << "Database not open for manifest entry creation";
         return false;
     }
@@ -36,44 +159,34 @@ bool ManifestManager::createManifestEntry(const ManifestEntry& entry)
         return false;
     }
     
-    QSqlQuery query(m_dbManager->getDatabase());
-    query.prepare(R"(
-        INSERT INTO Local_Library_Manifest 
-        (cartridge_guid, cartridge_hash, local_path, title, author, publisher, version, publication_year, cover_image_data)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )");
-    
-    query.addBindValue(entry.cartridgeGuid);
-    query.addBindValue(entry.cartridgeHash);
-    query.addBindValue(entry.localPath);
-    query.addBindValue(entry.title);
-    query.addBindValue(entry.author);
-    query.addBindValue(entry.publisher);
-    query.addBindValue(entry.version);
-    query.addBindValue(entry.publicationYear);
-    query.addBindValue(entry.coverImageData);
-    
-    if (!query.exec()) {
-        qCritical() << "Failed to create manifest entry:" << query.lastError().text();
+    if (!insertManifestRow(database, entry)) {
         return false;
     }
+
+    // Render the Bookshelf thumbnails once at import; a failure here is
+    // repaired by the view's backfill
+    if (!CoverThumbnailStore::store(database, entry.cartridgeGuid, entry.cartridgeHash, entry.coverImageData)) {
+        qWarning() << "Cover thumbnails not stored for" << entry.cartridgeGuid;
+    }
     
+    ManifestChangeFeed::getInstance().publish(ManifestChangeFeed::ChangeType::Created, entry.cartridgeGuid);
     return true;
 }
 
-ManifestManager::ManifestEntry ManifestManager::getManifestEntry(const QString& cartridgeGuid)
+ManifestManager::ManifestEntry ManifestManager::getManifestEntry(QSqlDatabase& database, const QString& cartridgeGuid)
 {
     ManifestEntry entry;
     
-    if (!m_dbManager->isOpen()) {
+    if (!database.isOpen()) {
         qWarning() << "Database not open for manifest entry retrieval";
         return entry;
     }
     
-    QSqlQuery query(m_dbManager->getDatabase());
+    database::InstrumentedQuery query(database);
     query.prepare(R"(
         SELECT cartridge_guid, cartridge_hash, local_path, title, author, publisher, 
-               version, publication_year, cover_image_data
+               version, publication_year, cover_image_data, series_name, edition_name, series_order,
+               file_size, file_modified, file_id, location_status
         FROM Local_Library_Manifest
         WHERE cartridge_guid = ?
     )");
@@ -94,14 +207,21 @@ ManifestManager::ManifestEntry ManifestManager::getManifestEntry(const QString&
         entry.version = query.value(6).toString();
         entry.publicationYear = query.value(7).toString();
         entry.coverImageData = query.value(8).toByteArray();
+        entry.seriesName = query.value(9).toString();
+        entry.editionName = query.value(10).toString();
+        entry.seriesOrder = query.value(11).toInt();
+        entry.fingerprint.size = query.value(12).isNull() ? -1 : query.value(12).toLongLong();
+        entry.fingerprint.modifiedMs = query.value(13).toLongLong();
+        entry.fingerprint.fileId = query.value(14).toLongLong();
+        entry.locationStatus = query.value(15).toString();
     }
     
     return entry;
 }
 
-bool ManifestManager::updateManifestEntry(const ManifestEntry& entry)
+bool ManifestManager::updateManifestEntry(QSqlDatabase& database, const ManifestEntry& entry)
 {
-    if (!m_dbManager->isOpen()) {
+    if (!database.isOpen()) {
         qWarning() << "Database not open for manifest entry update";
         return false;
     }
@@ -111,11 +231,68 @@ bool ManifestManager::updateManifestEntry(const ManifestEntry& entry)
         return false;
     }
     
-    QSqlQuery query(m_dbManager->getDatabase());
+    const int rowsAffected = updateManifestRow(database, entry);
+    if (rowsAffected < 0) {
+        return false;
+    }
+    
+    // Check if any rows were affected
+    if (rowsAffected == 0) {
+        qWarning() << "No manifest entry found to update for GUID:" << entry.cartridgeGuid;
+        return false;
+    }
+
+    // No-op unless the hash changed (the trigger has then dropped the old thumbnails)
+    if (!CoverThumbnailStore::store(database, entry.cartridgeGuid, entry.cartridgeHash, entry.coverImageData)) {
+        qWarning() << "Cover thumbnails not stored for" << entry.cartridgeGuid;
+    }
+    
+    ManifestChangeFeed::getInstance().publish(ManifestChangeFeed::ChangeType::Updated, entry.cartridgeGuid);
+    return true;
+}
+
+bool ManifestManager::insertManifestRow(QSqlDatabase& database, const ManifestEntry& entry)
+{
+    database::InstrumentedQuery query(database);
+    query.prepare(R"(
+        INSERT INTO Local_Library_Manifest 
+        (cartridge_guid, cartridge_hash, local_path, title, author, publisher, version, publication_year,
+         cover_image_data, series_name, edition_name, series_order,
+         file_size, file_modified, file_id, location_status)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    
+    query.addBindValue(entry.cartridgeGuid);
+    query.addBindValue(entry.cartridgeHash);
+    query.addBindValue(entry.localPath);
+    query.addBindValue(entry.title);
+    query.addBindValue(entry.author);
+    query.addBindValue(entry.publisher);
+    query.addBindValue(entry.version);
+    query.addBindValue(entry.publicationYear);
+    query.addBindValue(entry.coverImageData);
+    query.addBindValue(entry.seriesName.isEmpty() ? QVariant() : QVariant(entry.seriesName));
+    query.addBindValue(entry.editionName.isEmpty() ? QVariant() : QVariant(entry.editionName));
+    query.addBindValue(entry.seriesOrder > 0 ? QVariant(entry.seriesOrder) : QVariant());
+    bindFingerprint(query, entry.fingerprint);
+    query.addBindValue(locationStatusOf(entry.locationStatus));
+    
+    if (!query.exec()) {
+        qCritical() << "Failed to create manifest entry:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+int ManifestManager::updateManifestRow(QSqlDatabase& database, const ManifestEntry& entry)
+{
+    database::InstrumentedQuery query(database);
     query.prepare(R"(
         UPDATE Local_Library_Manifest 
         SET cartridge_hash = ?, local_path = ?, title = ?, author = ?, 
-            publisher = ?, version = ?, publication_year = ?, cover_image_data = ?
+            publisher = ?, version = ?, publication_year = ?, cover_image_data = ?,
+            series_name = ?, edition_name = ?, series_order = ?,
+            file_size = ?, file_modified = ?, file_id = ?, location_status = ?
         WHERE cartridge_guid = ?
     )");
     
@@ -127,29 +304,211 @@ bool ManifestManager::updateManifestEntry(const ManifestEntry& entry)
     query.addBindValue(entry.version);
     query.addBindValue(entry.publicationYear);
     query.addBindValue(entry.coverImageData);
+    query.addBindValue(entry.seriesName.isEmpty() ? QVariant() : QVariant(entry.seriesName));
+    query.addBindValue(entry.editionName.isEmpty() ? QVariant() : QVariant(entry.editionName));
+    query.addBindValue(entry.seriesOrder > 0 ? QVariant(entry.seriesOrder) : QVariant());
+    bindFingerprint(query, entry.fingerprint);
+    query.addBindValue(locationStatusOf(entry.locationStatus));
     query.addBindValue(entry.cartridgeGuid);
     
     if (!query.exec()) {
         qCritical() << "Failed to update manifest entry:" << query.lastError().text();
-        return false;
+        return -1;
     }
-    
-    // Check if any rows were affected
-    if (query.numRowsAffected() == 0) {
-        qWarning() << "No manifest entry found to update for GUID:" << entry.cartridgeGuid;
+    return query.numRowsAffected();
+}
+
+QList<ManifestManager::ImportOutcome> ManifestManager::importManifestEntries(QSqlDatabase& database,
+                                                                             const QList<ImportItem>& items)
+{
+    QList<ImportOutcome> outcomes(items.size(), ImportOutcome::Failed);
+    if (!database.isOpen()) {
+        qWarning() << "Database not open for manifest import";
+        return outcomes;
+    }
+
+    // One transaction per batch: a commit per cartridge would dominate
+    // the import of a large archive
+    const bool ownTransaction = database.transaction();
+
+    database::InstrumentedQuery existing(database);
+    existing.prepare(R"(
+        SELECT cartridge_hash, local_path, file_size, file_modified, file_id, location_status
+        FROM Local_Library_Manifest WHERE cartridge_guid = ?
+    )");
+    database::InstrumentedQuery stateUpdate(database);
+    prepareFileStateUpdate(stateUpdate);
+
+    for (int i = 0; i < items.size(); ++i) {
+        const ManifestEntry& entry = items.at(i).entry;
+        if (!entry.isValid()) {
+            qWarning() << "Skipping invalid manifest entry in import:" << entry.cartridgeGuid;
+            continue;
+        }
+
+        existing.addBindValue(entry.cartridgeGuid);
+        if (!existing.exec()) {
+            qWarning() << "Failed to query manifest entry:" << existing.lastError().text();
+            continue;
+        }
+
+        bool written = false;
+        if (existing.next()) {
+            if (existing.value(0).toByteArray() == entry.cartridgeHash
+                && existing.value(1).toString() == entry.localPath) {
+                utils::FileFingerprint stored;
+                stored.size = existing.value(2).isNull() ? -1 : existing.value(2).toLongLong();
+                stored.modifiedMs = existing.value(3).toLongLong();
+                stored.fileId = existing.value(4).toLongLong();
+                const QString storedStatus = existing.value(5).toString();
+                existing.finish();
+
+                // Same content: only refresh the fingerprint, so the file
+                // is not rehashed again until it changes
+                FileState state;
+                state.cartridgeGuid = entry.cartridgeGuid;
+                state.localPath = entry.localPath;
+                state.fingerprint = entry.fingerprint;
+                state.locationStatus = locationStatusOf(entry.locationStatus);
+                if (entry.fingerprint.exists()
+                    && (!stored.matches(entry.fingerprint) || storedStatus != state.locationStatus)) {
+                    updateFileStateRow(stateUpdate, state);
+                }
+                outcomes[i] = ImportOutcome::Unchanged;
+                continue;
+            }
+            existing.finish();
+            written = updateManifestRow(database, entry) > 0;
+            if (written) {
+                outcomes[i] = ImportOutcome::Updated;
+            }
+        } else {
+            existing.finish();
+            written = insertManifestRow(database, entry);
+            if (written) {
+                outcomes[i] = ImportOutcome::Created;
+            }
+        }
+
+        // Rendered on the importing thread; no thumbnails means no cover
+        if (written
+            && !CoverThumbnailStore::storeRendered(database, entry.cartridgeGuid, entry.cartridgeHash,
+                                                   items.at(i).thumbnails)) {
+            qWarning() << "Cover thumbnails not stored for" << entry.cartridgeGuid;
+        }
+    }
+
+    if (ownTransaction && !database.commit()) {
+        qCritical() << "Failed to commit manifest import:" << database.lastError().text();
+        database.rollback();
+        outcomes.fill(ImportOutcome::Failed);
+        return outcomes;
+    }
+
+    // Published only once the rows are visible to readers
+    for (int i = 0; i < items.size(); ++i) {
+        if (outcomes.at(i) == ImportOutcome::Created) {
+            ManifestChangeFeed::getInstance().publish(ManifestChangeFeed::ChangeType::Created,
+                                                      items.at(i).entry.cartridgeGuid);
+        } else if (outcomes.at(i) == ImportOutcome::Updated) {
+            ManifestChangeFeed::getInstance().publish(ManifestChangeFeed::ChangeType::Updated,
+                                                      items.at(i).entry.cartridgeGuid);
+        }
+    }
+    return outcomes;
+}
+
+QList<ManifestManager::FileState> ManifestManager::fileStates(QSqlDatabase& database)
+{
+    QList<FileState> states;
+    if (!database.isOpen()) {
+        qWarning() << "Database not open for file state query";
+        return states;
+    }
+
+    database::InstrumentedQuery query(database);
+    if (!query.exec(R"(
+        SELECT cartridge_guid, local_path, file_size, file_modified, file_id, location_status
+        FROM Local_Library_Manifest
+    )")) {
+        qWarning() << "Failed to query file states:" << query.lastError().text();
+        return states;
+    }
+
+    while (query.next()) {
+        FileState state;
+        state.cartridgeGuid = query.value(0).toString();
+        state.localPath = query.value(1).toString();
+        state.fingerprint.size = query.value(2).isNull() ? -1 : query.value(2).toLongLong();
+        state.fingerprint.modifiedMs = query.value(3).toLongLong();
+        state.fingerprint.fileId = query.value(4).toLongLong();
+        state.locationStatus = query.value(5).toString();
+        states.append(state);
+    }
+    return states;
+}
+
+void ManifestManager::prepareFileStateUpdate(database::InstrumentedQuery& query)
+{
+    query.prepare(R"(
+        UPDATE Local_Library_Manifest
+        SET local_path = ?, file_size = ?, file_modified = ?, file_id = ?, location_status = ?
+        WHERE cartridge_guid = ?
+    )");
+}
+
+bool ManifestManager::updateFileStateRow(database::InstrumentedQuery& query, const FileState& state)
+{
+    query.addBindValue(state.localPath);
+    bindFingerprint(query, state.fingerprint);
+    query.addBindValue(locationStatusOf(state.locationStatus));
+    query.addBindValue(state.cartridgeGuid);
+
+    if (!query.exec()) {
+        qCritical() << "Failed to update file state:" << query.lastError().text();
         return false;
     }
-    
-    return true;
+    return query.numRowsAffected() > 0;
 }
 
-bool ManifestManager::manifestEntryExists(const QString& cartridgeGuid)
+int ManifestManager::updateFileStates(QSqlDatabase& database, const QList<FileState>& states)
+{
+    if (!database.isOpen()) {
+        qWarning() << "Database not open for file state update";
+        return -1;
+    }
+
+    const bool ownTransaction = database.transaction();
+
+    database::InstrumentedQuery query(database);
+    prepareFileStateUpdate(query);
+
+    QStringList updated;
+    for (const FileState& state : states) {
+        if (updateFileStateRow(query, state)) {
+            updated.append(state.cartridgeGuid);
+        }
+    }
+
+    if (ownTransaction && !database.commit()) {
+        qCritical() << "Failed to commit file states:" << database.lastError().text();
+        database.rollback();
+        return -1;
+    }
+
+    for (const QString& cartridgeGuid : updated) {
+        ManifestChangeFeed::getInstance().publish(ManifestChangeFeed::ChangeType::Updated, cartridgeGuid);
+    }
+    return updated.size();
+}
+
+bool ManifestManager::manifestEntryExists(QSqlDatabase& database, const QString& cartridgeGuid)
 {
-    if (!m_dbManager->isOpen()) {
+    if (!database.isOpen()) {
         return false;
     }
     
-    QSqlQuery query(m_dbManager->getDatabase());
+    database::InstrumentedQuery query(database);
     query.prepare("SELECT COUNT(*) FROM Local_Library_Manifest WHERE cartridge_guid = ?");
     query.addBindValue(cartridgeGuid);
     
@@ -160,9 +519,9 @@ bool ManifestManager::manifestEntryExists(const QString& cartridgeGuid)
     return false;
 }
 
-bool ManifestManager::deleteManifestEntry(const QString& cartridgeGuid)
+bool ManifestManager::deleteManifestEntry(QSqlDatabase& database, const QString& cartridgeGuid)
 {
-    if (!m_dbManager->isOpen()) {
+    if (!database.isOpen()) {
         qWarning() << "Database not open for manifest entry deletion";
         return false;
     }
@@ -172,7 +531,7 @@ bool ManifestManager::deleteManifestEntry(const QString& cartridgeGuid)
         return false;
     }
     
-    QSqlQuery query(m_dbManager->getDatabase());
+    database::InstrumentedQuery query(database);
     query.prepare("DELETE FROM Local_Library_Manifest WHERE cartridge_guid = ?");
     query.addBindValue(cartridgeGuid);
     
@@ -187,6 +546,30 @@ bool ManifestManager::deleteManifestEntry(const QString& cartridgeGuid)
         return false;
     }
     
+    ManifestChangeFeed::getInstance().publish(ManifestChangeFeed::ChangeType::Deleted, cartridgeGuid);
+    return true;
+}
+
+bool ManifestManager::recordOpened(QSqlDatabase& database, const QString& cartridgeGuid)
+{
+    if (!database.isOpen() || cartridgeGuid.isEmpty()) {
+        return false;
+    }
+
+    // Feeds the "recently opened" sort (LibraryModel::LastOpenedSortKey)
+    database::InstrumentedQuery query(database);
+    query.prepare("UPDATE Local_Library_Manifest SET last_opened = ? WHERE cartridge_guid = ?");
+    query.addBindValue(QDateTime::currentSecsSinceEpoch());
+    query.addBindValue(cartridgeGuid);
+    if (!query.exec()) {
+        qWarning() << "Failed to record cartridge opened:" << query.lastError().text();
+        return false;
+    }
+    if (query.numRowsAffected() == 0) {
+        return false;
+    }
+
+    ManifestChangeFeed::getInstance().publish(ManifestChangeFeed::ChangeType::Updated, cartridgeGuid);
     return true;
 }
 
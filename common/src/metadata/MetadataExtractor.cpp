@@ -1,7 +1,7 @@
 #include "smartbook/common/metadata/MetadataExtractor.h"
+#include "smartbook/common/database/NativeSqlite.h"
 #include <QDir>
-#include <QSqlDatabase>
-#include <QSqlQuery>
+#include <QFile>
 #include <QFileInfo>
 #include <QDebug>
 
@@ -12,38 +12,39 @@ namespace metadata {
 CartridgeMetadata MetadataExtractor::extractMetadata(const QString& cartridgePath) {
     CartridgeMetadata metadata;
 
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "MetadataExtract");
-    db.setDatabaseName(cartridgePath);
-
-    if (!db.open()) {
+    // Own read-only connection per call: imports extract from many
+    // cartridges at once on worker threads. Where NativeConnection falls
+    // back to QtSql, that is a uniquely named QSqlDatabase, so parallel
+    // calls never share or collide on a connection name
+    database::NativeConnection connection;
+    if (!connection.open(cartridgePath, database::CartridgeOpenMode::ReadOnly,
+                         database::ConnectionRole::Reader)) {
         qWarning() << "Failed to open cartridge for metadata extraction:" << cartridgePath;
         return metadata;
     }
 
-    QSqlQuery query(db);
-
-    // Extract from Metadata table
-    if (query.exec("SELECT cartridge_guid, title, author, publisher, version, publication_year, series_name, edition_name, series_order, schema_version FROM Metadata LIMIT 1")) {
-        if (query.next()) {
-            metadata.cartridgeGuid = query.value(0).toString();
-            metadata.title = query.value(1).toString();
-            metadata.author = query.value(2).toString();
-            metadata.publisher = query.value(3).toString();
-            metadata.version = query.value(4).toString();
-            metadata.publicationYear = query.value(5).toString();
-            metadata.seriesName = query.value(6).toString();
-            metadata.editionName = query.value(7).toString();
-            metadata.seriesOrder = query.value(8).toInt();
-            metadata.schemaVersion = query.value(9).toString();
-        }
-    }
-
-    // Extract cover image
+    // Extract from Metadata table; cartridges from older creators lack
+    // the series and cover columns, so columns are looked up by name
     QString coverImagePath;
-    if (query.exec("SELECT cover_image_path FROM Metadata LIMIT 1")) {
-        if (query.next()) {
-            coverImagePath = query.value(0).toString();
-        }
+    database::NativeStatement query = connection.prepare("SELECT * FROM Metadata LIMIT 1");
+    if (query.isValid() && query.step()) {
+        auto text = [&query](const char* column) {
+            const int index = query.columnIndex(QString::fromLatin1(column));
+            return index >= 0 ? query.columnString(index) : QString();
+        };
+        metadata.cartridgeGuid = text("cartridge_guid");
+        metadata.title = text("title");
+        metadata.author = text("author");
+        metadata.publisher = text("publisher");
+        metadata.version = text("version");
+        metadata.publicationYear = text("publication_year");
+        metadata.seriesName = text("series_name");
+        metadata.editionName = text("edition_name");
+        metadata.schemaVersion = text("schema_version");
+        coverImagePath = text("cover_image_path");
+
+        const int seriesOrder = query.columnIndex("series_order");
+        metadata.seriesOrder = seriesOrder >= 0 ? query.columnInt(seriesOrder) : 0;
     }
 
     // Load cover image if path is relative
@@ -56,9 +57,6 @@ CartridgeMetadata MetadataExtractor::extractMetadata(const QString& cartridgePat
         }
     }
 
-    db.close();
-    QSqlDatabase::removeDatabase("MetadataExtract");
-
     return metadata;
 }
 
@@ -1,10 +1,12 @@
 #include "smartbook/common/security/SignatureVerifier.h"
 #include <QtSql/QSqlRecord>
 #include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/database/NativeSqlite.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QCryptographicHash>
+#include <QLocale>
 #include <QDebug>
 
 namespace smartbook {
@@ -55,10 +57,12 @@ VerificationResult SignatureVerifier::verifyCartridge(const QString& cartridgePa
 }
 
 QByteArray SignatureVerifier::calculateContentHash(const QString& cartridgePath) {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "HashCalc");
-    db.setDatabaseName(cartridgePath);
-
-    if (!db.open()) {
+    // Native scan: every column of every row is hashed, so skipping the
+    // per-value QVariant matters. Full-table scan profile: large mmap,
+    // small page cache
+    database::NativeConnection connection;
+    if (!connection.open(cartridgePath, database::CartridgeOpenMode::ReadOnly,
+                         database::ConnectionRole::Verifier)) {
         qWarning() << "Failed to open cartridge for hash calculation";
         return QByteArray();
     }
@@ -68,25 +72,39 @@ QByteArray SignatureVerifier::calculateContentHash(const QString& cartridgePath)
     // Hash tables in fixed order: Content_Pages, Content_Themes, Embedded_Apps, Form_Definitions, Metadata, Settings
     QStringList tables = {"Content_Pages", "Content_Themes", "Embedded_Apps", "Form_Definitions", "Metadata", "Settings"};
 
+    QByteArray rowData;
     for (const QString& tableName : tables) {
-        QSqlQuery query(db);
-        QString tableQuery = QString("SELECT * FROM %1 ORDER BY rowid").arg(tableName);
-        
-        if (!query.exec(tableQuery)) {
+        database::NativeStatement query = connection.prepare(
+            QString("SELECT * FROM %1 ORDER BY rowid").arg(tableName));
+        if (!query.isValid()) {
             // Table might not exist, hash empty
-            hash.addData(QByteArray());
             continue;
         }
 
-        // Hash each row
-        while (query.next()) {
-            QByteArray rowData;
-            for (int i = 0; i < query.record().count(); ++i) {
-                QVariant value = query.value(i);
-                if (value.isNull()) {
+        // Hash each row; values are encoded as their QVariant::toString()
+        // text so hashes match cartridges signed by earlier versions
+        const int columnCount = query.columnCount();
+        while (query.step()) {
+            rowData.clear();
+            for (int i = 0; i < columnCount; ++i) {
+                switch (query.columnType(i)) {
+                case database::NativeStatement::ColumnType::Null:
                     rowData.append('\0');
-                } else {
-                    rowData.append(value.toString().toUtf8());
+                    break;
+                case database::NativeStatement::ColumnType::Integer:
+                    rowData.append(QByteArray::number(query.columnInt64(i)));
+                    break;
+                case database::NativeStatement::ColumnType::Float:
+                    rowData.append(QString::number(query.columnDouble(i), 'g',
+                                                   QLocale::FloatingPointShortest).toUtf8());
+                    break;
+                case database::NativeStatement::ColumnType::Text:
+                    // Stored UTF-8, which is what toString().toUtf8() produced
+                    rowData.append(query.columnBlob(i));
+                    break;
+                case database::NativeStatement::ColumnType::Blob:
+                    rowData.append(QString::fromUtf8(query.columnBlob(i)).toUtf8());
+                    break;
                 }
             }
             hash.addData(rowData);
@@ -94,58 +112,46 @@ QByteArray SignatureVerifier::calculateContentHash(const QString& cartridgePath)
         }
     }
 
-    db.close();
-    QSqlDatabase::removeDatabase("HashCalc");
-
     return hash.result();
 }
 
 bool SignatureVerifier::phase1_Identity(const QString& cartridgePath, QString& cartridgeGuid, QByteArray& h1Hash, SecurityLevel& level) {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "Phase1");
-    db.setDatabaseName(cartridgePath);
-
-    if (!db.open()) {
+    // Own connection per call, so cartridges can be verified in parallel
+    database::NativeConnection connection;
+    if (!connection.open(cartridgePath, database::CartridgeOpenMode::ReadOnly,
+                         database::ConnectionRole::Verifier)) {
         return false;
     }
 
-    QSqlQuery query(db);
-
     // Read cartridge GUID
-    if (query.exec("SELECT cartridge_guid FROM Metadata LIMIT 1")) {
-        if (query.next()) {
-            cartridgeGuid = query.value(0).toString();
-        }
+    database::NativeStatement query = connection.prepare("SELECT cartridge_guid FROM Metadata LIMIT 1");
+    if (query.isValid() && query.step()) {
+        cartridgeGuid = query.columnString(0);
     }
 
     // Read security data
-    if (query.exec("SELECT hash_digest, certificate_data FROM Cartridge_Security LIMIT 1")) {
-        if (query.next()) {
-            h1Hash = query.value(0).toByteArray();
-            QByteArray certData = query.value(1).toByteArray();
-            
-            if (!certData.isEmpty()) {
-                // Check if CA-signed or self-signed
-                // For now, use a simple heuristic: if cert data contains "CA_SIGNED" marker,
-                // treat as Level 1. In production, this would use QSslCertificate to verify
-                // against system CA store.
-                if (certData.contains("CA_SIGNED")) {
-                    level = SecurityLevel::LEVEL_1;
-                } else {
-                    level = SecurityLevel::LEVEL_2; // Self-signed
-                }
+    query = connection.prepare("SELECT hash_digest, certificate_data FROM Cartridge_Security LIMIT 1");
+    if (query.isValid() && query.step()) {
+        h1Hash = query.columnBytes(0);
+        QByteArray certData = query.columnBytes(1);
+        
+        if (!certData.isEmpty()) {
+            // Check if CA-signed or self-signed
+            // For now, use a simple heuristic: if cert data contains "CA_SIGNED" marker,
+            // treat as Level 1. In production, this would use QSslCertificate to verify
+            // against system CA store.
+            if (certData.contains("CA_SIGNED")) {
+                level = SecurityLevel::LEVEL_1;
             } else {
-                level = SecurityLevel::LEVEL_3; // No certificate
+                level = SecurityLevel::LEVEL_2; // Self-signed
             }
         } else {
-            level = SecurityLevel::LEVEL_3;
+            level = SecurityLevel::LEVEL_3; // No certificate
         }
     } else {
         level = SecurityLevel::LEVEL_3;
     }
 
-    db.close();
-    QSqlDatabase::removeDatabase("Phase1");
-
     return !cartridgeGuid.isEmpty();
 }
 
@@ -171,12 +177,13 @@ TrustPolicy SignatureVerifier::phase3_LocalTrust(const QString& cartridgeGuid, b
         return TrustPolicy::REJECTED;
     }
 
-    database::LocalDBManager& dbManager = database::LocalDBManager::getInstance();
-    if (!dbManager.isOpen()) {
+    // Per-thread read connection: verification may run off the GUI thread
+    QSqlDatabase localDb = database::LocalDBManager::getInstance().readConnection();
+    if (!localDb.isOpen()) {
         return TrustPolicy::CONSENT_REQUIRED;
     }
 
-    QSqlQuery query(dbManager.getDatabase());
+    QSqlQuery query(localDb);
     query.prepare("SELECT trust_policy FROM Local_Trust_Registry WHERE cartridge_guid = ?");
     query.addBindValue(cartridgeGuid);
 
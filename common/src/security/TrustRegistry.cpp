@@ -1,5 +1,5 @@
 #include "smartbook/common/security/TrustRegistry.h"
-#include <QSqlQuery>
+#include "smartbook/common/database/InstrumentedQuery.h"
 #include <QSqlError>
 #include <QDateTime>
 #include <QDebug>
@@ -16,12 +16,52 @@ TrustRegistry::TrustRegistry(QObject* parent)
 
 bool TrustRegistry::storeTrustDecision(const QString& cartridgeGuid, TrustPolicy policy)
 {
-    if (!m_dbManager->isOpen()) {
+    // Serialized through the single writer connection
+    return m_dbManager->write([cartridgeGuid, policy](QSqlDatabase& database) {
+        return storeTrustDecision(database, cartridgeGuid, policy);
+    });
+}
+
+TrustRegistry::TrustPolicy TrustRegistry::getTrustDecision(const QString& cartridgeGuid)
+{
+    QSqlDatabase database = m_dbManager->readConnection();
+    return getTrustDecision(database, cartridgeGuid);
+}
+
+QFuture<bool> TrustRegistry::storeTrustDecisionAsync(const QString& cartridgeGuid, TrustPolicy policy, Priority priority)
+{
+    return m_dbManager->executor().submit([cartridgeGuid, policy](QSqlDatabase& database) {
+        return storeTrustDecision(database, cartridgeGuid, policy);
+    }, priority);
+}
+
+QFuture<TrustRegistry::TrustPolicy> TrustRegistry::getTrustDecisionAsync(const QString& cartridgeGuid, Priority priority)
+{
+    return m_dbManager->executor().submit([cartridgeGuid](QSqlDatabase& database) {
+        return getTrustDecision(database, cartridgeGuid);
+    }, priority);
+}
+
+QFuture<bool> TrustRegistry::revokeTrustAsync(const QString& cartridgeGuid, Priority priority)
+{
+    return storeTrustDecisionAsync(cartridgeGuid, TrustPolicy::REVOKED, priority);
+}
+
+QFuture<bool> TrustRegistry::hasPersistentTrustAsync(const QString& cartridgeGuid, Priority priority)
+{
+    return m_dbManager->executor().submit([cartridgeGuid](QSqlDatabase& database) {
+        return getTrustDecision(database, cartridgeGuid) == TrustPolicy::PERSISTENT;
+    }, priority);
+}
+
+bool TrustRegistry::storeTrustDecision(QSqlDatabase& database, const QString& cartridgeGuid, TrustPolicy policy)
+{
+    if (!database.isOpen()) {
         qWarning() << "Database not open for trust decision storage";
         return false;
     }
     
-    QSqlQuery query(m_dbManager->getDatabase());
+    database::InstrumentedQuery query(database);
     
     // Check if entry exists
     query.prepare("SELECT COUNT(*) FROM Local_Trust_Registry WHERE cartridge_guid = ?");
@@ -48,7 +88,7 @@ bool TrustRegistry::storeTrustDecision(const QString& cartridgeGuid, TrustPolicy
         // Insert new entry (but first ensure manifest entry exists for foreign key)
         // For testing, we may need to create a manifest entry first
         // Check if manifest entry exists
-        QSqlQuery manifestQuery(m_dbManager->getDatabase());
+        database::InstrumentedQuery manifestQuery(database);
         manifestQuery.prepare("SELECT COUNT(*) FROM Local_Library_Manifest WHERE cartridge_guid = ?");
         manifestQuery.addBindValue(cartridgeGuid);
         
@@ -59,7 +99,7 @@ bool TrustRegistry::storeTrustDecision(const QString& cartridgeGuid, TrustPolicy
         
         if (!manifestExists) {
             // Create a minimal manifest entry for foreign key constraint
-            QSqlQuery insertManifest(m_dbManager->getDatabase());
+            database::InstrumentedQuery insertManifest(database);
             insertManifest.prepare(R"(
                 INSERT INTO Local_Library_Manifest 
                 (cartridge_guid, cartridge_hash, local_path, title, author, publication_year)
@@ -94,13 +134,13 @@ bool TrustRegistry::storeTrustDecision(const QString& cartridgeGuid, TrustPolicy
     return true;
 }
 
-TrustRegistry::TrustPolicy TrustRegistry::getTrustDecision(const QString& cartridgeGuid)
+TrustRegistry::TrustPolicy TrustRegistry::getTrustDecision(QSqlDatabase& database, const QString& cartridgeGuid)
 {
-    if (!m_dbManager->isOpen()) {
+    if (!database.isOpen()) {
         return TrustPolicy::PERSISTENT; // Default
     }
     
-    QSqlQuery query(m_dbManager->getDatabase());
+    database::InstrumentedQuery query(database);
     query.prepare("SELECT trust_policy FROM Local_Trust_Registry WHERE cartridge_guid = ?");
     query.addBindValue(cartridgeGuid);
     
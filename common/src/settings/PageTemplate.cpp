@@ -0,0 +1,93 @@
+#include "smartbook/common/settings/PageTemplate.h"
+#include "smartbook/common/settings/SettingsManager.h"
+#include <QString>
+#include <cstring>
+
+namespace smartbook {
+namespace common {
+namespace settings {
+
+namespace {
+const char HEAD[] = R"(<!DOCTYPE html>
+<html>
+<head>
+    <meta charset="UTF-8">
+    <meta name="viewport" content="width=device-width, initial-scale=1.0">
+    <style>
+)";
+const char BODY[] = R"(</style>
+</head>
+<body>
+)";
+const char TAIL[] = R"(
+</body>
+</html>
+)";
+
+char* append(char* out, const char* data, qsizetype size) {
+    if (size > 0) {
+        std::memcpy(out, data, size_t(size));
+    }
+    return out + size;
+}
+}
+
+PageTemplate::PageTemplate()
+    : m_head(HEAD)
+    , m_settingsCss("\n    ")      // Indents the closing style tag
+    , m_body(BODY)
+    , m_tail(TAIL)
+{
+}
+
+PageTemplate PageTemplate::compile(const SettingsManager& settings) {
+    const QString fontSize = settings.getSetting("default_font_size", "12");
+    const QString fontFamily = settings.getSetting("default_font_family", "serif");
+    const QString lineSpacing = settings.getSetting("line_spacing", "1.5");
+    const QString textAlignment = settings.getSetting("text_alignment", "left");
+
+    // Settings as CSS variables and styles, after the page's CSS
+    const QString settingsCss = QString(R"(
+        :root {
+            --font-size: %1pt;
+            --font-family: %2;
+            --line-spacing: %3;
+            --text-align: %4;
+        }
+        body {
+            font-size: var(--font-size);
+            font-family: var(--font-family);
+            line-height: var(--line-spacing);
+            text-align: var(--text-align);
+        }
+    )").arg(fontSize, fontFamily, lineSpacing, textAlignment);
+
+    PageTemplate compiled;
+    compiled.m_settingsCss += settingsCss.toUtf8();
+    compiled.m_generation = settings.generation();
+    compiled.m_compiled = true;
+    return compiled;
+}
+
+bool PageTemplate::isCurrent(const SettingsManager& settings) const {
+    return m_compiled && m_generation == settings.generation();
+}
+
+QByteArray PageTemplate::render(QUtf8StringView htmlContent, QUtf8StringView css) const {
+    const qsizetype size = m_head.size() + css.size() + m_settingsCss.size() + m_body.size()
+                           + htmlContent.size() + m_tail.size();
+    QByteArray document(size, Qt::Uninitialized);
+
+    char* out = document.data();
+    out = append(out, m_head.constData(), m_head.size());
+    out = append(out, css.data(), css.size());
+    out = append(out, m_settingsCss.constData(), m_settingsCss.size());
+    out = append(out, m_body.constData(), m_body.size());
+    out = append(out, htmlContent.data(), htmlContent.size());
+    append(out, m_tail.constData(), m_tail.size());
+    return document;
+}
+
+} // namespace settings
+} // namespace common
+} // namespace smartbook
@@ -1,7 +1,7 @@
 #include "smartbook/common/settings/SettingsManager.h"
 #include "smartbook/common/database/LocalDBManager.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
-#include <QSqlQuery>
+#include "smartbook/common/database/InstrumentedQuery.h"
 #include <QSqlError>
 #include <QDateTime>
 #include <QSet>
@@ -11,6 +11,15 @@ namespace smartbook {
 namespace common {
 namespace settings {
 
+namespace {
+
+// Key prefix for this cartridge's overrides in the local write coalescer
+QString pendingPrefix(const QString& cartridgeGuid) {
+    return QString("setting/%1/").arg(cartridgeGuid);
+}
+
+} // namespace
+
 SettingsManager::SettingsManager(QObject* parent)
     : QObject(parent)
 {
@@ -28,28 +37,35 @@ bool SettingsManager::loadSettings(const QString& cartridgeGuid, const QString&
     // Load user overrides from local database
     loadUserOverrides(cartridgeGuid);
     
+    bumpGeneration();
     return true;
 }
 
+void SettingsManager::bumpGeneration()
+{
+    ++m_generation;
+    emit settingsChanged();
+}
+
 void SettingsManager::loadAuthorSettings(const QString& cartridgePath)
 {
     // Open cartridge database
     database::CartridgeDBConnector connector(this);
-    if (!connector.openCartridge(cartridgePath)) {
+    if (!connector.openCartridge(cartridgePath, database::CartridgeOpenMode::ReadOnly)) {
         qWarning() << "Failed to open cartridge for settings:" << cartridgePath;
         return;
     }
     
     // Query Settings table from cartridge
-    QSqlQuery query = connector.executeQuery(
+    database::PreparedQuery query = connector.executePrepared(
         "SELECT setting_key, setting_value, setting_type FROM Settings"
     );
     
-    while (query.next()) {
+    while (query.isPrepared() && query->next()) {
         SettingValue setting;
-        QString key = query.value(0).toString();
-        setting.value = query.value(1).toString();
-        setting.type = query.value(2).toString();
+        QString key = query->value(0).toString();
+        setting.value = query->value(1).toString();
+        setting.type = query->value(2).toString();
         
         if (setting.isValid()) {
             m_authorSettings[key] = setting;
@@ -67,8 +83,8 @@ void SettingsManager::loadUserOverrides(const QString& cartridgeGuid)
         return;
     }
     
-    // Query Local_User_Settings table
-    QSqlQuery query(dbManager.getDatabase());
+    // Query Local_User_Settings table on this thread's read connection
+    database::InstrumentedQuery query(dbManager.readConnection());
     query.prepare(R"(
         SELECT setting_key, setting_value
         FROM Local_User_Settings
@@ -86,6 +102,15 @@ void SettingsManager::loadUserOverrides(const QString& cartridgeGuid)
         QString value = query.value(1).toString();
         m_userOverrides[key] = value;
     }
+    query.finish();
+    
+    // Overrides not yet flushed are newer than the stored ones
+    if (database::WriteCoalescer* pending = dbManager.writeCoalescer()) {
+        const QHash<QString, QVariant> buffered = pending->pendingWithPrefix(pendingPrefix(cartridgeGuid));
+        for (auto it = buffered.constBegin(); it != buffered.constEnd(); ++it) {
+            m_userOverrides[it.key()] = it.value().toString();
+        }
+    }
 }
 
 QString SettingsManager::getSetting(const QString& settingKey, const QString& defaultValue) const
@@ -147,26 +172,45 @@ bool SettingsManager::setUserOverride(const QString& settingKey, const QString&
         return false;
     }
     
-    QSqlQuery query(dbManager.getDatabase());
-    
-    // Use INSERT OR REPLACE to update existing override
-    query.prepare(R"(
-        INSERT OR REPLACE INTO Local_User_Settings
-        (cartridge_guid, setting_key, setting_value, timestamp)
-        VALUES (?, ?, ?, ?)
-    )");
-    query.addBindValue(m_cartridgeGuid);
-    query.addBindValue(settingKey);
-    query.addBindValue(value);
-    query.addBindValue(QDateTime::currentSecsSinceEpoch());
-    
-    if (!query.exec()) {
-        qWarning() << "Failed to save user setting override:" << query.lastError().text();
+    database::WriteCoalescer* pending = dbManager.writeCoalescer();
+    if (!pending) {
+        qWarning() << "Local database not open for setting override";
         return false;
     }
     
+    const QString cartridgeGuid = m_cartridgeGuid;
+    const qint64 timestamp = QDateTime::currentSecsSinceEpoch();
+    
+    // Buffered and written with other pending writes in one transaction
+    // on the single writer connection
+    pending->enqueue(pendingPrefix(cartridgeGuid) + settingKey, value,
+                     [cartridgeGuid, settingKey, value, timestamp](QSqlDatabase& database) {
+        database::InstrumentedQuery query(database);
+        
+        // Use INSERT OR REPLACE to update existing override
+        query.prepare(R"(
+            INSERT OR REPLACE INTO Local_User_Settings
+            (cartridge_guid, setting_key, setting_value, timestamp)
+            VALUES (?, ?, ?, ?)
+        )");
+        query.addBindValue(cartridgeGuid);
+        query.addBindValue(settingKey);
+        query.addBindValue(value);
+        query.addBindValue(timestamp);
+        
+        if (!query.exec()) {
+            qWarning() << "Failed to save user setting override:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    });
+    
     // Update in-memory cache
-    m_userOverrides[settingKey] = value;
+    const auto current = m_userOverrides.constFind(settingKey);
+    if (current == m_userOverrides.constEnd() || *current != value) {
+        m_userOverrides[settingKey] = value;
+        bumpGeneration();
+    }
     
     return true;
 }
@@ -184,20 +228,37 @@ bool SettingsManager::resetToAuthorDefaults()
         return false;
     }
     
-    QSqlQuery query(dbManager.getDatabase());
-    query.prepare(R"(
-        DELETE FROM Local_User_Settings
-        WHERE cartridge_guid = ?
-    )");
-    query.addBindValue(m_cartridgeGuid);
+    const QString cartridgeGuid = m_cartridgeGuid;
     
-    if (!query.exec()) {
-        qWarning() << "Failed to reset user settings:" << query.lastError().text();
+    // Unflushed overrides would otherwise be written back after the delete
+    if (database::WriteCoalescer* pending = dbManager.writeCoalescer()) {
+        pending->discard(pendingPrefix(cartridgeGuid));
+    }
+    
+    bool reset = dbManager.write([cartridgeGuid](QSqlDatabase& database) {
+        database::InstrumentedQuery query(database);
+        query.prepare(R"(
+            DELETE FROM Local_User_Settings
+            WHERE cartridge_guid = ?
+        )");
+        query.addBindValue(cartridgeGuid);
+        
+        if (!query.exec()) {
+            qWarning() << "Failed to reset user settings:" << query.lastError().text();
+            return false;
+        }
+        return true;
+    });
+    
+    if (!reset) {
         return false;
     }
     
     // Clear in-memory cache
-    m_userOverrides.clear();
+    if (!m_userOverrides.isEmpty()) {
+        m_userOverrides.clear();
+        bumpGeneration();
+    }
     
     return true;
 }
@@ -0,0 +1,53 @@
+#include "smartbook/common/utils/FileFingerprint.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace smartbook {
+namespace common {
+namespace utils {
+
+bool FileFingerprint::matches(const FileFingerprint& other) const {
+    if (size != other.size || modifiedMs != other.modifiedMs) {
+        return false;
+    }
+    return fileId == 0 || other.fileId == 0 || fileId == other.fileId;
+}
+
+FileFingerprint FileFingerprint::of(const QString& path) {
+    FileFingerprint fingerprint;
+
+#ifdef Q_OS_UNIX
+    // One stat for all three; QFileInfo does not expose the inode
+    struct stat status;
+    if (::stat(QFile::encodeName(path).constData(), &status) != 0 || !S_ISREG(status.st_mode)) {
+        return fingerprint;
+    }
+    fingerprint.size = static_cast<qint64>(status.st_size);
+#if defined(Q_OS_DARWIN)
+    fingerprint.modifiedMs = static_cast<qint64>(status.st_mtimespec.tv_sec) * 1000
+                           + status.st_mtimespec.tv_nsec / 1000000;
+#else
+    fingerprint.modifiedMs = static_cast<qint64>(status.st_mtim.tv_sec) * 1000
+                           + status.st_mtim.tv_nsec / 1000000;
+#endif
+    fingerprint.fileId = static_cast<qint64>(status.st_ino);
+#else
+    const QFileInfo info(path);
+    if (!info.isFile()) {
+        return fingerprint;
+    }
+    fingerprint.size = info.size();
+    fingerprint.modifiedMs = info.lastModified().toMSecsSinceEpoch();
+#endif
+
+    return fingerprint;
+}
+
+} // namespace utils
+} // namespace common
+} // namespace smartbook
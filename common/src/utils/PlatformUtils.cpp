@@ -6,6 +6,7 @@
 #include <windows.h>
 #elif defined(Q_OS_MACOS)
 #include <TargetConditionals.h>
+#include <sys/sysctl.h>
 #elif defined(Q_OS_LINUX)
 #include <unistd.h>
 #endif
@@ -36,6 +37,33 @@ QString PlatformUtils::getArchitecture() {
 #endif
 }
 
+qint64 PlatformUtils::getPhysicalMemory() {
+#ifdef Q_OS_WIN
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status)) {
+        return qint64(status.ullTotalPhys);
+    }
+    return 0;
+#elif defined(Q_OS_MACOS)
+    int64_t size = 0;
+    size_t length = sizeof(size);
+    if (sysctlbyname("hw.memsize", &size, &length, nullptr, 0) == 0) {
+        return qint64(size);
+    }
+    return 0;
+#elif defined(Q_OS_LINUX)
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && pageSize > 0) {
+        return qint64(pages) * pageSize;
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
 QString PlatformUtils::getApplicationDataDirectory() {
     QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QDir().mkpath(path);
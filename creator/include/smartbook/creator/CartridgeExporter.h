@@ -62,6 +62,17 @@ public:
      */
     bool packageResources(const QString& sourceCartridgePath, const QString& targetCartridgePath);
 
+    /**
+     * @brief Build the full-text search index into a cartridge
+     *
+     * Runs on the cartridge's pooled connection (CartridgeDBConnector), so
+     * the idle lease the Creator keeps on the file is the only writer.
+     *
+     * @param cartridgePath Path to cartridge file
+     * @return true if the index was built, false otherwise
+     */
+    bool buildSearchIndex(const QString& cartridgePath);
+
 signals:
     void exportProgress(int percentage);
     void exportComplete(bool success, const QString& errorMessage);
@@ -1,5 +1,7 @@
 #include "smartbook/creator/CartridgeExporter.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include "smartbook/common/database/CartridgeSearchIndex.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
@@ -7,6 +9,8 @@
 #include <QHash>
 #include <QVariant>
 #include <QCryptographicHash>
+#include <QLocale>
+#include <QtEndian>
 #include <QFile>
 #include <QFileInfo>
 #include <QSslCertificate>
@@ -69,6 +73,13 @@ bool CartridgeExporter::exportCartridge(const QString& cartridgePath, const QHas
         qWarning() << "Failed to package content pages, but continuing export";
         // Don't fail export if content packaging fails - might be a new cartridge
     }
+
+    emit exportProgress(70);
+
+    // Ship the full-text index so readers do not have to build one
+    if (!buildSearchIndex(cartridgePath)) {
+        qWarning() << "Failed to build search index, readers will index the cartridge themselves";
+    }
     
     emit exportProgress(80);
     
@@ -594,6 +605,16 @@ bool CartridgeExporter::createCartridgeSchema(const QString& cartridgePath) {
         return false;
     }
 
+    // The reader's table of contents reads one level at a time
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_navigation_group "
+                    "ON Navigation_Structure(group_name, parent_item_id, item_order)")
+        || !query.exec("CREATE INDEX IF NOT EXISTS idx_navigation_parent "
+                       "ON Navigation_Structure(parent_item_id, item_order)")) {
+        qCritical() << "Failed to create Navigation_Structure indexes:" << query.lastError().text();
+        db.close();
+        return false;
+    }
+
     db.close();
     QSqlDatabase::removeDatabase("CartridgeCreate");
 
@@ -677,6 +698,25 @@ bool CartridgeExporter::packageContentPages(const QString& sourceCartridgePath,
     return success;
 }
 
+bool CartridgeExporter::buildSearchIndex(const QString& cartridgePath) {
+    // Write through the pooled connection the Creator keeps open on the
+    // file, not a second writer next to it
+    common::database::CartridgeDBConnector connector;
+    if (!connector.openCartridge(cartridgePath, common::database::CartridgeOpenMode::ReadWrite,
+                                 common::database::ConnectionRole::Creator)) {
+        return false;
+    }
+
+    bool built = false;
+    {
+        common::database::NativeConnection connection;
+        built = connection.attach(connector.getDatabase())
+                && common::database::CartridgeSearchIndex::buildIndex(connection);
+    }
+    connector.closeCartridge();
+    return built;
+}
+
 bool CartridgeExporter::packageMetadata(const QString& sourceCartridgePath, const QString& targetCartridgePath) {
     // If source and target are the same, metadata is already in place
     if (sourceCartridgePath == targetCartridgePath) {
@@ -894,10 +934,12 @@ bool CartridgeExporter::packageResources(const QString& sourceCartridgePath, con
 }
 
 QByteArray CartridgeExporter::calculateContentHash(const QString& cartridgePath) {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "HashCalc");
-    db.setDatabaseName(cartridgePath);
-    
-    if (!db.open()) {
+    // Native scan: every column of every row is hashed, so skipping the
+    // per-value QVariant (and the by-name lookup) matters. Full-table scan
+    // profile: large mmap, small page cache
+    common::database::NativeConnection connection;
+    if (!connection.open(cartridgePath, common::database::CartridgeOpenMode::ReadOnly,
+                         common::database::ConnectionRole::Verifier)) {
         qWarning() << "Failed to open cartridge for hash calculation:" << cartridgePath;
         return QByteArray();
     }
@@ -916,7 +958,6 @@ QByteArray CartridgeExporter::calculateContentHash(const QString& cartridgePath)
         QByteArray tablePrefix = tableNameHashResult.left(4);
         
         // Query rows ordered by primary key
-        QSqlQuery query(db);
         QString orderBy;
         
         if (tableName == "Content_Pages") {
@@ -934,24 +975,19 @@ QByteArray CartridgeExporter::calculateContentHash(const QString& cartridgePath)
         }
         
         QString queryStr = QString("SELECT * FROM %1 %2").arg(tableName, orderBy);
+        common::database::NativeStatement query = connection.prepare(queryStr);
         
-        if (!query.exec(queryStr)) {
-            // Table might not exist, hash empty table
-            QCryptographicHash emptyHash(QCryptographicHash::Sha256);
-            emptyHash.addData(QByteArray());
-            QByteArray emptyTableHash = emptyHash.result();
-            tableHashes.append(tablePrefix + emptyTableHash);
+        // Table might not exist: hash of the empty table
+        QCryptographicHash tableHash(QCryptographicHash::Sha256);
+        if (!query.isValid()) {
+            tableHashes.append(tablePrefix + tableHash.result());
             continue;
         }
         
-        // Serialize all rows
-        QByteArray rowData;
-        QSqlRecord record = query.record();
-        
         // Get column names and sort alphabetically
         QStringList columnNames;
-        for (int i = 0; i < record.count(); ++i) {
-            QString colName = record.fieldName(i);
+        for (int i = 0; i < query.columnCount(); ++i) {
+            QString colName = query.columnName(i);
             // For Metadata table, only include specified fields
             if (tableName == "Metadata") {
                 QStringList allowedFields = {"title", "author", "version", "publication_year", 
@@ -965,47 +1001,46 @@ QByteArray CartridgeExporter::calculateContentHash(const QString& cartridgePath)
         }
         columnNames.sort();
         
-        while (query.next()) {
-            // Serialize row in alphabetical column order
-            for (const QString& colName : columnNames) {
-                QVariant value = query.value(colName);
-                
-                if (value.isNull()) {
+        // Resolve the alphabetical order to column indexes once per table
+        QList<int> columns;
+        for (const QString& colName : columnNames) {
+            columns.append(query.columnIndex(colName));
+        }
+        
+        // Serialize rows and feed them to the table hash one at a time
+        QByteArray rowData;
+        while (query.step()) {
+            rowData.clear();
+            for (int column : columns) {
+                switch (query.columnType(column)) {
+                case common::database::NativeStatement::ColumnType::Null:
                     rowData.append('\0'); // NULL marker
-                } else {
-                    QMetaType type = value.metaType();
-                    if (type.id() == QMetaType::QString || type.id() == QMetaType::QByteArray) {
-                        // TEXT or BLOB: UTF-8 for text, raw bytes for BLOB
-                        if (type.id() == QMetaType::QString) {
-                            rowData.append(value.toString().toUtf8());
-                        } else {
-                            rowData.append(value.toByteArray());
-                        }
-                    } else if (type.id() == QMetaType::Int || type.id() == QMetaType::LongLong) {
-                        // INTEGER: 8-byte big-endian
-                        qint64 intValue = value.toLongLong();
-                        QByteArray intBytes(8, 0);
-                        for (int i = 7; i >= 0; --i) {
-                            intBytes[i] = static_cast<char>(intValue & 0xFF);
-                            intValue >>= 8;
-                        }
-                        rowData.append(intBytes);
-                    } else {
-                        // Other types: convert to string and UTF-8 encode
-                        rowData.append(value.toString().toUtf8());
-                    }
+                    break;
+                case common::database::NativeStatement::ColumnType::Text:
+                case common::database::NativeStatement::ColumnType::Blob:
+                    // TEXT or BLOB: UTF-8 for text, raw bytes for BLOB
+                    rowData.append(query.columnBlob(column));
+                    break;
+                case common::database::NativeStatement::ColumnType::Integer: {
+                    // INTEGER: 8-byte big-endian
+                    char intBytes[8];
+                    qToBigEndian<qint64>(query.columnInt64(column), intBytes);
+                    rowData.append(intBytes, sizeof(intBytes));
+                    break;
+                }
+                case common::database::NativeStatement::ColumnType::Float:
+                    // Other types: convert to string and UTF-8 encode
+                    rowData.append(QString::number(query.columnDouble(column), 'g',
+                                                   QLocale::FloatingPointShortest).toUtf8());
+                    break;
                 }
             }
             rowData.append('\n'); // Row delimiter
+            tableHash.addData(rowData);
         }
         
-        // Hash concatenated row data
-        QCryptographicHash tableHash(QCryptographicHash::Sha256);
-        tableHash.addData(rowData);
-        QByteArray tableHashResult = tableHash.result();
-        
         // Store prefix + hash
-        tableHashes.append(tablePrefix + tableHashResult);
+        tableHashes.append(tablePrefix + tableHash.result());
     }
     
     // Concatenate all table hashes
@@ -1018,9 +1053,6 @@ QByteArray CartridgeExporter::calculateContentHash(const QString& cartridgePath)
     QCryptographicHash finalHash(QCryptographicHash::Sha256);
     finalHash.addData(concatenatedHashes);
     
-    db.close();
-    QSqlDatabase::removeDatabase("HashCalc");
-    
     return finalHash.result();
 }
 
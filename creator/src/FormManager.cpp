@@ -51,16 +51,16 @@ QList<QString> FormManager::getFormIds() const
         return formIds;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
-    query.prepare("SELECT form_id FROM Form_Definitions ORDER BY form_id");
+    common::database::PreparedQuery query = m_dbConnector->executePrepared(
+        "SELECT form_id FROM Form_Definitions ORDER BY form_id");
     
-    if (!query.exec()) {
-        qWarning() << "Failed to get form IDs:" << query.lastError().text();
+    if (!query.isPrepared() || !query->isActive()) {
+        qWarning() << "Failed to get form IDs";
         return formIds;
     }
     
-    while (query.next()) {
-        formIds.append(query.value(0).toString());
+    while (query->next()) {
+        formIds.append(query->value(0).toString());
     }
     
     return formIds;
@@ -72,16 +72,15 @@ QString FormManager::getFormDefinition(const QString& formId) const
         return QString();
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
-    query.prepare("SELECT form_schema_json FROM Form_Definitions WHERE form_id = ?");
-    query.addBindValue(formId);
+    common::database::PreparedQuery query = m_dbConnector->executePrepared(
+        "SELECT form_schema_json FROM Form_Definitions WHERE form_id = ?", {formId});
     
-    if (!query.exec() || !query.next()) {
-        qWarning() << "Failed to get form definition:" << query.lastError().text();
+    if (!query.isPrepared() || !query->next()) {
+        qWarning() << "Failed to get form definition:" << formId;
         return QString();
     }
     
-    return query.value(0).toString();
+    return query->value(0).toString();
 }
 
 bool FormManager::saveFormDefinition(const QString& formId, const QString& schemaJson, int formVersion)
@@ -94,24 +93,22 @@ bool FormManager::saveFormDefinition(const QString& formId, const QString& schem
     // Check if form exists
     bool exists = formExists(formId);
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::PreparedQuery query;
     
     if (exists) {
         // Update existing form
-        query.prepare("UPDATE Form_Definitions SET form_schema_json = ?, form_version = ? WHERE form_id = ?");
-        query.addBindValue(schemaJson);
-        query.addBindValue(formVersion);
-        query.addBindValue(formId);
+        query = m_dbConnector->executePrepared(
+            "UPDATE Form_Definitions SET form_schema_json = ?, form_version = ? WHERE form_id = ?",
+            {schemaJson, formVersion, formId});
     } else {
         // Insert new form
-        query.prepare("INSERT INTO Form_Definitions (form_id, form_schema_json, form_version) VALUES (?, ?, ?)");
-        query.addBindValue(formId);
-        query.addBindValue(schemaJson);
-        query.addBindValue(formVersion);
+        query = m_dbConnector->executePrepared(
+            "INSERT INTO Form_Definitions (form_id, form_schema_json, form_version) VALUES (?, ?, ?)",
+            {formId, schemaJson, formVersion});
     }
     
-    if (!query.exec()) {
-        qWarning() << "Failed to save form definition:" << query.lastError().text();
+    if (!query.isPrepared() || !query->isActive()) {
+        qWarning() << "Failed to save form definition:" << formId;
         return false;
     }
     
@@ -126,12 +123,11 @@ bool FormManager::deleteFormDefinition(const QString& formId)
         return false;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
-    query.prepare("DELETE FROM Form_Definitions WHERE form_id = ?");
-    query.addBindValue(formId);
+    common::database::PreparedQuery query = m_dbConnector->executePrepared(
+        "DELETE FROM Form_Definitions WHERE form_id = ?", {formId});
     
-    if (!query.exec()) {
-        qWarning() << "Failed to delete form definition:" << query.lastError().text();
+    if (!query.isPrepared() || !query->isActive()) {
+        qWarning() << "Failed to delete form definition:" << formId;
         return false;
     }
     
@@ -145,15 +141,14 @@ bool FormManager::formExists(const QString& formId) const
         return false;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
-    query.prepare("SELECT COUNT(*) FROM Form_Definitions WHERE form_id = ?");
-    query.addBindValue(formId);
+    common::database::PreparedQuery query = m_dbConnector->executePrepared(
+        "SELECT COUNT(*) FROM Form_Definitions WHERE form_id = ?", {formId});
     
-    if (!query.exec() || !query.next()) {
+    if (!query.isPrepared() || !query->next()) {
         return false;
     }
     
-    return query.value(0).toInt() > 0;
+    return query->value(0).toInt() > 0;
 }
 
 } // namespace creator
@@ -1,6 +1,7 @@
 #include "smartbook/creator/MetadataEditor.h"
 #include "smartbook/creator/ResourceManager.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -10,7 +11,6 @@
 #include <QFileDialog>
 #include <QPixmap>
 #include <QMessageBox>
-#include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
 #include <QUuid>
@@ -262,7 +262,7 @@ bool MetadataEditor::loadMetadataFromDatabase(const QString& cartridgePath) {
         return false;
     }
     
-    QSqlQuery query(connector.getDatabase());
+    common::database::InstrumentedQuery query(connector.getDatabase());
     query.prepare("SELECT cartridge_guid, title, author, publisher, version, publication_year, tags_json, cover_image_path, schema_version FROM Metadata LIMIT 1");
     
     if (query.exec() && query.next()) {
@@ -332,7 +332,7 @@ bool MetadataEditor::saveMetadataToDatabase(const QString& cartridgePath) {
     }
     
     // Check if metadata exists
-    QSqlQuery checkQuery(connector.getDatabase());
+    common::database::InstrumentedQuery checkQuery(connector.getDatabase());
     checkQuery.prepare("SELECT COUNT(*) FROM Metadata WHERE cartridge_guid = ?");
     checkQuery.addBindValue(m_cartridgeGuid);
     checkQuery.exec();
@@ -341,7 +341,7 @@ bool MetadataEditor::saveMetadataToDatabase(const QString& cartridgePath) {
     
     QString tagsJson = formatTags(m_tags);
     
-    QSqlQuery query(connector.getDatabase());
+    common::database::InstrumentedQuery query(connector.getDatabase());
     
     if (exists) {
         // Update existing metadata
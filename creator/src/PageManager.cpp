@@ -1,6 +1,7 @@
 #include "smartbook/creator/PageManager.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
-#include <QSqlQuery>
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include "smartbook/common/database/NativeSqlite.h"
 #include <QSqlError>
 #include <QVariant>
 #include <QDebug>
@@ -79,7 +80,7 @@ int PageManager::createPage(const QString& chapterTitle)
     
     int nextOrder = getNextPageOrder();
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("INSERT INTO Content_Pages (page_order, chapter_title, html_content, associated_css) "
                   "VALUES (?, ?, '<p></p>', '')");
     query.addBindValue(nextOrder);
@@ -106,7 +107,7 @@ bool PageManager::updatePageContent(int pageId, const QString& htmlContent, cons
         return false;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("UPDATE Content_Pages SET html_content = ?, associated_css = ? WHERE page_id = ?");
     query.addBindValue(htmlContent);
     query.addBindValue(css.isEmpty() ? QVariant() : css);
@@ -138,7 +139,7 @@ bool PageManager::updatePageMetadata(int pageId, const QString& chapterTitle)
         return false;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("UPDATE Content_Pages SET chapter_title = ? WHERE page_id = ?");
     query.addBindValue(chapterTitle.isEmpty() ? QVariant() : chapterTitle);
     query.addBindValue(pageId);
@@ -169,7 +170,7 @@ bool PageManager::deletePage(int pageId)
         return false;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("DELETE FROM Content_Pages WHERE page_id = ?");
     query.addBindValue(pageId);
     
@@ -206,7 +207,7 @@ bool PageManager::reorderPages(const QList<int>& pageIds)
     // First, set all page_order values to temporary negative values to avoid UNIQUE constraint conflicts
     int maxOrder = m_pages.size() + 1000; // Large offset to avoid conflicts
     for (int i = 0; i < pageIds.size(); ++i) {
-        QSqlQuery query(m_dbConnector->getDatabase());
+        common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
         query.prepare("UPDATE Content_Pages SET page_order = ? WHERE page_id = ?");
         query.addBindValue(-(maxOrder + i)); // Temporary negative value
         query.addBindValue(pageIds[i]);
@@ -220,7 +221,7 @@ bool PageManager::reorderPages(const QList<int>& pageIds)
     
     // Now set the final page_order values
     for (int i = 0; i < pageIds.size(); ++i) {
-        QSqlQuery query(m_dbConnector->getDatabase());
+        common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
         query.prepare("UPDATE Content_Pages SET page_order = ? WHERE page_id = ?");
         query.addBindValue(i + 1); // page_order starts at 1
         query.addBindValue(pageIds[i]);
@@ -285,10 +286,34 @@ void PageManager::refreshPageList()
         return;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
-    query.prepare("SELECT page_id, page_order, chapter_title, html_content, associated_css "
-                  "FROM Content_Pages "
-                  "ORDER BY page_order");
+    const QString sql = "SELECT page_id, page_order, chapter_title, html_content, associated_css "
+                        "FROM Content_Pages "
+                        "ORDER BY page_order";
+    
+    // Native path skips a QVariant per column of every page
+    if (common::database::NativeConnection* native = m_dbConnector->nativeReader()) {
+        common::database::NativeStatement statement = native->prepare(sql);
+        while (statement.step()) {
+            PageInfo page;
+            page.pageId = statement.columnInt(0);
+            page.pageOrder = statement.columnInt(1);
+            page.chapterTitle = statement.columnString(2);
+            page.htmlContent = statement.columnString(3);
+            page.associatedCss = statement.columnString(4);
+            
+            if (page.isValid()) {
+                m_pages.append(page);
+            }
+        }
+        if (statement.isValid() && !statement.hasError()) {
+            return;
+        }
+        qWarning() << "Native page list refresh failed, retrying through QtSql";
+        m_pages.clear();
+    }
+    
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
+    query.prepare(sql);
     
     if (!query.exec()) {
         qWarning() << "Failed to refresh page list:" << query.lastError().text();
@@ -330,7 +355,7 @@ void PageManager::updatePageOrders()
     // Reorder all pages sequentially starting from 1
     for (int i = 0; i < m_pages.size(); ++i) {
         int pageId = m_pages[i].pageId;
-        QSqlQuery query(m_dbConnector->getDatabase());
+        common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
         query.prepare("UPDATE Content_Pages SET page_order = ? WHERE page_id = ?");
         query.addBindValue(i + 1);
         query.addBindValue(pageId);
@@ -1,6 +1,7 @@
 #include "smartbook/creator/ResourceManager.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
-#include <QSqlQuery>
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include "smartbook/common/database/NativeSqlite.h"
 #include <QSqlError>
 #include <QVariant>
 #include <QFile>
@@ -56,8 +57,29 @@ QList<ResourceInfo> ResourceManager::getResources() const
         return resources;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
-    query.prepare("SELECT resource_id, resource_path, resource_type, resource_data, mime_type FROM Resources ORDER BY resource_id");
+    const QString sql = "SELECT resource_id, resource_path, resource_type, resource_data, mime_type FROM Resources ORDER BY resource_id";
+    
+    // Native path copies each BLOB once, straight out of the row buffer
+    if (common::database::NativeConnection* native = m_dbConnector->nativeReader()) {
+        common::database::NativeStatement statement = native->prepare(sql);
+        while (statement.step()) {
+            ResourceInfo info;
+            info.resourceId = statement.columnString(0);
+            info.resourcePath = statement.columnString(1);
+            info.resourceType = statement.columnString(2);
+            info.resourceData = statement.columnBytes(3);
+            info.mimeType = statement.columnString(4);
+            resources.append(info);
+        }
+        if (statement.isValid() && !statement.hasError()) {
+            return resources;
+        }
+        qWarning() << "Native resource listing failed, retrying through QtSql";
+        resources.clear();
+    }
+    
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
+    query.prepare(sql);
     
     if (!query.exec()) {
         qWarning() << "Failed to get resources:" << query.lastError().text();
@@ -85,7 +107,7 @@ ResourceInfo ResourceManager::getResource(const QString& resourceId) const
         return info;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("SELECT resource_id, resource_path, resource_type, resource_data, mime_type FROM Resources WHERE resource_id = ?");
     query.addBindValue(resourceId);
     
@@ -125,7 +147,7 @@ QString ResourceManager::importResource(const QString& filePath, const QString&
     QFileInfo fileInfo(filePath);
     QString resourcePath = fileInfo.fileName();
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare(R"(
         INSERT OR REPLACE INTO Resources (resource_id, resource_path, resource_type, resource_data, mime_type)
         VALUES (?, ?, ?, ?, ?)
@@ -160,7 +182,7 @@ bool ResourceManager::importResourceData(const QByteArray& data, const QString&
     
     QString resourcePath = resourceId; // Use resource ID as path if not specified
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare(R"(
         INSERT OR REPLACE INTO Resources (resource_id, resource_path, resource_type, resource_data, mime_type)
         VALUES (?, ?, ?, ?, ?)
@@ -187,7 +209,7 @@ bool ResourceManager::deleteResource(const QString& resourceId)
         return false;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("DELETE FROM Resources WHERE resource_id = ?");
     query.addBindValue(resourceId);
     
@@ -206,7 +228,7 @@ bool ResourceManager::resourceExists(const QString& resourceId) const
         return false;
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("SELECT COUNT(*) FROM Resources WHERE resource_id = ?");
     query.addBindValue(resourceId);
     
@@ -223,7 +245,25 @@ QByteArray ResourceManager::getResourceData(const QString& resourceId) const
         return QByteArray();
     }
     
-    QSqlQuery query(m_dbConnector->getDatabase());
+    // Incremental BLOB I/O reads the data straight into the returned buffer
+    if (common::database::NativeConnection* native = m_dbConnector->nativeReader()) {
+        common::database::NativeStatement lookup = native->prepare("SELECT rowid FROM Resources WHERE resource_id = ?");
+        lookup.bindText(0, resourceId);
+        if (!lookup.step()) {
+            if (lookup.isValid() && !lookup.hasError()) {
+                return QByteArray();
+            }
+        } else {
+            const qint64 rowid = lookup.columnInt64(0);
+            lookup.reset();
+            common::database::NativeBlob blob = native->openBlob("Resources", "resource_data", rowid);
+            if (blob.isValid()) {
+                return blob.readAll();
+            }
+        }
+    }
+    
+    common::database::InstrumentedQuery query(m_dbConnector->getDatabase());
     query.prepare("SELECT resource_data FROM Resources WHERE resource_id = ?");
     query.addBindValue(resourceId);
     
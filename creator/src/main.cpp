@@ -2,6 +2,9 @@
 #include <QStyleFactory>
 #include "smartbook/creator/CreatorMainWindow.h"
 #include "smartbook/common/utils/PlatformUtils.h"
+#include "smartbook/common/database/ConnectionProfile.h"
+#include "smartbook/common/database/QueryStats.h"
+#include <QSettings>
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
@@ -18,6 +21,11 @@ int main(int argc, char *argv[]) {
     // Initialize platform-specific settings
     smartbook::common::utils::PlatformUtils::getApplicationDataDirectory();
 
+    // Apply SQLite connection profile overrides before any database is opened
+    QSettings settings;
+    smartbook::common::database::ConnectionProfile::loadOverrides(settings);
+    smartbook::common::database::QueryStats::getInstance().loadSettings(settings);
+
     // Create and show Creator Main Window
     smartbook::creator::CreatorMainWindow mainWindow;
     mainWindow.show();
@@ -4,6 +4,7 @@
 param(
     [string]$InstallPrefix = "$env:ProgramFiles\SmartBook",
     [string]$BuildType = "Release",
+    [string]$SqlitePath = "",
     [switch]$Help = $false
 )
 
@@ -23,6 +24,7 @@ if ($Help) {
     Write-Host "Options:"
     Write-Host "  -InstallPrefix <path>  Installation directory (default: `$env:ProgramFiles\SmartBook)"
     Write-Host "  -BuildType <type>      Build type: Release, Debug (default: Release)"
+    Write-Host "  -SqlitePath <path>     SQLite 3 prefix used for the build (default: vcpkg)"
     Write-Host "  -Help                  Show this help message"
     Write-Host ""
     Write-Host "Examples:"
@@ -74,5 +76,25 @@ foreach ($component in $components) {
     }
 }
 
+# smartbook_common links sqlite3.dll, which cmake --install does not copy
+if ([string]::IsNullOrEmpty($SqlitePath)) {
+    if ($env:SQLITE3_DIR) {
+        $SqlitePath = $env:SQLITE3_DIR
+    } elseif ($env:VCPKG_ROOT) {
+        $SqlitePath = Join-Path $env:VCPKG_ROOT "installed\x64-windows"
+    } else {
+        $SqlitePath = "C:\vcpkg\installed\x64-windows"
+    }
+}
+$SqliteDll = Join-Path $SqlitePath "bin\sqlite3.dll"
+if (Test-Path $SqliteDll) {
+    $BinDir = Join-Path $InstallPrefix "bin"
+    New-Item -ItemType Directory -Force -Path $BinDir | Out-Null
+    Copy-Item -Path $SqliteDll -Destination $BinDir -Force
+    Write-Host "`nInstalled sqlite3.dll from $SqlitePath" -ForegroundColor Green
+} else {
+    Write-Host "`nWarning: sqlite3.dll not found in $SqlitePath\bin; copy it next to the executables" -ForegroundColor Yellow
+}
+
 Write-Host "`n=== Install Complete ===" -ForegroundColor Green
 Write-Host "SmartBook installed to: $InstallPrefix" -ForegroundColor Cyan
@@ -0,0 +1,133 @@
+#ifndef SMARTBOOK_READER_CARTRIDGESCHEMEHANDLER_H
+#define SMARTBOOK_READER_CARTRIDGESCHEMEHANDLER_H
+
+#include <QWebEngineUrlSchemeHandler>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QUrl>
+#include <functional>
+#include <memory>
+
+class QWebEngineProfile;
+
+namespace smartbook {
+namespace common {
+namespace database {
+class CartridgeResources;
+}
+}
+
+namespace reader {
+
+/**
+ * @brief Serves open cartridges to QWebEngine under smartbook://
+ *
+ *   smartbook://<cartridge>/page/<page_id>      Page document
+ *   smartbook://<cartridge>/resource/<id>       Resources BLOB, by resource_id or resource_path
+ *
+ * Pages are navigated to instead of pushed through setHtml(), which caps
+ * a document at about 2 MB and gives it no base URL. Resources are read
+ * from SQLite a range at a time (CartridgeResourceDevice) with their
+ * stored MIME type; the device is seekable, so QWebEngine answers Range
+ * requests for audio and video from it. All resources of a cartridge are
+ * read through one connection, opened on the first request. Responses are marked no-cache:
+ * URLs do not change when a cartridge is replaced on disk, so a resource
+ * must not be reused from an earlier load. Their ETag is derived from
+ * the cartridge's content hash (Cartridge_Security).
+ *
+ * Links in the form of DDD 11 (smartbook://page/5) are redirected to the
+ * cartridge of the page they are on. A page may only load from its own
+ * cartridge.
+ *
+ * Only cartridges added with addCartridge() are served; a cartridge is
+ * removed again when its owner is destroyed. Requests are answered on the
+ * GUI thread.
+ */
+class CartridgeSchemeHandler : public QWebEngineUrlSchemeHandler {
+    Q_OBJECT
+
+public:
+    static constexpr const char* SCHEME = "smartbook";
+
+    /**
+     * @brief Builds the document of a page
+     *
+     * Returns the UTF-8 HTML, or a null QByteArray if there is no such page.
+     */
+    using PageSource = std::function<QByteArray(int pageId)>;
+
+    /**
+     * @brief Register the smartbook scheme with QWebEngine
+     *
+     * Must be called before the QApplication is created.
+     */
+    static void registerScheme();
+
+    /**
+     * @brief Get the handler of a profile, installing it on first use
+     * @param profile Profile the reader views use
+     * @return Handler (owned by the profile)
+     */
+    static CartridgeSchemeHandler* forProfile(QWebEngineProfile* profile);
+
+    /**
+     * @brief Get the URL of a page
+     * @param host Host the cartridge was added under
+     * @param pageId Page
+     * @return smartbook://<host>/page/<pageId>
+     */
+    static QUrl pageUrl(const QString& host, int pageId);
+
+    /**
+     * @brief Get the page a URL shows
+     * @param url Page URL
+     * @return page_id, -1 if url is not a page of a cartridge
+     */
+    static int pageIdOf(const QUrl& url);
+
+    /**
+     * @brief Serve a cartridge
+     *
+     * Adding the same host again (a second window on the cartridge) serves
+     * from the latest owner until it is removed.
+     *
+     * @param owner Object the cartridge is served for; removed when destroyed
+     * @param host Host name for its URLs (the cartridge GUID)
+     * @param cartridgePath Cartridge file
+     * @param pages Builds its page documents
+     */
+    void addCartridge(QObject* owner, const QString& host, const QString& cartridgePath, PageSource pages);
+
+    /**
+     * @brief Stop serving the cartridge added for an owner
+     * @param owner Owner passed to addCartridge()
+     */
+    void removeCartridge(QObject* owner);
+
+    void requestStarted(QWebEngineUrlRequestJob* job) override;
+
+private:
+    struct Cartridge {
+        QObject* owner = nullptr;
+        QString path;
+        PageSource pages;
+        QByteArray contentTag;      // Cartridge content hash, hex
+        std::shared_ptr<common::database::CartridgeResources> resources;
+    };
+
+    explicit CartridgeSchemeHandler(QObject* parent = nullptr);
+
+    const Cartridge* cartridgeFor(const QString& host) const;
+    static QByteArray contentTagOf(const QString& cartridgePath);
+    void servePage(QWebEngineUrlRequestJob* job, const Cartridge& cartridge, const QString& pageId);
+    void serveResource(QWebEngineUrlRequestJob* job, const Cartridge& cartridge, const QString& resource);
+
+    QHash<QString, QList<Cartridge>> m_cartridges;   // By host, latest last
+};
+
+} // namespace reader
+} // namespace smartbook
+
+#endif // SMARTBOOK_READER_CARTRIDGESCHEMEHANDLER_H
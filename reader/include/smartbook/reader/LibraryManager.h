@@ -5,36 +5,35 @@
 #include <QWidget>
 #include <QList>
 #include <QString>
-#include <QByteArray>
+#include <QStringList>
 #include <memory>
 
+class QProgressDialog;
+
 namespace smartbook {
+namespace common {
+namespace manifest {
+class CartridgeImporter;
+class LibraryWatcher;
+class ManifestManager;
+}
+}
+
 namespace reader {
 
 class LibraryView;
 class ReaderViewWindow;
 
-/**
- * @brief Cartridge information for library display
- */
-struct CartridgeInfo {
-    QString cartridgeGuid;
-    QString title;
-    QString author;
-    QString publicationYear;
-    QString publisher;
-    QString version;
-    QString localPath;
-    QByteArray coverImageData;
-    
-    bool isValid() const { return !cartridgeGuid.isEmpty() && !title.isEmpty(); }
-};
+namespace ui {
+class DiagnosticsPanel;
+}
 
 /**
  * @brief Main Library Manager window
  * 
  * The Hub - handles application launch, library browsing, import/delete,
- * and Trust Revocation. Relies exclusively on the Manifest for fast loading.
+ * and Trust Revocation. Relies exclusively on the Manifest for fast loading;
+ * the manifest is read by LibraryView's model only.
  */
 class LibraryManager : public QMainWindow {
     Q_OBJECT
@@ -49,24 +48,27 @@ public:
      */
     void openCartridge(const QString& cartridgeGuid);
 
-    /**
-     * @brief Load library from manifest
-     * @return List of cartridge metadata for display
-     */
-    QList<CartridgeInfo> loadLibraryData();
-
 private slots:
     void onImportCartridge();
+    void onImportFolder();
+    void onImportFinished(bool cancelled);
     void onDeleteCartridge(const QString& cartridgeGuid);
     void onCartridgeDoubleClicked(const QString& cartridgeGuid);
+    void onShowDiagnostics();
 
 private:
     void setupUI();
     void setupMenuBar();
     void loadLibrary();
+    void startImport(const QStringList& paths);
 
     LibraryView* m_libraryView;
     QList<ReaderViewWindow*> m_readerWindows;
+    ui::DiagnosticsPanel* m_diagnosticsPanel = nullptr;
+    common::manifest::CartridgeImporter* m_importer = nullptr;
+    common::manifest::LibraryWatcher* m_libraryWatcher = nullptr;
+    common::manifest::ManifestManager* m_manifestManager = nullptr;
+    QProgressDialog* m_importProgress = nullptr;
 };
 
 } // namespace reader
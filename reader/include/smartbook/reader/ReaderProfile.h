@@ -0,0 +1,86 @@
+#ifndef SMARTBOOK_READER_READERPROFILE_H
+#define SMARTBOOK_READER_READERPROFILE_H
+
+#include <QString>
+#include <QtGlobal>
+
+class QSettings;
+class QWebEngineProfile;
+
+namespace smartbook {
+namespace reader {
+
+/**
+ * @brief The QWebEngine profile every reader window shares
+ *
+ * One named profile instead of the default one, so all windows share one
+ * cache and one set of renderer processes, configured once:
+ *
+ * - Disk HTTP cache of http_cache_mb, kept across runs, for http(s)
+ *   content pages load. Chromium's HTTP and script code caches only
+ *   store http(s) loads: smartbook:// pages and resources come from the
+ *   cartridge on every load, and their scripts are compiled each time.
+ * - The smartbook:// handler installed (CartridgeSchemeHandler).
+ * - Page settings: JavaScript as configured, no windows opened by
+ *   scripts, no access to file:// or remote URLs from cartridge pages.
+ *
+ * The process model is Chromium's and can only be chosen before
+ * QWebEngine starts (applyProcessModel()):
+ *
+ * - "process-per-site" (default): one renderer per cartridge, since the
+ *   cartridge is the origin of its URLs. Windows and reopened books of
+ *   the same cartridge reuse its renderer instead of starting one.
+ * - "process-per-site-instance": Chromium's own default; a renderer per
+ *   window. Most isolation, most memory.
+ * - "single-process": everything in the browser process, for low-memory
+ *   devices. No renderer sandbox, and a crashing page takes the reader
+ *   down with it.
+ *
+ * Settings (reader/web/...): http_cache_mb, persistent (false keeps the
+ * cache in memory only), process_model, javascript_enabled.
+ */
+class ReaderProfile {
+public:
+    static constexpr const char* STORAGE_NAME = "reader";
+
+    struct Options {
+        int httpCacheMiB = 64;
+        bool persistent = true;
+        QString processModel = QStringLiteral("process-per-site");
+        bool javascriptEnabled = true;
+    };
+
+    /**
+     * @brief Read the options from settings
+     *
+     * Must be called before instance() to take effect.
+     */
+    static void loadSettings(QSettings& settings);
+
+    static const Options& options();
+    static void setOptions(const Options& options);
+
+    /**
+     * @brief Pass the process model to Chromium
+     *
+     * Must be called before the QApplication is created. A process model
+     * already given in QTWEBENGINE_CHROMIUM_FLAGS is kept.
+     */
+    static void applyProcessModel();
+
+    /**
+     * @brief Get the shared profile, creating it on first use
+     * @return Profile (owned by the application)
+     */
+    static QWebEngineProfile* instance();
+
+private:
+    static void configure(QWebEngineProfile* profile);
+
+    static Options s_options;
+};
+
+} // namespace reader
+} // namespace smartbook
+
+#endif // SMARTBOOK_READER_READERPROFILE_H
@@ -0,0 +1,95 @@
+#ifndef SMARTBOOK_READER_UI_COVERDECODER_H
+#define SMARTBOOK_READER_UI_COVERDECODER_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QMutex>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <functional>
+
+namespace smartbook {
+namespace reader {
+
+class CoverDecodeJob;
+
+/**
+ * @brief Decodes cover images on a private thread pool
+ *
+ * Jobs decode with QImageReader::setScaledSize (see
+ * CoverThumbnailStore::decodeScaled()), higher priorities start first,
+ * and jobs that have not started yet can be cancelled, e.g. when their
+ * rows scroll out of view. Results are delivered through decoded(), which
+ * reaches receivers on other threads as a queued signal.
+ *
+ * The destructor drops queued jobs and waits for running ones, so no job
+ * outlives the decoder.
+ */
+class CoverDecoder : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CoverDecoder(QObject* parent = nullptr);
+    ~CoverDecoder();
+
+    /**
+     * @brief Queue a decode
+     *
+     * A key that is already queued is not queued twice.
+     *
+     * @param key Identifies the result in decoded()
+     * @param tag Echoed back in decoded() (e.g. the scale it was requested for)
+     * @param data Encoded image
+     * @param maxSize Box the image is fitted into
+     * @param priority Jobs with higher priority start first
+     */
+    void decode(const QString& key, int tag, const QByteArray& data, const QSize& maxSize, int priority = 0);
+
+    /**
+     * @brief Cancel jobs that have not started yet
+     * @param predicate Returns true for keys to cancel; all if empty
+     * @return Keys of the cancelled jobs
+     */
+    QStringList cancelQueued(const std::function<bool(const QString& key)>& predicate =
+                                 std::function<bool(const QString& key)>());
+
+    /**
+     * @brief Get the number of jobs that have not started yet
+     * @return Queued job count
+     */
+    int queuedCount() const;
+
+    /**
+     * @brief Limit the number of decoding threads
+     * @param threads Maximum concurrent decodes
+     */
+    void setMaxThreadCount(int threads);
+
+signals:
+    /**
+     * @brief A decode finished (emitted on a pool thread)
+     * @param key Key passed to decode()
+     * @param tag Tag passed to decode()
+     * @param image Decoded image, null if the data could not be decoded
+     */
+    void decoded(const QString& key, int tag, const QImage& image);
+
+private:
+    friend class CoverDecodeJob;
+
+    // Called by a job when a pool thread picks it up
+    void jobStarted(CoverDecodeJob* job);
+
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+    QHash<QString, CoverDecodeJob*> m_queued;   // Not yet started, owned by the pool
+};
+
+} // namespace reader
+} // namespace smartbook
+
+#endif // SMARTBOOK_READER_UI_COVERDECODER_H
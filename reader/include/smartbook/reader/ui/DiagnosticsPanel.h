@@ -0,0 +1,50 @@
+#ifndef SMARTBOOK_READER_UI_DIAGNOSTICSPANEL_H
+#define SMARTBOOK_READER_UI_DIAGNOSTICSPANEL_H
+
+#include <QDialog>
+
+class QTableWidget;
+class QPlainTextEdit;
+class QLabel;
+
+namespace smartbook {
+namespace reader {
+namespace ui {
+
+/**
+ * @brief Hidden diagnostics panel showing database query statistics
+ *
+ * Lists per-statement latency percentiles, row and byte counts, and the
+ * slow-query log with query plans, as collected by QueryStats. Not reachable
+ * from the menus; opened with Ctrl+Shift+D in the Library Manager.
+ */
+class DiagnosticsPanel : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsPanel(QWidget* parent = nullptr);
+    ~DiagnosticsPanel();
+
+public slots:
+    /**
+     * @brief Reload statistics from QueryStats
+     */
+    void refresh();
+
+private slots:
+    void onReset();
+    void onSaveJson();
+
+private:
+    void setupUI();
+
+    QLabel* m_summaryLabel = nullptr;
+    QTableWidget* m_statementTable = nullptr;
+    QPlainTextEdit* m_slowQueryLog = nullptr;
+};
+
+} // namespace ui
+} // namespace reader
+} // namespace smartbook
+
+#endif // SMARTBOOK_READER_UI_DIAGNOSTICSPANEL_H
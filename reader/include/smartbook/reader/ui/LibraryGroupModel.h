@@ -0,0 +1,142 @@
+#ifndef SMARTBOOK_READER_UI_LIBRARYGROUPMODEL_H
+#define SMARTBOOK_READER_UI_LIBRARYGROUPMODEL_H
+
+#include "smartbook/common/manifest/LibraryGroups.h"
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+namespace smartbook {
+namespace reader {
+
+/**
+ * @brief Grouped library tree: series -> editions -> cartridges, or collections
+ *
+ * Opening the view reads only the groups and their counts (one row per
+ * group, see LibraryGroups), so it costs no more than the first page of
+ * the flat list. A group's children are fetched on the database executor
+ * when it is expanded, through canFetchMore()/fetchMore(): its editions
+ * first, then its cartridges page by page.
+ *
+ * Manifest writes announced by ManifestChangeFeed, and refresh(), re-read
+ * the groups and merge them in place: groups that appear or vanish are
+ * inserted or removed, and only groups whose count changed or that hold a
+ * changed cartridge reload their children. Expanded groups stay expanded.
+ *
+ * Columns and GuidRole match LibraryModel; group rows have no GUID.
+ */
+class LibraryGroupModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum class Grouping {
+        Series,
+        Collections
+    };
+
+    enum Role {
+        CountRole = Qt::UserRole + 10     // Cartridges in a group, on group rows
+    };
+
+    // Cartridges fetched per fetchMore() of a group
+    static constexpr int PAGE_SIZE = 200;
+
+    explicit LibraryGroupModel(QObject* parent = nullptr);
+    ~LibraryGroupModel();
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    /**
+     * @brief Switch between the series and collections trees
+     * @param grouping Tree to show; reloads if it changed
+     */
+    void setGrouping(Grouping grouping);
+    Grouping grouping() const { return m_grouping; }
+
+    /**
+     * @brief Drop everything and fetch the groups again
+     */
+    void reload();
+
+    /**
+     * @brief Merge the current groups into the tree
+     *
+     * Needed after collection edits, which are not manifest changes.
+     */
+    void refresh();
+
+    /**
+     * @brief Get the group of a group row
+     * @param index Row
+     * @return Group, nullptr for cartridge rows
+     */
+    const smartbook::common::manifest::LibraryGroups::Group* groupAt(const QModelIndex& index) const;
+
+signals:
+    /**
+     * @brief Emitted when the children of a group have been appended
+     * @param parent Group, invalid for the top level
+     */
+    void childrenLoaded(const QModelIndex& parent);
+
+private:
+    struct Node {
+        Node* parent = nullptr;
+        bool isGroup = true;
+        smartbook::common::manifest::LibraryGroups::Group group;
+        smartbook::common::manifest::LibraryGroups::Member member;
+        std::vector<std::unique_ptr<Node>> children;
+        int groupChildren = 0;      // Leading children that are groups
+        int membersLoaded = 0;
+        bool groupsLoaded = false;
+        bool atEnd = false;
+        quint64 fetchToken = 0;     // Non-zero while a fetch is in flight
+
+        int row() const;
+    };
+
+    struct Fetched {
+        bool withGroups = false;
+        QList<smartbook::common::manifest::LibraryGroups::Group> groups;
+        QList<smartbook::common::manifest::LibraryGroups::Member> members;
+    };
+
+    Node* nodeFor(const QModelIndex& index) const;
+    QModelIndex indexFor(Node* node, int column = 0) const;
+    static bool sameGroup(const smartbook::common::manifest::LibraryGroups::Group& a,
+                          const smartbook::common::manifest::LibraryGroups::Group& b);
+    void startFetch(Node* node);
+    void appendFetched(Node* node, const Fetched& fetched);
+    void mergeGroups(const QList<smartbook::common::manifest::LibraryGroups::Group>& groups);
+    void invalidateChildren(Node* node);
+    static bool holdsChanged(const Node* node, const QSet<QString>& guids);
+    void forgetFetches(Node* node);
+    void onEntryChanged(const QString& cartridgeGuid);
+
+    Grouping m_grouping = Grouping::Series;
+    Node m_root;
+    QHash<quint64, Node*> m_fetches;    // In-flight fetches by token
+    quint64 m_nextToken = 0;
+
+    // Manifest change feed
+    QSet<QString> m_changedGuids;      // Changed since the last refresh
+    bool m_refreshing = false;
+    bool m_refreshPending = false;
+    QTimer m_refreshTimer;
+};
+
+} // namespace reader
+} // namespace smartbook
+
+#endif // SMARTBOOK_READER_UI_LIBRARYGROUPMODEL_H
@@ -0,0 +1,292 @@
+#ifndef SMARTBOOK_READER_UI_LIBRARYMODEL_H
+#define SMARTBOOK_READER_UI_LIBRARYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QIdentityProxyModel>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QCache>
+#include <QPixmap>
+#include <QTimer>
+#include <QImage>
+#include <QVariant>
+
+namespace smartbook {
+namespace reader {
+
+class CoverDecoder;
+
+/**
+ * @brief Library table backed by Local_Library_Manifest
+ *
+ * Rows are fetched page by page on the database executor thread through
+ * canFetchMore()/fetchMore(), so only what the views have scrolled to is
+ * held in memory. Row data is kept column by column rather than as one
+ * item object per cell. sort() re-queries the manifest with a different
+ * ORDER BY instead of sorting in memory, and setFilter() narrows it in the
+ * WHERE clause.
+ *
+ * Pages are keyset-paginated: each page starts after the (sort key, GUID)
+ * of the last loaded row, and every sort key has a (key, cartridge_guid)
+ * index, so any page, in any order, is one index range read. Rows
+ * inserted or removed above the last loaded row do not shift later pages.
+ *
+ * Cover thumbnails are exposed under CoverRole. Rows a view paints get a
+ * placeholder at once; their encoded thumbnails are read in batches on the
+ * executor thread, decoded on a CoverDecoder pool (visible rows first) and
+ * streamed in through dataChanged(). Decoded covers are kept in a bounded
+ * pixmap cache.
+ *
+ * Manifest writes announced by ManifestChangeFeed are applied row by row:
+ * the model reads Local_Manifest_Changes from the last change it applied
+ * and inserts, updates or removes just the affected rows, placing them by
+ * their rank in the current sort order. Only when the change log no longer
+ * reaches back that far is the model reloaded.
+ *
+ * Both Library views attach through proxies (LibraryGridProxy for the
+ * Bookshelf view); QAbstractProxyModel forwards fetchMore() and sort().
+ */
+class LibraryModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        TitleColumn,
+        AuthorColumn,
+        VersionColumn,
+        YearColumn,
+        ColumnCount
+    };
+
+    // Sort keys without a column of their own; passed to sort() like a column
+    enum SortKey {
+        LastOpenedSortKey = ColumnCount    // Most recently opened with Qt::DescendingOrder
+    };
+
+    enum Role {
+        GuidRole = Qt::UserRole,   // Cartridge GUID, on every column
+        CoverRole                  // Cover thumbnail (QPixmap), title column only
+    };
+
+    // Manifest rows fetched per fetchMore()
+    static constexpr int PAGE_SIZE = 200;
+
+    /**
+     * @brief Conditions on manifest columns, evaluated in SQL
+     */
+    struct Filter {
+        QString author;         // Exact author, empty for any
+        QString publisher;      // Exact publisher, empty for any
+        int yearFrom = 0;       // First publication year, 0 for no lower bound
+        int yearTo = 0;         // Last publication year, 0 for no upper bound
+
+        bool isEmpty() const { return author.isEmpty() && publisher.isEmpty() && yearFrom <= 0 && yearTo <= 0; }
+        bool operator==(const Filter& other) const {
+            return author == other.author && publisher == other.publisher
+                && yearFrom == other.yearFrom && yearTo == other.yearTo;
+        }
+        bool operator!=(const Filter& other) const { return !(*this == other); }
+    };
+
+    explicit LibraryModel(QObject* parent = nullptr);
+    ~LibraryModel();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    /**
+     * @brief Drop all rows and fetch the first page again
+     */
+    void reload();
+
+    /**
+     * @brief Show only the rows matching a search
+     *
+     * Every word has to prefix-match the title, author, publisher, series
+     * or edition (see LibrarySearch). Matches keep the current sort order
+     * and are paged like the full library. Empty text shows everything.
+     *
+     * @param text Text typed by the user
+     */
+    void setFilterText(const QString& text);
+
+    /**
+     * @brief Get the current search text
+     * @return Text passed to setFilterText()
+     */
+    QString filterText() const { return m_filterText; }
+
+    /**
+     * @brief Show only the rows matching a filter
+     *
+     * Combines with the search text. Matches keep the current sort order
+     * and are paged like the full library.
+     *
+     * @param filter Conditions; an empty filter shows everything
+     */
+    void setFilter(const Filter& filter);
+
+    /**
+     * @brief Get the current filter
+     * @return Filter passed to setFilter()
+     */
+    Filter filter() const { return m_filter; }
+
+    /**
+     * @brief Get the current sort key
+     * @return Column or SortKey passed to sort()
+     */
+    int sortColumn() const { return m_sortColumn; }
+
+    /**
+     * @brief Set the device pixel ratio covers are loaded for
+     * @param scale Scale as returned by CoverThumbnailStore::scaleFor()
+     */
+    void setCoverScale(int scale);
+
+    /**
+     * @brief Tell the model which rows the Bookshelf view shows
+     *
+     * Covers of these rows are decoded first; queued decodes of rows
+     * outside the range are cancelled and requested again when painted.
+     *
+     * @param first First visible row
+     * @param last Last visible row
+     */
+    void setVisibleRows(int first, int last);
+
+    /**
+     * @brief Cancel cover loads that have not started decoding
+     *
+     * Used when the Bookshelf view is hidden.
+     */
+    void cancelCoverLoads();
+
+    /**
+     * @brief Get the GUID of a loaded row
+     * @param row Row number
+     * @return Cartridge GUID, empty if out of range
+     */
+    QString guidAt(int row) const;
+
+    /**
+     * @brief Check whether a page request is in flight
+     * @return true while fetchMore() results are pending
+     */
+    bool isFetching() const { return m_fetching; }
+
+signals:
+    /**
+     * @brief Emitted when a page has been appended
+     * @param rows Number of rows in the page
+     */
+    void pageLoaded(int rows);
+
+private:
+    // Column-wise row storage, also the unit returned by a page fetch
+    struct Rows {
+        QStringList guids;
+        QStringList titles;
+        QStringList authors;
+        QStringList versions;
+        QStringList years;
+        QList<qint64> lastOpened;    // 0 if never opened
+        QList<bool> needsThumbnail;  // Has a cover but no current thumbnail
+        qint64 changeId = -1;        // Change log position of a first page
+
+        int size() const { return guids.size(); }
+        void removeAt(int row);
+        void insertFrom(int row, const Rows& other, int index);
+    };
+
+    // Result of reading the change log, in the model's sort order
+    struct ChangeBatch {
+        bool complete = false;       // false: log pruned, reload instead
+        qint64 changeId = -1;        // Newest change included
+        QStringList removed;         // Changed GUIDs no longer in the manifest
+        Rows entries;                // Current data of changed rows
+        QList<int> ranks;            // Position of each entry, ascending
+    };
+
+    // SQL conditions on a manifest alias and the values they bind, in order
+    struct Conditions {
+        QStringList clauses;
+        QVariantList values;
+    };
+
+    static QString sortKey(int column, const QString& table);
+    static QString orderByClause(int column, Qt::SortOrder order);
+    QVariant lastSortValue() const;
+    static Conditions filterConditions(const QString& table, const Filter& filter);
+    void appendPage(const Rows& page);
+    void applyManifestChanges();
+    void applyChangeBatch(const ChangeBatch& batch);
+    void reindexFrom(int row);
+    void requestCover(const QString& guid) const;
+    void loadRequestedCovers();
+    void onCoverDecoded(const QString& guid, int scale, const QImage& image);
+    void emitCoverChanged(const QStringList& guids);
+    bool isVisibleRow(int row) const;
+    QPixmap placeholder() const;
+    void backfillThumbnails();
+    void clearCovers();
+
+    Rows m_rows;
+    QHash<QString, int> m_rowByGuid;
+    int m_sortColumn = TitleColumn;
+    Qt::SortOrder m_sortOrder = Qt::AscendingOrder;
+    int m_coverScale = 1;
+    bool m_fetching = false;
+    bool m_atEnd = false;
+    bool m_pageStale = false;       // Page in flight predates changes past the loaded rows
+    QString m_filterText;
+    QString m_filterMatch;          // FTS5 expression, empty without a search
+    Filter m_filter;
+    quint64 m_generation = 0;       // Discards pages of superseded loads
+
+    // Manifest change feed
+    qint64 m_changeCursor = -1;     // Last change applied, -1 before the first page
+    bool m_changesRunning = false;
+    bool m_changesPending = false;
+    QTimer m_changeTimer;
+
+    // Covers are keyed by GUID so they survive re-sorting
+    QCache<QString, QPixmap> m_covers;
+    mutable QSet<QString> m_coverQueue;     // Requested, not yet submitted
+    QSet<QString> m_coverFetching;          // Being read on the executor
+    QSet<QString> m_coverDecoding;          // Queued or running on the decoder
+    QSet<QString> m_noCover;                // Loaded, no cover available
+    mutable QTimer m_coverTimer;
+    CoverDecoder* m_decoder;
+    mutable QPixmap m_placeholder;          // At m_coverScale, built on first use
+    int m_visibleFirst = 0;
+    int m_visibleLast = -1;
+    bool m_backfillRunning = false;
+};
+
+/**
+ * @brief Bookshelf view adapter: shows CoverRole as the decoration
+ *
+ * Keeps covers out of the List View, which would otherwise request a
+ * thumbnail for every visible row.
+ */
+class LibraryGridProxy : public QIdentityProxyModel {
+    Q_OBJECT
+
+public:
+    explicit LibraryGridProxy(QObject* parent = nullptr);
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+};
+
+} // namespace reader
+} // namespace smartbook
+
+#endif // SMARTBOOK_READER_UI_LIBRARYMODEL_H
@@ -2,20 +2,32 @@
 #define SMARTBOOK_READER_UI_LIBRARYVIEW_H
 
 #include <QWidget>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QTreeView>
 #include <QListView>
 #include <QTableView>
 #include <QStackedWidget>
-#include <QStandardItemModel>
+#include <QIdentityProxyModel>
 #include <QAbstractItemView>
 
 namespace smartbook {
 namespace reader {
 
+class LibraryModel;
+class LibraryGridProxy;
+class LibraryGroupModel;
+
 /**
  * @brief Library view widget - displays cartridges in library
  * 
  * Supports both List View (table) and Bookshelf View (grid) modes.
- * Relies on Local_Library_Manifest for fast loading.
+ * Relies on Local_Library_Manifest for fast loading. Both views show
+ * one LibraryModel through their own proxy, so a refresh queries the
+ * manifest once and only for the rows on screen. The By Series and
+ * Collections groupings show a LibraryGroupModel tree instead, created the
+ * first time one is chosen.
  * 
  * DDD Section 11.1: UI Dual View
  */
@@ -28,6 +40,9 @@ public:
 
     /**
      * @brief Refresh the library view from manifest
+     *
+     * Not needed after manifest writes; the model applies those row by
+     * row from ManifestChangeFeed.
      */
     void refreshLibrary();
 
@@ -44,6 +59,18 @@ public:
      */
     bool isListView() const { return m_isListView; }
 
+    /**
+     * @brief Check whether a grouped tree is shown instead of the flat views
+     * @return true for By Series and Collections
+     */
+    bool isGrouped() const;
+
+    /**
+     * @brief Get the model shared by both views
+     * @return Library model (owned by the view)
+     */
+    LibraryModel* model() const { return m_model; }
+
 signals:
     void cartridgeDoubleClicked(const QString& cartridgeGuid);
     void cartridgeDeleteRequested(const QString& cartridgeGuid);
@@ -51,6 +78,10 @@ signals:
 private slots:
     void onItemDoubleClicked(const QModelIndex& index);
     void onTableDoubleClicked(const QModelIndex& index);
+    void onFilterTextChanged(const QString& text);
+    void onGroupingChanged(int index);
+    void onRecentFirstToggled(bool checked);
+    void updateVisibleCovers();
 
 private:
     void setupUI();
@@ -59,11 +90,17 @@ private:
     void setupBookshelfView();
     void updateView();
 
+    QComboBox* m_groupingBox;     // All Cartridges, By Series, Collections (DDD grouping filters)
+    QLineEdit* m_filterEdit;      // Search-as-you-type over both views
+    QCheckBox* m_recentFirstBox;  // Most recently opened first instead of the header order
     QStackedWidget* m_stackedWidget;
     QTableView* m_tableView;      // List View: Table with columns
     QListView* m_gridView;        // Bookshelf View: Grid layout
-    QStandardItemModel* m_listModel;
-    QStandardItemModel* m_gridModel;
+    QTreeView* m_groupView;       // Grouped views, null until first used
+    LibraryGroupModel* m_groupModel;
+    LibraryModel* m_model;        // Shared by both views
+    QIdentityProxyModel* m_listProxy;
+    LibraryGridProxy* m_gridProxy;
     bool m_isListView = true;
 };
 
@@ -0,0 +1,87 @@
+#ifndef SMARTBOOK_READER_UI_NAVIGATIONMODEL_H
+#define SMARTBOOK_READER_UI_NAVIGATIONMODEL_H
+
+#include <QAbstractItemModel>
+#include <QSet>
+#include <memory>
+#include <vector>
+
+namespace smartbook {
+namespace common {
+namespace database {
+    class NativeConnection;
+}
+}
+
+namespace reader {
+
+/**
+ * @brief Table of contents of a cartridge, from Navigation_Structure
+ *
+ * Groups (group_name, by group_order) hold their top-level items, and
+ * items hold the items whose parent_item_id points at them, each level by
+ * item_order. A cartridge with a single group shows its items at the top
+ * level.
+ *
+ * Only the groups are read when a cartridge is set. The items below a
+ * node are read when it is expanded, through canFetchMore()/fetchMore(),
+ * with one query on the model's own read-only connection. Which items
+ * have children is known from one scan up front, so expanders are right
+ * before anything is fetched.
+ */
+class NavigationModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum Role {
+        TargetTypeRole = Qt::UserRole + 1,  // target_type
+        TargetValueRole,                    // target_value
+        PageIdRole                          // Page a "page" target opens, -1 otherwise
+    };
+
+    explicit NavigationModel(QObject* parent = nullptr);
+    ~NavigationModel();
+
+    /**
+     * @brief Show the table of contents of a cartridge
+     * @param cartridgePath Path to the cartridge file; empty to clear
+     * @return false if the cartridge could not be read (the model is empty)
+     */
+    bool setCartridge(const QString& cartridgePath);
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    struct Node {
+        Node* parent = nullptr;
+        bool isGroup = false;
+        int navId = -1;             // Items only
+        QString label;              // item_label, or group_name
+        QString targetType;
+        QString targetValue;
+        std::vector<std::unique_ptr<Node>> children;
+        bool hasChildren = false;
+        bool fetched = false;
+
+        int row() const;
+    };
+
+    Node* nodeFor(const QModelIndex& index) const;
+    void fetchChildren(Node* node);
+
+    Node m_root;
+    std::unique_ptr<common::database::NativeConnection> m_connection;
+    QSet<int> m_parents;            // nav_ids that have children
+};
+
+} // namespace reader
+} // namespace smartbook
+
+#endif // SMARTBOOK_READER_UI_NAVIGATIONMODEL_H
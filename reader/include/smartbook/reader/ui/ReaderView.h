@@ -1,12 +1,26 @@
 #ifndef SMARTBOOK_READER_UI_READERVIEW_H
 #define SMARTBOOK_READER_UI_READERVIEW_H
 
+#include "smartbook/common/database/CartridgeSearchIndex.h"
+#include "smartbook/common/database/PageIndex.h"
+#include "smartbook/common/settings/PageTemplate.h"
 #include <QWidget>
 #include <QWebEngineView>
 #include <QString>
+#include <QFuture>
+#include <memory>
+
+class QWebEnginePage;
+class QWebEngineProfile;
+class QWebChannel;
+class QModelIndex;
 
 namespace smartbook {
 namespace common {
+namespace database {
+    class CartridgeDBConnector;
+    class PagePrefetcher;
+}
 namespace settings {
     class SettingsManager;
 }
@@ -15,12 +29,21 @@ namespace settings {
 namespace reader {
 
 class WebChannelBridge;
+class NavigationModel;
 
 /**
  * @brief Reader view widget - displays cartridge content
  * 
  * Uses QWebEngineView to render HTML content with embedded applications.
- * Loads content from Content_Pages table in the cartridge database.
+ * Pages are navigated to as smartbook://<cartridge>/page/<page_id> and
+ * built from the Content_Pages table by CartridgeSchemeHandler, which also
+ * serves the cartridge's Resources to them.
+ *
+ * Page turns are served ahead of time: once a page has loaded, the pages
+ * around it are read in the background (PagePrefetcher) and the next one
+ * is loaded into a hidden page, which nextPage() swaps into the view.
+ * The reading order is held in a PageIndex, so moving between pages
+ * needs no query; the table of contents is a NavigationModel.
  * Applies settings (author defaults and user overrides) to content rendering.
  */
 class ReaderView : public QWidget {
@@ -49,25 +72,158 @@ public:
      */
     int getCurrentPageId() const { return m_currentPageId; }
 
+    /**
+     * @brief Turn to the page after the current one (by page_order)
+     * @return false if the current page is the last
+     */
+    bool nextPage();
+
+    /**
+     * @brief Turn to the page before the current one (by page_order)
+     * @return false if the current page is the first
+     */
+    bool previousPage();
+
+    /**
+     * @brief Turn to the first page
+     * @return false if the cartridge has no pages
+     */
+    bool firstPage();
+
+    /**
+     * @brief Turn to the last page
+     * @return false if the cartridge has no pages
+     */
+    bool lastPage();
+
+    /**
+     * @brief Turn to the page at a fraction of the cartridge
+     * @param percent 0 (first page) to 100 (last page)
+     * @return false if the cartridge has no pages
+     */
+    bool jumpToPercent(double percent);
+
+    /**
+     * @brief Get the reading order of the open cartridge
+     * @return Page index, empty if no cartridge is open
+     */
+    const common::database::PageIndex& pageIndex() const { return m_pageIndex; }
+
+    /**
+     * @brief Get the table of contents of the open cartridge
+     * @return Model for a contents sidebar (owned by the view)
+     */
+    NavigationModel* navigationModel() const { return m_navigationModel; }
+
+    /**
+     * @brief Show the target of a table of contents entry
+     *
+     * "page" targets name a page_id, "chapter" targets a chapter_title.
+     *
+     * @param index Entry of navigationModel()
+     * @return false if the entry does not lead to a page
+     */
+    bool openNavigationTarget(const QModelIndex& index);
+
+    /**
+     * @brief Enable or disable rendering the next page in advance
+     *
+     * The hidden page costs about as much memory as the visible one; turn
+     * it off where memory is shorter than time. On by default, except on
+     * machines with less than 4 GB of RAM. The hidden page is muted and has
+     * no web channel until it is swapped in.
+     *
+     * @param enabled Whether to pre-render
+     */
+    void setPrerenderEnabled(bool enabled);
+
+    /**
+     * @brief Commit buffered form data and settings to disk
+     *
+     * Called when the window closes; form autosave is otherwise written
+     * behind in batches.
+     *
+     * @return true if all buffered writes were committed
+     */
+    bool flushPendingWrites();
+
+    /**
+     * @brief Search the open cartridge's pages
+     *
+     * Uses the index shipped in the cartridge. Cartridges without one are
+     * indexed into a sidecar in the background when loaded; until that
+     * finishes there is no index to search (see isSearchReady()).
+     *
+     * @param text Text typed by the user
+     * @param limit Maximum number of hits
+     * @return Hits in rank order, empty if nothing matches or the index is not ready
+     */
+    QList<common::database::CartridgeSearchIndex::Hit> search(const QString& text, int limit = 50);
+
+    /**
+     * @brief Check whether the open cartridge can be searched yet
+     * @return true once its index is available; searchReady() reports the change
+     */
+    bool isSearchReady() const;
+
+    /**
+     * @brief Show the page of a search hit and highlight its first match
+     * @param hit Hit returned by search()
+     */
+    void showSearchHit(const common::database::CartridgeSearchIndex::Hit& hit);
+
 signals:
     void contentLoaded();
     void errorOccurred(const QString& errorMessage);
 
+    /**
+     * @brief The search index of the loaded cartridge is settled
+     * @param available false if it could not be built
+     */
+    void searchReady(bool available);
+
 private slots:
     void onLoadFinished(bool success);
 
 private:
     void setupWebEngine();
+    QWebEnginePage* createPage();
     void loadContentFromDatabase();
-    QString buildHtmlDocument(const QString& htmlContent, const QString& css);
-    QString applySettingsToHtml(const QString& html);
+    void showPage(int pageId);
+    int neighbourPage(int pageId, int step);
+    void prepareNeighbours();
+    void resetPrerender();
+    QByteArray pageDocument(int pageId);
+    void prepareSearchIndex();
+    common::database::NativeConnection* searchConnection();
     
+    QWebEngineProfile* m_profile = nullptr;     // ReaderProfile, shared by all windows
     QWebEngineView* m_webView;
     WebChannelBridge* m_webChannelBridge;
+    QWebChannel* m_webChannel = nullptr;
     common::settings::SettingsManager* m_settingsManager;
+    common::database::CartridgeDBConnector* m_connector;  // Held for the lifetime of the open cartridge
     QString m_cartridgePath;
     QString m_cartridgeGuid;
+    QString m_host;             // Host of the cartridge's smartbook:// URLs
+    common::database::PageIndex m_pageIndex;
+    bool m_pageIndexLoaded = false;     // Else navigation queries the cartridge
+    NavigationModel* m_navigationModel;
+    common::settings::PageTemplate m_pageTemplate;  // Compiled for the current settings
     int m_currentPageId = -1;
+
+    // Page turns: neighbours read ahead, the next page rendered ahead
+    common::database::PagePrefetcher* m_prefetcher;
+    QWebEnginePage* m_prerenderPage = nullptr;  // Hidden; swapped with the view's page
+    int m_prerenderPageId = -1;
+    bool m_prerenderReady = false;
+    bool m_prerenderEnabled = true;  // Off on low-memory machines
+
+    // Search: empty sidecar path means the cartridge carries its own index
+    QString m_searchSidecarPath;
+    QFuture<bool> m_searchSidecarBuild;
+    std::unique_ptr<common::database::NativeConnection> m_searchSidecar;
+    QString m_pendingFind;      // Highlighted once the hit's page has loaded
 };
 
 } // namespace reader
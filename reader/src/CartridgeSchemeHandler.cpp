@@ -0,0 +1,221 @@
+#include "smartbook/reader/CartridgeSchemeHandler.h"
+#include "smartbook/common/database/CartridgeResourceDevice.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include "smartbook/common/utils/FileFingerprint.h"
+#include <QWebEngineUrlScheme>
+#include <QWebEngineUrlRequestJob>
+#include <QWebEngineProfile>
+#include <QCryptographicHash>
+#include <QBuffer>
+#include <QMultiMap>
+#include <QDebug>
+#include <memory>
+
+namespace smartbook {
+namespace reader {
+
+namespace {
+// Hosts of DDD 11 links, relative to the cartridge of the linking page
+const QString PAGE_LINK_HOST = QStringLiteral("page");
+const QString RESOURCE_LINK_HOST = QStringLiteral("resource");
+
+void setValidators(QWebEngineUrlRequestJob* job, const QByteArray& etag, const QByteArray& cacheControl) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+    QMultiMap<QByteArray, QByteArray> headers;
+    headers.insert("ETag", '"' + etag + '"');
+    headers.insert("Cache-Control", cacheControl);
+    headers.insert("Accept-Ranges", "bytes");
+    job->setResponseHeaders(headers);
+#else
+    Q_UNUSED(job);
+    Q_UNUSED(etag);
+    Q_UNUSED(cacheControl);
+#endif
+}
+}
+
+void CartridgeSchemeHandler::registerScheme() {
+    // Host syntax: the cartridge is the origin, so pages of different
+    // cartridges are isolated from each other like different sites
+    QWebEngineUrlScheme scheme(SCHEME);
+    scheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+    scheme.setDefaultPort(QWebEngineUrlScheme::PortUnspecified);
+    scheme.setFlags(QWebEngineUrlScheme::SecureScheme | QWebEngineUrlScheme::LocalScheme
+                    | QWebEngineUrlScheme::CorsEnabled);
+    QWebEngineUrlScheme::registerScheme(scheme);
+}
+
+CartridgeSchemeHandler* CartridgeSchemeHandler::forProfile(QWebEngineProfile* profile) {
+    if (auto* installed = qobject_cast<CartridgeSchemeHandler*>(profile->urlSchemeHandler(SCHEME))) {
+        return installed;
+    }
+    auto* handler = new CartridgeSchemeHandler(profile);
+    profile->installUrlSchemeHandler(SCHEME, handler);
+    return handler;
+}
+
+QUrl CartridgeSchemeHandler::pageUrl(const QString& host, int pageId) {
+    QUrl url;
+    url.setScheme(SCHEME);
+    url.setHost(host);
+    url.setPath(QString("/page/%1").arg(pageId));
+    return url;
+}
+
+int CartridgeSchemeHandler::pageIdOf(const QUrl& url) {
+    if (url.scheme() != QLatin1String(SCHEME)) {
+        return -1;
+    }
+    const QStringList parts = url.path().split('/', Qt::SkipEmptyParts);
+    bool ok = false;
+    const int pageId = parts.size() == 2 && parts.first() == QLatin1String("page") ? parts.last().toInt(&ok) : -1;
+    return ok ? pageId : -1;
+}
+
+CartridgeSchemeHandler::CartridgeSchemeHandler(QObject* parent)
+    : QWebEngineUrlSchemeHandler(parent)
+{
+}
+
+void CartridgeSchemeHandler::addCartridge(QObject* owner, const QString& host, const QString& cartridgePath,
+                                          PageSource pages) {
+    bool known = false;
+    for (const QList<Cartridge>& cartridges : std::as_const(m_cartridges)) {
+        for (const Cartridge& cartridge : cartridges) {
+            known = known || cartridge.owner == owner;
+        }
+    }
+    removeCartridge(owner);
+
+    Cartridge cartridge;
+    cartridge.owner = owner;
+    cartridge.path = cartridgePath;
+    cartridge.pages = std::move(pages);
+    cartridge.contentTag = contentTagOf(cartridgePath);
+    cartridge.resources = std::make_shared<common::database::CartridgeResources>(cartridgePath);
+    m_cartridges[host.toLower()].append(cartridge);
+
+    if (!known) {
+        connect(owner, &QObject::destroyed, this, [this, owner]() {
+            removeCartridge(owner);
+        });
+    }
+}
+
+void CartridgeSchemeHandler::removeCartridge(QObject* owner) {
+    for (auto it = m_cartridges.begin(); it != m_cartridges.end();) {
+        it->removeIf([owner](const Cartridge& cartridge) { return cartridge.owner == owner; });
+        it = it->isEmpty() ? m_cartridges.erase(it) : std::next(it);
+    }
+}
+
+const CartridgeSchemeHandler::Cartridge* CartridgeSchemeHandler::cartridgeFor(const QString& host) const {
+    const auto it = m_cartridges.constFind(host.toLower());
+    return it == m_cartridges.constEnd() ? nullptr : &it->last();
+}
+
+QByteArray CartridgeSchemeHandler::contentTagOf(const QString& cartridgePath) {
+    // The signed content hash changes with any page or resource
+    common::database::NativeConnection connection;
+    if (connection.open(cartridgePath, common::database::CartridgeOpenMode::ReadOnly,
+                        common::database::ConnectionRole::Reader)) {
+        common::database::NativeStatement statement =
+            connection.prepare("SELECT hash_digest FROM Cartridge_Security LIMIT 1");
+        if (statement.isValid() && statement.step() && !statement.columnBlob(0).isEmpty()) {
+            return statement.columnBlob(0).toByteArray().toHex().left(32);
+        }
+    }
+
+    // Unsigned cartridge: the file's state stands in for its content
+    const common::utils::FileFingerprint fingerprint = common::utils::FileFingerprint::of(cartridgePath);
+    return QByteArray::number(fingerprint.size, 16) + '-' + QByteArray::number(fingerprint.modifiedMs, 16);
+}
+
+void CartridgeSchemeHandler::requestStarted(QWebEngineUrlRequestJob* job) {
+    const QUrl url = job->requestUrl();
+    const QString host = url.host();
+    if (job->requestMethod() != "GET") {
+        job->fail(QWebEngineUrlRequestJob::RequestDenied);
+        return;
+    }
+
+    // A page may only reach into its own cartridge
+    const QUrl initiator = job->initiator();
+    const bool fromCartridge = initiator.scheme() == QLatin1String(SCHEME);
+    if (host == PAGE_LINK_HOST || host == RESOURCE_LINK_HOST) {
+        if (!fromCartridge || !cartridgeFor(initiator.host())) {
+            job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+            return;
+        }
+        QUrl target = url;
+        target.setHost(initiator.host());
+        target.setPath('/' + host + url.path());
+        job->redirect(target);
+        return;
+    }
+    if (fromCartridge && initiator.host() != host) {
+        job->fail(QWebEngineUrlRequestJob::RequestDenied);
+        return;
+    }
+
+    const Cartridge* cartridge = cartridgeFor(host);
+    if (!cartridge) {
+        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    // The resource part may itself hold slashes (resource_path)
+    const QString path = url.path(QUrl::FullyDecoded);
+    const int split = path.indexOf('/', 1);
+    const QString kind = path.mid(1, split < 0 ? -1 : split - 1);
+    const QString item = split < 0 ? QString() : path.mid(split + 1);
+    if (kind == QLatin1String("page")) {
+        servePage(job, *cartridge, item);
+    } else if (kind == QLatin1String("resource")) {
+        serveResource(job, *cartridge, item);
+    } else {
+        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+    }
+}
+
+void CartridgeSchemeHandler::servePage(QWebEngineUrlRequestJob* job, const Cartridge& cartridge,
+                                       const QString& pageId) {
+    bool ok = false;
+    const int id = pageId.toInt(&ok);
+    const QByteArray document = ok && cartridge.pages ? cartridge.pages(id) : QByteArray();
+    if (document.isNull()) {
+        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    // Documents carry the reader settings, so revalidate them every time
+    const QByteArray etag = QCryptographicHash::hash(document, QCryptographicHash::Sha256).toHex().left(32);
+    setValidators(job, etag, "no-cache");
+
+    // The job may be read on another thread; the device goes with the job
+    auto* buffer = new QBuffer();
+    buffer->setData(document);
+    buffer->open(QIODevice::ReadOnly);
+    connect(job, &QObject::destroyed, buffer, &QObject::deleteLater);
+    job->reply("text/html", buffer);
+}
+
+void CartridgeSchemeHandler::serveResource(QWebEngineUrlRequestJob* job, const Cartridge& cartridge,
+                                           const QString& resource) {
+    auto device = std::make_unique<common::database::CartridgeResourceDevice>();
+    if (!device->openResource(cartridge.resources, resource)) {
+        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    // The URL stays the same when the cartridge is replaced, so no copy
+    // may be reused without asking; the ETag follows the content hash
+    setValidators(job, cartridge.contentTag + '-' + QCryptographicHash::hash(resource.toUtf8(),
+                  QCryptographicHash::Sha256).toHex().left(16), "no-cache");
+    connect(job, &QObject::destroyed, device.get(), &QObject::deleteLater);
+    const QByteArray mimeType = device->mimeType().toUtf8();
+    job->reply(mimeType, device.release());
+}
+
+} // namespace reader
+} // namespace smartbook
@@ -1,14 +1,20 @@
 #include "smartbook/reader/LibraryManager.h"
 #include "smartbook/reader/ui/LibraryView.h"
 #include "smartbook/reader/ReaderViewWindow.h"
+#include "smartbook/reader/ui/DiagnosticsPanel.h"
 #include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/manifest/CartridgeImporter.h"
+#include "smartbook/common/manifest/LibraryWatcher.h"
+#include "smartbook/common/manifest/ManifestManager.h"
 #include <QMenuBar>
 #include <QMenu>
 #include <QAction>
+#include <QShortcut>
 #include <QStatusBar>
 #include <QMessageBox>
-#include <QSqlQuery>
-#include <QSqlError>
+#include <QFileDialog>
+#include <QProgressDialog>
+#include <QSettings>
 #include <QDebug>
 
 namespace smartbook {
@@ -27,6 +33,14 @@ LibraryManager::LibraryManager(QWidget* parent)
     dbManager.initializeConnection(QString());
 
     loadLibrary();
+
+    // Keeps entries in step with their files; checks every entry once now
+    QSettings settings;
+    m_libraryWatcher = new common::manifest::LibraryWatcher(this);
+    m_libraryWatcher->setRescanInterval(settings.value("library/rescan_interval_minutes", 15).toInt() * 60 * 1000);
+    m_libraryWatcher->start();
+
+    m_manifestManager = new common::manifest::ManifestManager(this);
 }
 
 LibraryManager::~LibraryManager() {
@@ -48,6 +62,10 @@ void LibraryManager::setupUI() {
     connect(m_libraryView, &LibraryView::cartridgeDeleteRequested,
             this, &LibraryManager::onDeleteCartridge);
 
+    // Hidden diagnostics panel; intentionally not listed in any menu
+    QShortcut* diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &LibraryManager::onShowDiagnostics);
+
     statusBar()->showMessage("Ready");
 }
 
@@ -59,6 +77,9 @@ void LibraryManager::setupMenuBar() {
     importAction->setShortcut(QKeySequence::New);
     connect(importAction, &QAction::triggered, this, &LibraryManager::onImportCartridge);
 
+    QAction* importFolderAction = fileMenu->addAction("Import &Folder...");
+    connect(importFolderAction, &QAction::triggered, this, &LibraryManager::onImportFolder);
+
     fileMenu->addSeparator();
 
     QAction* exitAction = fileMenu->addAction("E&xit");
@@ -82,49 +103,10 @@ void LibraryManager::loadLibrary() {
     }
 }
 
-QList<CartridgeInfo> LibraryManager::loadLibraryData()
-{
-    QList<CartridgeInfo> cartridges;
-    
-    common::database::LocalDBManager& dbManager = common::database::LocalDBManager::getInstance();
-    if (!dbManager.isOpen()) {
-        qWarning() << "Database not open for library load";
-        return cartridges;
-    }
-    
-    QSqlQuery query(dbManager.getDatabase());
-    query.prepare(R"(
-        SELECT cartridge_guid, title, author, publication_year, 
-               publisher, version, local_path, cover_image_data
-        FROM Local_Library_Manifest
-        ORDER BY title
-    )");
-    
-    if (!query.exec()) {
-        qWarning() << "Failed to load library:" << query.lastError().text();
-        return cartridges;
-    }
-    
-    while (query.next()) {
-        CartridgeInfo info;
-        info.cartridgeGuid = query.value(0).toString();
-        info.title = query.value(1).toString();
-        info.author = query.value(2).toString();
-        info.publicationYear = query.value(3).toString();
-        info.publisher = query.value(4).toString();
-        info.version = query.value(5).toString();
-        info.localPath = query.value(6).toString();
-        info.coverImageData = query.value(7).toByteArray();
-        
-        if (info.isValid()) {
-            cartridges.append(info);
-        }
-    }
-    
-    return cartridges;
-}
-
 void LibraryManager::openCartridge(const QString& cartridgeGuid) {
+    // For the "recently opened" order; the library picks it up from the change feed
+    m_manifestManager->recordOpenedAsync(cartridgeGuid);
+
     // Create new Reader View Window
     ReaderViewWindow* readerWindow = new ReaderViewWindow(cartridgeGuid, this);
     m_readerWindows.append(readerWindow);
@@ -137,9 +119,92 @@ void LibraryManager::openCartridge(const QString& cartridgeGuid) {
 }
 
 void LibraryManager::onImportCartridge() {
-    // TODO: Implement import dialog
-    QMessageBox::information(this, "Import Cartridge",
-        "Import functionality will be implemented.");
+    const QStringList files = QFileDialog::getOpenFileNames(this, "Import Cartridges", QString(),
+                                                            "SmartBook Cartridges (*.sqlite)");
+    if (!files.isEmpty()) {
+        startImport(files);
+    }
+}
+
+void LibraryManager::onImportFolder() {
+    const QString directory = QFileDialog::getExistingDirectory(this, "Import Folder");
+    if (!directory.isEmpty()) {
+        startImport(QStringList() << directory);
+    }
+}
+
+void LibraryManager::startImport(const QStringList& paths) {
+    if (m_importer && m_importer->isRunning()) {
+        QMessageBox::information(this, "Import", "An import is already running.");
+        return;
+    }
+
+    if (!m_importer) {
+        m_importer = new common::manifest::CartridgeImporter(this);
+        connect(m_importer, &common::manifest::CartridgeImporter::finished,
+                this, &LibraryManager::onImportFinished);
+    }
+
+    // Lower import/max_concurrent_reads for spinning disks and USB sticks
+    QSettings settings;
+    common::manifest::CartridgeImporter::Options options;
+    options.workerCount = settings.value("import/worker_count", 0).toInt();
+    options.maxConcurrentReads = settings.value("import/max_concurrent_reads", 0).toInt();
+    options.batchSize = qMax(1, settings.value("import/batch_size", options.batchSize).toInt());
+    m_importer->setOptions(options);
+
+    m_importProgress = new QProgressDialog("Importing cartridges...", "Cancel", 0, 0, this);
+    m_importProgress->setWindowModality(Qt::WindowModal);
+    m_importProgress->setMinimumDuration(500);
+    m_importProgress->setAutoClose(false);
+    m_importProgress->setAutoReset(false);
+    connect(m_importProgress, &QProgressDialog::canceled,
+            m_importer, &common::manifest::CartridgeImporter::cancel);
+    connect(m_importer, &common::manifest::CartridgeImporter::progress,
+            m_importProgress, [this](int processed, int total) {
+        m_importProgress->setMaximum(total);
+        m_importProgress->setValue(processed);
+        m_importProgress->setLabelText(QString("Importing cartridges (%1 of %2)...").arg(processed).arg(total));
+    });
+
+    statusBar()->showMessage("Importing cartridges...");
+    m_importer->start(paths);
+}
+
+void LibraryManager::onImportFinished(bool cancelled) {
+    if (m_importProgress) {
+        m_importProgress->deleteLater();
+        m_importProgress = nullptr;
+    }
+
+    // New rows reach the library view through the manifest change feed;
+    // the rescan starts watching the directories they came from
+    if (m_libraryWatcher) {
+        m_libraryWatcher->rescan();
+    }
+    const common::manifest::CartridgeImporter::Summary summary = m_importer->summary();
+    QString message = QString("%1 cartridges added, %2 updated, %3 already in the library, %4 failed.")
+        .arg(summary.created).arg(summary.updated).arg(summary.unchanged).arg(summary.failed);
+    if (cancelled) {
+        message.prepend("Import cancelled. ");
+    }
+    statusBar()->showMessage(message, 10000);
+
+    if (summary.total == 0) {
+        QMessageBox::information(this, "Import", "No cartridges were found.");
+        return;
+    }
+
+    QMessageBox box(summary.failed > 0 ? QMessageBox::Warning : QMessageBox::Information,
+                    "Import", message, QMessageBox::Ok, this);
+    if (!summary.failures.isEmpty()) {
+        QStringList details;
+        for (const auto& failure : summary.failures) {
+            details.append(QString("%1: %2").arg(failure.path, failure.errorMessage));
+        }
+        box.setDetailedText(details.join('\n'));
+    }
+    box.exec();
 }
 
 void LibraryManager::onDeleteCartridge(const QString& /* cartridgeGuid */) {
@@ -158,5 +223,15 @@ void LibraryManager::onCartridgeDoubleClicked(const QString& cartridgeGuid) {
     openCartridge(cartridgeGuid);
 }
 
+void LibraryManager::onShowDiagnostics() {
+    if (!m_diagnosticsPanel) {
+        m_diagnosticsPanel = new ui::DiagnosticsPanel(this);
+    }
+    m_diagnosticsPanel->refresh();
+    m_diagnosticsPanel->show();
+    m_diagnosticsPanel->raise();
+    m_diagnosticsPanel->activateWindow();
+}
+
 } // namespace reader
 } // namespace smartbook
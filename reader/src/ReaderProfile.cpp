@@ -0,0 +1,107 @@
+#include "smartbook/reader/ReaderProfile.h"
+#include "smartbook/reader/CartridgeSchemeHandler.h"
+#include <QCoreApplication>
+#include <QPointer>
+#include <QSettings>
+#include <QStringList>
+#include <QWebEngineProfile>
+#include <QWebEngineSettings>
+#include <QDebug>
+
+namespace smartbook {
+namespace reader {
+
+namespace {
+const char CHROMIUM_FLAGS[] = "QTWEBENGINE_CHROMIUM_FLAGS";
+
+const QStringList PROCESS_MODELS = {
+    QStringLiteral("process-per-site"),
+    QStringLiteral("process-per-site-instance"),
+    QStringLiteral("single-process")
+};
+
+QPointer<QWebEngineProfile> s_profile;
+}
+
+ReaderProfile::Options ReaderProfile::s_options;
+
+void ReaderProfile::loadSettings(QSettings& settings) {
+    Options options = s_options;
+
+    settings.beginGroup("reader/web");
+    options.httpCacheMiB = qBound(0, settings.value("http_cache_mb", options.httpCacheMiB).toInt(), 2047);
+    options.persistent = settings.value("persistent", options.persistent).toBool();
+    const QString processModel = settings.value("process_model", options.processModel).toString().toLower();
+    if (PROCESS_MODELS.contains(processModel)) {
+        options.processModel = processModel;
+    } else {
+        qWarning() << "ReaderProfile: Unknown process model" << processModel << "- using" << options.processModel;
+    }
+    options.javascriptEnabled = settings.value("javascript_enabled", options.javascriptEnabled).toBool();
+    settings.endGroup();
+
+    setOptions(options);
+}
+
+const ReaderProfile::Options& ReaderProfile::options() {
+    return s_options;
+}
+
+void ReaderProfile::setOptions(const Options& options) {
+    if (s_profile) {
+        qWarning() << "ReaderProfile: Options changed after the profile was created; they apply on restart";
+    }
+    s_options = options;
+}
+
+void ReaderProfile::applyProcessModel() {
+    QByteArray flags = qgetenv(CHROMIUM_FLAGS);
+    for (const QString& model : PROCESS_MODELS) {
+        if (flags.contains("--" + model.toLatin1())) {
+            return;
+        }
+    }
+
+    // Chromium's default needs no flag
+    if (s_options.processModel == QLatin1String("process-per-site-instance")) {
+        return;
+    }
+    if (!flags.isEmpty()) {
+        flags += ' ';
+    }
+    flags += "--" + s_options.processModel.toLatin1();
+    qputenv(CHROMIUM_FLAGS, flags);
+}
+
+QWebEngineProfile* ReaderProfile::instance() {
+    if (!s_profile) {
+        // Named profiles keep their cache on disk; unnamed ones are off the record
+        s_profile = s_options.persistent
+                        ? new QWebEngineProfile(QString::fromLatin1(STORAGE_NAME), QCoreApplication::instance())
+                        : new QWebEngineProfile(QCoreApplication::instance());
+        configure(s_profile);
+    }
+    return s_profile;
+}
+
+void ReaderProfile::configure(QWebEngineProfile* profile) {
+    profile->setHttpCacheType(s_options.persistent ? QWebEngineProfile::DiskHttpCache
+                                                   : QWebEngineProfile::MemoryHttpCache);
+    profile->setHttpCacheMaximumSize(s_options.httpCacheMiB * 1024 * 1024);
+
+    // Cartridges have no use for cookies beyond the session
+    profile->setPersistentCookiesPolicy(QWebEngineProfile::NoPersistentCookies);
+
+    QWebEngineSettings* settings = profile->settings();
+    settings->setAttribute(QWebEngineSettings::JavascriptEnabled, s_options.javascriptEnabled);
+    settings->setAttribute(QWebEngineSettings::JavascriptCanOpenWindows, false);
+    settings->setAttribute(QWebEngineSettings::LocalStorageEnabled, true);
+    settings->setAttribute(QWebEngineSettings::LocalContentCanAccessFileUrls, false);
+    settings->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, false);
+    settings->setAttribute(QWebEngineSettings::PluginsEnabled, false);
+
+    CartridgeSchemeHandler::forProfile(profile);
+}
+
+} // namespace reader
+} // namespace smartbook
@@ -1,10 +1,14 @@
 #include "smartbook/reader/ReaderViewWindow.h"
 #include "smartbook/reader/ui/ReaderView.h"
+#include "smartbook/reader/ui/NavigationModel.h"
 #include "smartbook/reader/WebChannelBridge.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
 #include "smartbook/common/database/LocalDBManager.h"
 #include "smartbook/common/manifest/ManifestManager.h"
 #include <QCloseEvent>
+#include <QShortcut>
+#include <QDockWidget>
+#include <QTreeView>
 #include <QSqlQuery>
 #include <QDebug>
 #include <QApplication>
@@ -37,6 +41,32 @@ void ReaderViewWindow::setupUI() {
             this, &ReaderViewWindow::onContentLoaded);
     connect(m_readerView, &ReaderView::errorOccurred,
             this, &ReaderViewWindow::onError);
+
+    // Page turns; plain Page Up/Down still scroll within a page
+    connect(new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_PageDown), this), &QShortcut::activated,
+            m_readerView, &ReaderView::nextPage);
+    connect(new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_PageUp), this), &QShortcut::activated,
+            m_readerView, &ReaderView::previousPage);
+    connect(new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_Home), this), &QShortcut::activated,
+            m_readerView, &ReaderView::firstPage);
+    connect(new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_End), this), &QShortcut::activated,
+            m_readerView, &ReaderView::lastPage);
+
+    // Table of contents; shown only for cartridges that have one
+    auto* contentsView = new QTreeView(this);
+    contentsView->setModel(m_readerView->navigationModel());
+    contentsView->setHeaderHidden(true);
+    contentsView->setUniformRowHeights(true);
+    connect(contentsView, &QTreeView::activated, m_readerView, &ReaderView::openNavigationTarget);
+
+    auto* contentsDock = new QDockWidget(tr("Contents"), this);
+    contentsDock->setObjectName("contentsDock");
+    contentsDock->setWidget(contentsView);
+    contentsDock->hide();
+    addDockWidget(Qt::LeftDockWidgetArea, contentsDock);
+    connect(m_readerView->navigationModel(), &QAbstractItemModel::modelReset, contentsDock, [contentsDock, this]() {
+        contentsDock->setVisible(m_readerView->navigationModel()->rowCount() > 0);
+    });
 }
 
 void ReaderViewWindow::loadCartridge() {
@@ -88,6 +118,10 @@ void ReaderViewWindow::onError(const QString& errorMessage) {
 }
 
 void ReaderViewWindow::closeEvent(QCloseEvent* event) {
+    // Form autosave is buffered; make it durable before the window goes away
+    if (m_readerView) {
+        m_readerView->flushPendingWrites();
+    }
     saveWindowState();
     QMainWindow::closeEvent(event);
 }
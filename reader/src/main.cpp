@@ -1,16 +1,28 @@
 #include <QApplication>
 #include <QStyleFactory>
 #include "smartbook/reader/LibraryManager.h"
+#include "smartbook/reader/CartridgeSchemeHandler.h"
+#include "smartbook/reader/ReaderProfile.h"
 #include "smartbook/common/utils/PlatformUtils.h"
+#include "smartbook/common/database/ConnectionProfile.h"
+#include "smartbook/common/database/QueryStats.h"
+#include <QSettings>
 
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
+    // Set application metadata (before the app, so QSettings finds them)
+    QApplication::setApplicationName("SmartBook Reader");
+    QApplication::setApplicationVersion("1.0.0");
+    QApplication::setOrganizationName("SmartBook");
+    QApplication::setOrganizationDomain("smartbook.org");
+
+    // Custom schemes and the process model have to be known to QWebEngine
+    // before it starts
+    QSettings settings;
+    smartbook::reader::CartridgeSchemeHandler::registerScheme();
+    smartbook::reader::ReaderProfile::loadSettings(settings);
+    smartbook::reader::ReaderProfile::applyProcessModel();
 
-    // Set application metadata
-    app.setApplicationName("SmartBook Reader");
-    app.setApplicationVersion("1.0.0");
-    app.setOrganizationName("SmartBook");
-    app.setOrganizationDomain("smartbook.org");
+    QApplication app(argc, argv);
 
     // Apply Qt Fusion style for uniform appearance
     app.setStyle(QStyleFactory::create("Fusion"));
@@ -18,6 +30,10 @@ int main(int argc, char *argv[]) {
     // Initialize platform-specific settings
     smartbook::common::utils::PlatformUtils::getApplicationDataDirectory();
 
+    // Apply SQLite connection profile overrides before any database is opened
+    smartbook::common::database::ConnectionProfile::loadOverrides(settings);
+    smartbook::common::database::QueryStats::getInstance().loadSettings(settings);
+
     // Create and show Library Manager
     smartbook::reader::LibraryManager libraryManager;
     libraryManager.show();
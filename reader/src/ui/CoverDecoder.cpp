@@ -0,0 +1,98 @@
+#include "smartbook/reader/ui/CoverDecoder.h"
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include <QRunnable>
+#include <QThread>
+#include <QMutexLocker>
+
+namespace smartbook {
+namespace reader {
+
+class CoverDecodeJob : public QRunnable {
+public:
+    CoverDecodeJob(CoverDecoder* decoder, const QString& key, int tag, const QByteArray& data, const QSize& maxSize)
+        : m_decoder(decoder)
+        , m_key(key)
+        , m_tag(tag)
+        , m_data(data)
+        , m_maxSize(maxSize)
+    {
+    }
+
+    const QString& key() const { return m_key; }
+
+    void run() override {
+        m_decoder->jobStarted(this);
+        const QImage image = smartbook::common::manifest::CoverThumbnailStore::decodeScaled(m_data, m_maxSize);
+        emit m_decoder->decoded(m_key, m_tag, image);
+    }
+
+private:
+    CoverDecoder* m_decoder;
+    QString m_key;
+    int m_tag;
+    QByteArray m_data;
+    QSize m_maxSize;
+};
+
+CoverDecoder::CoverDecoder(QObject* parent)
+    : QObject(parent)
+{
+    // Leave a core for the GUI and the database executor
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() - 1, 4));
+}
+
+CoverDecoder::~CoverDecoder() {
+    cancelQueued();
+    m_pool.waitForDone();
+}
+
+void CoverDecoder::decode(const QString& key, int tag, const QByteArray& data, const QSize& maxSize, int priority) {
+    QMutexLocker locker(&m_mutex);
+    if (m_queued.contains(key)) {
+        return;
+    }
+
+    CoverDecodeJob* job = new CoverDecodeJob(this, key, tag, data, maxSize);
+    m_queued.insert(key, job);
+    m_pool.start(job, priority);
+}
+
+QStringList CoverDecoder::cancelQueued(const std::function<bool(const QString& key)>& predicate) {
+    QStringList cancelled;
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_queued.begin(); it != m_queued.end();) {
+        if (predicate && !predicate(it.key())) {
+            ++it;
+            continue;
+        }
+        // A job a pool thread already took runs to completion
+        if (!m_pool.tryTake(it.value())) {
+            ++it;
+            continue;
+        }
+        delete it.value();
+        cancelled.append(it.key());
+        it = m_queued.erase(it);
+    }
+    return cancelled;
+}
+
+int CoverDecoder::queuedCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_queued.size();
+}
+
+void CoverDecoder::setMaxThreadCount(int threads) {
+    m_pool.setMaxThreadCount(qMax(1, threads));
+}
+
+void CoverDecoder::jobStarted(CoverDecodeJob* job) {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_queued.find(job->key());
+    if (it != m_queued.end() && it.value() == job) {
+        m_queued.erase(it);
+    }
+}
+
+} // namespace reader
+} // namespace smartbook
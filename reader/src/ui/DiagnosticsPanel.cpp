@@ -0,0 +1,149 @@
+#include "smartbook/reader/ui/DiagnosticsPanel.h"
+#include "smartbook/common/database/QueryStats.h"
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QPlainTextEdit>
+#include <QSplitter>
+#include <QFileDialog>
+#include <QMessageBox>
+
+namespace smartbook {
+namespace reader {
+namespace ui {
+
+namespace {
+
+QString formatMs(qint64 ns) {
+    return QString::number(static_cast<double>(ns) / 1000000.0, 'f', 3);
+}
+
+QTableWidgetItem* numberItem(const QString& text) {
+    QTableWidgetItem* item = new QTableWidgetItem(text);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+DiagnosticsPanel::DiagnosticsPanel(QWidget* parent)
+    : QDialog(parent)
+{
+    setupUI();
+    refresh();
+}
+
+DiagnosticsPanel::~DiagnosticsPanel() {
+}
+
+void DiagnosticsPanel::setupUI() {
+    setWindowTitle("Database Diagnostics");
+    resize(1000, 650);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+
+    m_summaryLabel = new QLabel(this);
+    layout->addWidget(m_summaryLabel);
+
+    QSplitter* splitter = new QSplitter(Qt::Vertical, this);
+
+    m_statementTable = new QTableWidget(0, 9, splitter);
+    m_statementTable->setHorizontalHeaderLabels({
+        "Statement", "Calls", "Total ms", "p50 ms", "p95 ms", "p99 ms", "Max ms", "Rows", "Bytes"
+    });
+    m_statementTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_statementTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_statementTable->setWordWrap(false);
+    m_statementTable->verticalHeader()->setVisible(false);
+    m_statementTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    m_slowQueryLog = new QPlainTextEdit(splitter);
+    m_slowQueryLog->setReadOnly(true);
+    m_slowQueryLog->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    splitter->addWidget(m_statementTable);
+    splitter->addWidget(m_slowQueryLog);
+    layout->addWidget(splitter);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton* refreshButton = buttonBox->addButton("Refresh", QDialogButtonBox::ActionRole);
+    QPushButton* resetButton = buttonBox->addButton("Reset", QDialogButtonBox::ResetRole);
+    QPushButton* saveButton = buttonBox->addButton("Save JSON...", QDialogButtonBox::ActionRole);
+
+    connect(refreshButton, &QPushButton::clicked, this, &DiagnosticsPanel::refresh);
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsPanel::onReset);
+    connect(saveButton, &QPushButton::clicked, this, &DiagnosticsPanel::onSaveJson);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    layout->addWidget(buttonBox);
+}
+
+void DiagnosticsPanel::refresh() {
+    using QueryStats = smartbook::common::database::QueryStats;
+    QueryStats& queryStats = QueryStats::getInstance();
+
+    const QList<QueryStats::StatementStats> statements = queryStats.statements();
+    m_statementTable->setRowCount(statements.size());
+
+    for (int row = 0; row < statements.size(); ++row) {
+        const QueryStats::StatementStats& stats = statements.at(row);
+        QTableWidgetItem* sqlItem = new QTableWidgetItem(stats.sql);
+        sqlItem->setToolTip(stats.plan.isEmpty() ? stats.sql : stats.sql + "\n\n" + stats.plan.join('\n'));
+        m_statementTable->setItem(row, 0, sqlItem);
+        m_statementTable->setItem(row, 1, numberItem(QString::number(stats.calls)));
+        m_statementTable->setItem(row, 2, numberItem(formatMs(stats.totalNs)));
+        m_statementTable->setItem(row, 3, numberItem(formatMs(stats.p50Ns)));
+        m_statementTable->setItem(row, 4, numberItem(formatMs(stats.p95Ns)));
+        m_statementTable->setItem(row, 5, numberItem(formatMs(stats.p99Ns)));
+        m_statementTable->setItem(row, 6, numberItem(formatMs(stats.maxNs)));
+        m_statementTable->setItem(row, 7, numberItem(QString::number(stats.rows)));
+        m_statementTable->setItem(row, 8, numberItem(QString::number(stats.bytes)));
+    }
+    m_statementTable->resizeColumnsToContents();
+
+    const QList<QueryStats::SlowQuery> slowQueries = queryStats.slowQueries();
+    QStringList lines;
+    for (auto it = slowQueries.crbegin(); it != slowQueries.crend(); ++it) {
+        lines << QString("[%1] %2 ms, %3 rows on %4")
+                     .arg(it->timestamp.toLocalTime().toString("HH:mm:ss.zzz"),
+                          formatMs(it->elapsedNs),
+                          QString::number(it->rows),
+                          it->connectionName);
+        lines << "  " + it->sql;
+        for (const QString& step : it->plan) {
+            lines << "    " + step;
+        }
+        lines << QString();
+    }
+    m_slowQueryLog->setPlainText(lines.isEmpty() ? "No slow queries recorded." : lines.join('\n'));
+
+    m_summaryLabel->setText(QString("%1 statements, %2 slow queries (threshold %3 ms)%4")
+                                .arg(statements.size())
+                                .arg(slowQueries.size())
+                                .arg(queryStats.slowQueryThresholdMs())
+                                .arg(queryStats.isEnabled() ? QString() : " - collection disabled"));
+}
+
+void DiagnosticsPanel::onReset() {
+    smartbook::common::database::QueryStats::getInstance().reset();
+    refresh();
+}
+
+void DiagnosticsPanel::onSaveJson() {
+    const QString filePath = QFileDialog::getSaveFileName(this, "Save Query Statistics",
+                                                          "query-stats.json", "JSON Files (*.json)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    if (!smartbook::common::database::QueryStats::getInstance().dumpJson(filePath)) {
+        QMessageBox::warning(this, "Save Failed", "Could not write query statistics to " + filePath);
+    }
+}
+
+} // namespace ui
+} // namespace reader
+} // namespace smartbook
@@ -0,0 +1,495 @@
+#include "smartbook/reader/ui/LibraryGroupModel.h"
+#include "smartbook/reader/ui/LibraryModel.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/manifest/ManifestChangeFeed.h"
+#include <QFuture>
+#include <algorithm>
+#include <QDebug>
+
+namespace smartbook {
+namespace reader {
+
+using smartbook::common::manifest::LibraryGroups;
+
+namespace {
+// Result of a refresh: the top level, and the editions of loaded series
+struct GroupSnapshot {
+    QList<LibraryGroups::Group> groups;
+    QHash<QString, QList<LibraryGroups::Group>> editions;
+};
+}
+
+int LibraryGroupModel::Node::row() const {
+    if (!parent) {
+        return 0;
+    }
+    for (int i = 0; i < static_cast<int>(parent->children.size()); ++i) {
+        if (parent->children[i].get() == this) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+LibraryGroupModel::LibraryGroupModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{
+    // Manifest writes (published on the executor thread) are collected and
+    // merged in one task
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(0);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &LibraryGroupModel::refresh);
+    connect(&smartbook::common::manifest::ManifestChangeFeed::getInstance(),
+            &smartbook::common::manifest::ManifestChangeFeed::entryChanged,
+            this, [this](smartbook::common::manifest::ManifestChangeFeed::ChangeType, const QString& guid) {
+        onEntryChanged(guid);
+    });
+}
+
+LibraryGroupModel::~LibraryGroupModel() {
+}
+
+QModelIndex LibraryGroupModel::index(int row, int column, const QModelIndex& parent) const {
+    const Node* node = nodeFor(parent);
+    if (!node || row < 0 || row >= static_cast<int>(node->children.size())
+        || column < 0 || column >= LibraryModel::ColumnCount) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, node->children[row].get());
+}
+
+QModelIndex LibraryGroupModel::parent(const QModelIndex& child) const {
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    Node* node = static_cast<Node*>(child.internalPointer());
+    return indexFor(node->parent);
+}
+
+int LibraryGroupModel::rowCount(const QModelIndex& parent) const {
+    if (parent.column() > 0) {
+        return 0;
+    }
+    const Node* node = nodeFor(parent);
+    return node ? static_cast<int>(node->children.size()) : 0;
+}
+
+int LibraryGroupModel::columnCount(const QModelIndex&) const {
+    return LibraryModel::ColumnCount;
+}
+
+bool LibraryGroupModel::hasChildren(const QModelIndex& parent) const {
+    if (parent.column() > 0) {
+        return false;
+    }
+    const Node* node = nodeFor(parent);
+    if (!node || !node->isGroup) {
+        return false;
+    }
+    // Counts come with the group, so the expander is right before fetching
+    return node == &m_root || node->group.cartridgeCount > 0;
+}
+
+QVariant LibraryGroupModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const Node* node = static_cast<const Node*>(index.internalPointer());
+    if (node->isGroup) {
+        if (role == CountRole) {
+            return node->group.cartridgeCount;
+        }
+        if (role != Qt::DisplayRole || index.column() != LibraryModel::TitleColumn) {
+            return QVariant();
+        }
+        const QString name = node->group.name.isEmpty() ? tr("No series") : node->group.name;
+        return QStringLiteral("%1 (%2)").arg(name).arg(node->group.cartridgeCount);
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case LibraryModel::TitleColumn:
+            return node->member.title;
+        case LibraryModel::AuthorColumn:
+            return node->member.author;
+        case LibraryModel::VersionColumn:
+            return node->member.version;
+        case LibraryModel::YearColumn:
+            return node->member.publicationYear;
+        default:
+            return QVariant();
+        }
+    case LibraryModel::GuidRole:
+        return node->member.cartridgeGuid;
+    default:
+        return QVariant();
+    }
+}
+
+QVariant LibraryGroupModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractItemModel::headerData(section, orientation, role);
+    }
+
+    // Same columns as the List View
+    switch (section) {
+    case LibraryModel::TitleColumn:
+        return QStringLiteral("Title");
+    case LibraryModel::AuthorColumn:
+        return QStringLiteral("Author");
+    case LibraryModel::VersionColumn:
+        return QStringLiteral("Edition/Version");
+    case LibraryModel::YearColumn:
+        return QStringLiteral("Year of Publication");
+    default:
+        return QVariant();
+    }
+}
+
+bool LibraryGroupModel::canFetchMore(const QModelIndex& parent) const {
+    const Node* node = nodeFor(parent);
+    return node && node->isGroup && !node->atEnd && node->fetchToken == 0;
+}
+
+void LibraryGroupModel::fetchMore(const QModelIndex& parent) {
+    Node* node = nodeFor(parent);
+    if (!node || !node->isGroup || node->atEnd || node->fetchToken != 0) {
+        return;
+    }
+    startFetch(node);
+}
+
+void LibraryGroupModel::setGrouping(Grouping grouping) {
+    if (grouping == m_grouping) {
+        return;
+    }
+    m_grouping = grouping;
+    reload();
+}
+
+void LibraryGroupModel::reload() {
+    beginResetModel();
+    m_root.children.clear();
+    m_root.groupChildren = 0;
+    m_root.membersLoaded = 0;
+    m_root.groupsLoaded = false;
+    m_root.atEnd = false;
+    m_root.fetchToken = 0;
+    m_fetches.clear();          // Results of dropped nodes are discarded
+    m_changedGuids.clear();
+    m_refreshPending = false;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+const LibraryGroups::Group* LibraryGroupModel::groupAt(const QModelIndex& index) const {
+    const Node* node = index.isValid() ? static_cast<const Node*>(index.internalPointer()) : nullptr;
+    return node && node->isGroup ? &node->group : nullptr;
+}
+
+LibraryGroupModel::Node* LibraryGroupModel::nodeFor(const QModelIndex& index) const {
+    if (!index.isValid()) {
+        return const_cast<Node*>(&m_root);
+    }
+    return static_cast<Node*>(index.internalPointer());
+}
+
+QModelIndex LibraryGroupModel::indexFor(Node* node, int column) const {
+    if (!node || node == &m_root) {
+        return QModelIndex();
+    }
+    return createIndex(node->row(), column, node);
+}
+
+bool LibraryGroupModel::sameGroup(const LibraryGroups::Group& a, const LibraryGroups::Group& b) {
+    if (a.kind != b.kind) {
+        return false;
+    }
+    if (a.kind == LibraryGroups::Kind::Collection) {
+        return a.collectionId == b.collectionId;
+    }
+    return a.seriesName == b.seriesName && a.editionName == b.editionName;
+}
+
+void LibraryGroupModel::startFetch(Node* node) {
+    smartbook::common::database::LocalDBManager& dbManager =
+        smartbook::common::database::LocalDBManager::getInstance();
+    if (!dbManager.isOpen()) {
+        return;
+    }
+
+    const quint64 token = ++m_nextToken;
+    node->fetchToken = token;
+    m_fetches.insert(token, node);
+
+    // The top level is one row per group; a group reads its editions once,
+    // then a page of its own cartridges per fetch
+    const bool top = node == &m_root;
+    const Grouping grouping = m_grouping;
+    const LibraryGroups::Group group = node->group;
+    const bool withGroups = !node->groupsLoaded;
+    const LibraryGroups::Member after = node->membersLoaded > 0 ? node->children.back()->member
+                                                                : LibraryGroups::Member();
+
+    QFuture<Fetched> fetched = dbManager.executor().submit(
+        [top, grouping, group, withGroups, after](QSqlDatabase& database) {
+        Fetched result;
+        result.withGroups = withGroups;
+        if (top) {
+            result.groups = grouping == Grouping::Series ? LibraryGroups::seriesGroups(database)
+                                                         : LibraryGroups::collections(database);
+            return result;
+        }
+        if (withGroups && group.kind == LibraryGroups::Kind::Series) {
+            result.groups = LibraryGroups::editionGroups(database, group.seriesName);
+        }
+        result.members = LibraryGroups::members(database, group, PAGE_SIZE, after);
+        return result;
+    });
+
+    // Skipped if the node was dropped or reloaded meanwhile
+    fetched.then(this, [this, token](const Fetched& result) {
+        Node* node = m_fetches.take(token);
+        if (!node) {
+            return;
+        }
+        node->fetchToken = 0;
+        appendFetched(node, result);
+    }).onCanceled(this, [this, token]() {
+        // Database closed before the fetch ran
+        if (Node* node = m_fetches.take(token)) {
+            node->fetchToken = 0;
+            node->atEnd = true;
+        }
+    });
+}
+
+void LibraryGroupModel::appendFetched(Node* node, const Fetched& fetched) {
+    if (node == &m_root) {
+        mergeGroups(fetched.groups);
+        m_root.groupsLoaded = true;
+        m_root.atEnd = true;
+        emit childrenLoaded(QModelIndex());
+        if (m_refreshPending) {
+            m_refreshTimer.start();
+        }
+        return;
+    }
+
+    const int groups = fetched.withGroups ? fetched.groups.size() : 0;
+    const int count = groups + fetched.members.size();
+    if (count > 0) {
+        const int first = static_cast<int>(node->children.size());
+        beginInsertRows(indexFor(node), first, first + count - 1);
+        for (int i = 0; i < groups; ++i) {
+            auto child = std::make_unique<Node>();
+            child->parent = node;
+            child->group = fetched.groups.at(i);
+            node->children.push_back(std::move(child));
+        }
+        for (const LibraryGroups::Member& member : fetched.members) {
+            auto child = std::make_unique<Node>();
+            child->parent = node;
+            child->isGroup = false;
+            child->atEnd = true;
+            child->member = member;
+            node->children.push_back(std::move(child));
+        }
+        node->groupChildren += groups;
+        endInsertRows();
+    }
+
+    node->groupsLoaded = true;
+    node->membersLoaded += fetched.members.size();
+    node->atEnd = fetched.members.size() < PAGE_SIZE;
+    emit childrenLoaded(indexFor(node));
+}
+
+void LibraryGroupModel::mergeGroups(const QList<LibraryGroups::Group>& groups) {
+    // Groups that are gone
+    for (int row = static_cast<int>(m_root.children.size()) - 1; row >= 0; --row) {
+        const LibraryGroups::Group& current = m_root.children[row]->group;
+        const bool kept = std::any_of(groups.cbegin(), groups.cend(), [&current](const LibraryGroups::Group& group) {
+            return sameGroup(current, group);
+        });
+        if (!kept) {
+            forgetFetches(m_root.children[row].get());
+            beginRemoveRows(QModelIndex(), row, row);
+            m_root.children.erase(m_root.children.begin() + row);
+            endRemoveRows();
+        }
+    }
+
+    // Everything before row i is in place; move or insert group i there
+    for (int i = 0; i < groups.size(); ++i) {
+        const LibraryGroups::Group& group = groups.at(i);
+        int found = -1;
+        for (int row = i; row < static_cast<int>(m_root.children.size()); ++row) {
+            if (sameGroup(m_root.children[row]->group, group)) {
+                found = row;
+                break;
+            }
+        }
+
+        if (found < 0) {
+            beginInsertRows(QModelIndex(), i, i);
+            auto child = std::make_unique<Node>();
+            child->parent = &m_root;
+            child->group = group;
+            m_root.children.insert(m_root.children.begin() + i, std::move(child));
+            endInsertRows();
+            continue;
+        }
+
+        if (found > i) {
+            // Renamed collections change place
+            beginMoveRows(QModelIndex(), found, found, QModelIndex(), i);
+            std::unique_ptr<Node> moved = std::move(m_root.children[found]);
+            m_root.children.erase(m_root.children.begin() + found);
+            m_root.children.insert(m_root.children.begin() + i, std::move(moved));
+            endMoveRows();
+        }
+
+        Node* node = m_root.children[i].get();
+        const bool countChanged = node->group.cartridgeCount != group.cartridgeCount;
+        if (countChanged || node->group.name != group.name) {
+            node->group = group;
+            emit dataChanged(indexFor(node, 0), indexFor(node, LibraryModel::ColumnCount - 1));
+        }
+        if (countChanged) {
+            invalidateChildren(node);
+        }
+    }
+    m_root.groupChildren = static_cast<int>(m_root.children.size());
+}
+
+void LibraryGroupModel::invalidateChildren(Node* node) {
+    const bool loaded = !node->children.empty() || node->fetchToken != 0;
+    if (node->fetchToken != 0) {
+        m_fetches.remove(node->fetchToken);
+        node->fetchToken = 0;
+    }
+    if (!node->children.empty()) {
+        for (const auto& child : node->children) {
+            forgetFetches(child.get());
+        }
+        beginRemoveRows(indexFor(node), 0, static_cast<int>(node->children.size()) - 1);
+        node->children.clear();
+        endRemoveRows();
+    }
+    node->groupChildren = 0;
+    node->membersLoaded = 0;
+    node->groupsLoaded = false;
+    node->atEnd = false;
+
+    // Loaded means the group was expanded; keep it populated
+    if (loaded && node->group.cartridgeCount > 0) {
+        startFetch(node);
+    }
+}
+
+bool LibraryGroupModel::holdsChanged(const Node* node, const QSet<QString>& guids) {
+    for (const auto& child : node->children) {
+        if (child->isGroup ? holdsChanged(child.get(), guids) : guids.contains(child->member.cartridgeGuid)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LibraryGroupModel::forgetFetches(Node* node) {
+    if (node->fetchToken != 0) {
+        m_fetches.remove(node->fetchToken);
+        node->fetchToken = 0;
+    }
+    for (const auto& child : node->children) {
+        forgetFetches(child.get());
+    }
+}
+
+void LibraryGroupModel::onEntryChanged(const QString& cartridgeGuid) {
+    m_changedGuids.insert(cartridgeGuid);
+    m_refreshTimer.start();
+}
+
+void LibraryGroupModel::refresh() {
+    smartbook::common::database::LocalDBManager& dbManager =
+        smartbook::common::database::LocalDBManager::getInstance();
+    if (!m_root.groupsLoaded || m_refreshing) {
+        m_refreshPending = true;    // Picked up by the first fetch or the running refresh
+        return;
+    }
+    if (!dbManager.isOpen()) {
+        return;
+    }
+
+    m_refreshPending = false;
+    m_refreshing = true;
+    const QSet<QString> changed = m_changedGuids;
+    m_changedGuids.clear();
+
+    // Editions are re-read for series whose editions are loaded: a cartridge
+    // moving between editions leaves the series count as it was
+    QStringList loadedSeries;
+    if (m_grouping == Grouping::Series) {
+        for (const auto& child : m_root.children) {
+            if (child->groupsLoaded) {
+                loadedSeries.append(child->group.seriesName);
+            }
+        }
+    }
+
+    const Grouping grouping = m_grouping;
+    QFuture<GroupSnapshot> loaded = dbManager.executor().submit([grouping, loadedSeries](QSqlDatabase& database) {
+        GroupSnapshot snapshot;
+        snapshot.groups = grouping == Grouping::Series ? LibraryGroups::seriesGroups(database)
+                                                       : LibraryGroups::collections(database);
+        for (const QString& series : loadedSeries) {
+            snapshot.editions.insert(series, LibraryGroups::editionGroups(database, series));
+        }
+        return snapshot;
+    });
+
+    loaded.then(this, [this, grouping, changed](const GroupSnapshot& snapshot) {
+        m_refreshing = false;
+        if (grouping != m_grouping || !m_root.groupsLoaded) {
+            return; // Reloaded meanwhile
+        }
+
+        mergeGroups(snapshot.groups);
+
+        // Groups whose count stayed put but whose loaded content changed
+        for (const auto& child : m_root.children) {
+            Node* node = child.get();
+            if (!node->groupsLoaded) {
+                continue;
+            }
+
+            bool stale = holdsChanged(node, changed);
+            const auto editions = snapshot.editions.constFind(node->group.seriesName);
+            if (!stale && node->group.kind == LibraryGroups::Kind::Series && editions != snapshot.editions.cend()) {
+                stale = editions->size() != node->groupChildren;
+                for (int i = 0; !stale && i < editions->size(); ++i) {
+                    const LibraryGroups::Group& current = node->children[i]->group;
+                    stale = !sameGroup(current, editions->at(i))
+                        || current.cartridgeCount != editions->at(i).cartridgeCount;
+                }
+            }
+            if (stale) {
+                invalidateChildren(node);
+            }
+        }
+
+        if (m_refreshPending) {
+            m_refreshTimer.start();
+        }
+    }).onCanceled(this, [this]() {
+        m_refreshing = false;
+    });
+}
+
+} // namespace reader
+} // namespace smartbook
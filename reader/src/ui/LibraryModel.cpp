@@ -0,0 +1,940 @@
+#include "smartbook/reader/ui/LibraryModel.h"
+#include "smartbook/reader/ui/CoverDecoder.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include "smartbook/common/manifest/ManifestChangeFeed.h"
+#include "smartbook/common/manifest/LibrarySearch.h"
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+#include <QImage>
+#include <QColor>
+#include <QSet>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <QDebug>
+
+namespace smartbook {
+namespace reader {
+
+namespace {
+// Covers read, rendered and stored per backfill round
+constexpr int THUMBNAIL_BACKFILL_BATCH = 50;
+
+// Decoded cover budget in KiB (about 850 covers at 2x)
+constexpr int COVER_CACHE_KIB = 64 * 1024;
+
+// LibraryGridProxy shows CoverRole as the decoration, so views are told both
+const QList<int> COVER_ROLES = {LibraryModel::CoverRole, Qt::DecorationRole};
+
+using PendingCover = smartbook::common::manifest::CoverThumbnailStore::PendingCover;
+
+// Renders each cover on its own pool thread; the full-size covers are
+// dropped once rendered so only the thumbnails go back to the executor
+QFuture<QList<PendingCover>> renderCovers(const QList<PendingCover>& covers) {
+    struct Render {
+        QList<PendingCover> covers;
+        std::atomic_int remaining{0};
+        QPromise<QList<PendingCover>> promise;
+    };
+    auto render = std::make_shared<Render>();
+    render->covers = covers;
+    render->remaining = int(covers.size());
+    QFuture<QList<PendingCover>> rendered = render->promise.future();
+    render->promise.start();
+
+    // Detached here, so workers only touch their own element
+    PendingCover* items = render->covers.data();
+    for (qsizetype i = 0; i < covers.size(); ++i) {
+        QThreadPool::globalInstance()->start([render, cover = items + i]() {
+            cover->thumbnails = smartbook::common::manifest::CoverThumbnailStore::renderAll(cover->coverImage);
+            cover->coverImage = QByteArray();
+            if (--render->remaining == 0) {
+                render->promise.addResult(render->covers);
+                render->promise.finish();
+            }
+        });
+    }
+    return rendered;
+}
+}
+
+LibraryModel::LibraryModel(QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_covers(COVER_CACHE_KIB)
+    , m_decoder(new CoverDecoder(this))
+{
+    // Cover requests made while painting are collected and loaded in one task
+    m_coverTimer.setSingleShot(true);
+    m_coverTimer.setInterval(0);
+    connect(&m_coverTimer, &QTimer::timeout, this, &LibraryModel::loadRequestedCovers);
+
+    // Emitted on decoder threads, delivered queued on this thread
+    connect(m_decoder, &CoverDecoder::decoded, this, &LibraryModel::onCoverDecoded);
+
+    // Manifest writes (published on the executor thread) are collected and
+    // applied from the change log in one task
+    m_changeTimer.setSingleShot(true);
+    m_changeTimer.setInterval(0);
+    connect(&m_changeTimer, &QTimer::timeout, this, &LibraryModel::applyManifestChanges);
+    connect(&smartbook::common::manifest::ManifestChangeFeed::getInstance(),
+            &smartbook::common::manifest::ManifestChangeFeed::entryChanged,
+            &m_changeTimer, qOverload<>(&QTimer::start));
+}
+
+LibraryModel::~LibraryModel() {
+    // Decodes still running when the decoder is deleted have nowhere to go
+    disconnect(m_decoder, nullptr, this, nullptr);
+}
+
+int LibraryModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int LibraryModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant LibraryModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const int row = index.row();
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case TitleColumn:
+            return m_rows.titles.at(row);
+        case AuthorColumn:
+            return m_rows.authors.at(row);
+        case VersionColumn:
+            return m_rows.versions.at(row);
+        case YearColumn:
+            return m_rows.years.at(row);
+        default:
+            return QVariant();
+        }
+    case GuidRole:
+        return m_rows.guids.at(row);
+    case CoverRole:
+        if (index.column() == TitleColumn) {
+            const QString& guid = m_rows.guids.at(row);
+            if (const QPixmap* cover = m_covers.object(guid)) {
+                return *cover;
+            }
+            if (!m_noCover.contains(guid)) {
+                requestCover(guid);
+            }
+            // Paints immediately; the cover replaces it when decoded
+            return placeholder();
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+QVariant LibraryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    // DDD 11.1: List-View mandatory columns
+    switch (section) {
+    case TitleColumn:
+        return QStringLiteral("Title");
+    case AuthorColumn:
+        return QStringLiteral("Author");
+    case VersionColumn:
+        return QStringLiteral("Edition/Version");
+    case YearColumn:
+        return QStringLiteral("Year of Publication");
+    default:
+        return QVariant();
+    }
+}
+
+bool LibraryModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !m_atEnd && !m_fetching;
+}
+
+void LibraryModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || m_atEnd || m_fetching) {
+        return;
+    }
+
+    smartbook::common::database::LocalDBManager& dbManager =
+        smartbook::common::database::LocalDBManager::getInstance();
+    if (!dbManager.isOpen()) {
+        return;
+    }
+
+    // DDD 11.1: List-View columns sourced from manifest. Covers are not part
+    // of the page; only whether a thumbnail still has to be rendered. A
+    // search joins the FTS index, so only matching rows are sorted
+    const bool searching = !m_filterMatch.isEmpty();
+    const bool first = m_rows.size() == 0;
+    Conditions conditions = filterConditions("m", m_filter);
+    if (searching) {
+        conditions.clauses.prepend("Local_Library_Search MATCH ?");
+        conditions.values.prepend(m_filterMatch);
+    }
+    if (!first) {
+        // Seek past the last loaded row instead of counting an OFFSET. The
+        // plain bound lets SQLite seek expression indexes too, which it does
+        // not for a row value alone
+        const bool ascending = m_sortOrder == Qt::AscendingOrder;
+        const QString key = sortKey(m_sortColumn, "m");
+        conditions.clauses.append(QString("%1 %2 ?").arg(key, ascending ? ">=" : "<="));
+        conditions.clauses.append(QString("(%1, m.cartridge_guid) %2 (?, ?)").arg(key, ascending ? ">" : "<"));
+        conditions.values.append(lastSortValue());
+        conditions.values.append(lastSortValue());
+        conditions.values.append(m_rows.guids.last());
+    }
+
+    const QString sql = QString(R"(
+        SELECT m.cartridge_guid, m.title, m.author, m.version, m.publication_year, IFNULL(m.last_opened, 0),
+               length(m.cover_image_data) > 0 AND t.cartridge_guid IS NULL
+        FROM Local_Library_Manifest m
+        %1
+        LEFT JOIN Local_Cover_Thumbnails t
+          ON t.cartridge_guid = m.cartridge_guid AND t.scale = ? AND t.cartridge_hash = m.cartridge_hash
+        %2
+        ORDER BY %3
+        LIMIT ?
+    )").arg(searching ? "JOIN Local_Library_Search ON Local_Library_Search.rowid = m.manifest_id" : "",
+            conditions.clauses.isEmpty() ? QString() : "WHERE " + conditions.clauses.join(" AND "),
+            orderByClause(m_sortColumn, m_sortOrder));
+
+    m_fetching = true;
+    const quint64 generation = m_generation;
+    const int scale = m_coverScale;
+    const QVariantList values = conditions.values;
+
+    QFuture<Rows> page = dbManager.executor().submit([sql, scale, first, values](QSqlDatabase& database) {
+        Rows rows;
+
+        // Changes logged after this point are applied on top of the first page
+        const qint64 changeId = first
+            ? smartbook::common::manifest::ManifestChangeFeed::latestChangeId(database)
+            : -1;
+
+        // Native scan avoids a QVariant per column and a UTF-16 round trip per string
+        smartbook::common::database::NativeConnection* native =
+            smartbook::common::database::LocalDBManager::getInstance().nativeReadConnection();
+        if (native) {
+            smartbook::common::database::NativeStatement statement = native->prepare(sql);
+            int parameter = 0;
+            statement.bindInt64(parameter++, scale);
+            for (const QVariant& value : values) {
+                if (value.typeId() == QMetaType::QString) {
+                    statement.bindText(parameter++, value.toString());
+                } else {
+                    statement.bindInt64(parameter++, value.toLongLong());
+                }
+            }
+            statement.bindInt64(parameter++, PAGE_SIZE);
+            while (statement.step()) {
+                rows.guids.append(statement.columnString(0));
+                rows.titles.append(statement.columnString(1));
+                rows.authors.append(statement.columnString(2));
+                rows.versions.append(statement.columnString(3));
+                rows.years.append(statement.columnString(4));
+                rows.lastOpened.append(statement.columnInt64(5));
+                rows.needsThumbnail.append(statement.columnInt(6) != 0);
+            }
+            if (statement.isValid() && !statement.hasError()) {
+                rows.changeId = changeId;
+                return rows;
+            }
+            // Fall back to the executor connection
+            rows = Rows();
+        }
+
+        smartbook::common::database::InstrumentedQuery query(database);
+        query.setForwardOnly(true);
+        query.prepare(sql);
+        query.addBindValue(scale);
+        for (const QVariant& value : values) {
+            query.addBindValue(value);
+        }
+        query.addBindValue(PAGE_SIZE);
+        if (!query.exec()) {
+            return rows;
+        }
+
+        while (query.next()) {
+            rows.guids.append(query.value(0).toString());
+            rows.titles.append(query.value(1).toString());
+            rows.authors.append(query.value(2).toString());
+            rows.versions.append(query.value(3).toString());
+            rows.years.append(query.value(4).toString());
+            rows.lastOpened.append(query.value(5).toLongLong());
+            rows.needsThumbnail.append(query.value(6).toBool());
+        }
+        rows.changeId = changeId;
+        return rows;
+    });
+
+    // Append back on the GUI thread; skipped if the model is gone
+    page.then(this, [this, generation](const Rows& rows) {
+        if (generation != m_generation) {
+            return; // A reload, re-sort or new filter superseded this page
+        }
+        m_fetching = false;
+        if (m_pageStale) {
+            // Changed rows past the loaded ones may be missing or outdated
+            m_pageStale = false;
+            fetchMore(QModelIndex());
+            return;
+        }
+        m_atEnd = rows.size() < PAGE_SIZE;
+        appendPage(rows);
+        emit pageLoaded(rows.size());
+
+        if (rows.changeId >= 0) {
+            m_changeCursor = rows.changeId;
+            if (m_changesPending) {
+                m_changeTimer.start();
+            }
+        }
+
+        if (rows.needsThumbnail.contains(true)) {
+            backfillThumbnails();
+        }
+    }).onCanceled(this, [this, generation]() {
+        // Database closed before the page ran
+        if (generation == m_generation) {
+            m_fetching = false;
+            m_atEnd = true;
+        }
+    });
+}
+
+void LibraryModel::sort(int column, Qt::SortOrder order) {
+    if (column < 0 || column > LastOpenedSortKey) {
+        return;
+    }
+    if (column == m_sortColumn && order == m_sortOrder) {
+        return;
+    }
+
+    m_sortColumn = column;
+    m_sortOrder = order;
+    reload();
+}
+
+void LibraryModel::setFilterText(const QString& text) {
+    const QString match = smartbook::common::manifest::LibrarySearch::matchExpression(text);
+    m_filterText = text;
+    if (match == m_filterMatch) {
+        return; // Only whitespace changed
+    }
+
+    m_filterMatch = match;
+    reload();
+}
+
+void LibraryModel::setFilter(const Filter& filter) {
+    if (filter == m_filter) {
+        return;
+    }
+    m_filter = filter;
+    reload();
+}
+
+void LibraryModel::reload() {
+    beginResetModel();
+    m_rows = Rows();
+    m_rowByGuid.clear();
+    m_atEnd = false;
+    m_fetching = false;
+    m_pageStale = false;
+    m_changeCursor = -1;        // Set again by the first page
+    m_generation++;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+void LibraryModel::setCoverScale(int scale) {
+    if (scale == m_coverScale) {
+        return;
+    }
+    m_coverScale = scale;
+    clearCovers();
+    if (!m_rows.guids.isEmpty()) {
+        emit dataChanged(index(0, TitleColumn), index(m_rows.size() - 1, TitleColumn), COVER_ROLES);
+    }
+}
+
+QString LibraryModel::guidAt(int row) const {
+    if (row < 0 || row >= m_rows.size()) {
+        return QString();
+    }
+    return m_rows.guids.at(row);
+}
+
+QString LibraryModel::sortKey(int column, const QString& table) {
+    switch (column) {
+    case AuthorColumn:
+        return table + ".author";
+    case VersionColumn:
+        // Row value comparisons (see applyManifestChanges) need a non-NULL key
+        return QString("IFNULL(%1.version, '')").arg(table);
+    case YearColumn:
+        return table + ".publication_year";
+    case LastOpenedSortKey:
+        return QString("IFNULL(%1.last_opened, 0)").arg(table);
+    default:
+        return table + ".title";
+    }
+}
+
+QString LibraryModel::orderByClause(int column, Qt::SortOrder order) {
+    // The GUID makes the order total, so a page can seek past the last row
+    // it has; each key has a (key, cartridge_guid) index in this form
+    const QString direction = order == Qt::AscendingOrder ? "ASC" : "DESC";
+    return QString("%1 %2, m.cartridge_guid %2").arg(sortKey(column, "m"), direction);
+}
+
+QVariant LibraryModel::lastSortValue() const {
+    const int row = m_rows.size() - 1;
+    if (row < 0) {
+        return QVariant();
+    }
+
+    // The loaded values are the key values: NULL keys read back as '' and 0,
+    // as sortKey() maps them
+    switch (m_sortColumn) {
+    case AuthorColumn:
+        return m_rows.authors.at(row);
+    case VersionColumn:
+        return m_rows.versions.at(row);
+    case YearColumn:
+        return m_rows.years.at(row);
+    case LastOpenedSortKey:
+        return m_rows.lastOpened.at(row);
+    default:
+        return m_rows.titles.at(row);
+    }
+}
+
+LibraryModel::Conditions LibraryModel::filterConditions(const QString& table, const Filter& filter) {
+    Conditions conditions;
+    if (!filter.author.isEmpty()) {
+        conditions.clauses.append(table + ".author = ?");
+        conditions.values.append(filter.author);
+    }
+    if (!filter.publisher.isEmpty()) {
+        conditions.clauses.append(table + ".publisher = ?");
+        conditions.values.append(filter.publisher);
+    }
+
+    // publication_year is text; four-digit bounds compare like numbers and
+    // keep the index usable. The upper bound is exclusive so "2025-03" is in 2025
+    if (filter.yearFrom > 0) {
+        conditions.clauses.append(table + ".publication_year >= ?");
+        conditions.values.append(QString::number(filter.yearFrom).rightJustified(4, '0'));
+    }
+    if (filter.yearTo > 0) {
+        conditions.clauses.append(table + ".publication_year < ?");
+        conditions.values.append(QString::number(filter.yearTo + 1).rightJustified(4, '0'));
+    }
+    return conditions;
+}
+
+void LibraryModel::appendPage(const Rows& page) {
+    // A row the change feed already placed can come again with the page
+    // read before it was applied
+    QList<int> fresh;
+    for (int i = 0; i < page.size(); ++i) {
+        if (!m_rowByGuid.contains(page.guids.at(i))) {
+            fresh.append(i);
+        }
+    }
+    if (fresh.isEmpty()) {
+        return;
+    }
+
+    const int first = m_rows.size();
+    beginInsertRows(QModelIndex(), first, first + fresh.size() - 1);
+    for (int i : fresh) {
+        m_rows.insertFrom(m_rows.size(), page, i);
+        m_rowByGuid.insert(page.guids.at(i), m_rows.size() - 1);
+    }
+    endInsertRows();
+}
+
+void LibraryModel::applyManifestChanges() {
+    smartbook::common::database::LocalDBManager& dbManager =
+        smartbook::common::database::LocalDBManager::getInstance();
+    if (m_changeCursor < 0 || m_changesRunning) {
+        m_changesPending = true;    // Picked up by the first page or the running batch
+        return;
+    }
+    if (!dbManager.isOpen()) {
+        return;
+    }
+
+    m_changesPending = false;
+    m_changesRunning = true;
+    const quint64 generation = m_generation;
+    const qint64 since = m_changeCursor;
+    const int scale = m_coverScale;
+
+    // A row's position is its rank in the current order: the number of rows
+    // whose (key, guid) sorts before it. Loaded rows are always a prefix of
+    // that order, so a rank within them is where the row goes
+    // While searching or filtering, rows outside the results count as
+    // removed and ranks only count results
+    auto inResults = [this](const QString& table) {
+        Conditions conditions = filterConditions(table, m_filter);
+        if (!m_filterMatch.isEmpty()) {
+            conditions.clauses.prepend(QString("%1.manifest_id IN (SELECT rowid FROM Local_Library_Search "
+                                               "WHERE Local_Library_Search MATCH ?)").arg(table));
+            conditions.values.prepend(m_filterMatch);
+        }
+        return conditions;
+    };
+    const Conditions ranked = inResults("o");
+    const Conditions changed = inResults("m");
+    const QString sql = QString(R"(
+        SELECT m.title, m.author, m.version, m.publication_year, IFNULL(m.last_opened, 0),
+               length(m.cover_image_data) > 0 AND t.cartridge_guid IS NULL,
+               (SELECT COUNT(*) FROM Local_Library_Manifest o
+                WHERE (%1, o.cartridge_guid) %2 (%3, m.cartridge_guid) %4)
+        FROM Local_Library_Manifest m
+        LEFT JOIN Local_Cover_Thumbnails t
+          ON t.cartridge_guid = m.cartridge_guid AND t.scale = ? AND t.cartridge_hash = m.cartridge_hash
+        WHERE m.cartridge_guid = ? %5
+    )").arg(sortKey(m_sortColumn, "o"),
+            m_sortOrder == Qt::AscendingOrder ? "<" : ">",
+            sortKey(m_sortColumn, "m"),
+            ranked.clauses.isEmpty() ? QString() : "AND " + ranked.clauses.join(" AND "),
+            changed.clauses.isEmpty() ? QString() : "AND " + changed.clauses.join(" AND "));
+
+    // Positional: the rank subquery's values, the thumbnail scale, the GUID,
+    // then the changed row's own conditions
+    QVariantList before = ranked.values;
+    before.append(scale);
+    const QVariantList after = changed.values;
+
+    QFuture<ChangeBatch> changes = dbManager.executor().submit([sql, since, before, after](QSqlDatabase& database) {
+        ChangeBatch batch;
+        QList<smartbook::common::manifest::ManifestChangeFeed::Change> log;
+        if (!smartbook::common::manifest::ManifestChangeFeed::changesSince(database, since, log)) {
+            return batch;
+        }
+
+        batch.changeId = since;
+        QStringList guids;
+        QSet<QString> seen;
+        for (const auto& change : log) {
+            batch.changeId = change.changeId;
+            if (!seen.contains(change.cartridgeGuid)) {
+                seen.insert(change.cartridgeGuid);
+                guids.append(change.cartridgeGuid);
+            }
+        }
+
+        // Bulk imports are cheaper to reload than to place row by row
+        if (guids.size() > PAGE_SIZE) {
+            return batch;
+        }
+
+        Rows entries;
+        QList<QPair<int, int>> order;   // (rank, index into entries)
+        smartbook::common::database::InstrumentedQuery query(database);
+        query.prepare(sql);
+        for (const QString& guid : guids) {
+            int parameter = 0;
+            for (const QVariant& value : before) {
+                query.bindValue(parameter++, value);
+            }
+            query.bindValue(parameter++, guid);
+            for (const QVariant& value : after) {
+                query.bindValue(parameter++, value);
+            }
+            if (!query.exec()) {
+                return batch;
+            }
+            if (!query.next()) {
+                batch.removed.append(guid);
+                continue;
+            }
+            order.append(qMakePair(query.value(6).toInt(), entries.size()));
+            entries.guids.append(guid);
+            entries.titles.append(query.value(0).toString());
+            entries.authors.append(query.value(1).toString());
+            entries.versions.append(query.value(2).toString());
+            entries.years.append(query.value(3).toString());
+            entries.lastOpened.append(query.value(4).toLongLong());
+            entries.needsThumbnail.append(query.value(5).toBool());
+            query.finish();
+        }
+
+        std::sort(order.begin(), order.end());
+        for (const auto& item : order) {
+            batch.entries.insertFrom(batch.entries.size(), entries, item.second);
+            batch.ranks.append(item.first);
+        }
+        batch.complete = true;
+        return batch;
+    }, smartbook::common::database::LocalDBExecutor::Priority::Interactive);
+
+    changes.then(this, [this, generation](const ChangeBatch& batch) {
+        m_changesRunning = false;
+        if (generation == m_generation) {
+            if (!batch.complete) {
+                reload();
+                return;
+            }
+            applyChangeBatch(batch);
+        }
+        if (m_changesPending) {
+            m_changeTimer.start();
+        }
+    }).onCanceled(this, [this]() {
+        m_changesRunning = false;
+    });
+}
+
+void LibraryModel::applyChangeBatch(const ChangeBatch& batch) {
+    m_changeCursor = batch.changeId;
+    if (batch.removed.isEmpty() && batch.entries.size() == 0) {
+        return;
+    }
+
+    // Covers of changed rows are loaded again; results in flight are dropped
+    bool needsThumbnail = batch.entries.needsThumbnail.contains(true);
+    for (const QStringList& guids : {batch.removed, batch.entries.guids}) {
+        for (const QString& guid : guids) {
+            m_covers.remove(guid);
+            m_noCover.remove(guid);
+            m_coverFetching.remove(guid);
+            m_coverDecoding.remove(guid);
+        }
+    }
+
+    // Common case: one row edited without moving
+    if (batch.removed.isEmpty() && batch.entries.size() == 1) {
+        const int row = m_rowByGuid.value(batch.entries.guids.first(), -1);
+        if (row >= 0 && row == batch.ranks.first()) {
+            m_rows.removeAt(row);
+            m_rows.insertFrom(row, batch.entries, 0);
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+            if (needsThumbnail) {
+                backfillThumbnails();
+            }
+            return;
+        }
+    }
+
+    // A page in flight starts after the last loaded row, so only changes
+    // past it can leave the page out of date
+    bool pastLoaded = false;
+    for (const QString& guid : batch.removed) {
+        pastLoaded = pastLoaded || !m_rowByGuid.contains(guid);
+    }
+    for (const QStringList& guids : {batch.removed, batch.entries.guids}) {
+        for (const QString& guid : guids) {
+            const int row = m_rowByGuid.value(guid, -1);
+            if (row < 0) {
+                continue;
+            }
+            beginRemoveRows(QModelIndex(), row, row);
+            m_rows.removeAt(row);
+            m_rowByGuid.remove(guid);
+            reindexFrom(row);
+            endRemoveRows();
+        }
+    }
+
+    // Ascending ranks, so every earlier entry is already in place. Rows
+    // past the loaded ones arrive with a later page instead
+    for (int i = 0; i < batch.entries.size(); ++i) {
+        const int row = batch.ranks.at(i);
+        if (row > m_rows.size() || (row == m_rows.size() && !m_atEnd)) {
+            pastLoaded = true;
+            break;
+        }
+        beginInsertRows(QModelIndex(), row, row);
+        m_rows.insertFrom(row, batch.entries, i);
+        reindexFrom(row);
+        endInsertRows();
+    }
+    m_pageStale = m_pageStale || (m_fetching && pastLoaded);
+
+    if (needsThumbnail) {
+        backfillThumbnails();
+    }
+}
+
+void LibraryModel::reindexFrom(int row) {
+    for (int i = row; i < m_rows.size(); ++i) {
+        m_rowByGuid.insert(m_rows.guids.at(i), i);
+    }
+}
+
+void LibraryModel::Rows::removeAt(int row) {
+    guids.removeAt(row);
+    titles.removeAt(row);
+    authors.removeAt(row);
+    versions.removeAt(row);
+    years.removeAt(row);
+    lastOpened.removeAt(row);
+    needsThumbnail.removeAt(row);
+}
+
+void LibraryModel::Rows::insertFrom(int row, const Rows& other, int index) {
+    guids.insert(row, other.guids.at(index));
+    titles.insert(row, other.titles.at(index));
+    authors.insert(row, other.authors.at(index));
+    versions.insert(row, other.versions.at(index));
+    years.insert(row, other.years.at(index));
+    lastOpened.insert(row, other.lastOpened.at(index));
+    needsThumbnail.insert(row, other.needsThumbnail.at(index));
+}
+
+void LibraryModel::setVisibleRows(int first, int last) {
+    m_visibleFirst = first;
+    m_visibleLast = last;
+
+    // Rows scrolled away give up their place in the decode queue
+    const QStringList cancelled = m_decoder->cancelQueued([this](const QString& guid) {
+        return !isVisibleRow(m_rowByGuid.value(guid, -1));
+    });
+    for (const QString& guid : cancelled) {
+        m_coverDecoding.remove(guid);
+    }
+    for (auto it = m_coverQueue.begin(); it != m_coverQueue.end();) {
+        if (isVisibleRow(m_rowByGuid.value(*it, -1))) {
+            ++it;
+        } else {
+            it = m_coverQueue.erase(it);
+        }
+    }
+}
+
+void LibraryModel::cancelCoverLoads() {
+    m_coverTimer.stop();
+    m_coverQueue.clear();
+    m_coverFetching.clear();   // Results still on the executor are ignored
+    const QStringList cancelled = m_decoder->cancelQueued();
+    for (const QString& guid : cancelled) {
+        m_coverDecoding.remove(guid);
+    }
+}
+
+bool LibraryModel::isVisibleRow(int row) const {
+    return row >= m_visibleFirst && row <= m_visibleLast;
+}
+
+QPixmap LibraryModel::placeholder() const {
+    if (m_placeholder.isNull()) {
+        m_placeholder = QPixmap(smartbook::common::manifest::CoverThumbnailStore::thumbnailSize() * m_coverScale);
+        m_placeholder.fill(QColor(224, 224, 224));
+        m_placeholder.setDevicePixelRatio(m_coverScale);
+    }
+    return m_placeholder;
+}
+
+void LibraryModel::requestCover(const QString& guid) const {
+    if (m_coverFetching.contains(guid) || m_coverDecoding.contains(guid) || m_coverQueue.contains(guid)) {
+        return;
+    }
+    m_coverQueue.insert(guid);
+    if (!m_coverTimer.isActive()) {
+        m_coverTimer.start();
+    }
+}
+
+void LibraryModel::loadRequestedCovers() {
+    smartbook::common::database::LocalDBManager& dbManager =
+        smartbook::common::database::LocalDBManager::getInstance();
+    if (m_coverQueue.isEmpty() || !dbManager.isOpen()) {
+        m_coverQueue.clear();
+        return;
+    }
+
+    const QStringList guids(m_coverQueue.cbegin(), m_coverQueue.cend());
+    m_coverFetching.unite(m_coverQueue);
+    m_coverQueue.clear();
+    const int scale = m_coverScale;
+
+    // Only the encoded bytes are read on the executor; decoding happens on
+    // the decoder pool. Covers without a current thumbnail (backfill still
+    // pending) fall back to the full cover, decoded at reduced size
+    QFuture<QHash<QString, QByteArray>> covers = dbManager.executor().submit([guids, scale](QSqlDatabase& database) {
+        QHash<QString, QByteArray> result;
+        smartbook::common::database::InstrumentedQuery query(database);
+        query.prepare(R"(
+            SELECT t.image_data, CASE WHEN t.cartridge_guid IS NULL THEN m.cover_image_data END
+            FROM Local_Library_Manifest m
+            LEFT JOIN Local_Cover_Thumbnails t
+              ON t.cartridge_guid = m.cartridge_guid AND t.scale = ? AND t.cartridge_hash = m.cartridge_hash
+            WHERE m.cartridge_guid = ?
+        )");
+        for (const QString& guid : guids) {
+            query.bindValue(0, scale);
+            query.bindValue(1, guid);
+            QByteArray data;
+            if (query.exec() && query.next()) {
+                data = query.value(0).toByteArray();
+                if (data.isEmpty()) {
+                    data = query.value(1).toByteArray();
+                }
+            }
+            query.finish();
+            result.insert(guid, data);
+        }
+        return result;
+    });
+
+    covers.then(this, [this, scale](const QHash<QString, QByteArray>& encoded) {
+        const QSize maxSize = smartbook::common::manifest::CoverThumbnailStore::thumbnailSize() * scale;
+        QStringList missing;
+        for (auto it = encoded.cbegin(); it != encoded.cend(); ++it) {
+            if (!m_coverFetching.remove(it.key()) || scale != m_coverScale) {
+                continue; // Cancelled or superseded by a scale change
+            }
+
+            if (it.value().isEmpty()) {
+                m_noCover.insert(it.key());
+                missing.append(it.key());
+                continue;
+            }
+
+            const int priority = isVisibleRow(m_rowByGuid.value(it.key(), -1)) ? 1 : 0;
+            m_coverDecoding.insert(it.key());
+            m_decoder->decode(it.key(), scale, it.value(), maxSize, priority);
+        }
+        emitCoverChanged(missing);
+    }).onCanceled(this, [this, guids]() {
+        for (const QString& guid : guids) {
+            m_coverFetching.remove(guid);
+        }
+    });
+}
+
+void LibraryModel::onCoverDecoded(const QString& guid, int scale, const QImage& image) {
+    if (!m_coverDecoding.remove(guid) || scale != m_coverScale) {
+        return; // Cleared by a reload or scale change
+    }
+
+    if (image.isNull()) {
+        m_noCover.insert(guid);
+    } else {
+        QPixmap* pixmap = new QPixmap(QPixmap::fromImage(image));
+        pixmap->setDevicePixelRatio(scale);
+        const qint64 bytes = qint64(pixmap->width()) * pixmap->height() * 4;
+        m_covers.insert(guid, pixmap, qMax<qint64>(1, bytes / 1024));
+    }
+    emitCoverChanged(QStringList{guid});
+}
+
+void LibraryModel::emitCoverChanged(const QStringList& guids) {
+    int firstRow = m_rows.size();
+    int lastRow = -1;
+    for (const QString& guid : guids) {
+        const int row = m_rowByGuid.value(guid, -1);
+        if (row >= 0) {
+            firstRow = qMin(firstRow, row);
+            lastRow = qMax(lastRow, row);
+        }
+    }
+    if (lastRow >= firstRow) {
+        emit dataChanged(index(firstRow, TitleColumn), index(lastRow, TitleColumn), COVER_ROLES);
+    }
+}
+
+void LibraryModel::backfillThumbnails() {
+    if (m_backfillRunning) {
+        return;
+    }
+
+    smartbook::common::database::LocalDBManager& dbManager =
+        smartbook::common::database::LocalDBManager::getInstance();
+    if (!dbManager.isOpen()) {
+        return;
+    }
+
+    // Libraries imported before the thumbnail cache get their covers rendered
+    // in small batches: a short read on the background lane, rendering on the
+    // thread pool, then one transaction storing the batch
+    m_backfillRunning = true;
+    QFuture<QList<PendingCover>> pending = dbManager.executor().submit([](QSqlDatabase& database) {
+        return smartbook::common::manifest::CoverThumbnailStore::pendingCovers(database, THUMBNAIL_BACKFILL_BATCH);
+    }, smartbook::common::database::LocalDBExecutor::Priority::Background);
+
+    pending.then(this, [this](const QList<PendingCover>& covers) {
+        if (covers.isEmpty()) {
+            m_backfillRunning = false;
+            return;
+        }
+
+        renderCovers(covers).then(this, [this](const QList<PendingCover>& rendered) {
+            smartbook::common::database::LocalDBManager& dbManager =
+                smartbook::common::database::LocalDBManager::getInstance();
+            if (!dbManager.isOpen()) {
+                m_backfillRunning = false;
+                return;
+            }
+
+            QFuture<int> stored = dbManager.executor().submit([rendered](QSqlDatabase& database) {
+                return smartbook::common::manifest::CoverThumbnailStore::storeRendered(database, rendered);
+            }, smartbook::common::database::LocalDBExecutor::Priority::Background);
+
+            const bool more = rendered.size() >= THUMBNAIL_BACKFILL_BATCH;
+            stored.then(this, [this, more](int count) {
+                m_backfillRunning = false;
+                if (count < 0) {
+                    return;
+                }
+
+                if (count > 0) {
+                    // Covers found missing before may exist now
+                    m_noCover.clear();
+                    if (!m_rows.guids.isEmpty()) {
+                        emit dataChanged(index(0, TitleColumn), index(m_rows.size() - 1, TitleColumn), COVER_ROLES);
+                    }
+                }
+                if (more) {
+                    backfillThumbnails();
+                }
+            }).onCanceled(this, [this]() {
+                m_backfillRunning = false;
+            });
+        });
+    }).onCanceled(this, [this]() {
+        m_backfillRunning = false;
+    });
+}
+
+void LibraryModel::clearCovers() {
+    cancelCoverLoads();
+    m_covers.clear();
+    m_coverDecoding.clear();   // Running decodes are ignored when they finish
+    m_noCover.clear();
+    m_placeholder = QPixmap();
+}
+
+LibraryGridProxy::LibraryGridProxy(QObject* parent)
+    : QIdentityProxyModel(parent)
+{
+}
+
+QVariant LibraryGridProxy::data(const QModelIndex& index, int role) const {
+    if (role == Qt::DecorationRole && index.column() == LibraryModel::TitleColumn) {
+        return QIdentityProxyModel::data(index, LibraryModel::CoverRole);
+    }
+    return QIdentityProxyModel::data(index, role);
+}
+
+} // namespace reader
+} // namespace smartbook
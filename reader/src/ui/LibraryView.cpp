@@ -1,24 +1,39 @@
 #include "smartbook/reader/ui/LibraryView.h"
-#include "smartbook/common/database/LocalDBManager.h"
-#include <QSqlQuery>
-#include <QStandardItemModel>
-#include <QStandardItem>
+#include "smartbook/reader/ui/LibraryModel.h"
+#include "smartbook/reader/ui/LibraryGroupModel.h"
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QHeaderView>
-#include <QPixmap>
-#include <QIcon>
+#include <QScrollBar>
+#include <QSignalBlocker>
 #include <QDebug>
 
 namespace smartbook {
 namespace reader {
 
+namespace {
+// Entries of the grouping box
+enum GroupingEntry {
+    AllCartridges,
+    BySeries,
+    Collections
+};
+}
+
 LibraryView::LibraryView(QWidget* parent)
     : QWidget(parent)
+    , m_groupingBox(nullptr)
+    , m_filterEdit(nullptr)
+    , m_recentFirstBox(nullptr)
     , m_stackedWidget(nullptr)
     , m_tableView(nullptr)
     , m_gridView(nullptr)
-    , m_listModel(nullptr)
-    , m_gridModel(nullptr)
+    , m_groupView(nullptr)
+    , m_groupModel(nullptr)
+    , m_model(nullptr)
+    , m_listProxy(nullptr)
+    , m_gridProxy(nullptr)
     , m_isListView(true)
 {
     setupUI();
@@ -30,10 +45,38 @@ LibraryView::~LibraryView() {
 void LibraryView::setupUI() {
     QVBoxLayout* layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* filterLayout = new QHBoxLayout();
+
+    m_groupingBox = new QComboBox(this);
+    m_groupingBox->addItem(tr("All Cartridges"));
+    m_groupingBox->addItem(tr("By Series"));
+    m_groupingBox->addItem(tr("Collections"));
+    connect(m_groupingBox, qOverload<int>(&QComboBox::currentIndexChanged),
+            this, &LibraryView::onGroupingChanged);
+    filterLayout->addWidget(m_groupingBox);
+
+    // Every keystroke filters through the FTS index (see LibrarySearch);
+    // only the first page of matches is loaded
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(tr("Search title, author, publisher, series or edition"));
+    m_filterEdit->setClearButtonEnabled(true);
+    connect(m_filterEdit, &QLineEdit::textChanged,
+            this, &LibraryView::onFilterTextChanged);
+    filterLayout->addWidget(m_filterEdit, 1);
+
+    m_recentFirstBox = new QCheckBox(tr("Recently opened first"), this);
+    connect(m_recentFirstBox, &QCheckBox::toggled,
+            this, &LibraryView::onRecentFirstToggled);
+    filterLayout->addWidget(m_recentFirstBox);
+    layout->addLayout(filterLayout);
     
     // Stacked widget to switch between views
     m_stackedWidget = new QStackedWidget(this);
     layout->addWidget(m_stackedWidget);
+
+    // One model for both views; rows are paged in as the views scroll
+    m_model = new LibraryModel(this);
     
     setupListView();
     setupBookshelfView();
@@ -46,22 +89,29 @@ void LibraryView::setupUI() {
 
 void LibraryView::setupListView() {
     m_tableView = new QTableView(this);
-    m_listModel = new QStandardItemModel(this);
-    
-    // Set up columns: Title, Author, Edition/Version, Year of Publication
-    // DDD 11.1: List-View mandatory columns
-    m_listModel->setColumnCount(4);
-    m_listModel->setHeaderData(0, Qt::Horizontal, "Title");
-    m_listModel->setHeaderData(1, Qt::Horizontal, "Author");
-    m_listModel->setHeaderData(2, Qt::Horizontal, "Edition/Version");
-    m_listModel->setHeaderData(3, Qt::Horizontal, "Year of Publication");
     
-    m_tableView->setModel(m_listModel);
+    // Columns: Title, Author, Edition/Version, Year of Publication
+    // DDD 11.1: List-View mandatory columns (headers come from LibraryModel)
+    m_listProxy = new QIdentityProxyModel(this);
+    m_listProxy->setSourceModel(m_model);
+    m_tableView->setModel(m_listProxy);
     m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
     m_tableView->setSelectionMode(QAbstractItemView::SingleSelection);
     m_tableView->setAlternatingRowColors(true);
+    // Header clicks re-query the manifest in the new order; start with the
+    // model's own order so enabling sorting does not trigger a reload
+    m_tableView->horizontalHeader()->setSortIndicator(LibraryModel::TitleColumn, Qt::AscendingOrder);
     m_tableView->setSortingEnabled(true);
     m_tableView->horizontalHeader()->setStretchLastSection(true);
+
+    // A header click replaces the recently opened order
+    connect(m_tableView->horizontalHeader(), &QHeaderView::sortIndicatorChanged, this, [this]() {
+        if (m_recentFirstBox->isChecked()) {
+            QSignalBlocker blocker(m_recentFirstBox);
+            m_recentFirstBox->setChecked(false);
+            m_tableView->horizontalHeader()->setSortIndicatorShown(true);
+        }
+    });
     
     connect(m_tableView, &QTableView::doubleClicked,
             this, &LibraryView::onTableDoubleClicked);
@@ -71,108 +121,165 @@ void LibraryView::setupListView() {
 
 void LibraryView::setupBookshelfView() {
     m_gridView = new QListView(this);
-    m_gridModel = new QStandardItemModel(this);
     
     // Bookshelf View: Grid layout with cover images
     // DDD 11.1: Bookshelf View - grid with cover images
     m_gridView->setViewMode(QListView::IconMode);
     m_gridView->setResizeMode(QListView::Adjust);
     m_gridView->setGridSize(QSize(150, 200));
+    m_gridView->setIconSize(smartbook::common::manifest::CoverThumbnailStore::thumbnailSize());
     m_gridView->setSpacing(10);
     
-    m_gridView->setModel(m_gridModel);
+    // Covers are only requested for the items the grid paints
+    m_gridProxy = new LibraryGridProxy(this);
+    m_gridProxy->setSourceModel(m_model);
+    m_gridView->setModel(m_gridProxy);
+    m_gridView->setModelColumn(LibraryModel::TitleColumn);
     
     connect(m_gridView, &QListView::doubleClicked,
             this, &LibraryView::onItemDoubleClicked);
+
+    // Covers of the items on screen decode first; scrolling cancels the rest
+    connect(m_gridView->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &LibraryView::updateVisibleCovers);
+    connect(m_model, &LibraryModel::pageLoaded,
+            this, &LibraryView::updateVisibleCovers);
     
     m_stackedWidget->addWidget(m_gridView);
 }
 
 void LibraryView::updateView() {
-    if (m_isListView) {
+    if (isGrouped() && m_groupView) {
+        m_stackedWidget->setCurrentWidget(m_groupView);
+    } else if (m_isListView) {
         m_stackedWidget->setCurrentWidget(m_tableView);
     } else {
         m_stackedWidget->setCurrentWidget(m_gridView);
     }
 }
 
+bool LibraryView::isGrouped() const {
+    return m_groupingBox && m_groupingBox->currentIndex() != AllCartridges;
+}
+
 void LibraryView::refreshLibrary() {
     loadCartridges();
+    if (m_groupModel) {
+        m_groupModel->reload();
+    }
 }
 
 void LibraryView::toggleView() {
     m_isListView = !m_isListView;
+    if (isGrouped()) {
+        // Back to the flat views, in the new mode
+        m_groupingBox->setCurrentIndex(AllCartridges);
+    }
     updateView();
     // Views are already loaded, just switch display
     // AC: Both views load instantly
+    if (m_isListView) {
+        // The table shows no covers; drop decodes nobody will see
+        m_model->cancelCoverLoads();
+    } else {
+        updateVisibleCovers();
+    }
 }
 
-void LibraryView::loadCartridges() {
-    smartbook::common::database::LocalDBManager& dbManager = 
-        smartbook::common::database::LocalDBManager::getInstance();
-
-    if (!dbManager.isOpen()) {
+void LibraryView::updateVisibleCovers() {
+    if (m_isListView || isGrouped()) {
         return;
     }
 
-    // Clear existing data
-    m_listModel->clear();
-    m_gridModel->clear();
-    
-    // Set up list model headers
-    m_listModel->setColumnCount(4);
-    m_listModel->setHeaderData(0, Qt::Horizontal, "Title");
-    m_listModel->setHeaderData(1, Qt::Horizontal, "Author");
-    m_listModel->setHeaderData(2, Qt::Horizontal, "Edition/Version");
-    m_listModel->setHeaderData(3, Qt::Horizontal, "Year of Publication");
-    
-    // Query manifest for all required fields
-    // DDD 11.1: List-View columns sourced from manifest
-    QSqlQuery query = dbManager.executeQuery(
-        "SELECT cartridge_guid, title, author, version, publication_year, cover_image_data "
-        "FROM Local_Library_Manifest ORDER BY title"
-    );
-
-    while (query.next()) {
-        QString guid = query.value(0).toString();
-        QString title = query.value(1).toString();
-        QString author = query.value(2).toString();
-        QString version = query.value(3).toString();
-        QString year = query.value(4).toString();
-        QByteArray coverImage = query.value(5).toByteArray();
-        
-        // List View: Add row with all columns
-        QList<QStandardItem*> rowItems;
-        QStandardItem* titleItem = new QStandardItem(title);
-        titleItem->setData(guid, Qt::UserRole);
-        rowItems.append(titleItem);
-        rowItems.append(new QStandardItem(author));
-        rowItems.append(new QStandardItem(version));
-        rowItems.append(new QStandardItem(year));
-        m_listModel->appendRow(rowItems);
-        
-        // Bookshelf View: Add item with title and cover
-        QStandardItem* gridItem = new QStandardItem(title);
-        gridItem->setData(guid, Qt::UserRole);
-        if (!coverImage.isEmpty()) {
-            QPixmap pixmap;
-            if (pixmap.loadFromData(coverImage)) {
-                gridItem->setIcon(QIcon(pixmap.scaled(120, 160, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
+    // Probe the viewport at half-cell steps; items are laid out on the grid
+    const QRect area = m_gridView->viewport()->rect();
+    const QSize step = m_gridView->gridSize() / 2;
+    int first = -1;
+    int last = -1;
+    for (int y = area.top(); y <= area.bottom(); y += qMax(1, step.height())) {
+        for (int x = area.left(); x <= area.right(); x += qMax(1, step.width())) {
+            const QModelIndex index = m_gridView->indexAt(QPoint(x, y));
+            if (!index.isValid()) {
+                continue;
             }
+            first = first < 0 ? index.row() : qMin(first, index.row());
+            last = qMax(last, index.row());
         }
-        m_gridModel->appendRow(gridItem);
     }
+    m_model->setVisibleRows(first, last);
+}
+
+void LibraryView::loadCartridges() {
+    // Drops loaded rows and fetches the first page on the executor thread;
+    // further pages follow through fetchMore() as the views scroll
+    m_model->setCoverScale(
+        smartbook::common::manifest::CoverThumbnailStore::scaleFor(devicePixelRatioF()));
+    m_model->reload();
+}
+
+void LibraryView::onFilterTextChanged(const QString& text) {
+    m_model->setFilterText(text);
+}
+
+void LibraryView::onRecentFirstToggled(bool checked) {
+    // last_opened has no column; the header shows no order meanwhile
+    QHeaderView* header = m_tableView->horizontalHeader();
+    header->setSortIndicatorShown(!checked);
+    if (checked) {
+        m_model->sort(LibraryModel::LastOpenedSortKey, Qt::DescendingOrder);
+    } else {
+        m_model->sort(header->sortIndicatorSection(), header->sortIndicatorOrder());
+    }
+}
+
+void LibraryView::onGroupingChanged(int index) {
+    // Search and ordering cover the flat views only
+    m_filterEdit->setEnabled(index == AllCartridges);
+    m_recentFirstBox->setEnabled(index == AllCartridges);
+    if (index == AllCartridges) {
+        updateView();
+        if (!m_isListView) {
+            updateVisibleCovers();
+        }
+        return;
+    }
+
+    if (!m_groupView) {
+        // Groups come with their counts; members are fetched when expanded
+        m_groupModel = new LibraryGroupModel(this);
+        m_groupView = new QTreeView(this);
+        m_groupView->setModel(m_groupModel);
+        m_groupView->setSelectionBehavior(QAbstractItemView::SelectRows);
+        m_groupView->setSelectionMode(QAbstractItemView::SingleSelection);
+        m_groupView->setAlternatingRowColors(true);
+        m_groupView->setUniformRowHeights(true);
+        m_groupView->header()->setStretchLastSection(true);
+        connect(m_groupView, &QTreeView::doubleClicked,
+                this, &LibraryView::onTableDoubleClicked);
+        m_stackedWidget->addWidget(m_groupView);
+    }
+
+    const LibraryGroupModel::Grouping grouping = index == BySeries
+        ? LibraryGroupModel::Grouping::Series
+        : LibraryGroupModel::Grouping::Collections;
+    if (grouping != m_groupModel->grouping()) {
+        m_groupModel->setGrouping(grouping);
+    } else if (m_groupModel->canFetchMore(QModelIndex())) {
+        m_groupModel->fetchMore(QModelIndex());
+    }
+    m_model->cancelCoverLoads();
+    updateView();
 }
 
 void LibraryView::onItemDoubleClicked(const QModelIndex& index) {
-    QString guid = index.data(Qt::UserRole).toString();
+    QString guid = index.data(LibraryModel::GuidRole).toString();
     if (!guid.isEmpty()) {
         emit cartridgeDoubleClicked(guid);
     }
 }
 
 void LibraryView::onTableDoubleClicked(const QModelIndex& index) {
-    QString guid = m_listModel->item(index.row(), 0)->data(Qt::UserRole).toString();
+    QString guid = index.data(LibraryModel::GuidRole).toString();
     if (!guid.isEmpty()) {
         emit cartridgeDoubleClicked(guid);
     }
@@ -0,0 +1,230 @@
+#include "smartbook/reader/ui/NavigationModel.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include <QDebug>
+
+namespace smartbook {
+namespace reader {
+
+using common::database::NativeConnection;
+using common::database::NativeStatement;
+
+int NavigationModel::Node::row() const {
+    if (!parent) {
+        return 0;
+    }
+    for (int i = 0; i < static_cast<int>(parent->children.size()); ++i) {
+        if (parent->children[i].get() == this) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+NavigationModel::NavigationModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{
+    m_root.fetched = true;
+}
+
+NavigationModel::~NavigationModel() {
+}
+
+bool NavigationModel::setCartridge(const QString& cartridgePath) {
+    beginResetModel();
+    m_root.children.clear();
+    m_root.isGroup = false;
+    m_root.label.clear();
+    m_root.fetched = true;
+    m_parents.clear();
+    m_connection.reset();
+
+    bool loaded = cartridgePath.isEmpty();
+    auto connection = std::make_unique<NativeConnection>();
+    if (!loaded && connection->open(cartridgePath, common::database::CartridgeOpenMode::ReadOnly,
+                                    common::database::ConnectionRole::Reader)) {
+        m_connection = std::move(connection);
+        loaded = true;
+
+        // Cartridges written before the table existed have no contents
+        NativeStatement table = m_connection->prepare(
+            "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'Navigation_Structure'");
+        if (!table.isValid() || !table.step()) {
+            m_connection.reset();
+        }
+    }
+
+    if (m_connection) {
+        NativeStatement parents = m_connection->prepare(R"(
+            SELECT DISTINCT parent_item_id
+            FROM Navigation_Structure
+            WHERE parent_item_id IS NOT NULL
+        )");
+        while (parents.isValid() && parents.step()) {
+            m_parents.insert(parents.columnInt(0));
+        }
+
+        NativeStatement groups = m_connection->prepare(R"(
+            SELECT group_name
+            FROM Navigation_Structure
+            GROUP BY group_name
+            ORDER BY MIN(group_order), group_name
+        )");
+        while (groups.isValid() && groups.step()) {
+            auto group = std::make_unique<Node>();
+            group->parent = &m_root;
+            group->isGroup = true;
+            group->label = groups.columnString(0);
+            m_root.children.push_back(std::move(group));
+        }
+
+        // A single group is the whole table of contents
+        if (m_root.children.size() == 1) {
+            m_root.isGroup = true;
+            m_root.label = m_root.children.front()->label;
+            m_root.children.clear();
+            m_root.fetched = false;
+            fetchChildren(&m_root);
+        }
+    }
+
+    endResetModel();
+    return loaded;
+}
+
+QModelIndex NavigationModel::index(int row, int column, const QModelIndex& parent) const {
+    const Node* node = nodeFor(parent);
+    if (!node || row < 0 || row >= static_cast<int>(node->children.size()) || column != 0) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, node->children[row].get());
+}
+
+QModelIndex NavigationModel::parent(const QModelIndex& child) const {
+    if (!child.isValid()) {
+        return QModelIndex();
+    }
+    Node* node = static_cast<Node*>(child.internalPointer())->parent;
+    if (!node || node == &m_root) {
+        return QModelIndex();
+    }
+    return createIndex(node->row(), 0, node);
+}
+
+int NavigationModel::rowCount(const QModelIndex& parent) const {
+    if (parent.column() > 0) {
+        return 0;
+    }
+    const Node* node = nodeFor(parent);
+    return node ? static_cast<int>(node->children.size()) : 0;
+}
+
+int NavigationModel::columnCount(const QModelIndex&) const {
+    return 1;
+}
+
+bool NavigationModel::hasChildren(const QModelIndex& parent) const {
+    const Node* node = nodeFor(parent);
+    if (!node || parent.column() > 0) {
+        return false;
+    }
+    if (node->fetched) {
+        return !node->children.empty();
+    }
+    return node->isGroup || node->hasChildren;
+}
+
+QVariant NavigationModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    const Node* node = static_cast<const Node*>(index.internalPointer());
+    switch (role) {
+    case Qt::DisplayRole:
+        return node->label;
+    case TargetTypeRole:
+        return node->isGroup ? QVariant() : QVariant(node->targetType);
+    case TargetValueRole:
+        return node->isGroup ? QVariant() : QVariant(node->targetValue);
+    case PageIdRole: {
+        bool ok = false;
+        const int pageId = node->targetType == QLatin1String("page") ? node->targetValue.toInt(&ok) : -1;
+        return ok ? pageId : -1;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+bool NavigationModel::canFetchMore(const QModelIndex& parent) const {
+    const Node* node = nodeFor(parent);
+    return node && m_connection && !node->fetched && (node->isGroup || node->hasChildren);
+}
+
+void NavigationModel::fetchMore(const QModelIndex& parent) {
+    if (canFetchMore(parent)) {
+        fetchChildren(nodeFor(parent));
+    }
+}
+
+NavigationModel::Node* NavigationModel::nodeFor(const QModelIndex& index) const {
+    if (!index.isValid()) {
+        return const_cast<Node*>(&m_root);
+    }
+    return static_cast<Node*>(index.internalPointer());
+}
+
+void NavigationModel::fetchChildren(Node* node) {
+    node->fetched = true;
+
+    // Seeks on idx_navigation_group / idx_navigation_parent where the
+    // cartridge has them
+    NativeStatement items = m_connection->prepare(node->isGroup ? R"(
+        SELECT nav_id, item_label, target_type, target_value
+        FROM Navigation_Structure
+        WHERE group_name = ?1 AND parent_item_id IS NULL
+        ORDER BY item_order, nav_id
+    )" : R"(
+        SELECT nav_id, item_label, target_type, target_value
+        FROM Navigation_Structure
+        WHERE parent_item_id = ?1
+        ORDER BY item_order, nav_id
+    )");
+    if (!items.isValid()) {
+        return;
+    }
+    if (node->isGroup) {
+        items.bindText(0, node->label);
+    } else {
+        items.bindInt64(0, node->navId);
+    }
+
+    std::vector<std::unique_ptr<Node>> children;
+    while (items.step()) {
+        auto child = std::make_unique<Node>();
+        child->parent = node;
+        child->navId = items.columnInt(0);
+        child->label = items.columnString(1);
+        child->targetType = items.columnString(2);
+        child->targetValue = items.columnString(3);
+        child->hasChildren = m_parents.contains(child->navId);
+        child->fetched = !child->hasChildren;
+        children.push_back(std::move(child));
+    }
+    if (children.empty()) {
+        return;
+    }
+
+    // The root is filled inside setCartridge()'s model reset
+    const bool announce = node != &m_root;
+    if (announce) {
+        beginInsertRows(createIndex(node->row(), 0, node), 0, static_cast<int>(children.size()) - 1);
+    }
+    node->children = std::move(children);
+    if (announce) {
+        endInsertRows();
+    }
+}
+
+} // namespace reader
+} // namespace smartbook
@@ -1,7 +1,12 @@
 #include "smartbook/reader/ui/ReaderView.h"
 #include "smartbook/reader/WebChannelBridge.h"
+#include "smartbook/reader/CartridgeSchemeHandler.h"
+#include "smartbook/reader/ReaderProfile.h"
+#include "smartbook/reader/ui/NavigationModel.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
+#include "smartbook/common/database/PagePrefetcher.h"
 #include "smartbook/common/settings/SettingsManager.h"
+#include "smartbook/common/utils/PlatformUtils.h"
 #include <QWebEngineView>
 #include <QWebEngineProfile>
 #include <QWebEngineSettings>
@@ -12,16 +17,25 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QApplication>
+#include <QPromise>
+#include <QThreadPool>
+#include <QUuid>
 #include <QDebug>
 
 namespace smartbook {
 namespace reader {
 
+namespace {
+// Below this much RAM the hidden page is not worth its renderer memory
+constexpr qint64 PRERENDER_MIN_MEMORY = qint64(4) * 1024 * 1024 * 1024;
+}
+
 ReaderView::ReaderView(QWidget* parent)
     : QWidget(parent)
     , m_webView(nullptr)
     , m_webChannelBridge(nullptr)
     , m_settingsManager(nullptr)
+    , m_connector(nullptr)
     , m_currentPageId(-1)
 {
     QVBoxLayout* layout = new QVBoxLayout(this);
@@ -29,13 +43,36 @@ ReaderView::ReaderView(QWidget* parent)
 
     setupWebEngine();
     
+    // Pages are owned here, not by the view, so they survive being swapped out
     m_webView = new QWebEngineView(this);
+    m_webView->setPage(createPage());
+    m_prerenderPage = createPage();
+    m_prerenderPage->setAudioMuted(true);
     layout->addWidget(m_webView);
+
+    // Unknown sizes count as enough
+    const qint64 memory = common::utils::PlatformUtils::getPhysicalMemory();
+    m_prerenderEnabled = memory <= 0 || memory >= PRERENDER_MIN_MEMORY;
     
     m_settingsManager = new common::settings::SettingsManager(this);
+    m_connector = new common::database::CartridgeDBConnector(this);
+    m_prefetcher = new common::database::PagePrefetcher(this);
+    m_navigationModel = new NavigationModel(this);
+
+    // The hidden page was rendered with the settings it replaces
+    connect(m_settingsManager, &common::settings::SettingsManager::settingsChanged,
+            this, &ReaderView::resetPrerender);
     
     connect(m_webView, &QWebEngineView::loadFinished,
             this, &ReaderView::onLoadFinished);
+
+    // Links between pages navigate without going through loadPage()
+    connect(m_webView, &QWebEngineView::urlChanged, this, [this](const QUrl& url) {
+        const int pageId = CartridgeSchemeHandler::pageIdOf(url);
+        if (pageId >= 0 && url.host() == m_host) {
+            m_currentPageId = pageId;
+        }
+    });
 }
 
 ReaderView::~ReaderView() {
@@ -45,9 +82,13 @@ ReaderView::~ReaderView() {
         disconnect(m_webView, nullptr, this, nullptr);
         
         // Clear WebChannel first
-        if (m_webView->page()) {
-            m_webView->page()->setWebChannel(nullptr);
+        QWebEnginePage* shownPage = m_webView->page();
+        for (QWebEnginePage* page : {shownPage, m_prerenderPage}) {
+            if (page) {
+                page->setWebChannel(nullptr);
+            }
         }
+        m_prefetcher->cancel();
         
         // Delete WebChannel bridge first
         if (m_webChannelBridge) {
@@ -55,6 +96,12 @@ ReaderView::~ReaderView() {
             m_webChannelBridge = nullptr;
         }
         
+        // Return the cartridge connection lease
+        if (m_connector) {
+            delete m_connector;
+            m_connector = nullptr;
+        }
+        
         // Delete settings manager
         if (m_settingsManager) {
             delete m_settingsManager;
@@ -68,19 +115,64 @@ ReaderView::~ReaderView() {
         // Delete web view (this will trigger WebEngine cleanup)
         delete m_webView;
         m_webView = nullptr;
+
+        // Then the pages it showed
+        delete shownPage;
+        delete m_prerenderPage;
+        m_prerenderPage = nullptr;
     }
 }
 
 void ReaderView::setupWebEngine() {
-    // TODO: Configure WebEngine profile with security settings
-    // For now, use default profile
-    // DDD Section 5: WebEngine Profile Configuration
+    // DDD Section 5: one configured profile for all reader windows, so they
+    // share its disk cache, compiled scripts and renderer processes
+    m_profile = ReaderProfile::instance();
+}
+
+QWebEnginePage* ReaderView::createPage() {
+    auto* page = new QWebEnginePage(m_profile, this);
+
+    // Only the hidden page reports here; the view forwards the shown one's
+    connect(page, &QWebEnginePage::loadFinished, this, [this, page](bool success) {
+        if (page == m_prerenderPage) {
+            m_prerenderReady = success && m_prerenderPageId >= 0
+                               && CartridgeSchemeHandler::pageIdOf(page->url()) == m_prerenderPageId;
+        }
+    });
+    return page;
 }
 
 void ReaderView::loadCartridge(const QString& cartridgePath, const QString& cartridgeGuid) {
     m_cartridgePath = cartridgePath;
     m_cartridgeGuid = cartridgeGuid;
     m_currentPageId = -1;
+    m_prefetcher->setCartridge(cartridgePath);
+    resetPrerender();
+    m_pageIndex.clear();
+    m_pageIndexLoaded = false;
+    
+    // Keep the cartridge leased while it is displayed so page turns
+    // only pay for the page query, not an open/configure cycle
+    if (!m_connector->openCartridge(cartridgePath, common::database::CartridgeOpenMode::ReadOnly)) {
+        emit errorOccurred("Failed to open cartridge: " + cartridgePath);
+        return;
+    }
+    
+    prepareSearchIndex();
+
+    // Reading order in memory: navigation no longer queries per click
+    common::database::NativeConnection* native = m_connector->nativeReader();
+    m_pageIndexLoaded = native && m_pageIndex.load(*native);
+    m_navigationModel->setCartridge(cartridgePath);
+
+    // Pages and resources are served from the cartridge under its GUID
+    m_host = m_cartridgeGuid.isEmpty() ? m_connector->getCartridgeGuid() : m_cartridgeGuid;
+    if (m_host.isEmpty()) {
+        m_host = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    }
+    m_host = m_host.remove('{').remove('}').toLower();
+    CartridgeSchemeHandler::forProfile(m_profile)
+        ->addCartridge(this, m_host, cartridgePath, [this](int pageId) { return pageDocument(pageId); });
     
     // Load settings if cartridge GUID is provided
     if (!m_cartridgeGuid.isEmpty() && m_settingsManager) {
@@ -92,151 +184,338 @@ void ReaderView::loadCartridge(const QString& cartridgePath, const QString& cart
 }
 
 void ReaderView::loadPage(int pageId) {
+    // A jump away from the prepared neighbours stops preparing them
+    if (pageId != m_prerenderPageId && !m_prefetcher->contains(pageId)) {
+        m_prefetcher->cancel();
+    }
     m_currentPageId = pageId;
     loadContentFromDatabase();
 }
 
+bool ReaderView::nextPage() {
+    const int pageId = neighbourPage(m_currentPageId, 1);
+    if (pageId < 0) {
+        return false;
+    }
+    loadPage(pageId);
+    return true;
+}
+
+bool ReaderView::previousPage() {
+    const int pageId = neighbourPage(m_currentPageId, -1);
+    if (pageId < 0) {
+        return false;
+    }
+    loadPage(pageId);
+    return true;
+}
+
+void ReaderView::setPrerenderEnabled(bool enabled) {
+    m_prerenderEnabled = enabled;
+    resetPrerender();
+    if (enabled && m_currentPageId >= 0) {
+        prepareNeighbours();
+    }
+}
+
+bool ReaderView::firstPage() {
+    const int pageId = m_pageIndexLoaded ? m_pageIndex.firstPage() : -1;
+    if (pageId < 0) {
+        return false;
+    }
+    loadPage(pageId);
+    return true;
+}
+
+bool ReaderView::lastPage() {
+    const int pageId = m_pageIndexLoaded ? m_pageIndex.lastPage() : -1;
+    if (pageId < 0) {
+        return false;
+    }
+    loadPage(pageId);
+    return true;
+}
+
+bool ReaderView::jumpToPercent(double percent) {
+    const int pageId = m_pageIndexLoaded ? m_pageIndex.pageAtPercent(percent) : -1;
+    if (pageId < 0) {
+        return false;
+    }
+    loadPage(pageId);
+    return true;
+}
+
+bool ReaderView::openNavigationTarget(const QModelIndex& index) {
+    int pageId = index.data(NavigationModel::PageIdRole).toInt();
+    if (pageId < 0 && index.data(NavigationModel::TargetTypeRole).toString() == QLatin1String("chapter")) {
+        pageId = m_pageIndex.firstPageOfChapter(index.data(NavigationModel::TargetValueRole).toString());
+    }
+    if (pageId < 0 || (m_pageIndexLoaded && !m_pageIndex.contains(pageId))) {
+        return false;
+    }
+    loadPage(pageId);
+    return true;
+}
+
+int ReaderView::neighbourPage(int pageId, int step) {
+    if (pageId < 0 || !m_connector || !m_connector->isOpen()) {
+        return -1;
+    }
+    if (m_pageIndexLoaded) {
+        return m_pageIndex.neighbour(pageId, step > 0 ? 1 : -1);
+    }
+
+    common::database::PreparedQuery query = m_connector->executePrepared(step > 0 ? R"(
+        SELECT page_id
+        FROM Content_Pages
+        WHERE page_order > (SELECT page_order FROM Content_Pages WHERE page_id = ?)
+        ORDER BY page_order ASC
+        LIMIT 1
+    )" : R"(
+        SELECT page_id
+        FROM Content_Pages
+        WHERE page_order < (SELECT page_order FROM Content_Pages WHERE page_id = ?)
+        ORDER BY page_order DESC
+        LIMIT 1
+    )", {pageId});
+    if (!query.isPrepared() || !query->next()) {
+        return -1;
+    }
+    return query->value(0).toInt();
+}
+
 void ReaderView::loadContentFromDatabase() {
     if (m_cartridgePath.isEmpty()) {
         emit errorOccurred("No cartridge path specified");
         return;
     }
     
-    // Open cartridge database
-    common::database::CartridgeDBConnector connector(this);
-    if (!connector.openCartridge(m_cartridgePath)) {
-        emit errorOccurred("Failed to open cartridge: " + m_cartridgePath);
+    if (!m_connector || !m_connector->isOpen()) {
+        emit errorOccurred("Cartridge not open: " + m_cartridgePath);
         return;
     }
     
-    // Query Content_Pages table
+    // Prepared pages are known to exist
+    if (m_currentPageId >= 0
+        && (m_currentPageId == m_prerenderPageId || m_prefetcher->contains(m_currentPageId))) {
+        showPage(m_currentPageId);
+        return;
+    }
+
     // If pageId is -1, load first page (lowest page_order)
-    QString queryString;
+    if (m_pageIndexLoaded) {
+        const int pageId = m_currentPageId == -1 ? m_pageIndex.firstPage() : m_currentPageId;
+        if (!m_pageIndex.contains(pageId)) {
+            emit errorOccurred("No content pages found in cartridge");
+            return;
+        }
+        showPage(pageId);
+        return;
+    }
+
+    // Query Content_Pages table through cached prepared statements
+    common::database::PreparedQuery query;
     if (m_currentPageId == -1) {
-        queryString = R"(
-            SELECT page_id, html_content, associated_css
+        query = m_connector->executePrepared(R"(
+            SELECT page_id
             FROM Content_Pages
             ORDER BY page_order ASC
             LIMIT 1
-        )";
+        )");
     } else {
-        queryString = QString(R"(
-            SELECT page_id, html_content, associated_css
+        query = m_connector->executePrepared(R"(
+            SELECT page_id
             FROM Content_Pages
-            WHERE page_id = %1
-        )").arg(m_currentPageId);
+            WHERE page_id = ?
+        )", {m_currentPageId});
     }
     
-    QSqlQuery query = connector.executeQuery(queryString);
-    
-    if (!query.next()) {
-        connector.closeCartridge();
+    if (!query.isPrepared() || !query->next()) {
         emit errorOccurred("No content pages found in cartridge");
         return;
     }
     
-    int pageId = query.value(0).toInt();
-    QString htmlContent = query.value(1).toString();
-    QString css = query.value(2).toString();
-    
-    m_currentPageId = pageId;
-    
-    // Build complete HTML document with CSS
-    QString fullHtml = buildHtmlDocument(htmlContent, css);
-    
-    // Apply settings (font size, font family, theme, etc.) to HTML
-    fullHtml = applySettingsToHtml(fullHtml);
-    
-    // Load into QWebEngineView
-    m_webView->setHtml(fullHtml);
-    
-    // Setup WebChannel bridge if not already set up
+    showPage(query->value(0).toInt());
+}
+
+void ReaderView::showPage(int pageId) {
+    // Setup WebChannel bridge if not already set up; only the shown page
+    // is attached, so a hidden page cannot call into the bridge
     if (!m_webChannelBridge) {
         m_webChannelBridge = new WebChannelBridge(this);
-        QWebChannel* channel = new QWebChannel(this);
-        m_webChannelBridge->setupWebChannel(channel);
-        m_webView->page()->setWebChannel(channel);
+        m_webChannel = new QWebChannel(this);
+        m_webChannelBridge->setupWebChannel(m_webChannel);
+        m_webView->page()->setWebChannel(m_webChannel);
     }
-    
-    connector.closeCartridge();
+
+    m_currentPageId = pageId;
+    if (m_prerenderReady && pageId == m_prerenderPageId) {
+        // Already rendered: swap it in, the shown page becomes the hidden one
+        QWebEnginePage* shown = m_webView->page();
+        shown->setWebChannel(nullptr);
+        shown->setAudioMuted(true);
+        m_prerenderPage->setWebChannel(m_webChannel);
+        m_prerenderPage->setAudioMuted(false);
+        m_webView->setPage(m_prerenderPage);
+        m_prerenderPage = shown;
+        m_prerenderPageId = -1;
+        m_prerenderReady = false;
+        onLoadFinished(true);
+        return;
+    }
+
+    // Navigate to the page; CartridgeSchemeHandler asks pageDocument() for it
+    m_webView->setUrl(CartridgeSchemeHandler::pageUrl(m_host, pageId));
 }
 
-QString ReaderView::buildHtmlDocument(const QString& htmlContent, const QString& css) {
-    QString html = R"(<!DOCTYPE html>
-<html>
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <style>
-)";
-    
-    if (!css.isEmpty()) {
-        html += css;
+void ReaderView::prepareNeighbours() {
+    m_prefetcher->prefetchAround(m_currentPageId);
+
+    if (!m_prerenderEnabled) {
+        return;
     }
-    
-    html += R"(
-    </style>
-</head>
-<body>
-)";
-    
-    html += htmlContent;
-    
-    html += R"(
-</body>
-</html>
-)";
-    
-    return html;
+    const int nextPageId = neighbourPage(m_currentPageId, 1);
+    if (nextPageId < 0 || nextPageId == m_prerenderPageId) {
+        return;
+    }
+    m_prerenderPageId = nextPageId;
+    m_prerenderReady = false;
+    m_prerenderPage->setUrl(CartridgeSchemeHandler::pageUrl(m_host, nextPageId));
 }
 
-QString ReaderView::applySettingsToHtml(const QString& html) {
-    if (!m_settingsManager) {
-        return html;
+void ReaderView::resetPrerender() {
+    m_prerenderPageId = -1;
+    m_prerenderReady = false;
+    if (m_prerenderPage && !m_prerenderPage->url().isEmpty()) {
+        m_prerenderPage->setUrl(QUrl(QStringLiteral("about:blank")));
     }
-    
-    // Get settings with priority resolution
-    QString fontSize = m_settingsManager->getSetting("default_font_size", "12");
-    QString fontFamily = m_settingsManager->getSetting("default_font_family", "serif");
-    QString theme = m_settingsManager->getSetting("default_theme", "light");
-    QString lineSpacing = m_settingsManager->getSetting("line_spacing", "1.5");
-    QString textAlignment = m_settingsManager->getSetting("text_alignment", "left");
-    QString pageMargins = m_settingsManager->getSetting("page_margins", R"({"top": 20, "bottom": 20, "left": 30, "right": 30})");
-    
-    // Inject settings as CSS variables and styles
-    QString settingsCss = QString(R"(
-        :root {
-            --font-size: %1pt;
-            --font-family: %2;
-            --line-spacing: %3;
-            --text-align: %4;
+}
+
+QByteArray ReaderView::pageDocument(int pageId) {
+    if (!m_connector || !m_connector->isOpen()) {
+        return QByteArray();
+    }
+
+    // Settings CSS is formatted once per settings change, not per page
+    if (!m_pageTemplate.isCurrent(*m_settingsManager)) {
+        m_pageTemplate = common::settings::PageTemplate::compile(*m_settingsManager);
+    }
+
+    const common::database::PagePrefetcher::Page prefetched = m_prefetcher->page(pageId);
+    if (prefetched.pageId >= 0) {
+        return m_pageTemplate.render(QUtf8StringView(prefetched.htmlContent),
+                                     QUtf8StringView(prefetched.associatedCss));
+    }
+
+    // Copied into the document straight from SQLite's UTF-8
+    if (common::database::NativeConnection* native = m_connector->nativeReader()) {
+        common::database::NativeStatement statement = native->prepare(R"(
+            SELECT html_content, associated_css
+            FROM Content_Pages
+            WHERE page_id = ?
+        )");
+        if (!statement.isValid() || !statement.bindInt64(0, pageId) || !statement.step()) {
+            return QByteArray();
         }
-        body {
-            font-size: var(--font-size);
-            font-family: var(--font-family);
-            line-height: var(--line-spacing);
-            text-align: var(--text-align);
+        return m_pageTemplate.render(statement.columnText(0), statement.columnText(1));
+    }
+
+    common::database::PreparedQuery query = m_connector->executePrepared(R"(
+        SELECT html_content, associated_css
+        FROM Content_Pages
+        WHERE page_id = ?
+    )", {pageId});
+    if (!query.isPrepared() || !query->next()) {
+        return QByteArray();
+    }
+    return m_pageTemplate.render(QUtf8StringView(query->value(0).toString().toUtf8()),
+                                 QUtf8StringView(query->value(1).toString().toUtf8()));
+}
+
+bool ReaderView::flushPendingWrites() {
+    if (!m_connector || !m_connector->isOpen()) {
+        return true;
+    }
+    return m_connector->flushFormData();
+}
+
+void ReaderView::prepareSearchIndex() {
+    m_searchSidecar.reset();
+    m_searchSidecarPath.clear();
+
+    common::database::NativeConnection* cartridge = m_connector->nativeReader();
+    if (cartridge && common::database::CartridgeSearchIndex::hasIndex(*cartridge)) {
+        emit searchReady(true);
+        return;
+    }
+
+    // Indexed once per cartridge version; later opens find the sidecar current
+    m_searchSidecarPath = common::database::CartridgeSearchIndex::sidecarPath(m_cartridgePath);
+    auto promise = std::make_shared<QPromise<bool>>();
+    m_searchSidecarBuild = promise->future();
+    promise->start();
+    QThreadPool::globalInstance()->start([promise, cartridgePath = m_cartridgePath, sidecar = m_searchSidecarPath]() {
+        promise->addResult(common::database::CartridgeSearchIndex::buildSidecar(cartridgePath, sidecar));
+        promise->finish();
+    });
+
+    // Search stays unavailable until the build is done; nothing waits on it
+    m_searchSidecarBuild.then(this, [this, sidecarPath = m_searchSidecarPath](bool built) {
+        if (sidecarPath != m_searchSidecarPath || m_searchSidecar) {
+            return;     // Another cartridge was loaded meanwhile
         }
-    )").arg(fontSize, fontFamily, lineSpacing, textAlignment);
-    
-    // Insert settings CSS before closing </style> tag
-    QString result = html;
-    int styleEndPos = result.lastIndexOf("</style>");
-    if (styleEndPos != -1) {
-        result.insert(styleEndPos, settingsCss);
-    } else {
-        // No style tag, add one in head
-        int headEndPos = result.indexOf("</head>");
-        if (headEndPos != -1) {
-            result.insert(headEndPos, "<style>" + settingsCss + "</style>");
+        auto sidecar = std::make_unique<common::database::NativeConnection>();
+        if (built && sidecar->open(sidecarPath, common::database::CartridgeOpenMode::ReadOnly,
+                                   common::database::ConnectionRole::Reader)) {
+            m_searchSidecar = std::move(sidecar);
         }
+        emit searchReady(m_searchSidecar != nullptr);
+    });
+}
+
+bool ReaderView::isSearchReady() const {
+    if (!m_connector || !m_connector->isOpen()) {
+        return false;
     }
-    
-    return result;
+    return m_searchSidecarPath.isEmpty() || m_searchSidecar;
+}
+
+common::database::NativeConnection* ReaderView::searchConnection() {
+    if (!m_connector || !m_connector->isOpen()) {
+        return nullptr;
+    }
+    if (m_searchSidecarPath.isEmpty()) {
+        return m_connector->nativeReader();
+    }
+
+    // Opened by prepareSearchIndex() once the sidecar is built
+    return m_searchSidecar.get();
+}
+
+QList<common::database::CartridgeSearchIndex::Hit> ReaderView::search(const QString& text, int limit) {
+    common::database::NativeConnection* connection = searchConnection();
+    if (!connection) {
+        return {};
+    }
+    return common::database::CartridgeSearchIndex::search(*connection, text, limit);
+}
+
+void ReaderView::showSearchHit(const common::database::CartridgeSearchIndex::Hit& hit) {
+    if (hit.pageId < 0) {
+        return;
+    }
+    m_pendingFind = hit.matches.isEmpty() ? QString() : hit.matches.first().text;
+    loadPage(hit.pageId);
 }
 
 void ReaderView::onLoadFinished(bool success) {
+    if (success && !m_pendingFind.isEmpty()) {
+        m_webView->findText(m_pendingFind);
+    }
+    m_pendingFind.clear();
+
     if (success) {
+        prepareNeighbours();
         emit contentLoaded();
     } else {
         emit errorOccurred("Failed to load content page");
@@ -0,0 +1,211 @@
+#include <QtTest>
+#include "smartbook/common/database/CartridgeConnectionPool.h"
+#include "smartbook/common/database/CartridgeDBConnector.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include <QTemporaryDir>
+#include <QDir>
+#include <QUuid>
+#include <QFile>
+#include <QSqlQuery>
+#include <QSqlDatabase>
+
+using namespace smartbook::common::database;
+
+class TestCartridgeConnectionPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testConnectionReusedAcrossConnectors();
+    void testLeaseCounting();
+    void testIdleEviction();
+    void testInvalidateWhileLeased();
+    void testReadOnlyDirectory();
+
+private:
+    QTemporaryDir* m_tempDir;
+    QString m_cartridgePath;
+
+    QString createTestCartridge(const QString& name, const QString& guid);
+};
+
+void TestCartridgeConnectionPool::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_cartridgePath = createTestCartridge("PooledCartridge", QUuid::createUuid().toString(QUuid::WithoutBraces));
+    QVERIFY(QFile::exists(m_cartridgePath));
+}
+
+void TestCartridgeConnectionPool::cleanupTestCase()
+{
+    CartridgeConnectionPool::getInstance().closeThreadConnections();
+    delete m_tempDir;
+}
+
+QString TestCartridgeConnectionPool::createTestCartridge(const QString& name, const QString& guid)
+{
+    QString path = m_tempDir->filePath(name + ".sqlite");
+    QString connectionName = "TestCartridge_" + name;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+
+        if (!db.open()) {
+            qWarning() << "Failed to create test cartridge:" << path;
+            return QString();
+        }
+
+        QSqlQuery query(db);
+        query.exec(R"(
+            CREATE TABLE IF NOT EXISTS Metadata (
+                cartridge_guid TEXT PRIMARY KEY,
+                title TEXT NOT NULL,
+                author TEXT NOT NULL,
+                publication_year TEXT NOT NULL
+            )
+        )");
+
+        query.prepare("INSERT INTO Metadata (cartridge_guid, title, author, publication_year) VALUES (?, ?, ?, ?)");
+        query.addBindValue(guid);
+        query.addBindValue(name);
+        query.addBindValue("Test Author");
+        query.addBindValue("2025");
+        query.exec();
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    return path;
+}
+
+// Reopening a cartridge must not create a second SQLite connection
+void TestCartridgeConnectionPool::testConnectionReusedAcrossConnectors()
+{
+    CartridgeConnectionPool& pool = CartridgeConnectionPool::getInstance();
+    pool.closeThreadConnections();
+    QCOMPARE(pool.connectionCount(), 0);
+
+    CartridgeDBConnector first(this);
+    QVERIFY(first.openCartridge(m_cartridgePath));
+    QString firstConnection = first.getDatabase().connectionName();
+    first.closeCartridge();
+
+    // Released connection stays pooled
+    QCOMPARE(pool.connectionCount(), 1);
+
+    CartridgeDBConnector second(this);
+    QVERIFY(second.openCartridge(m_cartridgePath));
+    QCOMPARE(second.getDatabase().connectionName(), firstConnection);
+    QVERIFY(!second.getCartridgeGuid().isEmpty());
+    second.closeCartridge();
+}
+
+void TestCartridgeConnectionPool::testLeaseCounting()
+{
+    CartridgeConnectionPool& pool = CartridgeConnectionPool::getInstance();
+
+    CartridgeDBConnector connectorA(this);
+    CartridgeDBConnector connectorB(this);
+    QVERIFY(connectorA.openCartridge(m_cartridgePath));
+    QVERIFY(connectorB.openCartridge(m_cartridgePath));
+
+    QCOMPARE(pool.leaseCount(m_cartridgePath), 2);
+
+    connectorA.closeCartridge();
+    QCOMPARE(pool.leaseCount(m_cartridgePath), 1);
+    QVERIFY(connectorB.isOpen());
+
+    connectorB.closeCartridge();
+    QCOMPARE(pool.leaseCount(m_cartridgePath), 0);
+}
+
+void TestCartridgeConnectionPool::testIdleEviction()
+{
+    CartridgeConnectionPool& pool = CartridgeConnectionPool::getInstance();
+
+    CartridgeDBConnector connector(this);
+    QVERIFY(connector.openCartridge(m_cartridgePath));
+
+    // Leased connections are never evicted
+    QCOMPARE(pool.evictIdle(0), 0);
+
+    connector.closeCartridge();
+    QCOMPARE(pool.evictIdle(0), 1);
+    QCOMPARE(pool.connectionCount(), 0);
+}
+
+void TestCartridgeConnectionPool::testInvalidateWhileLeased()
+{
+    CartridgeConnectionPool& pool = CartridgeConnectionPool::getInstance();
+
+    CartridgeDBConnector leased(this);
+    QVERIFY(leased.openCartridge(m_cartridgePath));
+    QString retiredConnection = leased.getDatabase().connectionName();
+
+    pool.invalidate(m_cartridgePath);
+
+    // New opens get a fresh connection while the old lease stays usable
+    CartridgeDBConnector fresh(this);
+    QVERIFY(fresh.openCartridge(m_cartridgePath));
+    QVERIFY(fresh.getDatabase().connectionName() != retiredConnection);
+    QVERIFY(leased.isOpen());
+
+    leased.closeCartridge();
+    QVERIFY(!QSqlDatabase::contains(retiredConnection));
+
+    fresh.closeCartridge();
+}
+
+// A WAL cartridge without -shm on read-only media opens as immutable
+void TestCartridgeConnectionPool::testReadOnlyDirectory()
+{
+    const QString directory = m_tempDir->filePath("media");
+    QVERIFY(QDir().mkpath(directory));
+    const QString path = directory + "/WalCartridge.sqlite";
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "TestCartridge_Wal");
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("PRAGMA journal_mode=WAL"));
+        QVERIFY(query.exec("CREATE TABLE Metadata (cartridge_guid TEXT PRIMARY KEY, title TEXT)"));
+        QVERIFY(query.exec("INSERT INTO Metadata VALUES ('wal-guid', 'On media')"));
+        db.close();     // Last connection: -wal and -shm are removed
+    }
+    QSqlDatabase::removeDatabase("TestCartridge_Wal");
+    QVERIFY(!QFile::exists(path + "-shm"));
+
+    const QFileDevice::Permissions writable = QFile::permissions(directory);
+    QVERIFY(QFile::setPermissions(directory, QFileDevice::ReadOwner | QFileDevice::ExeOwner));
+    QFile probe(directory + "/probe");
+    if (probe.open(QIODevice::WriteOnly)) {
+        probe.close();
+        probe.remove();
+        QFile::setPermissions(directory, writable);
+        QSKIP("Directory permissions are not enforced for this user");
+    }
+
+    {
+        CartridgeDBConnector connector(this);
+        QVERIFY(connector.openCartridge(path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+        QCOMPARE(connector.getCartridgeGuid(), QString("wal-guid"));
+        connector.closeCartridge();
+
+        NativeConnection native;
+        QVERIFY(native.open(path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+        NativeStatement title = native.prepare("SELECT title FROM Metadata");
+        QVERIFY(title.step());
+        QCOMPARE(title.columnString(0), QString("On media"));
+    }
+    CartridgeConnectionPool::getInstance().closeThreadConnections();
+    QVERIFY(QFile::setPermissions(directory, writable));
+}
+
+QTEST_MAIN(TestCartridgeConnectionPool)
+#include "test_cartridgeconnectionpool.moc"
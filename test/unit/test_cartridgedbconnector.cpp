@@ -18,6 +18,10 @@ private slots:
     void cleanupTestCase();
     void testMultiWindowIsolation();  // T-PERS-02: Multi-Window Isolation (FR-2.1.1)
     void testFormDataPersistence();   // T-PERS-02: Form data isolation
+    void testPreparedStatementReuse();
+    void testStatementCacheEvictsLeastRecentlyUsed();
+    void testReadOnlyOpen();
+    void testFormDataWriteBehind();
 
 private:
     QTemporaryDir* m_tempDir;
@@ -173,5 +177,144 @@ void TestCartridgeDBConnector::testFormDataPersistence()
     QCOMPARE(loaded, testData);
 }
 
+// Repeated parameterized queries must reuse one compiled statement
+void TestCartridgeDBConnector::testPreparedStatementReuse()
+{
+    CartridgeDBConnector connector(this);
+    QVERIFY(connector.openCartridge(m_cartridgeAPath));
+    
+    const QString sql = "SELECT title FROM Metadata WHERE cartridge_guid = ?";
+    {
+        PreparedQuery warmup = connector.executePrepared(sql, {connector.getCartridgeGuid()});
+        QVERIFY(warmup.isPrepared());
+        QVERIFY(warmup->next());
+        QCOMPARE(warmup->value(0).toString(), QString("CartridgeA"));
+    }
+    
+    StatementCache::Stats before = connector.statementCacheStats();
+    for (int i = 0; i < 10; ++i) {
+        PreparedQuery query = connector.executePrepared(sql, {connector.getCartridgeGuid()});
+        QVERIFY(query.isPrepared());
+        QVERIFY(query->next());
+    }
+    StatementCache::Stats after = connector.statementCacheStats();
+    
+    QCOMPARE(after.prepares, before.prepares);
+    QCOMPARE(after.hits, before.hits + 10);
+    
+    // A statement still held by an outer handle is not shared
+    PreparedQuery outer = connector.executePrepared(sql, {connector.getCartridgeGuid()});
+    PreparedQuery inner = connector.executePrepared(sql, {QString("missing")});
+    QVERIFY(outer->next());
+    QVERIFY(!inner->next());
+}
+
+// A statement in use survives statements prepared after it
+void TestCartridgeDBConnector::testStatementCacheEvictsLeastRecentlyUsed()
+{
+    const QString connectionName = "StatementCacheLru";
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(":memory:");
+        QVERIFY(database.open());
+
+        StatementCache cache(connectionName, 2);
+        QVERIFY(cache.statement("SELECT 1"));
+        QVERIFY(cache.statement("SELECT 2"));
+        QVERIFY(cache.statement("SELECT 1"));     // Now the most recent
+        QVERIFY(cache.statement("SELECT 3"));     // Evicts SELECT 2
+        QCOMPARE(cache.stats().prepares, qint64(3));
+        QCOMPARE(cache.stats().cachedStatements, 2);
+
+        QVERIFY(cache.statement("SELECT 1"));
+        QCOMPARE(cache.stats().prepares, qint64(3));
+        QVERIFY(cache.statement("SELECT 2"));
+        QCOMPARE(cache.stats().prepares, qint64(4));
+        cache.clear();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+// Read-only opens must not write to the cartridge; form data goes to the local DB
+void TestCartridgeDBConnector::testReadOnlyOpen()
+{
+    QString guid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    QString path = createTestCartridge("CartridgeReadOnly", guid);
+    QVERIFY(QFile::exists(path));
+    
+    // Local_User_Data rows reference the manifest entry
+    QSqlQuery manifest(LocalDBManager::getInstance().getDatabase());
+    manifest.prepare(R"(
+        INSERT INTO Local_Library_Manifest
+        (cartridge_guid, cartridge_hash, local_path, title, author, publication_year)
+        VALUES (?, ?, ?, ?, ?, ?)
+    )");
+    manifest.addBindValue(guid);
+    manifest.addBindValue(QByteArray(32, '\0'));
+    manifest.addBindValue(path);
+    manifest.addBindValue("CartridgeReadOnly");
+    manifest.addBindValue("Test Author");
+    manifest.addBindValue("2025");
+    QVERIFY(manifest.exec());
+    
+    CartridgeDBConnector connector(this);
+    QVERIFY(connector.openCartridge(path, CartridgeOpenMode::ReadOnly));
+    QVERIFY(connector.isReadOnly());
+    QCOMPARE(connector.getCartridgeGuid(), guid);
+    
+    QSqlQuery write(connector.getDatabase());
+    QVERIFY(!write.exec("UPDATE Metadata SET title = 'Changed'"));
+    
+    const QString formData = R"({"answer": "read-only"})";
+    QVERIFY(connector.saveFormData("form_ro", formData));
+    QCOMPARE(connector.loadFormData("form_ro"), formData);
+    
+    QSqlQuery cartridgeData(connector.getDatabase());
+    QVERIFY(cartridgeData.exec("SELECT COUNT(*) FROM User_Data"));
+    QVERIFY(cartridgeData.next());
+    QCOMPARE(cartridgeData.value(0).toInt(), 0);
+    cartridgeData.finish();
+    
+    // No journal files are created next to the cartridge
+    QVERIFY(!QFile::exists(path + "-wal"));
+    connector.closeCartridge();
+    
+    CartridgeDBConnector immutable(this);
+    QVERIFY(immutable.openCartridge(path, CartridgeOpenMode::Immutable));
+    QCOMPARE(immutable.loadFormData("form_ro"), formData);
+    immutable.closeCartridge();
+}
+
+// Rapid saves are buffered and reach the cartridge in one flush
+void TestCartridgeDBConnector::testFormDataWriteBehind()
+{
+    CartridgeDBConnector connector(this);
+    QVERIFY(connector.openCartridge(m_cartridgeBPath));
+    
+    for (int i = 0; i < 25; ++i) {
+        QVERIFY(connector.saveFormData("autosave", QString(R"({"keystrokes": %1})").arg(i)));
+    }
+    
+    // Buffered data is visible to loads before it is written
+    QCOMPARE(connector.loadFormData("autosave"), QString(R"({"keystrokes": 24})"));
+    
+    auto storedRows = [&connector]() {
+        QSqlQuery query(connector.getDatabase());
+        if (!query.exec("SELECT COUNT(*) FROM User_Data WHERE form_id = 'autosave'") || !query.next()) {
+            return -1;
+        }
+        return query.value(0).toInt();
+    };
+    QCOMPARE(storedRows(), 0);
+    
+    QVERIFY(connector.flushFormData());
+    QCOMPARE(storedRows(), 1);
+    
+    connector.closeCartridge();
+    QVERIFY(connector.openCartridge(m_cartridgeBPath));
+    QCOMPARE(connector.loadFormData("autosave"), QString(R"({"keystrokes": 24})"));
+}
+
 QTEST_MAIN(TestCartridgeDBConnector)
 #include "test_cartridgedbconnector.moc"
@@ -0,0 +1,291 @@
+#include <QtTest>
+#include "smartbook/common/manifest/CartridgeImporter.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QDir>
+#include <QFile>
+#include <QUuid>
+
+using namespace smartbook::common::manifest;
+using namespace smartbook::common::database;
+
+class TestCartridgeImporter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testCollectCartridges();
+    void testImportDirectory();
+    void testReimportUnchanged();
+    void testFailuresReportedPerFile();
+    void testCancel();
+    void testImportOnQtSqlFallback();
+
+private:
+    QString createCartridge(const QString& path, const QString& title, const QString& publicationYear = "2025");
+    int manifestCount();
+    bool runImport(CartridgeImporter& importer, const QStringList& paths);
+
+    QTemporaryDir* m_tempDir = nullptr;
+    LocalDBManager* m_dbManager = nullptr;
+};
+
+void TestCartridgeImporter::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_dbManager = &LocalDBManager::getInstance();
+    QVERIFY(m_dbManager->initializeConnection(m_tempDir->filePath("test_local_reader.sqlite")));
+    QVERIFY(m_dbManager->isOpen());
+}
+
+void TestCartridgeImporter::cleanupTestCase()
+{
+    if (m_dbManager && m_dbManager->isOpen()) {
+        m_dbManager->closeConnection();
+    }
+    delete m_tempDir;
+}
+
+QString TestCartridgeImporter::createCartridge(const QString& path, const QString& title,
+                                               const QString& publicationYear)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    const QString guid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    const QString connectionName = "ImporterFixture_" + guid;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        if (!db.open()) {
+            return QString();
+        }
+
+        QSqlQuery query(db);
+        query.exec(R"(
+            CREATE TABLE Metadata (
+                cartridge_guid TEXT PRIMARY KEY,
+                title TEXT,
+                author TEXT,
+                publication_year TEXT
+            )
+        )");
+        query.prepare("INSERT INTO Metadata (cartridge_guid, title, author, publication_year) VALUES (?, ?, ?, ?)");
+        query.addBindValue(guid);
+        query.addBindValue(title);
+        query.addBindValue("Test Author");
+        query.addBindValue(publicationYear);
+        query.exec();
+
+        query.exec("CREATE TABLE Content_Pages (page_id INTEGER PRIMARY KEY, content_html TEXT)");
+        query.exec(QString("INSERT INTO Content_Pages (page_id, content_html) VALUES (1, '<p>%1</p>')").arg(title));
+        query.exec("CREATE TABLE Content_Themes (theme_id TEXT PRIMARY KEY, theme_config_json TEXT)");
+        query.exec("CREATE TABLE Embedded_Apps (app_id TEXT PRIMARY KEY, app_name TEXT)");
+        query.exec("CREATE TABLE Form_Definitions (form_id TEXT PRIMARY KEY, form_json TEXT)");
+        query.exec("CREATE TABLE Settings (setting_key TEXT PRIMARY KEY, setting_value TEXT)");
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return guid;
+}
+
+int TestCartridgeImporter::manifestCount()
+{
+    QSqlQuery query(m_dbManager->getDatabase());
+    if (query.exec("SELECT COUNT(*) FROM Local_Library_Manifest") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return -1;
+}
+
+bool TestCartridgeImporter::runImport(CartridgeImporter& importer, const QStringList& paths)
+{
+    QSignalSpy finishedSpy(&importer, &CartridgeImporter::finished);
+    if (!importer.start(paths)) {
+        return false;
+    }
+    return finishedSpy.wait(30000);
+}
+
+void TestCartridgeImporter::testCollectCartridges()
+{
+    const QString root = m_tempDir->filePath("collect");
+    QDir().mkpath(root + "/sub/deeper");
+    QFile(root + "/a.sqlite").open(QIODevice::WriteOnly);
+    QFile(root + "/sub/b.sqlite").open(QIODevice::WriteOnly);
+    QFile(root + "/sub/deeper/c.sqlite").open(QIODevice::WriteOnly);
+    QFile(root + "/notes.txt").open(QIODevice::WriteOnly);
+    QFile(root + "/explicit.book").open(QIODevice::WriteOnly);
+
+    const QStringList found = CartridgeImporter::collectCartridges(
+        QStringList() << root << root + "/sub/b.sqlite" << root + "/explicit.book");
+
+    // Directories yield *.sqlite only, explicit files are always taken, duplicates dropped
+    QCOMPARE(found.size(), 4);
+    QVERIFY(found.contains(QDir(root).absoluteFilePath("a.sqlite")));
+    QVERIFY(found.contains(QDir(root).absoluteFilePath("sub/b.sqlite")));
+    QVERIFY(found.contains(QDir(root).absoluteFilePath("sub/deeper/c.sqlite")));
+    QVERIFY(found.contains(QDir(root).absoluteFilePath("explicit.book")));
+}
+
+void TestCartridgeImporter::testImportDirectory()
+{
+    const QString root = m_tempDir->filePath("library");
+    QStringList guids;
+    for (int i = 0; i < 7; ++i) {
+        const QString guid = createCartridge(QString("%1/shelf%2/book%3.sqlite").arg(root).arg(i % 2).arg(i),
+                                             QString("Book %1").arg(i));
+        QVERIFY(!guid.isEmpty());
+        guids.append(guid);
+    }
+
+    const int before = manifestCount();
+
+    CartridgeImporter importer;
+    CartridgeImporter::Options options;
+    options.workerCount = 3;
+    options.maxConcurrentReads = 1;
+    options.batchSize = 2;      // Several transactions for 7 cartridges
+    importer.setOptions(options);
+
+    QSignalSpy progressSpy(&importer, &CartridgeImporter::progress);
+    QSignalSpy fileSpy(&importer, &CartridgeImporter::fileFinished);
+    QVERIFY(runImport(importer, QStringList() << root));
+
+    const CartridgeImporter::Summary summary = importer.summary();
+    QCOMPARE(summary.total, 7);
+    QCOMPARE(summary.created, 7);
+    QCOMPARE(summary.failed, 0);
+    QVERIFY(!summary.cancelled);
+    QCOMPARE(fileSpy.count(), 7);
+    QCOMPARE(progressSpy.last().at(0).toInt(), 7);
+    QCOMPARE(manifestCount(), before + 7);
+
+    // Registered in place
+    ManifestManager manager;
+    const ManifestManager::ManifestEntry entry = manager.getManifestEntry(guids.first());
+    QCOMPARE(entry.title, QString("Book 0"));
+    QCOMPARE(entry.localPath, QDir(root).absoluteFilePath("shelf0/book0.sqlite"));
+    QVERIFY(!entry.cartridgeHash.isEmpty());
+}
+
+void TestCartridgeImporter::testReimportUnchanged()
+{
+    const QString root = m_tempDir->filePath("library");
+    const int before = manifestCount();
+
+    CartridgeImporter importer;
+    QVERIFY(runImport(importer, QStringList() << root));
+
+    const CartridgeImporter::Summary summary = importer.summary();
+    QCOMPARE(summary.total, 7);
+    QCOMPARE(summary.unchanged, 7);
+    QCOMPARE(summary.created, 0);
+    QCOMPARE(summary.updated, 0);
+    QCOMPARE(manifestCount(), before);
+}
+
+void TestCartridgeImporter::testFailuresReportedPerFile()
+{
+    const QString root = m_tempDir->filePath("mixed");
+    QVERIFY(!createCartridge(root + "/good.sqlite", "Good Book").isEmpty());
+    QVERIFY(!createCartridge(root + "/noyear.sqlite", "No Year", QString()).isEmpty());
+    QFile garbage(root + "/garbage.sqlite");
+    QVERIFY(garbage.open(QIODevice::WriteOnly));
+    garbage.write("not a database");
+    garbage.close();
+
+    CartridgeImporter importer;
+    QSignalSpy fileSpy(&importer, &CartridgeImporter::fileFinished);
+    QVERIFY(runImport(importer, QStringList() << root));
+
+    const CartridgeImporter::Summary summary = importer.summary();
+    QCOMPARE(summary.total, 3);
+    QCOMPARE(summary.created, 1);
+    QCOMPARE(summary.failed, 2);
+    QCOMPARE(summary.failures.size(), 2);
+
+    QStringList failedPaths;
+    for (const QList<QVariant>& arguments : fileSpy) {
+        if (!arguments.at(1).toBool()) {
+            failedPaths.append(QFileInfo(arguments.at(0).toString()).fileName());
+            QVERIFY(!arguments.at(2).toString().isEmpty());
+        }
+    }
+    failedPaths.sort();
+    QCOMPARE(failedPaths, QStringList() << "garbage.sqlite" << "noyear.sqlite");
+}
+
+void TestCartridgeImporter::testCancel()
+{
+    const QString root = m_tempDir->filePath("cancel");
+    for (int i = 0; i < 40; ++i) {
+        QVERIFY(!createCartridge(QString("%1/book%2.sqlite").arg(root).arg(i), QString("Cancel %1").arg(i)).isEmpty());
+    }
+    const int before = manifestCount();
+
+    CartridgeImporter importer;
+    CartridgeImporter::Options options;
+    options.workerCount = 1;
+    importer.setOptions(options);
+
+    QSignalSpy finishedSpy(&importer, &CartridgeImporter::finished);
+    QVERIFY(importer.start(QStringList() << root));
+    importer.cancel();
+    QVERIFY(finishedSpy.wait(30000));
+    QCOMPARE(finishedSpy.first().at(0).toBool(), true);
+    QVERIFY(!importer.isRunning());
+
+    // Whatever was processed before the cancel is still written
+    const CartridgeImporter::Summary summary = importer.summary();
+    QVERIFY(summary.cancelled);
+    QVERIFY(summary.created < 40);
+    QCOMPARE(manifestCount(), before + summary.created);
+
+    // The importer can be reused
+    QVERIFY(runImport(importer, QStringList() << root));
+    QCOMPARE(importer.summary().created + importer.summary().unchanged, 40);
+    QCOMPARE(manifestCount(), before + 40);
+}
+
+void TestCartridgeImporter::testImportOnQtSqlFallback()
+{
+    // Metadata and hashes are read through QtSql when QSQLITE has its own SQLite
+    const QString root = m_tempDir->filePath("fallback");
+    QStringList guids;
+    for (int i = 0; i < 4; ++i) {
+        const QString guid = createCartridge(QString("%1/book%2.sqlite").arg(root).arg(i), QString("Fallback %1").arg(i));
+        QVERIFY(!guid.isEmpty());
+        guids.append(guid);
+    }
+    const int before = manifestCount();
+
+    qputenv("SMARTBOOK_NATIVE_SQLITE", "0");
+    CartridgeImporter importer;
+    CartridgeImporter::Options options;
+    options.workerCount = 2;    // Extraction on two worker threads at once
+    importer.setOptions(options);
+    const bool finished = runImport(importer, QStringList() << root);
+    qunsetenv("SMARTBOOK_NATIVE_SQLITE");
+    QVERIFY(finished);
+
+    const CartridgeImporter::Summary summary = importer.summary();
+    QCOMPARE(summary.created, 4);
+    QCOMPARE(summary.failed, 0);
+    QCOMPARE(manifestCount(), before + 4);
+
+    ManifestManager manager;
+    const ManifestManager::ManifestEntry entry = manager.getManifestEntry(guids.last());
+    QCOMPARE(entry.title, QString("Fallback 3"));
+    QVERIFY(!entry.cartridgeHash.isEmpty());
+}
+
+QTEST_MAIN(TestCartridgeImporter)
+#include "test_cartridgeimporter.moc"
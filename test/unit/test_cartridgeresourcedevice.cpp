@@ -0,0 +1,186 @@
+#include <QtTest>
+#include "smartbook/common/database/CartridgeResourceDevice.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+using namespace smartbook::common::database;
+
+class TestCartridgeResourceDevice : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testOpenById();
+    void testOpenByPath();
+    void testSeekAndRangedRead();
+    void testMimeTypeFallback();
+    void testMissingResource();
+    void testSharedConnection();
+    void testQtSqlFallback();
+
+private:
+    QTemporaryDir* m_tempDir;
+    QString m_path;
+    QByteArray m_video;
+    QString m_connectionName = "ResourceDeviceTest";
+};
+
+void TestCartridgeResourceDevice::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+    m_path = m_tempDir->filePath("resources.sqlite");
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    database.setDatabaseName(m_path);
+    QVERIFY(database.open());
+
+    QSqlQuery setup(database);
+    QVERIFY(setup.exec("CREATE TABLE Resources (resource_id TEXT PRIMARY KEY, resource_path TEXT NOT NULL, "
+                       "resource_type TEXT NOT NULL, resource_data BLOB NOT NULL, mime_type TEXT NOT NULL)"));
+
+    m_video = QByteArray(100 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < m_video.size(); ++i) {
+        m_video[i] = static_cast<char>(i % 251);
+    }
+
+    QSqlQuery insert(database);
+    QVERIFY(insert.prepare("INSERT INTO Resources (resource_id, resource_path, resource_type, resource_data, mime_type) "
+                           "VALUES (?, ?, ?, ?, ?)"));
+    insert.addBindValue("clip");
+    insert.addBindValue("media/clip.mp4");
+    insert.addBindValue("video");
+    insert.addBindValue(m_video);
+    insert.addBindValue("video/mp4");
+    QVERIFY(insert.exec());
+    insert.addBindValue("style");
+    insert.addBindValue("styles/book.css");
+    insert.addBindValue("stylesheet");
+    insert.addBindValue(QByteArray("body { margin: 0; }"));
+    insert.addBindValue("");
+    QVERIFY(insert.exec());
+
+    database.close();
+}
+
+void TestCartridgeResourceDevice::cleanupTestCase()
+{
+    QSqlDatabase::removeDatabase(m_connectionName);
+    delete m_tempDir;
+}
+
+void TestCartridgeResourceDevice::testOpenById()
+{
+    CartridgeResourceDevice device;
+    QVERIFY(device.openResource(m_path, "clip"));
+    QVERIFY(device.isOpen());
+    QVERIFY(!device.isSequential());
+    QCOMPARE(device.size(), qint64(m_video.size()));
+    QCOMPARE(device.mimeType(), QString("video/mp4"));
+    QCOMPARE(device.readAll(), m_video);
+    QVERIFY(device.atEnd());
+
+    device.close();
+    QVERIFY(!device.isOpen());
+    QCOMPARE(device.size(), qint64(0));
+}
+
+void TestCartridgeResourceDevice::testOpenByPath()
+{
+    CartridgeResourceDevice device;
+    QVERIFY(device.openResource(m_path, "media/clip.mp4"));
+    QCOMPARE(device.size(), qint64(m_video.size()));
+    QCOMPARE(device.read(16), m_video.left(16));
+}
+
+void TestCartridgeResourceDevice::testSeekAndRangedRead()
+{
+    // What QWebEngine does for "Range: bytes=70000-"
+    CartridgeResourceDevice device;
+    QVERIFY(device.openResource(m_path, "clip"));
+    QVERIFY(device.seek(70000));
+    QCOMPARE(device.read(4096), m_video.mid(70000, 4096));
+    QCOMPARE(device.pos(), qint64(70000 + 4096));
+
+    QVERIFY(device.seek(m_video.size() - 10));
+    QCOMPARE(device.read(4096), m_video.right(10));
+    QCOMPARE(device.read(4096), QByteArray());
+
+    QVERIFY(device.seek(0));
+    QCOMPARE(device.read(8), m_video.left(8));
+}
+
+void TestCartridgeResourceDevice::testMimeTypeFallback()
+{
+    CartridgeResourceDevice device;
+    QVERIFY(device.openResource(m_path, "style"));
+    QCOMPARE(device.mimeType(), QString("text/css"));
+    QCOMPARE(device.readAll(), QByteArray("body { margin: 0; }"));
+
+    QCOMPARE(CartridgeResourceDevice::mimeTypeFor("image/png", "cover.jpg"), QString("image/png"));
+    QCOMPARE(CartridgeResourceDevice::mimeTypeFor("application/octet-stream", "cover.png"), QString("image/png"));
+    QCOMPARE(CartridgeResourceDevice::mimeTypeFor("application/x-custom", "data"), QString("application/x-custom"));
+}
+
+void TestCartridgeResourceDevice::testMissingResource()
+{
+    CartridgeResourceDevice device;
+    QVERIFY(!device.openResource(m_path, "nothing"));
+    QVERIFY(!device.isOpen());
+    QVERIFY(!device.openResource(m_path, QString()));
+    QVERIFY(!device.openResource(m_tempDir->filePath("missing.sqlite"), "clip"));
+}
+
+void TestCartridgeResourceDevice::testSharedConnection()
+{
+    // Several requests of one page, read interleaved on one connection
+    auto resources = std::make_shared<CartridgeResources>(m_path);
+    CartridgeResourceDevice video;
+    CartridgeResourceDevice style;
+    CartridgeResourceDevice missing;
+    QVERIFY(video.openResource(resources, "clip"));
+    QVERIFY(style.openResource(resources, "styles/book.css"));
+    QVERIFY(!missing.openResource(resources, "nothing"));
+
+    QVERIFY(video.seek(5000));
+    QCOMPARE(style.read(4), QByteArray("body"));
+    QCOMPARE(video.read(100), m_video.mid(5000, 100));
+
+    // A device can be read on another thread than the one that opened it
+    QByteArray readOnWorker;
+    QThread* worker = QThread::create([&video, &readOnWorker]() {
+        video.seek(0);
+        readOnWorker = video.read(64);
+    });
+    worker->start();
+    QVERIFY(worker->wait(10000));
+    delete worker;
+    QCOMPARE(readOnWorker, m_video.left(64));
+
+    // The connection outlives whoever dropped it first
+    resources.reset();
+    QCOMPARE(style.readAll(), QByteArray(" { margin: 0; }"));
+    video.close();
+    style.close();
+}
+
+void TestCartridgeResourceDevice::testQtSqlFallback()
+{
+    qputenv("SMARTBOOK_NATIVE_SQLITE", "0");
+    auto resources = std::make_shared<CartridgeResources>(m_path);
+    CartridgeResourceDevice device;
+    const bool opened = device.openResource(resources, "media/clip.mp4");
+    qunsetenv("SMARTBOOK_NATIVE_SQLITE");
+
+    QVERIFY(opened);
+    QCOMPARE(device.mimeType(), QString("video/mp4"));
+    QCOMPARE(device.size(), qint64(m_video.size()));
+    QVERIFY(device.seek(70000));
+    QCOMPARE(device.read(4096), m_video.mid(70000, 4096));
+}
+
+QTEST_MAIN(TestCartridgeResourceDevice)
+#include "test_cartridgeresourcedevice.moc"
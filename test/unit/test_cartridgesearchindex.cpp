@@ -0,0 +1,265 @@
+#include <QtTest>
+#include "smartbook/common/database/CartridgeSearchIndex.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QFile>
+
+using namespace smartbook::common::database;
+
+class TestCartridgeSearchIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testPlainText();
+    void testBuildAndSearch();
+    void testChapterTitleRanksHigher();
+    void testPageEditsInvalidateIndex();
+    void testSidecar();
+    void testLargeCartridgeSearch();
+
+private:
+    QString createCartridge(const QString& name, int fillerPages = 0);
+    bool execOn(const QString& path, const QString& sql);
+
+    QTemporaryDir* m_tempDir = nullptr;
+};
+
+void TestCartridgeSearchIndex::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+}
+
+void TestCartridgeSearchIndex::cleanupTestCase()
+{
+    delete m_tempDir;
+}
+
+QString TestCartridgeSearchIndex::createCartridge(const QString& name, int fillerPages)
+{
+    const QString path = m_tempDir->filePath(name);
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", name);
+        database.setDatabaseName(path);
+        if (!database.open()) {
+            return QString();
+        }
+
+        QSqlQuery setup(database);
+        setup.exec("CREATE TABLE Content_Pages (page_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                   "page_order INTEGER NOT NULL, chapter_title TEXT, html_content TEXT NOT NULL, "
+                   "associated_css TEXT)");
+        database.transaction();
+        QSqlQuery insert(database);
+        insert.prepare("INSERT INTO Content_Pages (page_id, page_order, chapter_title, html_content) "
+                       "VALUES (?, ?, ?, ?)");
+        const QList<QStringList> pages = {
+            {"Dragons", "<h1>Dragons</h1><p>Fire&amp;smoke rise over the hills.</p>"},
+            {"Rivers", "<p>The <b>dra</b>gon was seen near the river.</p><script>var dragon;</script>"},
+            {"Appendix", "<p>Index of <em>dragons</em> and other beasts.</p>"}
+        };
+        for (int i = 0; i < pages.size(); ++i) {
+            insert.addBindValue(i + 1);
+            insert.addBindValue(i + 1);
+            insert.addBindValue(pages[i][0]);
+            insert.addBindValue(pages[i][1]);
+            insert.exec();
+        }
+        const QString filler = QString("<p>%1</p>").arg(QString("lorem ipsum dolor sit amet ").repeated(40));
+        for (int i = 0; i < fillerPages; ++i) {
+            insert.addBindValue(pages.size() + i + 1);
+            insert.addBindValue(pages.size() + i + 1);
+            insert.addBindValue(QString("Chapter %1").arg(i));
+            insert.addBindValue(filler + QString("<p>entry%1</p>").arg(i));
+            insert.exec();
+        }
+        database.commit();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    return path;
+}
+
+bool TestCartridgeSearchIndex::execOn(const QString& path, const QString& sql)
+{
+    NativeConnection connection;
+    return connection.open(path, CartridgeOpenMode::ReadWrite, ConnectionRole::Creator)
+        && connection.exec(sql);
+}
+
+void TestCartridgeSearchIndex::testPlainText()
+{
+    QCOMPARE(CartridgeSearchIndex::plainText("<p>Hello <b>wor</b>ld</p><p>again</p>"),
+             QString("Hello world again"));
+    QCOMPARE(CartridgeSearchIndex::plainText("a&amp;b &lt;c&gt; &#233;t&#xE9; &nbsp;x &bogus; y"),
+             QString("a&b <c> été x &bogus; y"));
+    QCOMPARE(CartridgeSearchIndex::plainText("<style>p{}</style>one<!-- two --><br/>three<script>four</script>"),
+             QString("one three"));
+    QCOMPARE(CartridgeSearchIndex::plainText("  text\n\twith   space  "), QString("text with space"));
+    QCOMPARE(CartridgeSearchIndex::plainText("unterminated <p"), QString("unterminated"));
+}
+
+void TestCartridgeSearchIndex::testBuildAndSearch()
+{
+    const QString path = createCartridge("build.sqlite");
+    NativeConnection connection;
+    QVERIFY(connection.open(path, CartridgeOpenMode::ReadWrite, ConnectionRole::Creator));
+    QVERIFY(!CartridgeSearchIndex::hasIndex(connection));
+    QVERIFY(CartridgeSearchIndex::buildIndex(connection));
+    QVERIFY(CartridgeSearchIndex::hasIndex(connection));
+
+    // Inline tags do not split words; script contents are not indexed
+    QList<CartridgeSearchIndex::Hit> hits = CartridgeSearchIndex::search(connection, "dragon", 10);
+    QCOMPARE(hits.size(), 3);
+
+    hits = CartridgeSearchIndex::search(connection, "river drag", 10);
+    QCOMPARE(hits.size(), 1);
+    const CartridgeSearchIndex::Hit& hit = hits.first();
+    QCOMPARE(hit.pageId, 2);
+    QCOMPARE(hit.chapterTitle, QString("Rivers"));
+    QCOMPARE(hit.matches.size(), 2);
+
+    // Offsets are positions in the page's plain text
+    const QString text = CartridgeSearchIndex::plainText(
+        "<p>The <b>dra</b>gon was seen near the river.</p><script>var dragon;</script>");
+    for (const CartridgeSearchIndex::Match& match : hit.matches) {
+        QCOMPARE(text.mid(match.offset, match.length), match.text);
+    }
+    QCOMPARE(hit.matches.first().text, QString("dragon"));
+    QCOMPARE(hit.matches.last().text, QString("river"));
+    QVERIFY(hit.snippet.contains("<mark>dragon</mark>"));
+
+    // Snippets are escaped text, not page markup
+    hits = CartridgeSearchIndex::search(connection, "smoke", 10);
+    QCOMPARE(hits.size(), 1);
+    QVERIFY(hits.first().snippet.contains("Fire&amp;<mark>smoke</mark>"));
+
+    QVERIFY(CartridgeSearchIndex::search(connection, "griffin", 10).isEmpty());
+    QVERIFY(CartridgeSearchIndex::search(connection, "dragon", 0).isEmpty());
+    QVERIFY(CartridgeSearchIndex::search(connection, "  ", 10).isEmpty());
+}
+
+void TestCartridgeSearchIndex::testChapterTitleRanksHigher()
+{
+    const QString path = createCartridge("rank.sqlite");
+    NativeConnection connection;
+    QVERIFY(connection.open(path, CartridgeOpenMode::ReadWrite, ConnectionRole::Creator));
+    QVERIFY(CartridgeSearchIndex::buildIndex(connection));
+
+    const QList<CartridgeSearchIndex::Hit> hits = CartridgeSearchIndex::search(connection, "dragons", 10);
+    QCOMPARE(hits.size(), 2);
+    QCOMPARE(hits.first().pageId, 1);   // Title and text over text alone
+    QVERIFY(hits.first().score < hits.last().score);
+    QCOMPARE(CartridgeSearchIndex::search(connection, "dragons", 1).size(), 1);
+}
+
+void TestCartridgeSearchIndex::testPageEditsInvalidateIndex()
+{
+    const QString path = createCartridge("edits.sqlite");
+    {
+        NativeConnection connection;
+        QVERIFY(connection.open(path, CartridgeOpenMode::ReadWrite, ConnectionRole::Creator));
+        QVERIFY(CartridgeSearchIndex::buildIndex(connection));
+    }
+
+    // Reordering keeps the index
+    QVERIFY(execOn(path, "UPDATE Content_Pages SET page_order = page_order + 10"));
+    NativeConnection reader;
+    QVERIFY(reader.open(path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QVERIFY(CartridgeSearchIndex::hasIndex(reader));
+
+    QVERIFY(execOn(path, "UPDATE Content_Pages SET html_content = '<p>changed</p>' WHERE page_id = 3"));
+    QVERIFY(!CartridgeSearchIndex::hasIndex(reader));
+
+    // A rebuild at export makes it current again
+    {
+        NativeConnection connection;
+        QVERIFY(connection.open(path, CartridgeOpenMode::ReadWrite, ConnectionRole::Creator));
+        QVERIFY(CartridgeSearchIndex::buildIndex(connection));
+    }
+    QVERIFY(CartridgeSearchIndex::hasIndex(reader));
+    QCOMPARE(CartridgeSearchIndex::search(reader, "changed", 10).size(), 1);
+
+    QVERIFY(execOn(path, "DELETE FROM Content_Pages WHERE page_id = 3"));
+    QVERIFY(!CartridgeSearchIndex::hasIndex(reader));
+}
+
+void TestCartridgeSearchIndex::testSidecar()
+{
+    const QString path = createCartridge("sidecar.sqlite");
+    const QString sidecar = m_tempDir->filePath("sidecar-index.sqlite");
+
+    QCOMPARE(CartridgeSearchIndex::sidecarPath(path), CartridgeSearchIndex::sidecarPath(path));
+    QVERIFY(CartridgeSearchIndex::sidecarPath(path) != CartridgeSearchIndex::sidecarPath(m_tempDir->filePath("other.sqlite")));
+
+    // Built from a read-only open; the cartridge itself is not touched
+    QVERIFY(!CartridgeSearchIndex::isSidecarCurrent(path, sidecar));
+    QVERIFY(CartridgeSearchIndex::buildSidecar(path, sidecar));
+    QVERIFY(CartridgeSearchIndex::isSidecarCurrent(path, sidecar));
+    {
+        NativeConnection cartridge;
+        QVERIFY(cartridge.open(path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+        QVERIFY(!CartridgeSearchIndex::hasIndex(cartridge));
+    }
+
+    {
+        NativeConnection connection;
+        QVERIFY(connection.open(sidecar, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+        const QList<CartridgeSearchIndex::Hit> hits = CartridgeSearchIndex::search(connection, "beasts", 10);
+        QCOMPARE(hits.size(), 1);
+        QCOMPARE(hits.first().pageId, 3);
+    }
+
+    // A changed cartridge makes the sidecar stale until rebuilt
+    QVERIFY(execOn(path, "INSERT INTO Content_Pages (page_order, chapter_title, html_content) "
+                         "VALUES (4, 'Griffins', '<p>griffin</p>')"));
+    QFile cartridgeFile(path);
+    QVERIFY(cartridgeFile.open(QIODevice::ReadWrite));
+    QVERIFY(cartridgeFile.setFileTime(QDateTime::currentDateTime().addSecs(60), QFileDevice::FileModificationTime));
+    cartridgeFile.close();
+    QVERIFY(!CartridgeSearchIndex::isSidecarCurrent(path, sidecar));
+    QVERIFY(CartridgeSearchIndex::buildSidecar(path, sidecar));
+    QVERIFY(CartridgeSearchIndex::isSidecarCurrent(path, sidecar));
+
+    NativeConnection connection;
+    QVERIFY(connection.open(sidecar, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QCOMPARE(CartridgeSearchIndex::search(connection, "griffin", 10).size(), 1);
+
+    QVERIFY(!CartridgeSearchIndex::buildSidecar(m_tempDir->filePath("missing.sqlite"),
+                                                m_tempDir->filePath("missing-index.sqlite")));
+}
+
+void TestCartridgeSearchIndex::testLargeCartridgeSearch()
+{
+    // 5,000-page reference cartridge: a search is an index lookup
+    const QString path = createCartridge("large.sqlite", 5000);
+    {
+        NativeConnection connection;
+        QVERIFY(connection.open(path, CartridgeOpenMode::ReadWrite, ConnectionRole::Creator));
+        QVERIFY(CartridgeSearchIndex::buildIndex(connection));
+    }
+
+    NativeConnection reader;
+    QVERIFY(reader.open(path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QElapsedTimer timer;
+    timer.start();
+    const QList<CartridgeSearchIndex::Hit> rare = CartridgeSearchIndex::search(reader, "entry4321", 50);
+    const QList<CartridgeSearchIndex::Hit> common = CartridgeSearchIndex::search(reader, "lorem ipsum", 50);
+    const qint64 elapsed = timer.elapsed();
+
+    QCOMPARE(rare.size(), 1);
+    QCOMPARE(common.size(), 50);
+    qDebug() << "Two searches over 5000 pages took" << elapsed << "ms";
+    QVERIFY2(elapsed < 500, qPrintable(QString("Search took %1 ms").arg(elapsed)));
+}
+
+QTEST_MAIN(TestCartridgeSearchIndex)
+#include "test_cartridgesearchindex.moc"
@@ -0,0 +1,154 @@
+#include <QtTest>
+#include "smartbook/common/database/ConnectionProfile.h"
+#include "smartbook/common/database/CartridgeConnectionPool.h"
+#include "smartbook/common/database/CartridgeDBConnector.h"
+#include <QTemporaryDir>
+#include <QSettings>
+#include <QSqlQuery>
+#include <QSqlDatabase>
+#include <climits>
+
+using namespace smartbook::common::database;
+
+class TestConnectionProfile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    void testScanAndPageFetchProfilesDiffer();
+    void testOverridesFromSettings();
+    void testInvalidOverrideIgnored();
+    void testProfileAppliedToConnection();
+    void testRolesUseSeparateConnections();
+
+private:
+    QTemporaryDir* m_tempDir;
+    QString m_cartridgePath;
+
+    int pragmaValue(QSqlDatabase& database, const QString& pragma);
+};
+
+void TestConnectionProfile::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+    m_cartridgePath = m_tempDir->filePath("ProfileCartridge.sqlite");
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "CreateProfileCartridge");
+        db.setDatabaseName(m_cartridgePath);
+        QVERIFY(db.open());
+
+        QSqlQuery query(db);
+        QVERIFY(query.exec("CREATE TABLE Metadata (cartridge_guid TEXT PRIMARY KEY, title TEXT NOT NULL)"));
+        QVERIFY(query.exec("INSERT INTO Metadata VALUES ('profile-guid', 'Profiles')"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("CreateProfileCartridge");
+}
+
+void TestConnectionProfile::cleanupTestCase()
+{
+    CartridgeConnectionPool::getInstance().closeThreadConnections();
+    delete m_tempDir;
+}
+
+void TestConnectionProfile::cleanup()
+{
+    ConnectionProfile::clearOverrides();
+}
+
+int TestConnectionProfile::pragmaValue(QSqlDatabase& database, const QString& pragma)
+{
+    QSqlQuery query(database);
+    if (!query.exec("PRAGMA " + pragma) || !query.next()) {
+        return INT_MIN;
+    }
+    return query.value(0).toInt();
+}
+
+// A hashing scan and a page fetch want opposite cache/mmap trade-offs
+void TestConnectionProfile::testScanAndPageFetchProfilesDiffer()
+{
+    ConnectionProfile reader = ConnectionProfile::forRole(ConnectionRole::Reader);
+    ConnectionProfile verifier = ConnectionProfile::forRole(ConnectionRole::Verifier);
+    ConnectionProfile bulk = ConnectionProfile::forRole(ConnectionRole::BulkImport);
+
+    QVERIFY(verifier.cacheSizeKiB < reader.cacheSizeKiB);
+    QVERIFY(verifier.mmapSizeBytes > reader.mmapSizeBytes);
+    QCOMPARE(bulk.lockingMode, QString("EXCLUSIVE"));
+    QVERIFY(bulk.cacheSizeKiB > reader.cacheSizeKiB);
+    QCOMPARE(reader.name, QString("reader"));
+}
+
+void TestConnectionProfile::testOverridesFromSettings()
+{
+    QSettings settings(m_tempDir->filePath("profiles.ini"), QSettings::IniFormat);
+    settings.setValue("database/profiles/reader/cache_size_kib", 4096);
+    settings.setValue("database/profiles/reader/synchronous", "full");
+    settings.sync();
+
+    ConnectionProfile::loadOverrides(settings);
+
+    ConnectionProfile reader = ConnectionProfile::forRole(ConnectionRole::Reader);
+    QCOMPARE(reader.cacheSizeKiB, 4096);
+    QCOMPARE(reader.synchronous, QString("FULL"));
+    QCOMPARE(reader.mmapSizeBytes, ConnectionProfile::defaults(ConnectionRole::Reader).mmapSizeBytes);
+
+    // Roles without settings keep their defaults
+    QCOMPARE(ConnectionProfile::forRole(ConnectionRole::Creator).cacheSizeKiB,
+             ConnectionProfile::defaults(ConnectionRole::Creator).cacheSizeKiB);
+}
+
+void TestConnectionProfile::testInvalidOverrideIgnored()
+{
+    QSettings settings(m_tempDir->filePath("invalid.ini"), QSettings::IniFormat);
+    settings.setValue("database/profiles/verifier/locking_mode", "NORMAL; DROP TABLE Metadata");
+    settings.sync();
+
+    ConnectionProfile::loadOverrides(settings);
+
+    QCOMPARE(ConnectionProfile::forRole(ConnectionRole::Verifier).lockingMode,
+             ConnectionProfile::defaults(ConnectionRole::Verifier).lockingMode);
+}
+
+void TestConnectionProfile::testProfileAppliedToConnection()
+{
+    ConnectionProfile custom = ConnectionProfile::defaults(ConnectionRole::Reader);
+    custom.cacheSizeKiB = 1234;
+    custom.busyTimeoutMs = 2500;
+    ConnectionProfile::setOverride(ConnectionRole::Verifier, custom);
+
+    CartridgeDBConnector connector(this);
+    QVERIFY(connector.openCartridge(m_cartridgePath, CartridgeOpenMode::ReadOnly, ConnectionRole::Verifier));
+    QCOMPARE(connector.role(), ConnectionRole::Verifier);
+
+    QCOMPARE(pragmaValue(connector.getDatabase(), "cache_size"), -1234);
+    QCOMPARE(pragmaValue(connector.getDatabase(), "busy_timeout"), 2500);
+    connector.closeCartridge();
+
+    // Drop the pooled connection so later tests see fresh settings
+    CartridgeConnectionPool::getInstance().invalidate(m_cartridgePath);
+}
+
+void TestConnectionProfile::testRolesUseSeparateConnections()
+{
+    CartridgeDBConnector reader(this);
+    CartridgeDBConnector verifier(this);
+    QVERIFY(reader.openCartridge(m_cartridgePath, CartridgeOpenMode::ReadOnly));
+    QVERIFY(verifier.openCartridge(m_cartridgePath, CartridgeOpenMode::ReadOnly, ConnectionRole::Verifier));
+
+    QCOMPARE(reader.role(), ConnectionRole::Reader);
+    QVERIFY(reader.getDatabase().connectionName() != verifier.getDatabase().connectionName());
+    QCOMPARE(pragmaValue(verifier.getDatabase(), "cache_size"),
+             -ConnectionProfile::defaults(ConnectionRole::Verifier).cacheSizeKiB);
+
+    reader.closeCartridge();
+    verifier.closeCartridge();
+}
+
+QTEST_MAIN(TestConnectionProfile)
+#include "test_connectionprofile.moc"
@@ -0,0 +1,104 @@
+#include <QtTest>
+#include "smartbook/reader/ui/CoverDecoder.h"
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include <QBuffer>
+#include <QImage>
+
+using namespace smartbook::reader;
+using namespace smartbook::common::manifest;
+
+class TestCoverDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDecodeScaled();
+    void testDecodedSignal();
+    void testUndecodableData();
+    void testCancelQueued();
+
+private:
+    static QByteArray encodedImage(const QColor& color, const QSize& size, const char* format);
+};
+
+QByteArray TestCoverDecoder::encodedImage(const QColor& color, const QSize& size, const char* format)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(color);
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, format);
+    return data;
+}
+
+void TestCoverDecoder::testDecodeScaled()
+{
+    // JPEG decodes directly at the reduced size
+    const QImage jpeg = CoverThumbnailStore::decodeScaled(
+        encodedImage(Qt::red, QSize(1800, 2400), "JPEG"), QSize(120, 160));
+    QCOMPARE(jpeg.size(), QSize(120, 160));
+
+    // Formats without scaled decoding are scaled afterwards, aspect ratio kept
+    const QImage png = CoverThumbnailStore::decodeScaled(
+        encodedImage(Qt::blue, QSize(800, 400), "PNG"), QSize(120, 160));
+    QCOMPARE(png.size(), QSize(120, 60));
+}
+
+void TestCoverDecoder::testDecodedSignal()
+{
+    CoverDecoder decoder;
+    QSignalSpy decoded(&decoder, &CoverDecoder::decoded);
+
+    decoder.decode("cover", 2, encodedImage(Qt::green, QSize(600, 800), "JPEG"), QSize(240, 320));
+    QTRY_COMPARE(decoded.count(), 1);
+
+    const QList<QVariant> arguments = decoded.takeFirst();
+    QCOMPARE(arguments.at(0).toString(), QString("cover"));
+    QCOMPARE(arguments.at(1).toInt(), 2);
+    QCOMPARE(arguments.at(2).value<QImage>().size(), QSize(240, 320));
+}
+
+void TestCoverDecoder::testUndecodableData()
+{
+    CoverDecoder decoder;
+    QSignalSpy decoded(&decoder, &CoverDecoder::decoded);
+
+    decoder.decode("broken", 1, QByteArray("not an image"), QSize(120, 160));
+    QTRY_COMPARE(decoded.count(), 1);
+    QVERIFY(decoded.first().at(2).value<QImage>().isNull());
+}
+
+void TestCoverDecoder::testCancelQueued()
+{
+    CoverDecoder decoder;
+    decoder.setMaxThreadCount(1);
+    QSignalSpy decoded(&decoder, &CoverDecoder::decoded);
+
+    // One thread and many large covers: most jobs are still queued
+    const QByteArray cover = encodedImage(Qt::gray, QSize(2400, 3200), "PNG");
+    const int total = 40;
+    for (int i = 0; i < total; ++i) {
+        decoder.decode(QString("cover-%1").arg(i), 1, cover, QSize(120, 160));
+    }
+
+    // Cancel the odd keys first, then everything left
+    const QStringList odd = decoder.cancelQueued([](const QString& key) {
+        return key.section('-', 1).toInt() % 2 == 1;
+    });
+    for (const QString& key : odd) {
+        QVERIFY(key.section('-', 1).toInt() % 2 == 1);
+    }
+    const QStringList rest = decoder.cancelQueued();
+    QVERIFY(odd.size() + rest.size() > 0);
+    QCOMPARE(decoder.queuedCount(), 0);
+
+    // Only jobs that had started report a result
+    const int expected = total - int(odd.size() + rest.size());
+    QTRY_COMPARE(decoded.count(), expected);
+    QTest::qWait(100);
+    QCOMPARE(decoded.count(), expected);
+}
+
+QTEST_MAIN(TestCoverDecoder)
+#include "test_coverdecoder.moc"
@@ -0,0 +1,253 @@
+#include <QtTest>
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include "smartbook/common/manifest/CoverThumbnailStore.h"
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QBuffer>
+#include <QImage>
+#include <QUuid>
+
+using namespace smartbook::common::database;
+using namespace smartbook::common::manifest;
+
+class TestCoverThumbnails : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testScaleFor();
+    void testCreateRendersThumbnails();
+    void testHashChangeInvalidates();
+    void testUndecodableCoverNotRetried();
+    void testBackfill();
+    void testStoreRenderedSkipsChangedCovers();
+    void testDeleteCascades();
+
+private:
+    static QByteArray coverImage(const QColor& color, const QSize& size = QSize(600, 800));
+    ManifestManager::ManifestEntry makeEntry(const QByteArray& cover);
+    bool insertWithoutThumbnails(const ManifestManager::ManifestEntry& entry);
+    QImage storedThumbnail(const QString& guid, int scale);
+    int thumbnailRows(const QString& guid);
+
+    QTemporaryDir* m_tempDir = nullptr;
+    LocalDBManager* m_dbManager = nullptr;
+};
+
+void TestCoverThumbnails::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_dbManager = &LocalDBManager::getInstance();
+    QVERIFY(m_dbManager->initializeConnection(m_tempDir->filePath("thumbnails.sqlite")));
+}
+
+void TestCoverThumbnails::cleanupTestCase()
+{
+    if (m_dbManager && m_dbManager->isOpen()) {
+        m_dbManager->closeConnection();
+    }
+    delete m_tempDir;
+}
+
+QByteArray TestCoverThumbnails::coverImage(const QColor& color, const QSize& size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(color);
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return data;
+}
+
+ManifestManager::ManifestEntry TestCoverThumbnails::makeEntry(const QByteArray& cover)
+{
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    entry.cartridgeHash = QUuid::createUuid().toRfc4122();
+    entry.localPath = "/path/to/cartridge.sqlite";
+    entry.title = "Covered Book";
+    entry.author = "Author";
+    entry.publicationYear = "2025";
+    entry.coverImageData = cover;
+    return entry;
+}
+
+bool TestCoverThumbnails::insertWithoutThumbnails(const ManifestManager::ManifestEntry& entry)
+{
+    // Rows written without the manager, as in libraries from before the cache
+    return m_dbManager->write([&](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare("INSERT INTO Local_Library_Manifest "
+                      "(cartridge_guid, cartridge_hash, local_path, title, author, publication_year, cover_image_data) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?)");
+        query.addBindValue(entry.cartridgeGuid);
+        query.addBindValue(entry.cartridgeHash);
+        query.addBindValue(entry.localPath);
+        query.addBindValue(entry.title);
+        query.addBindValue(entry.author);
+        query.addBindValue(entry.publicationYear);
+        query.addBindValue(entry.coverImageData);
+        return query.exec();
+    });
+}
+
+QImage TestCoverThumbnails::storedThumbnail(const QString& guid, int scale)
+{
+    QSqlDatabase database = m_dbManager->readConnection();
+    return QImage::fromData(CoverThumbnailStore::thumbnail(database, guid, scale));
+}
+
+int TestCoverThumbnails::thumbnailRows(const QString& guid)
+{
+    QSqlQuery query(m_dbManager->readConnection());
+    query.prepare("SELECT COUNT(*) FROM Local_Cover_Thumbnails WHERE cartridge_guid = ?");
+    query.addBindValue(guid);
+    if (!query.exec() || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+void TestCoverThumbnails::testScaleFor()
+{
+    QCOMPARE(CoverThumbnailStore::scaleFor(1.0), 1);
+    QCOMPARE(CoverThumbnailStore::scaleFor(1.25), 2);
+    QCOMPARE(CoverThumbnailStore::scaleFor(2.0), 2);
+    QCOMPARE(CoverThumbnailStore::scaleFor(3.0), 2);
+}
+
+void TestCoverThumbnails::testCreateRendersThumbnails()
+{
+    ManifestManager manager(this);
+    const ManifestManager::ManifestEntry entry = makeEntry(coverImage(Qt::red));
+    QVERIFY(manager.createManifestEntry(entry));
+
+    QCOMPARE(thumbnailRows(entry.cartridgeGuid), int(CoverThumbnailStore::scales().size()));
+
+    const QImage normal = storedThumbnail(entry.cartridgeGuid, 1);
+    QVERIFY(!normal.isNull());
+    QCOMPARE(normal.size(), QSize(120, 160));
+
+    const QImage hiDpi = storedThumbnail(entry.cartridgeGuid, 2);
+    QCOMPARE(hiDpi.size(), QSize(240, 320));
+
+    // Wide covers keep their aspect ratio
+    const QImage wide = CoverThumbnailStore::render(coverImage(Qt::blue, QSize(800, 400)), 1);
+    QCOMPARE(wide.size(), QSize(120, 60));
+}
+
+void TestCoverThumbnails::testHashChangeInvalidates()
+{
+    ManifestManager manager(this);
+    ManifestManager::ManifestEntry entry = makeEntry(coverImage(Qt::red));
+    QVERIFY(manager.createManifestEntry(entry));
+
+    // A hash change alone (e.g. written by another path) hides and drops the old thumbnails
+    QVERIFY(m_dbManager->write([&](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare("UPDATE Local_Library_Manifest SET cartridge_hash = ? WHERE cartridge_guid = ?");
+        query.addBindValue(QByteArray("changed"));
+        query.addBindValue(entry.cartridgeGuid);
+        return query.exec();
+    }));
+    QVERIFY(storedThumbnail(entry.cartridgeGuid, 1).isNull());
+    QCOMPARE(thumbnailRows(entry.cartridgeGuid), 0);
+
+    // Updating through the manager renders the new cover
+    entry.cartridgeHash = QUuid::createUuid().toRfc4122();
+    entry.coverImageData = coverImage(Qt::green);
+    QVERIFY(manager.updateManifestEntry(entry));
+
+    const QImage thumbnail = storedThumbnail(entry.cartridgeGuid, 1);
+    QVERIFY(!thumbnail.isNull());
+    const QColor pixel = thumbnail.pixelColor(60, 80);
+    QVERIFY(pixel.green() > 200 && pixel.red() < 50);
+}
+
+void TestCoverThumbnails::testUndecodableCoverNotRetried()
+{
+    ManifestManager manager(this);
+    const ManifestManager::ManifestEntry entry = makeEntry(QByteArray("not an image"));
+    QVERIFY(manager.createManifestEntry(entry));
+
+    QCOMPARE(thumbnailRows(entry.cartridgeGuid), int(CoverThumbnailStore::scales().size()));
+    QVERIFY(storedThumbnail(entry.cartridgeGuid, 1).isNull());
+
+    const int processed = m_dbManager->write([](QSqlDatabase& database) {
+        return CoverThumbnailStore::backfill(database);
+    });
+    QCOMPARE(processed, 0);
+}
+
+void TestCoverThumbnails::testBackfill()
+{
+    const ManifestManager::ManifestEntry entry = makeEntry(coverImage(Qt::yellow));
+    QVERIFY(insertWithoutThumbnails(entry));
+    QCOMPARE(thumbnailRows(entry.cartridgeGuid), 0);
+
+    const int first = m_dbManager->write([](QSqlDatabase& database) {
+        return CoverThumbnailStore::backfill(database, 10);
+    });
+    QCOMPARE(first, 1);
+    QCOMPARE(storedThumbnail(entry.cartridgeGuid, 2).size(), QSize(240, 320));
+
+    const int second = m_dbManager->write([](QSqlDatabase& database) {
+        return CoverThumbnailStore::backfill(database, 10);
+    });
+    QCOMPARE(second, 0);
+}
+
+void TestCoverThumbnails::testStoreRenderedSkipsChangedCovers()
+{
+    const ManifestManager::ManifestEntry kept = makeEntry(coverImage(Qt::cyan));
+    const ManifestManager::ManifestEntry changed = makeEntry(coverImage(Qt::magenta));
+    QVERIFY(insertWithoutThumbnails(kept));
+    QVERIFY(insertWithoutThumbnails(changed));
+
+    // Read and render outside the writer, as the library view does
+    QList<CoverThumbnailStore::PendingCover> covers = m_dbManager->write([](QSqlDatabase& database) {
+        return CoverThumbnailStore::pendingCovers(database);
+    });
+    QCOMPARE(covers.size(), 2);
+    for (CoverThumbnailStore::PendingCover& cover : covers) {
+        QVERIFY(!cover.coverImage.isEmpty());
+        cover.thumbnails = CoverThumbnailStore::renderAll(cover.coverImage);
+    }
+
+    // Replaced while the covers were rendering
+    QVERIFY(m_dbManager->write([&](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare("UPDATE Local_Library_Manifest SET cartridge_hash = ? WHERE cartridge_guid = ?");
+        query.addBindValue(QUuid::createUuid().toRfc4122());
+        query.addBindValue(changed.cartridgeGuid);
+        return query.exec();
+    }));
+
+    const int stored = m_dbManager->write([&](QSqlDatabase& database) {
+        return CoverThumbnailStore::storeRendered(database, covers);
+    });
+    QCOMPARE(stored, 1);
+    QCOMPARE(thumbnailRows(kept.cartridgeGuid), int(CoverThumbnailStore::scales().size()));
+    QCOMPARE(storedThumbnail(kept.cartridgeGuid, 1).size(), QSize(120, 160));
+    QCOMPARE(thumbnailRows(changed.cartridgeGuid), 0);
+}
+
+void TestCoverThumbnails::testDeleteCascades()
+{
+    ManifestManager manager(this);
+    const ManifestManager::ManifestEntry entry = makeEntry(coverImage(Qt::red));
+    QVERIFY(manager.createManifestEntry(entry));
+    QVERIFY(thumbnailRows(entry.cartridgeGuid) > 0);
+
+    QVERIFY(manager.deleteManifestEntry(entry.cartridgeGuid));
+    QCOMPARE(thumbnailRows(entry.cartridgeGuid), 0);
+}
+
+QTEST_MAIN(TestCoverThumbnails)
+#include "test_coverthumbnails.moc"
@@ -0,0 +1,278 @@
+#include <QtTest>
+#include "smartbook/common/manifest/LibraryGroups.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QUuid>
+
+using namespace smartbook::common::manifest;
+using namespace smartbook::common::database;
+
+class TestLibraryGroups : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testSeriesGroups();
+    void testCountsFollowChanges();
+    void testMembersPaged();
+    void testCollections();
+    void testDeletedCartridgeLeavesCollections();
+
+private:
+    QString addEntry(const QString& title, const QString& series = QString(),
+                     const QString& edition = QString(), int seriesOrder = 0);
+    static const LibraryGroups::Group* find(const QList<LibraryGroups::Group>& groups, const QString& name);
+    static QStringList titles(const QList<LibraryGroups::Member>& members);
+
+    QTemporaryDir* m_tempDir = nullptr;
+    LocalDBManager* m_dbManager = nullptr;
+    ManifestManager* m_manifestManager = nullptr;
+};
+
+void TestLibraryGroups::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_dbManager = &LocalDBManager::getInstance();
+    QVERIFY(m_dbManager->initializeConnection(m_tempDir->filePath("test_local_reader.sqlite")));
+    QVERIFY(m_dbManager->isOpen());
+    m_manifestManager = new ManifestManager(this);
+}
+
+void TestLibraryGroups::cleanupTestCase()
+{
+    if (m_dbManager && m_dbManager->isOpen()) {
+        m_dbManager->closeConnection();
+    }
+    delete m_tempDir;
+}
+
+QString TestLibraryGroups::addEntry(const QString& title, const QString& series,
+                                    const QString& edition, int seriesOrder)
+{
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    entry.cartridgeHash = QByteArray("hash-") + title.toUtf8();
+    entry.localPath = m_tempDir->filePath(entry.cartridgeGuid + ".sqlite");
+    entry.title = title;
+    entry.author = "Test Author";
+    entry.publicationYear = "2025";
+    entry.seriesName = series;
+    entry.editionName = edition;
+    entry.seriesOrder = seriesOrder;
+    return m_manifestManager->createManifestEntry(entry) ? entry.cartridgeGuid : QString();
+}
+
+const LibraryGroups::Group* TestLibraryGroups::find(const QList<LibraryGroups::Group>& groups, const QString& name)
+{
+    for (const LibraryGroups::Group& group : groups) {
+        if (group.name == name) {
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
+QStringList TestLibraryGroups::titles(const QList<LibraryGroups::Member>& members)
+{
+    QStringList result;
+    for (const LibraryGroups::Member& member : members) {
+        result.append(member.title);
+    }
+    return result;
+}
+
+void TestLibraryGroups::testSeriesGroups()
+{
+    QVERIFY(!addEntry("Volume Two", "Atlas", QString(), 2).isEmpty());
+    QVERIFY(!addEntry("Volume One", "Atlas", QString(), 1).isEmpty());
+    QVERIFY(!addEntry("Atlas Student", "Atlas", "Student").isEmpty());
+    QVERIFY(!addEntry("Atlas Teacher", "Atlas", "Teacher").isEmpty());
+    QVERIFY(!addEntry("Loose Book").isEmpty());
+    QVERIFY(!addEntry("Loose Edition", QString(), "Pocket").isEmpty());
+
+    QSqlDatabase database = m_dbManager->getDatabase();
+    const QList<LibraryGroups::Group> series = LibraryGroups::seriesGroups(database);
+    QCOMPARE(series.size(), 2);
+
+    // Named series first, "no series" last
+    QCOMPARE(series.at(0).seriesName, QString("Atlas"));
+    QCOMPARE(series.at(0).cartridgeCount, 4);
+    QVERIFY(series.last().seriesName.isEmpty());
+    QCOMPARE(series.last().cartridgeCount, 2);
+
+    const QList<LibraryGroups::Group> editions = LibraryGroups::editionGroups(database, "Atlas");
+    QCOMPARE(editions.size(), 2);
+    QCOMPARE(editions.at(0).name, QString("Student"));
+    QCOMPARE(editions.at(0).kind, LibraryGroups::Kind::Edition);
+    QCOMPARE(editions.at(0).cartridgeCount, 1);
+
+    // Without an edition: directly under the series, in series order
+    QCOMPARE(titles(LibraryGroups::members(database, series.at(0), 10)),
+             QStringList() << "Volume One" << "Volume Two");
+    QCOMPARE(titles(LibraryGroups::members(database, editions.at(1), 10)),
+             QStringList() << "Atlas Teacher");
+    QCOMPARE(titles(LibraryGroups::members(database, series.last(), 10)),
+             QStringList() << "Loose Book");
+    QCOMPARE(LibraryGroups::editionGroups(database, QString()).size(), 1);
+}
+
+void TestLibraryGroups::testCountsFollowChanges()
+{
+    const QString guid = addEntry("Moving Book", "Beacon", "First");
+    QVERIFY(!guid.isEmpty());
+
+    QSqlDatabase database = m_dbManager->getDatabase();
+    QList<LibraryGroups::Group> series = LibraryGroups::seriesGroups(database);
+    const LibraryGroups::Group* beacon = find(series, "Beacon");
+    QVERIFY(beacon);
+    QCOMPARE(beacon->cartridgeCount, 1);
+
+    // Moved to another edition: the series count stays, the editions change
+    ManifestManager::ManifestEntry entry = m_manifestManager->getManifestEntry(guid);
+    entry.editionName = "Second";
+    QVERIFY(m_manifestManager->updateManifestEntry(entry));
+    QList<LibraryGroups::Group> editions = LibraryGroups::editionGroups(database, "Beacon");
+    QCOMPARE(editions.size(), 1);
+    QCOMPARE(editions.first().name, QString("Second"));
+
+    // Moved to another series: the old group is gone
+    entry.seriesName = "Compass";
+    QVERIFY(m_manifestManager->updateManifestEntry(entry));
+    series = LibraryGroups::seriesGroups(database);
+    QVERIFY(!find(series, "Beacon"));
+    QVERIFY(find(series, "Compass"));
+    QCOMPARE(find(series, "Compass")->cartridgeCount, 1);
+
+    QVERIFY(m_manifestManager->deleteManifestEntry(guid));
+    series = LibraryGroups::seriesGroups(database);
+    QVERIFY(!find(series, "Compass"));
+
+    // The maintained counts agree with counting the manifest
+    QSqlQuery query(database);
+    QVERIFY(query.exec(R"(
+        SELECT COUNT(*) FROM Local_Series_Counts c
+        WHERE c.cartridge_count <> (SELECT COUNT(*) FROM Local_Library_Manifest m
+                                    WHERE IFNULL(m.series_name, '') = c.series_name
+                                      AND IFNULL(m.edition_name, '') = c.edition_name)
+    )"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 0);
+}
+
+void TestLibraryGroups::testMembersPaged()
+{
+    for (int i = 1; i <= 5; ++i) {
+        QVERIFY(!addEntry(QString("Delta %1").arg(i), "Delta", QString(), i).isEmpty());
+    }
+    // Unnumbered and equal keys: the pages must neither skip nor repeat them
+    QVERIFY(!addEntry("Delta Extra", "Delta").isEmpty());
+    QVERIFY(!addEntry("Delta Extra", "Delta").isEmpty());
+    QVERIFY(!addEntry("Delta 3", "Delta", QString(), 3).isEmpty());
+
+    QSqlDatabase database = m_dbManager->getDatabase();
+    const QList<LibraryGroups::Group> series = LibraryGroups::seriesGroups(database);
+    const LibraryGroups::Group* delta = find(series, "Delta");
+    QVERIFY(delta);
+
+    const QList<LibraryGroups::Member> all = LibraryGroups::members(database, *delta, 10);
+    QCOMPARE(titles(all), QStringList() << "Delta Extra" << "Delta Extra" << "Delta 1" << "Delta 2"
+                                        << "Delta 3" << "Delta 3" << "Delta 4" << "Delta 5");
+
+    QList<LibraryGroups::Member> paged;
+    QList<LibraryGroups::Member> page = LibraryGroups::members(database, *delta, 3);
+    while (!page.isEmpty()) {
+        QVERIFY(page.size() <= 3);
+        paged += page;
+        page = LibraryGroups::members(database, *delta, 3, paged.last());
+    }
+    QCOMPARE(paged.size(), all.size());
+    for (int i = 0; i < all.size(); ++i) {
+        QCOMPARE(paged.at(i).cartridgeGuid, all.at(i).cartridgeGuid);
+    }
+    QVERIFY(LibraryGroups::members(database, *delta, 2, all.last()).isEmpty());
+
+    // Read off the series index, without sorting
+    QSqlQuery plan(database);
+    QVERIFY(plan.exec(R"(
+        EXPLAIN QUERY PLAN
+        SELECT cartridge_guid FROM Local_Library_Manifest
+        WHERE series_name IS 'Delta' AND edition_name IS NULL
+          AND series_order >= 2 AND (series_order, title, cartridge_guid) > (2, 'Delta 2', '')
+        ORDER BY series_order, title, cartridge_guid
+    )"));
+    QString details;
+    while (plan.next()) {
+        details += plan.value(3).toString() + '\n';
+    }
+    QVERIFY2(details.contains("idx_manifest_series_edition"), qPrintable(details));
+    QVERIFY2(!details.contains("TEMP B-TREE"), qPrintable(details));
+}
+
+void TestLibraryGroups::testCollections()
+{
+    const QString first = addEntry("Zebra Facts");
+    const QString second = addEntry("Apple Facts");
+    QVERIFY(!first.isEmpty() && !second.isEmpty());
+
+    QSqlDatabase database = m_dbManager->getDatabase();
+    const qint64 favourites = LibraryGroups::createCollection(database, "Favourites");
+    const qint64 archive = LibraryGroups::createCollection(database, "Archive", "Old books");
+    QVERIFY(favourites > 0 && archive > 0);
+    QCOMPARE(LibraryGroups::createCollection(database, "  "), qint64(0));
+
+    // Members keep the order they were added in; duplicates are skipped
+    QCOMPARE(LibraryGroups::addToCollection(database, favourites, QStringList() << first << second), 2);
+    QCOMPARE(LibraryGroups::addToCollection(database, favourites, QStringList() << first), 0);
+    QCOMPARE(LibraryGroups::addToCollection(database, favourites, QStringList() << "no-such-cartridge"), -1);
+
+    QList<LibraryGroups::Group> collections = LibraryGroups::collections(database);
+    QCOMPARE(collections.size(), 2);
+    QCOMPARE(collections.at(0).name, QString("Archive"));
+    QCOMPARE(collections.at(0).cartridgeCount, 0);
+    QCOMPARE(collections.at(1).collectionId, favourites);
+    QCOMPARE(collections.at(1).cartridgeCount, 2);
+    QCOMPARE(titles(LibraryGroups::members(database, collections.at(1), 10)),
+             QStringList() << "Zebra Facts" << "Apple Facts");
+    const QList<LibraryGroups::Member> firstPage = LibraryGroups::members(database, collections.at(1), 1);
+    QCOMPARE(titles(firstPage), QStringList() << "Zebra Facts");
+    QCOMPARE(titles(LibraryGroups::members(database, collections.at(1), 1, firstPage.last())),
+             QStringList() << "Apple Facts");
+
+    QCOMPARE(LibraryGroups::removeFromCollection(database, favourites, QStringList() << first), 1);
+    QVERIFY(LibraryGroups::renameCollection(database, favourites, "Best"));
+    collections = LibraryGroups::collections(database);
+    QCOMPARE(collections.at(1).name, QString("Best"));
+    QCOMPARE(collections.at(1).cartridgeCount, 1);
+
+    QVERIFY(LibraryGroups::deleteCollection(database, favourites));
+    QVERIFY(!LibraryGroups::deleteCollection(database, favourites));
+    QCOMPARE(LibraryGroups::collections(database).size(), 1);
+    QVERIFY(m_manifestManager->manifestEntryExists(second));
+}
+
+void TestLibraryGroups::testDeletedCartridgeLeavesCollections()
+{
+    const QString guid = addEntry("Short Lived");
+    QVERIFY(!guid.isEmpty());
+
+    QSqlDatabase database = m_dbManager->getDatabase();
+    const qint64 collection = LibraryGroups::createCollection(database, "Temporary");
+    QCOMPARE(LibraryGroups::addToCollection(database, collection, QStringList() << guid), 1);
+
+    // The membership would otherwise block the delete (foreign key)
+    QVERIFY(m_manifestManager->deleteManifestEntry(guid));
+    const QList<LibraryGroups::Group> collections = LibraryGroups::collections(database);
+    const LibraryGroups::Group* temporary = find(collections, "Temporary");
+    QVERIFY(temporary);
+    QCOMPARE(temporary->cartridgeCount, 0);
+}
+
+QTEST_MAIN(TestLibraryGroups)
+#include "test_librarygroups.moc"
@@ -0,0 +1,477 @@
+#include <QtTest>
+#include "smartbook/reader/ui/LibraryModel.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QBuffer>
+#include <QImage>
+#include <QPixmap>
+#include <QUuid>
+
+using namespace smartbook::reader;
+using namespace smartbook::common::database;
+using namespace smartbook::common::manifest;
+
+class TestLibraryModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testHeaders();
+    void testFetchesInPages();
+    void testSortDelegatedToSql();
+    void testGridProxyLoadsCovers();
+    void testCancelledCoverIsRequestedAgain();
+    void testFilterText();
+    void testAppliesManifestChanges();
+    void testKeysetPagesOnTiedKeys();
+    void testFilterInSql();
+    void testSortByLastOpened();
+
+private:
+    static constexpr int ENTRY_COUNT = 450;
+
+    QTemporaryDir* m_tempDir = nullptr;
+    LocalDBManager* m_dbManager = nullptr;
+    QString m_coverGuid;
+};
+
+void TestLibraryModel::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_dbManager = &LocalDBManager::getInstance();
+    QVERIFY(m_dbManager->initializeConnection(m_tempDir->filePath("library.sqlite")));
+
+    // Titles sort opposite to authors so the two orders are distinguishable
+    QVERIFY(m_dbManager->write([](QSqlDatabase& database) {
+        if (!database.transaction()) {
+            return false;
+        }
+        QSqlQuery insert(database);
+        insert.prepare("INSERT INTO Local_Library_Manifest "
+                       "(cartridge_guid, cartridge_hash, local_path, title, author, version, publication_year) "
+                       "VALUES (?, ?, ?, ?, ?, '1.0', '2025')");
+        for (int i = 0; i < ENTRY_COUNT; ++i) {
+            insert.bindValue(0, QUuid::createUuid().toString(QUuid::WithoutBraces));
+            insert.bindValue(1, QByteArray("hash"));
+            insert.bindValue(2, QString("/library/%1.sqlite").arg(i));
+            insert.bindValue(3, QString("Book %1").arg(i, 3, 10, QChar('0')));
+            insert.bindValue(4, QString("Author %1").arg(ENTRY_COUNT - i, 3, 10, QChar('0')));
+            if (!insert.exec()) {
+                database.rollback();
+                return false;
+            }
+        }
+        return database.commit();
+    }));
+
+    // One entry with a cover, sorted first by title
+    QImage image(300, 400, QImage::Format_RGB32);
+    image.fill(Qt::darkBlue);
+    QByteArray cover;
+    QBuffer buffer(&cover);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(image.save(&buffer, "PNG"));
+
+    ManifestManager manager;
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    entry.cartridgeHash = QByteArray("covered");
+    entry.localPath = "/library/covered.sqlite";
+    entry.title = "A Covered Book";
+    entry.author = "Author 999";
+    entry.publicationYear = "2025";
+    entry.coverImageData = cover;
+    QVERIFY(manager.createManifestEntry(entry));
+    m_coverGuid = entry.cartridgeGuid;
+}
+
+void TestLibraryModel::cleanupTestCase()
+{
+    if (m_dbManager && m_dbManager->isOpen()) {
+        m_dbManager->closeConnection();
+    }
+    delete m_tempDir;
+}
+
+void TestLibraryModel::testHeaders()
+{
+    LibraryModel model;
+    QCOMPARE(model.columnCount(), 4);
+    QCOMPARE(model.headerData(LibraryModel::TitleColumn, Qt::Horizontal).toString(), QString("Title"));
+    QCOMPARE(model.headerData(LibraryModel::AuthorColumn, Qt::Horizontal).toString(), QString("Author"));
+    QCOMPARE(model.headerData(LibraryModel::VersionColumn, Qt::Horizontal).toString(), QString("Edition/Version"));
+    QCOMPARE(model.headerData(LibraryModel::YearColumn, Qt::Horizontal).toString(), QString("Year of Publication"));
+}
+
+void TestLibraryModel::testFetchesInPages()
+{
+    LibraryModel model;
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+
+    model.reload();
+    QTRY_COMPARE(pages.count(), 1);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE);
+    QVERIFY(model.canFetchMore(QModelIndex()));
+
+    // Nothing beyond the first page is held until a view asks for it
+    while (model.canFetchMore(QModelIndex())) {
+        const int before = pages.count();
+        model.fetchMore(QModelIndex());
+        QVERIFY(!model.canFetchMore(QModelIndex()));   // In flight
+        QTRY_COMPARE(pages.count(), before + 1);
+    }
+    QCOMPARE(model.rowCount(), ENTRY_COUNT + 1);
+
+    // Pages join without gaps or repeats
+    QSet<QString> guids;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        guids.insert(model.guidAt(row));
+    }
+    QCOMPARE(int(guids.size()), ENTRY_COUNT + 1);
+
+    const QModelIndex first = model.index(0, LibraryModel::TitleColumn);
+    QCOMPARE(first.data().toString(), QString("A Covered Book"));
+    QCOMPARE(model.index(0, LibraryModel::YearColumn).data().toString(), QString("2025"));
+    QCOMPARE(model.index(0, LibraryModel::AuthorColumn).data(LibraryModel::GuidRole).toString(), m_coverGuid);
+}
+
+void TestLibraryModel::testSortDelegatedToSql()
+{
+    LibraryModel model;
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.reload();
+    QTRY_COMPARE(pages.count(), 1);
+    QCOMPARE(model.index(1, LibraryModel::TitleColumn).data().toString(), QString("Book 000"));
+
+    // Sorting reloads from the first page in the new order
+    QSignalSpy resets(&model, &QAbstractItemModel::modelReset);
+    model.sort(LibraryModel::AuthorColumn, Qt::DescendingOrder);
+    QCOMPARE(resets.count(), 1);
+    QTRY_COMPARE(pages.count(), 2);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE);
+    QCOMPARE(model.index(0, LibraryModel::AuthorColumn).data().toString(), QString("Author 999"));
+    QCOMPARE(model.index(1, LibraryModel::AuthorColumn).data().toString(), QString("Author 450"));
+    QCOMPARE(model.index(1, LibraryModel::TitleColumn).data().toString(), QString("Book 000"));
+
+    for (int row = 1; row < model.rowCount(); ++row) {
+        QVERIFY(model.index(row - 1, LibraryModel::AuthorColumn).data().toString()
+                >= model.index(row, LibraryModel::AuthorColumn).data().toString());
+    }
+
+    // Same order again is a no-op
+    model.sort(LibraryModel::AuthorColumn, Qt::DescendingOrder);
+    QCOMPARE(resets.count(), 1);
+}
+
+void TestLibraryModel::testGridProxyLoadsCovers()
+{
+    LibraryModel model;
+    LibraryGridProxy grid;
+    grid.setSourceModel(&model);
+
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.reload();
+    QTRY_COMPARE(pages.count(), 1);
+    QCOMPARE(model.guidAt(0), m_coverGuid);
+
+    // The list side never sees covers
+    QVERIFY(!model.index(0, LibraryModel::TitleColumn).data(Qt::DecorationRole).isValid());
+
+    // A placeholder paints at once; the decoded cover arrives with a dataChanged
+    const QModelIndex index = grid.index(0, LibraryModel::TitleColumn);
+    QSignalSpy changed(&grid, &QAbstractItemModel::dataChanged);
+    const QPixmap placeholder = index.data(Qt::DecorationRole).value<QPixmap>();
+    QVERIFY(!placeholder.isNull());
+    QCOMPARE(placeholder.size(), QSize(120, 160));
+    QTRY_VERIFY(changed.count() > 0);
+
+    const QPixmap cover = index.data(Qt::DecorationRole).value<QPixmap>();
+    QVERIFY(!cover.isNull());
+    QCOMPARE(cover.size(), QSize(120, 160));
+    const QColor pixel = cover.toImage().pixelColor(60, 80);
+    QCOMPARE(pixel, QColor(Qt::darkBlue));
+
+    // Rows without a cover keep the placeholder
+    const QPixmap empty = grid.index(1, LibraryModel::TitleColumn).data(Qt::DecorationRole).value<QPixmap>();
+    QCOMPARE(empty.size(), QSize(120, 160));
+}
+
+void TestLibraryModel::testCancelledCoverIsRequestedAgain()
+{
+    LibraryModel model;
+    LibraryGridProxy grid;
+    grid.setSourceModel(&model);
+
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.reload();
+    QTRY_COMPARE(pages.count(), 1);
+
+    // Hiding the Bookshelf view before the load starts drops the request
+    const QModelIndex index = grid.index(0, LibraryModel::TitleColumn);
+    QSignalSpy changed(&grid, &QAbstractItemModel::dataChanged);
+    index.data(Qt::DecorationRole);
+    model.cancelCoverLoads();
+    QTest::qWait(100);
+    QCOMPARE(changed.count(), 0);
+
+    // Painting it again queues a new load
+    model.setVisibleRows(0, 10);
+    index.data(Qt::DecorationRole);
+    QTRY_VERIFY(changed.count() > 0);
+    QCOMPARE(index.data(Qt::DecorationRole).value<QPixmap>().toImage().pixelColor(60, 80), QColor(Qt::darkBlue));
+}
+
+void TestLibraryModel::testFilterText()
+{
+    LibraryModel model;
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.reload();
+    QTRY_COMPARE(pages.count(), 1);
+
+    // Matches are loaded in the current sort order, nothing else
+    QSignalSpy resets(&model, &QAbstractItemModel::modelReset);
+    model.setFilterText("book 01");
+    QCOMPARE(resets.count(), 1);
+    QTRY_COMPARE(pages.count(), 2);
+    QCOMPARE(model.rowCount(), 10);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    QCOMPARE(model.index(0, LibraryModel::TitleColumn).data().toString(), QString("Book 010"));
+    QCOMPARE(model.index(9, LibraryModel::TitleColumn).data().toString(), QString("Book 019"));
+
+    // Whitespace alone does not reload
+    model.setFilterText(" book  01 ");
+    QCOMPARE(resets.count(), 1);
+    QCOMPARE(model.filterText(), QString(" book  01 "));
+
+    // Imports that match join the results, others stay out
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    ManifestManager manager;
+    ManifestManager::ManifestEntry match;
+    match.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    match.cartridgeHash = QByteArray("match");
+    match.localPath = "/library/match.sqlite";
+    match.title = "Book 015a";
+    match.author = "Searched Author";
+    match.publicationYear = "2025";
+    QVERIFY(manager.createManifestEntry(match));
+    QTRY_COMPARE(inserted.count(), 1);
+    QCOMPARE(model.rowCount(), 11);
+    QCOMPARE(model.guidAt(6), match.cartridgeGuid);
+
+    // Edited out of the results, it leaves the model
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    match.title = "Unrelated";
+    QVERIFY(manager.updateManifestEntry(match));
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(model.rowCount(), 10);
+    QVERIFY(manager.deleteManifestEntry(match.cartridgeGuid));
+
+    model.setFilterText(QString());
+    QCOMPARE(resets.count(), 2);
+    QTRY_COMPARE(pages.count(), 3);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE);
+}
+
+void TestLibraryModel::testAppliesManifestChanges()
+{
+    LibraryModel model;
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.reload();
+    QTRY_COMPARE(pages.count(), 1);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE);
+
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+
+    // An import lands in its sorted place among the loaded rows
+    ManifestManager manager;
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    entry.cartridgeHash = QByteArray("imported");
+    entry.localPath = "/library/imported.sqlite";
+    entry.title = "Book 050a";
+    entry.author = "Imported Author";
+    entry.publicationYear = "2025";
+    QVERIFY(manager.createManifestEntry(entry));
+    QTRY_COMPARE(inserted.count(), 1);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE + 1);
+    QCOMPARE(model.guidAt(52), entry.cartridgeGuid);   // After "A Covered Book" and Book 000-050
+
+    // An edit that keeps the order updates the row in place
+    entry.author = "Edited Author";
+    QVERIFY(manager.updateManifestEntry(entry));
+    QTRY_VERIFY(changed.count() > 0);
+    QCOMPARE(model.index(52, LibraryModel::AuthorColumn).data().toString(), QString("Edited Author"));
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(removed.count(), 0);
+
+    // Sorting past the loaded rows drops it until that page is fetched
+    entry.title = "Book 300a";
+    QVERIFY(manager.updateManifestEntry(entry));
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE);
+    QVERIFY(model.guidAt(52) != entry.cartridgeGuid);
+
+    // Deleting a loaded row removes just that row
+    const QString deleted = model.guidAt(1);
+    QVERIFY(manager.deleteManifestEntry(deleted));
+    QTRY_COMPARE(removed.count(), 2);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE - 1);
+    QVERIFY(model.guidAt(1) != deleted);
+
+    QCOMPARE(reset.count(), 0);
+    QVERIFY(manager.deleteManifestEntry(entry.cartridgeGuid));
+}
+
+void TestLibraryModel::testKeysetPagesOnTiedKeys()
+{
+    QSqlQuery count = m_dbManager->executeQuery("SELECT COUNT(*) FROM Local_Library_Manifest");
+    QVERIFY(count.next());
+    const int total = count.value(0).toInt();
+
+    // Every entry has the same year, so pages seek on the GUID alone
+    LibraryModel model;
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.sort(LibraryModel::YearColumn, Qt::DescendingOrder);
+    QTRY_COMPARE(pages.count(), 1);
+    while (model.canFetchMore(QModelIndex())) {
+        const int before = pages.count();
+        model.fetchMore(QModelIndex());
+        QTRY_COMPARE(pages.count(), before + 1);
+    }
+    QCOMPARE(model.rowCount(), total);
+
+    QSet<QString> guids;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        guids.insert(model.guidAt(row));
+        if (row > 0) {
+            QVERIFY(model.guidAt(row - 1) > model.guidAt(row));
+        }
+    }
+    QCOMPARE(int(guids.size()), total);
+
+    // The page query reads its sort index instead of sorting
+    QSqlQuery plan = m_dbManager->executeQuery(R"(
+        EXPLAIN QUERY PLAN
+        SELECT cartridge_guid FROM Local_Library_Manifest m
+        WHERE m.publication_year <= '2025' AND (m.publication_year, m.cartridge_guid) < ('2025', 'x')
+        ORDER BY m.publication_year DESC, m.cartridge_guid DESC LIMIT 200
+    )");
+    QString details;
+    while (plan.next()) {
+        details += plan.value(3).toString() + '\n';
+    }
+    QVERIFY2(details.contains("idx_manifest_year"), qPrintable(details));
+    QVERIFY2(!details.contains("TEMP B-TREE"), qPrintable(details));
+}
+
+void TestLibraryModel::testFilterInSql()
+{
+    ManifestManager manager;
+    QStringList added;
+    const QStringList years = QStringList() << "1999" << "2003" << "2007-05" << "2010";
+    for (int i = 0; i < years.size(); ++i) {
+        ManifestManager::ManifestEntry entry;
+        entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        entry.cartridgeHash = QByteArray("filtered");
+        entry.localPath = QString("/library/filtered-%1.sqlite").arg(i);
+        entry.title = QString("Filtered %1").arg(i);
+        entry.author = "Filtered Author";
+        entry.publisher = i % 2 ? "Odd Press" : "Even Press";
+        entry.publicationYear = years.at(i);
+        QVERIFY(manager.createManifestEntry(entry));
+        added.append(entry.cartridgeGuid);
+    }
+
+    LibraryModel model;
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.reload();
+    QTRY_COMPARE(pages.count(), 1);
+
+    LibraryModel::Filter filter;
+    filter.author = "Filtered Author";
+    QSignalSpy resets(&model, &QAbstractItemModel::modelReset);
+    model.setFilter(filter);
+    QCOMPARE(resets.count(), 1);
+    QTRY_COMPARE(pages.count(), 2);
+    QCOMPARE(model.rowCount(), 4);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+
+    // Year bounds are inclusive; "2007-05" is in 2007
+    filter.yearFrom = 2003;
+    filter.yearTo = 2007;
+    model.setFilter(filter);
+    QTRY_COMPARE(pages.count(), 3);
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.index(0, LibraryModel::TitleColumn).data().toString(), QString("Filtered 1"));
+    QCOMPARE(model.index(1, LibraryModel::TitleColumn).data().toString(), QString("Filtered 2"));
+
+    filter.publisher = "Odd Press";
+    model.setFilter(filter);
+    QTRY_COMPARE(pages.count(), 4);
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(model.guidAt(0), added.at(1));
+
+    // Same filter again is a no-op
+    model.setFilter(filter);
+    QCOMPARE(resets.count(), 3);
+
+    // Edits are placed against the filter like against a search
+    QSignalSpy removed(&model, &QAbstractItemModel::rowsRemoved);
+    ManifestManager::ManifestEntry entry = manager.getManifestEntry(added.at(1));
+    entry.publisher = "Even Press";
+    QVERIFY(manager.updateManifestEntry(entry));
+    QTRY_COMPARE(removed.count(), 1);
+    QCOMPARE(model.rowCount(), 0);
+
+    model.setFilter(LibraryModel::Filter());
+    QTRY_COMPARE(pages.count(), 5);
+    QCOMPARE(model.rowCount(), LibraryModel::PAGE_SIZE);
+
+    for (const QString& guid : added) {
+        QVERIFY(manager.deleteManifestEntry(guid));
+    }
+}
+
+void TestLibraryModel::testSortByLastOpened()
+{
+    ManifestManager manager;
+    const QString opened = m_coverGuid;
+    QVERIFY(manager.recordOpened(opened));
+    QVERIFY(!manager.recordOpened("no-such-cartridge"));
+
+    // A minute earlier, so the next open sorts above it
+    QVERIFY(m_dbManager->write([opened](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare("UPDATE Local_Library_Manifest SET last_opened = last_opened - 60 WHERE cartridge_guid = ?");
+        query.addBindValue(opened);
+        return query.exec();
+    }));
+
+    LibraryModel model;
+    QSignalSpy pages(&model, &LibraryModel::pageLoaded);
+    model.sort(LibraryModel::LastOpenedSortKey, Qt::DescendingOrder);
+    QCOMPARE(model.sortColumn(), int(LibraryModel::LastOpenedSortKey));
+    QTRY_COMPARE(pages.count(), 1);
+    QCOMPARE(model.guidAt(0), opened);
+    QCOMPARE(model.columnCount(), 4);
+
+    // Opening another moves it to the top through the change feed
+    const QString next = model.guidAt(10);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+    QVERIFY(manager.recordOpenedAsync(next).result());
+    QTRY_COMPARE(inserted.count(), 1);
+    QCOMPARE(model.guidAt(0), next);
+    QCOMPARE(model.guidAt(1), opened);
+}
+
+QTEST_MAIN(TestLibraryModel)
+#include "test_librarymodel.moc"
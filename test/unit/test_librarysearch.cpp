@@ -0,0 +1,144 @@
+#include <QtTest>
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include "smartbook/common/manifest/LibrarySearch.h"
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QUuid>
+
+using namespace smartbook::common::database;
+using namespace smartbook::common::manifest;
+
+class TestLibrarySearch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testMatchExpression();
+    void testPrefixSearch();
+    void testRankedByColumn();
+    void testTriggersKeepIndexInSync();
+
+private:
+    ManifestManager::ManifestEntry makeEntry(const QString& title, const QString& author);
+    QStringList search(const QString& text, int limit = 100);
+
+    QTemporaryDir* m_tempDir = nullptr;
+    LocalDBManager* m_dbManager = nullptr;
+};
+
+void TestLibrarySearch::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_dbManager = &LocalDBManager::getInstance();
+    QVERIFY(m_dbManager->initializeConnection(m_tempDir->filePath("search.sqlite")));
+}
+
+void TestLibrarySearch::cleanupTestCase()
+{
+    if (m_dbManager && m_dbManager->isOpen()) {
+        m_dbManager->closeConnection();
+    }
+    delete m_tempDir;
+}
+
+ManifestManager::ManifestEntry TestLibrarySearch::makeEntry(const QString& title, const QString& author)
+{
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    entry.cartridgeHash = QUuid::createUuid().toRfc4122();
+    entry.localPath = "/path/to/cartridge.sqlite";
+    entry.title = title;
+    entry.author = author;
+    entry.publicationYear = "2025";
+    return entry;
+}
+
+QStringList TestLibrarySearch::search(const QString& text, int limit)
+{
+    QSqlDatabase database = m_dbManager->readConnection();
+    return LibrarySearch::search(database, text, limit);
+}
+
+void TestLibrarySearch::testMatchExpression()
+{
+    QCOMPARE(LibrarySearch::matchExpression("  "), QString());
+    QCOMPARE(LibrarySearch::matchExpression("dra"), QString("\"dra\"*"));
+    QCOMPARE(LibrarySearch::matchExpression(" dragon  tol "), QString("\"dragon\"* \"tol\"*"));
+
+    // FTS5 syntax is searched for literally
+    QCOMPARE(LibrarySearch::matchExpression("C++ AND"), QString("\"C++\"* \"AND\"*"));
+    QCOMPARE(LibrarySearch::matchExpression("say \"hi"), QString("\"say\"* \"\"\"hi\"*"));
+}
+
+void TestLibrarySearch::testPrefixSearch()
+{
+    ManifestManager manager;
+    ManifestManager::ManifestEntry dragons = makeEntry("Here Be Dragons", "Ölga Tolkien");
+    dragons.publisher = "Wyrm Press";
+    QVERIFY(manager.createManifestEntry(dragons));
+    QVERIFY(m_dbManager->write([&](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare("UPDATE Local_Library_Manifest SET series_name = 'Maps' WHERE cartridge_guid = ?");
+        query.addBindValue(dragons.cartridgeGuid);
+        return query.exec();
+    }));
+    ManifestManager::ManifestEntry gardens = makeEntry("Gardening Basics", "Sam Green");
+    QVERIFY(manager.createManifestEntry(gardens));
+
+    QCOMPARE(search("dra"), QStringList{dragons.cartridgeGuid});
+    QCOMPARE(search("DRAGONS"), QStringList{dragons.cartridgeGuid});
+    QCOMPARE(search("olga"), QStringList{dragons.cartridgeGuid});   // Diacritics ignored
+    QCOMPARE(search("wyrm ma"), QStringList{dragons.cartridgeGuid});
+    QCOMPARE(search("g"), QStringList{gardens.cartridgeGuid});
+
+    // Every word has to match
+    QVERIFY(search("dragons green").isEmpty());
+    QVERIFY(search("C++ AND").isEmpty());
+    QVERIFY(search("").isEmpty());
+    QVERIFY(search("dra", 0).isEmpty());
+
+    QVERIFY(manager.deleteManifestEntry(dragons.cartridgeGuid));
+    QVERIFY(manager.deleteManifestEntry(gardens.cartridgeGuid));
+}
+
+void TestLibrarySearch::testRankedByColumn()
+{
+    // A title match outranks the same word in the publisher
+    ManifestManager manager;
+    ManifestManager::ManifestEntry publisher = makeEntry("Collected Works", "Anon");
+    publisher.publisher = "Lantern Books";
+    QVERIFY(manager.createManifestEntry(publisher));
+    ManifestManager::ManifestEntry title = makeEntry("The Lantern", "Anon");
+    QVERIFY(manager.createManifestEntry(title));
+
+    QCOMPARE(search("lantern"), (QStringList{title.cartridgeGuid, publisher.cartridgeGuid}));
+    QCOMPARE(search("lantern", 1), QStringList{title.cartridgeGuid});
+
+    QVERIFY(manager.deleteManifestEntry(publisher.cartridgeGuid));
+    QVERIFY(manager.deleteManifestEntry(title.cartridgeGuid));
+}
+
+void TestLibrarySearch::testTriggersKeepIndexInSync()
+{
+    ManifestManager manager;
+    ManifestManager::ManifestEntry entry = makeEntry("Old Title", "Writer");
+    QVERIFY(manager.createManifestEntry(entry));
+    QCOMPARE(search("old"), QStringList{entry.cartridgeGuid});
+
+    entry.title = "New Title";
+    QVERIFY(manager.updateManifestEntry(entry));
+    QVERIFY(search("old").isEmpty());
+    QCOMPARE(search("new tit"), QStringList{entry.cartridgeGuid});
+
+    QVERIFY(manager.deleteManifestEntry(entry.cartridgeGuid));
+    QVERIFY(search("new").isEmpty());
+    QVERIFY(search("writer").isEmpty());
+}
+
+QTEST_MAIN(TestLibrarySearch)
+#include "test_librarysearch.moc"
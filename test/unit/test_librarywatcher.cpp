@@ -0,0 +1,281 @@
+#include <QtTest>
+#include "smartbook/common/manifest/LibraryWatcher.h"
+#include "smartbook/common/manifest/CartridgeImporter.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/utils/FileFingerprint.h"
+#include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QUuid>
+
+using namespace smartbook::common::manifest;
+using namespace smartbook::common::database;
+using smartbook::common::utils::FileFingerprint;
+
+class TestLibraryWatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testFingerprint();
+    void testAdoptsMissingFingerprint();
+    void testMissingAndReappearing();
+    void testMovedFile();
+    void testChangedFileRehashed();
+
+private:
+    QString createCartridge(const QString& path, const QString& title);
+    bool setTitle(const QString& path, const QString& title);
+    QString importCartridge(const QString& path);
+    bool runScan(LibraryWatcher& watcher, QList<QVariant>* counts = nullptr);
+
+    QTemporaryDir* m_tempDir = nullptr;
+    LocalDBManager* m_dbManager = nullptr;
+    ManifestManager* m_manifestManager = nullptr;
+};
+
+void TestLibraryWatcher::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_dbManager = &LocalDBManager::getInstance();
+    QVERIFY(m_dbManager->initializeConnection(m_tempDir->filePath("test_local_reader.sqlite")));
+    QVERIFY(m_dbManager->isOpen());
+    m_manifestManager = new ManifestManager(this);
+}
+
+void TestLibraryWatcher::cleanupTestCase()
+{
+    if (m_dbManager && m_dbManager->isOpen()) {
+        m_dbManager->closeConnection();
+    }
+    delete m_tempDir;
+}
+
+QString TestLibraryWatcher::createCartridge(const QString& path, const QString& title)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    const QString guid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    const QString connectionName = "WatcherFixture_" + guid;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        if (!db.open()) {
+            return QString();
+        }
+
+        QSqlQuery query(db);
+        query.exec("CREATE TABLE Metadata (cartridge_guid TEXT PRIMARY KEY, title TEXT, author TEXT, publication_year TEXT)");
+        query.prepare("INSERT INTO Metadata (cartridge_guid, title, author, publication_year) VALUES (?, ?, ?, ?)");
+        query.addBindValue(guid);
+        query.addBindValue(title);
+        query.addBindValue("Test Author");
+        query.addBindValue("2025");
+        query.exec();
+        query.exec("CREATE TABLE Content_Pages (page_id INTEGER PRIMARY KEY, content_html TEXT)");
+        query.exec("INSERT INTO Content_Pages (page_id, content_html) VALUES (1, '<p>Page</p>')");
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return guid;
+}
+
+bool TestLibraryWatcher::setTitle(const QString& path, const QString& title)
+{
+    const QString connectionName = "WatcherFixtureEdit";
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(path);
+        if (db.open()) {
+            QSqlQuery query(db);
+            query.prepare("UPDATE Metadata SET title = ?");
+            query.addBindValue(title);
+            ok = query.exec();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+QString TestLibraryWatcher::importCartridge(const QString& path)
+{
+    CartridgeImporter importer;
+    QSignalSpy finishedSpy(&importer, &CartridgeImporter::finished);
+    if (!importer.start(QStringList() << path) || !finishedSpy.wait(30000)
+        || importer.summary().created + importer.summary().updated != 1) {
+        return QString();
+    }
+    return QFileInfo(path).absoluteFilePath();
+}
+
+bool TestLibraryWatcher::runScan(LibraryWatcher& watcher, QList<QVariant>* counts)
+{
+    QSignalSpy scanSpy(&watcher, &LibraryWatcher::scanFinished);
+    watcher.rescan();
+    if (!scanSpy.wait(30000)) {
+        return false;
+    }
+    if (counts) {
+        *counts = scanSpy.first();
+    }
+    return true;
+}
+
+void TestLibraryWatcher::testFingerprint()
+{
+    const QString path = m_tempDir->filePath("fingerprint.bin");
+    QVERIFY(!FileFingerprint::of(path).exists());
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("abc");
+    file.close();
+
+    const FileFingerprint first = FileFingerprint::of(path);
+    QVERIFY(first.exists());
+    QCOMPARE(first.size, qint64(3));
+    QVERIFY(first.matches(FileFingerprint::of(path)));
+
+    QVERIFY(file.open(QIODevice::Append));
+    file.write("d");
+    file.close();
+    QVERIFY(!first.matches(FileFingerprint::of(path)));
+
+    // Directories are not cartridges
+    QVERIFY(!FileFingerprint::of(m_tempDir->path()).exists());
+}
+
+void TestLibraryWatcher::testAdoptsMissingFingerprint()
+{
+    // Entry created without a fingerprint, as before fingerprints existed
+    const QString path = m_tempDir->filePath("adopt/book.sqlite");
+    const QString guid = createCartridge(path, "Adopted");
+    QVERIFY(!guid.isEmpty());
+
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = guid;
+    entry.cartridgeHash = QByteArray("old-hash");
+    entry.localPath = path;
+    entry.title = "Adopted";
+    entry.author = "Test Author";
+    entry.publicationYear = "2025";
+    QVERIFY(m_manifestManager->createManifestEntry(entry));
+    QVERIFY(!m_manifestManager->getManifestEntry(guid).fingerprint.exists());
+
+    LibraryWatcher watcher;
+    watcher.setRescanInterval(0);
+    QSignalSpy scanSpy(&watcher, &LibraryWatcher::scanFinished);
+    watcher.start();
+    QVERIFY(scanSpy.wait(30000));
+
+    // Recorded without rehashing
+    QCOMPARE(scanSpy.first().at(2).toInt(), 0);
+    const ManifestManager::ManifestEntry adopted = m_manifestManager->getManifestEntry(guid);
+    QVERIFY(adopted.fingerprint.matches(FileFingerprint::of(path)));
+    QCOMPARE(adopted.cartridgeHash, QByteArray("old-hash"));
+    QCOMPARE(adopted.locationStatus, QString(ManifestManager::LOCATION_LOCAL));
+}
+
+void TestLibraryWatcher::testMissingAndReappearing()
+{
+    const QString path = m_tempDir->filePath("missing/book.sqlite");
+    const QString guid = createCartridge(path, "Missing");
+    QVERIFY(!importCartridge(path).isEmpty());
+
+    LibraryWatcher watcher;
+    watcher.setRescanInterval(0);
+    QSignalSpy scanSpy(&watcher, &LibraryWatcher::scanFinished);
+    watcher.start();
+    QVERIFY(scanSpy.wait(30000));
+
+    // Moved out of every scanned directory: missing
+    const QString away = m_tempDir->filePath("elsewhere.bin");
+    QVERIFY(QFile::rename(path, away));
+    QList<QVariant> counts;
+    QVERIFY(runScan(watcher, &counts));
+    QCOMPARE(counts.at(0).toInt(), 1);
+    QCOMPARE(m_manifestManager->getManifestEntry(guid).locationStatus, QString(ManifestManager::LOCATION_MISSING));
+
+    // Still missing: not counted again
+    QVERIFY(runScan(watcher, &counts));
+    QCOMPARE(counts.at(0).toInt(), 0);
+
+    QVERIFY(QFile::rename(away, path));
+    QVERIFY(runScan(watcher, &counts));
+    QCOMPARE(counts.at(2).toInt(), 0);
+    QCOMPARE(m_manifestManager->getManifestEntry(guid).locationStatus, QString(ManifestManager::LOCATION_LOCAL));
+}
+
+void TestLibraryWatcher::testMovedFile()
+{
+    const QString path = m_tempDir->filePath("moved/book.sqlite");
+    const QString guid = createCartridge(path, "Moved");
+    QVERIFY(!importCartridge(path).isEmpty());
+    if (m_manifestManager->getManifestEntry(guid).fingerprint.fileId == 0) {
+        QSKIP("File ids are not available on this platform");
+    }
+
+    LibraryWatcher watcher;
+    watcher.setRescanInterval(0);
+    QSignalSpy scanSpy(&watcher, &LibraryWatcher::scanFinished);
+    watcher.start();
+    QVERIFY(scanSpy.wait(30000));
+
+    const QString renamed = m_tempDir->filePath("moved/renamed.sqlite");
+    QVERIFY(QFile::rename(path, renamed));
+    QList<QVariant> counts;
+    QVERIFY(runScan(watcher, &counts));
+    QCOMPARE(counts.at(0).toInt(), 0);
+    QCOMPARE(counts.at(1).toInt(), 1);
+    QCOMPARE(counts.at(2).toInt(), 0);
+
+    const ManifestManager::ManifestEntry entry = m_manifestManager->getManifestEntry(guid);
+    QCOMPARE(entry.localPath, QFileInfo(renamed).absoluteFilePath());
+    QCOMPARE(entry.locationStatus, QString(ManifestManager::LOCATION_LOCAL));
+}
+
+void TestLibraryWatcher::testChangedFileRehashed()
+{
+    const QString path = m_tempDir->filePath("changed/book.sqlite");
+    const QString guid = createCartridge(path, "Before");
+    QVERIFY(!importCartridge(path).isEmpty());
+    const QByteArray hashBefore = m_manifestManager->getManifestEntry(guid).cartridgeHash;
+
+    LibraryWatcher watcher;
+    watcher.setRescanInterval(0);
+    QSignalSpy scanSpy(&watcher, &LibraryWatcher::scanFinished);
+    watcher.start();
+    QVERIFY(scanSpy.wait(30000));
+
+    // Unchanged files are not rehashed
+    QList<QVariant> counts;
+    QVERIFY(runScan(watcher, &counts));
+    QCOMPARE(counts.at(2).toInt(), 0);
+
+    QThread::msleep(20);    // Make sure the modification time moves
+    QVERIFY(setTitle(path, "After"));
+
+    QSignalSpy rehashSpy(&watcher, &LibraryWatcher::rehashFinished);
+    QVERIFY(runScan(watcher, &counts));
+    QCOMPARE(counts.at(2).toInt(), 1);
+    QVERIFY(rehashSpy.wait(30000));
+
+    const ManifestManager::ManifestEntry entry = m_manifestManager->getManifestEntry(guid);
+    QCOMPARE(entry.title, QString("After"));
+    QVERIFY(entry.cartridgeHash != hashBefore);
+    QVERIFY(entry.fingerprint.matches(FileFingerprint::of(path)));
+}
+
+QTEST_MAIN(TestLibraryWatcher)
+#include "test_librarywatcher.moc"
@@ -0,0 +1,190 @@
+#include <QtTest>
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/database/LocalDBExecutor.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include "smartbook/common/security/TrustRegistry.h"
+#include <QTemporaryDir>
+#include <QSemaphore>
+#include <QThread>
+#include <QMutex>
+#include <QStringList>
+#include <QUuid>
+
+using namespace smartbook::common::database;
+using namespace smartbook::common::manifest;
+using namespace smartbook::common::security;
+
+class TestLocalDBExecutor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testTasksRunOffCallerThread();
+    void testManifestAsyncRoundTrip();
+    void testTrustAsyncRoundTrip();
+    void testInteractiveLanePreemptsBackground();
+    void testStopCancelsQueuedTasks();
+
+private:
+    QTemporaryDir* m_tempDir;
+
+    ManifestManager::ManifestEntry makeEntry(const QString& title);
+};
+
+void TestLocalDBExecutor::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    QVERIFY(dbManager.initializeConnection(m_tempDir->filePath("test_executor.sqlite")));
+}
+
+void TestLocalDBExecutor::cleanupTestCase()
+{
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    if (dbManager.isOpen()) {
+        dbManager.closeConnection();
+    }
+    QVERIFY(!dbManager.executor().isRunning());
+    delete m_tempDir;
+}
+
+ManifestManager::ManifestEntry TestLocalDBExecutor::makeEntry(const QString& title)
+{
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    entry.cartridgeHash = QByteArray(32, 'h');
+    entry.localPath = "/library/" + title + ".sqlite";
+    entry.title = title;
+    entry.author = "Test Author";
+    entry.publicationYear = "2025";
+    return entry;
+}
+
+void TestLocalDBExecutor::testTasksRunOffCallerThread()
+{
+    LocalDBExecutor& executor = LocalDBManager::getInstance().executor();
+    QVERIFY(executor.isRunning());
+
+    QFuture<QThread*> worker = executor.submit([](QSqlDatabase& database) {
+        Q_UNUSED(database);
+        return QThread::currentThread();
+    });
+    QVERIFY(worker.result() != QThread::currentThread());
+
+    QFuture<bool> open = executor.submit([](QSqlDatabase& database) {
+        return database.isOpen() && database.connectionName() != "LocalReaderDB";
+    });
+    QVERIFY(open.result());
+}
+
+void TestLocalDBExecutor::testManifestAsyncRoundTrip()
+{
+    ManifestManager manager(this);
+    ManifestManager::ManifestEntry entry = makeEntry("AsyncEntry");
+
+    QVERIFY(manager.createManifestEntryAsync(entry).result());
+    QVERIFY(manager.manifestEntryExistsAsync(entry.cartridgeGuid).result());
+
+    ManifestManager::ManifestEntry loaded = manager.getManifestEntryAsync(entry.cartridgeGuid).result();
+    QCOMPARE(loaded.title, entry.title);
+    QCOMPARE(loaded.cartridgeHash, entry.cartridgeHash);
+
+    // Writes from the executor connection are visible to the GUI-thread connection
+    QVERIFY(manager.manifestEntryExists(entry.cartridgeGuid));
+
+    QVERIFY(manager.deleteManifestEntryAsync(entry.cartridgeGuid).result());
+    QVERIFY(!manager.manifestEntryExists(entry.cartridgeGuid));
+}
+
+void TestLocalDBExecutor::testTrustAsyncRoundTrip()
+{
+    ManifestManager manager(this);
+    ManifestManager::ManifestEntry entry = makeEntry("TrustedEntry");
+    QVERIFY(manager.createManifestEntry(entry));
+
+    TrustRegistry registry(this);
+    QVERIFY(registry.storeTrustDecisionAsync(entry.cartridgeGuid, TrustRegistry::TrustPolicy::SESSION).result());
+    QVERIFY(registry.getTrustDecisionAsync(entry.cartridgeGuid).result() == TrustRegistry::TrustPolicy::SESSION);
+
+    QVERIFY(registry.revokeTrustAsync(entry.cartridgeGuid).result());
+    QVERIFY(!registry.hasPersistentTrustAsync(entry.cartridgeGuid).result());
+    QVERIFY(registry.getTrustDecision(entry.cartridgeGuid) == TrustRegistry::TrustPolicy::REVOKED);
+}
+
+void TestLocalDBExecutor::testInteractiveLanePreemptsBackground()
+{
+    LocalDBExecutor& executor = LocalDBManager::getInstance().executor();
+
+    QSemaphore started;
+    QSemaphore release;
+    QMutex orderMutex;
+    QStringList order;
+
+    // Hold the worker so the following tasks queue up
+    QFuture<void> blocker = executor.submit([&](QSqlDatabase&) {
+        started.release();
+        release.acquire();
+    }, LocalDBExecutor::Priority::Background);
+    started.acquire();
+
+    auto record = [&](const QString& name) {
+        return [&, name](QSqlDatabase&) {
+            QMutexLocker locker(&orderMutex);
+            order.append(name);
+        };
+    };
+
+    QFuture<void> write1 = executor.submit(record("write1"), LocalDBExecutor::Priority::Background);
+    QFuture<void> write2 = executor.submit(record("write2"), LocalDBExecutor::Priority::Background);
+    QFuture<void> read = executor.submit(record("read"), LocalDBExecutor::Priority::Interactive);
+
+    QVERIFY(executor.hasPendingInteractive());
+    QCOMPARE(executor.pendingCount(LocalDBExecutor::Priority::Background), 2);
+
+    release.release();
+    write2.waitForFinished();
+    read.waitForFinished();
+
+    QCOMPARE(order, QStringList({"read", "write1", "write2"}));
+}
+
+void TestLocalDBExecutor::testStopCancelsQueuedTasks()
+{
+    LocalDBExecutor executor;
+    QVERIFY(executor.start(LocalDBManager::getInstance().databasePath()));
+
+    QSemaphore started;
+    QSemaphore release;
+    QFuture<void> blocker = executor.submit([&](QSqlDatabase&) {
+        started.release();
+        release.acquire();
+    });
+    started.acquire();
+
+    QFuture<int> queued = executor.submit([](QSqlDatabase&) { return 42; });
+
+    // stop() waits for the running task, so let it finish from another thread
+    QThread* releaser = QThread::create([&]() {
+        QThread::msleep(50);
+        release.release();
+    });
+    releaser->start();
+    executor.stop();
+    releaser->wait();
+    delete releaser;
+
+    QVERIFY(blocker.isFinished());
+    QVERIFY(queued.isCanceled());
+    QVERIFY(!executor.isRunning());
+
+    // Submitting to a stopped executor yields a canceled future
+    QFuture<int> rejected = executor.submit([](QSqlDatabase&) { return 1; });
+    QVERIFY(rejected.isCanceled());
+}
+
+QTEST_MAIN(TestLocalDBExecutor)
+#include "test_localdbexecutor.moc"
@@ -17,6 +17,9 @@ private slots:
     void testInitializeConnection();
     void testSchemaCreation();
     void testQueryExecution();
+    void testSchemaVersion();
+    void testUpgradeUnversionedDatabase();
+    void testBlockingUpgradeDefersSearchRebuild();
 
 private:
     QTemporaryDir* m_tempDir;
@@ -85,5 +88,119 @@ void TestLocalDBManager::testQueryExecution()
     QCOMPARE(query.value(0).toInt(), 1);
 }
 
+void TestLocalDBManager::testSchemaVersion()
+{
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    
+    if (!dbManager.isOpen()) {
+        dbManager.initializeConnection(m_testDbPath);
+    }
+    
+    // A new database is migrated completely at startup
+    QCOMPARE(dbManager.schemaVersion(), LocalDBManager::latestSchemaVersion());
+    QSqlQuery query = dbManager.executeQuery(
+        "SELECT name FROM sqlite_master WHERE type='index' AND name='idx_manifest_title'"
+    );
+    QVERIFY(query.next());
+    
+    // Reopening a current database runs no migration
+    dbManager.closeConnection();
+    QVERIFY(dbManager.initializeConnection(m_testDbPath));
+    QCOMPARE(dbManager.schemaVersion(), LocalDBManager::latestSchemaVersion());
+}
+
+void TestLocalDBManager::testUpgradeUnversionedDatabase()
+{
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    dbManager.closeConnection();
+    
+    // Database created before schema versioning: tables exist, user_version 0
+    const QString legacyPath = m_tempDir->filePath("legacy_local_reader.sqlite");
+    {
+        QSqlDatabase legacy = QSqlDatabase::addDatabase("QSQLITE", "LegacyLocalDB");
+        legacy.setDatabaseName(legacyPath);
+        QVERIFY(legacy.open());
+        QSqlQuery setup(legacy);
+        QVERIFY(setup.exec("CREATE TABLE Local_Library_Manifest (manifest_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                           "cartridge_guid TEXT NOT NULL UNIQUE, cartridge_hash BLOB NOT NULL, "
+                           "local_path TEXT NOT NULL, title TEXT NOT NULL, author TEXT NOT NULL, "
+                           "publisher TEXT, version TEXT, publication_year TEXT NOT NULL, "
+                           "cover_image_data BLOB, last_opened INTEGER, location_status TEXT, "
+                           "series_name TEXT, edition_name TEXT, series_order INTEGER)"));
+        QVERIFY(setup.exec("CREATE INDEX idx_manifest_guid ON Local_Library_Manifest(cartridge_guid)"));
+        QVERIFY(setup.exec("INSERT INTO Local_Library_Manifest (cartridge_guid, cartridge_hash, local_path, "
+                           "title, author, publication_year) VALUES ('guid-1', x'00', '/tmp/a', 'A', 'B', '2024')"));
+        legacy.close();
+    }
+    QSqlDatabase::removeDatabase("LegacyLocalDB");
+    
+    QVERIFY(dbManager.initializeConnection(legacyPath));
+    QVERIFY(dbManager.schemaVersion() >= 1);
+    
+    // Index-only migrations finish on the executor's background lane,
+    // one task per migration
+    QTRY_COMPARE_WITH_TIMEOUT(dbManager.schemaVersion(), LocalDBManager::latestSchemaVersion(), 10000);
+    
+    QSqlQuery query = dbManager.executeQuery(
+        "SELECT name FROM sqlite_master WHERE type='index' AND name='idx_manifest_guid'"
+    );
+    QVERIFY(!query.next());
+    query = dbManager.executeQuery("SELECT title FROM Local_Library_Manifest WHERE cartridge_guid = 'guid-1'");
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toString(), QString("A"));
+    
+    dbManager.closeConnection();
+}
+
+void TestLocalDBManager::testBlockingUpgradeDefersSearchRebuild()
+{
+    // Library at version 4, before the search index
+    const QString path = m_tempDir->filePath("v4_local_reader.sqlite");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "V4LocalDB");
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        QSqlQuery setup(db);
+        QVERIFY(setup.exec("CREATE TABLE Local_Library_Manifest (manifest_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                           "cartridge_guid TEXT NOT NULL UNIQUE, cartridge_hash BLOB NOT NULL, "
+                           "local_path TEXT NOT NULL, title TEXT NOT NULL, author TEXT NOT NULL, "
+                           "publisher TEXT, version TEXT, publication_year TEXT NOT NULL, "
+                           "cover_image_data BLOB, last_opened INTEGER, location_status TEXT, "
+                           "series_name TEXT, edition_name TEXT, series_order INTEGER)"));
+        QVERIFY(setup.exec("CREATE TABLE Local_Cartridge_Groups (group_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                           "group_name TEXT NOT NULL, group_type TEXT NOT NULL, created_timestamp INTEGER NOT NULL, "
+                           "last_modified_timestamp INTEGER NOT NULL, description TEXT)"));
+        QVERIFY(setup.exec("CREATE TABLE Local_Cartridge_Group_Members (membership_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                           "group_id INTEGER NOT NULL, cartridge_guid TEXT NOT NULL, added_timestamp INTEGER NOT NULL, "
+                           "display_order INTEGER, UNIQUE(group_id, cartridge_guid))"));
+        QVERIFY(setup.exec("INSERT INTO Local_Library_Manifest (cartridge_guid, cartridge_hash, local_path, "
+                           "title, author, publication_year) VALUES ('guid-1', x'00', '/tmp/a', 'Astronomy', 'B', '2024')"));
+        QVERIFY(setup.exec("PRAGMA user_version=4"));
+        setup.finish();
+
+        // The startup pass applies the schema changes but leaves the
+        // search 'rebuild' and index builds for the background pass
+        const SchemaMigrator migrator = LocalDBManager::schemaMigrations();
+        QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::Blocking));
+        QCOMPARE(SchemaMigrator::currentVersion(db), 7);
+        QVERIFY(!migrator.isCurrent(db));
+
+        QSqlQuery query(db);
+        QVERIFY(query.exec("SELECT COUNT(*) FROM Local_Library_Search WHERE Local_Library_Search MATCH 'astro*'"));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), 0);
+        query.finish();
+
+        QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::All));
+        QCOMPARE(SchemaMigrator::currentVersion(db), LocalDBManager::latestSchemaVersion());
+        QVERIFY(query.exec("SELECT COUNT(*) FROM Local_Library_Search WHERE Local_Library_Search MATCH 'astro*'"));
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), 1);
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase("V4LocalDB");
+}
+
 QTEST_MAIN(TestLocalDBManager)
 #include "test_localdbmanager.moc"
@@ -0,0 +1,168 @@
+#include <QtTest>
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/security/TrustRegistry.h"
+#include <QTemporaryDir>
+#include <QThread>
+#include <QSemaphore>
+#include <QSqlQuery>
+#include <QUuid>
+#include <atomic>
+
+using namespace smartbook::common::database;
+using namespace smartbook::common::security;
+
+class TestLocalDBReaders : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testReadConnectionsArePerThread();
+    void testReadConnectionIsQueryOnly();
+    void testConcurrentReadersSeeSerializedWrites();
+    void testReinitializeRetiresReaders();
+
+private:
+    QTemporaryDir* m_tempDir;
+
+    bool insertManifestRow(const QString& guid);
+    int manifestCount(QSqlDatabase database);
+};
+
+void TestLocalDBReaders::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+    QVERIFY(LocalDBManager::getInstance().initializeConnection(m_tempDir->filePath("readers.sqlite")));
+}
+
+void TestLocalDBReaders::cleanupTestCase()
+{
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    if (dbManager.isOpen()) {
+        dbManager.closeConnection();
+    }
+    delete m_tempDir;
+}
+
+bool TestLocalDBReaders::insertManifestRow(const QString& guid)
+{
+    return LocalDBManager::getInstance().write([guid](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare(R"(
+            INSERT INTO Local_Library_Manifest
+            (cartridge_guid, cartridge_hash, local_path, title, author, publication_year)
+            VALUES (?, ?, ?, ?, ?, ?)
+        )");
+        query.addBindValue(guid);
+        query.addBindValue(QByteArray(32, 'r'));
+        query.addBindValue("/library/" + guid + ".sqlite");
+        query.addBindValue("Reader Test");
+        query.addBindValue("Test Author");
+        query.addBindValue("2025");
+        return query.exec();
+    });
+}
+
+int TestLocalDBReaders::manifestCount(QSqlDatabase database)
+{
+    QSqlQuery query(database);
+    if (!query.exec("SELECT COUNT(*) FROM Local_Library_Manifest") || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+void TestLocalDBReaders::testReadConnectionsArePerThread()
+{
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    const QString mainName = dbManager.readConnection().connectionName();
+    QVERIFY(!mainName.isEmpty());
+    QCOMPARE(dbManager.readConnection().connectionName(), mainName);
+    QVERIFY(mainName != dbManager.getDatabase().connectionName());
+
+    QString workerName;
+    QThread* worker = QThread::create([&]() {
+        workerName = LocalDBManager::getInstance().readConnection().connectionName();
+    });
+    worker->start();
+    worker->wait();
+    delete worker;
+
+    QVERIFY(!workerName.isEmpty());
+    QVERIFY(workerName != mainName);
+
+    // The worker's connection was closed when its thread exited
+    QVERIFY(!QSqlDatabase::contains(workerName));
+}
+
+void TestLocalDBReaders::testReadConnectionIsQueryOnly()
+{
+    QSqlQuery query(LocalDBManager::getInstance().readConnection());
+    QVERIFY(!query.exec("DELETE FROM Local_Library_Manifest"));
+}
+
+void TestLocalDBReaders::testConcurrentReadersSeeSerializedWrites()
+{
+    const int baseline = manifestCount(LocalDBManager::getInstance().readConnection());
+    QVERIFY(baseline >= 0);
+
+    QVERIFY(insertManifestRow(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+    QVERIFY(insertManifestRow(QUuid::createUuid().toString(QUuid::WithoutBraces)));
+
+    // Several threads read at once, each on its own connection
+    const int readerCount = 4;
+    QSemaphore ready;
+    QSemaphore go;
+    std::atomic<int> matching{0};
+    QList<QThread*> readers;
+
+    for (int i = 0; i < readerCount; ++i) {
+        QThread* reader = QThread::create([&]() {
+            QSqlDatabase database = LocalDBManager::getInstance().readConnection();
+            ready.release();
+            go.acquire();
+            if (manifestCount(database) == baseline + 2) {
+                matching++;
+            }
+        });
+        readers.append(reader);
+        reader->start();
+    }
+
+    ready.acquire(readerCount);
+    go.release(readerCount);
+
+    // Trust lookups read through the calling thread's connection as well
+    const QString trustedGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    QVERIFY(insertManifestRow(trustedGuid));
+    TrustRegistry registry;
+    QVERIFY(registry.storeTrustDecision(trustedGuid, TrustRegistry::TrustPolicy::REVOKED));
+    QVERIFY(registry.getTrustDecision(trustedGuid) == TrustRegistry::TrustPolicy::REVOKED);
+
+    for (QThread* reader : readers) {
+        reader->wait();
+        delete reader;
+    }
+
+    QCOMPARE(matching.load(), readerCount);
+}
+
+void TestLocalDBReaders::testReinitializeRetiresReaders()
+{
+    LocalDBManager& dbManager = LocalDBManager::getInstance();
+    const QString oldName = dbManager.readConnection().connectionName();
+
+    dbManager.closeConnection();
+    QVERIFY(!QSqlDatabase::contains(oldName));
+    QVERIFY(!dbManager.readConnection().isValid());
+
+    QVERIFY(dbManager.initializeConnection(m_tempDir->filePath("readers_second.sqlite")));
+    QSqlDatabase fresh = dbManager.readConnection();
+    QVERIFY(fresh.isOpen());
+    QCOMPARE(manifestCount(fresh), 0);
+}
+
+QTEST_MAIN(TestLocalDBReaders)
+#include "test_localdbreaders.moc"
@@ -0,0 +1,180 @@
+#include <QtTest>
+#include "smartbook/common/database/LocalDBManager.h"
+#include "smartbook/common/manifest/ManifestManager.h"
+#include "smartbook/common/manifest/ManifestChangeFeed.h"
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QUuid>
+
+using namespace smartbook::common::database;
+using namespace smartbook::common::manifest;
+
+class TestManifestChangeFeed : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testLogsCreateUpdateDelete();
+    void testPublishesEntryChanged();
+    void testLogsWritesOutsideManager();
+    void testPrunedLogReported();
+
+private:
+    ManifestManager::ManifestEntry makeEntry();
+    qint64 latestChangeId();
+    bool changesSince(qint64 changeId, QList<ManifestChangeFeed::Change>& changes);
+
+    QTemporaryDir* m_tempDir = nullptr;
+    LocalDBManager* m_dbManager = nullptr;
+};
+
+void TestManifestChangeFeed::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    m_dbManager = &LocalDBManager::getInstance();
+    QVERIFY(m_dbManager->initializeConnection(m_tempDir->filePath("changes.sqlite")));
+}
+
+void TestManifestChangeFeed::cleanupTestCase()
+{
+    if (m_dbManager && m_dbManager->isOpen()) {
+        m_dbManager->closeConnection();
+    }
+    delete m_tempDir;
+}
+
+ManifestManager::ManifestEntry TestManifestChangeFeed::makeEntry()
+{
+    ManifestManager::ManifestEntry entry;
+    entry.cartridgeGuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    entry.cartridgeHash = QByteArray("hash");
+    entry.localPath = "/path/to/cartridge.sqlite";
+    entry.title = "Logged Book";
+    entry.author = "Author";
+    entry.publicationYear = "2025";
+    return entry;
+}
+
+qint64 TestManifestChangeFeed::latestChangeId()
+{
+    QSqlDatabase database = m_dbManager->readConnection();
+    return ManifestChangeFeed::latestChangeId(database);
+}
+
+bool TestManifestChangeFeed::changesSince(qint64 changeId, QList<ManifestChangeFeed::Change>& changes)
+{
+    QSqlDatabase database = m_dbManager->readConnection();
+    return ManifestChangeFeed::changesSince(database, changeId, changes);
+}
+
+void TestManifestChangeFeed::testLogsCreateUpdateDelete()
+{
+    const qint64 start = latestChangeId();
+    QVERIFY(start >= 0);
+
+    ManifestManager manager(this);
+    ManifestManager::ManifestEntry entry = makeEntry();
+    QVERIFY(manager.createManifestEntry(entry));
+    entry.title = "Renamed Book";
+    QVERIFY(manager.updateManifestEntry(entry));
+    QVERIFY(manager.deleteManifestEntry(entry.cartridgeGuid));
+
+    QList<ManifestChangeFeed::Change> changes;
+    QVERIFY(changesSince(start, changes));
+    QCOMPARE(int(changes.size()), 3);
+    QCOMPARE(changes.at(0).type, ManifestChangeFeed::ChangeType::Created);
+    QCOMPARE(changes.at(1).type, ManifestChangeFeed::ChangeType::Updated);
+    QCOMPARE(changes.at(2).type, ManifestChangeFeed::ChangeType::Deleted);
+    for (const ManifestChangeFeed::Change& change : changes) {
+        QCOMPARE(change.cartridgeGuid, entry.cartridgeGuid);
+    }
+    QVERIFY(changes.at(0).changeId < changes.at(1).changeId);
+    QVERIFY(changes.at(1).changeId < changes.at(2).changeId);
+    QCOMPARE(latestChangeId(), changes.last().changeId);
+}
+
+void TestManifestChangeFeed::testPublishesEntryChanged()
+{
+    QSignalSpy published(&ManifestChangeFeed::getInstance(), &ManifestChangeFeed::entryChanged);
+
+    ManifestManager manager(this);
+    const ManifestManager::ManifestEntry entry = makeEntry();
+    QVERIFY(manager.createManifestEntry(entry));
+    QVERIFY(manager.deleteManifestEntry(entry.cartridgeGuid));
+
+    // Emitted on the writer thread before write() returns
+    QCOMPARE(published.count(), 2);
+    QCOMPARE(published.at(0).at(0).value<ManifestChangeFeed::ChangeType>(), ManifestChangeFeed::ChangeType::Created);
+    QCOMPARE(published.at(0).at(1).toString(), entry.cartridgeGuid);
+    QCOMPARE(published.at(1).at(0).value<ManifestChangeFeed::ChangeType>(), ManifestChangeFeed::ChangeType::Deleted);
+
+    // Failed writes publish nothing
+    QVERIFY(!manager.deleteManifestEntry(entry.cartridgeGuid));
+    QCOMPARE(published.count(), 2);
+}
+
+void TestManifestChangeFeed::testLogsWritesOutsideManager()
+{
+    ManifestManager manager(this);
+    const ManifestManager::ManifestEntry entry = makeEntry();
+    QVERIFY(manager.createManifestEntry(entry));
+    const qint64 start = latestChangeId();
+
+    QVERIFY(m_dbManager->write([&](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare("UPDATE Local_Library_Manifest SET last_opened = 1 WHERE cartridge_guid = ?");
+        query.addBindValue(entry.cartridgeGuid);
+        return query.exec();
+    }));
+
+    QList<ManifestChangeFeed::Change> changes;
+    QVERIFY(changesSince(start, changes));
+    QCOMPARE(int(changes.size()), 1);
+    QCOMPARE(changes.first().cartridgeGuid, entry.cartridgeGuid);
+    QCOMPARE(changes.first().type, ManifestChangeFeed::ChangeType::Updated);
+}
+
+void TestManifestChangeFeed::testPrunedLogReported()
+{
+    ManifestManager manager(this);
+    const ManifestManager::ManifestEntry entry = makeEntry();
+    QVERIFY(manager.createManifestEntry(entry));
+    const qint64 start = latestChangeId();
+
+    // More changes than the log keeps (pruning runs every LOG_RETENTION changes)
+    QVERIFY(m_dbManager->write([&](QSqlDatabase& database) {
+        if (!database.transaction()) {
+            return false;
+        }
+        QSqlQuery query(database);
+        query.prepare("UPDATE Local_Library_Manifest SET last_opened = ? WHERE cartridge_guid = ?");
+        for (int i = 0; i < 2 * ManifestChangeFeed::LOG_RETENTION + 10; ++i) {
+            query.bindValue(0, i);
+            query.bindValue(1, entry.cartridgeGuid);
+            if (!query.exec()) {
+                database.rollback();
+                return false;
+            }
+        }
+        return database.commit();
+    }));
+
+    QList<ManifestChangeFeed::Change> changes;
+    QVERIFY(!changesSince(start, changes));
+
+    // Consumers close to the head still get their changes
+    const qint64 latest = latestChangeId();
+    QVERIFY(changesSince(latest - 5, changes));
+    QCOMPARE(int(changes.size()), 5);
+
+    QSqlQuery count(m_dbManager->readConnection());
+    QVERIFY(count.exec("SELECT COUNT(*) FROM Local_Manifest_Changes") && count.next());
+    QVERIFY(count.value(0).toInt() < 2 * ManifestChangeFeed::LOG_RETENTION);
+}
+
+QTEST_MAIN(TestManifestChangeFeed)
+#include "test_manifestchangefeed.moc"
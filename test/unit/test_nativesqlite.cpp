@@ -0,0 +1,472 @@
+#include <QtTest>
+#include "smartbook/common/database/NativeSqlite.h"
+#include "smartbook/common/database/QueryStats.h"
+#include "smartbook/common/security/SignatureVerifier.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+
+using namespace smartbook::common::database;
+using smartbook::common::security::SignatureVerifier;
+
+class TestNativeSqlite : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testTypedColumns();
+    void testZeroCopyViews();
+    void testBindAndReset();
+    void testReadOnlyModes();
+    void testAttachToQtSql();
+    void testIncrementalBlob();
+    void testContentHashMatchesQtSql();
+    void testRecordsQueryStats();
+    void testQtSqlFallback();
+    void benchmarkPageScan_data();
+    void benchmarkPageScan();
+
+private:
+    QByteArray qtSqlContentHash(const QString& path);
+
+    QTemporaryDir* m_tempDir;
+    QString m_path;
+    QString m_connectionName = "NativeSqliteTest";
+};
+
+void TestNativeSqlite::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+    m_path = m_tempDir->filePath("native.sqlite");
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    database.setDatabaseName(m_path);
+    QVERIFY(database.open());
+
+    QSqlQuery setup(database);
+    QVERIFY(setup.exec("PRAGMA journal_mode=WAL"));
+    QVERIFY(setup.exec("CREATE TABLE Content_Pages (page_id INTEGER PRIMARY KEY, page_order INTEGER, "
+                       "chapter_title TEXT, html_content TEXT, associated_css TEXT, weight REAL)"));
+    QVERIFY(setup.exec("CREATE TABLE Resources (resource_id TEXT PRIMARY KEY, resource_data BLOB NOT NULL)"));
+    QVERIFY(setup.exec("CREATE TABLE Metadata (cartridge_guid TEXT, title TEXT, version TEXT, "
+                       "publication_year INTEGER, cover BLOB)"));
+
+    QVERIFY(database.transaction());
+    QSqlQuery insert(database);
+    QVERIFY(insert.prepare("INSERT INTO Content_Pages (page_order, chapter_title, html_content, associated_css, weight) "
+                           "VALUES (?, ?, ?, ?, ?)"));
+    const QString html = QString("<p>%1</p>").arg(QString(2000, QChar('x')));
+    for (int i = 1; i <= 2000; ++i) {
+        insert.addBindValue(i);
+        insert.addBindValue(QString("Chapitre %1 été").arg(i));
+        insert.addBindValue(html);
+        insert.addBindValue(i % 2 == 0 ? QVariant(QMetaType::fromType<QString>()) : QVariant("body{}"));
+        insert.addBindValue(i / 3.0);
+        QVERIFY(insert.exec());
+    }
+
+    QVERIFY(insert.prepare("INSERT INTO Resources (resource_id, resource_data) VALUES (?, ?)"));
+    QByteArray image(64 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<char>(i % 251);
+    }
+    insert.addBindValue("cover.png");
+    insert.addBindValue(image);
+    QVERIFY(insert.exec());
+    insert.addBindValue("small.bin");
+    insert.addBindValue(QByteArray("\x00\x01\x02\x03", 4));
+    QVERIFY(insert.exec());
+
+    QVERIFY(setup.exec("INSERT INTO Metadata VALUES ('guid-1', 'Café', '1.0', 2024, x'00ff10')"));
+    QVERIFY(database.commit());
+}
+
+void TestNativeSqlite::cleanupTestCase()
+{
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+    delete m_tempDir;
+}
+
+void TestNativeSqlite::testTypedColumns()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+
+    NativeStatement statement = connection.prepare(
+        "SELECT page_id, page_order, chapter_title, associated_css, weight FROM Content_Pages WHERE page_order = 2");
+    QVERIFY(statement.isValid());
+    QCOMPARE(statement.columnCount(), 5);
+    QCOMPARE(statement.columnName(2), QString("chapter_title"));
+    QCOMPARE(statement.columnIndex("WEIGHT"), 4);
+    QCOMPARE(statement.columnIndex("missing"), -1);
+
+    QVERIFY(statement.step());
+    QCOMPARE(statement.columnType(0), NativeStatement::ColumnType::Integer);
+    QCOMPARE(statement.columnInt(1), 2);
+    QCOMPARE(statement.columnInt64(1), qint64(2));
+    QCOMPARE(statement.columnType(2), NativeStatement::ColumnType::Text);
+    QCOMPARE(statement.columnString(2), QString("Chapitre 2 été"));
+    QVERIFY(statement.isNull(3));
+    QVERIFY(statement.columnString(3).isNull());
+    QCOMPARE(statement.columnType(4), NativeStatement::ColumnType::Float);
+    QCOMPARE(statement.columnDouble(4), 2 / 3.0);
+
+    QVERIFY(!statement.step());
+    QVERIFY(!statement.hasError());
+}
+
+void TestNativeSqlite::testZeroCopyViews()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+
+    NativeStatement statement = connection.prepare("SELECT title, cover FROM Metadata");
+    QVERIFY(statement.step());
+
+    const QUtf8StringView title = statement.columnText(0);
+    QCOMPARE(title.size(), qsizetype(5));  // "Caf" + 2-byte e-acute
+    QCOMPARE(title.toString(), QString("Café"));
+
+    const QByteArrayView cover = statement.columnBlob(1);
+    QCOMPARE(cover.size(), qsizetype(3));
+    QCOMPARE(cover.toByteArray(), QByteArray("\x00\xff\x10", 3));
+    QCOMPARE(statement.columnBytes(1), QByteArray("\x00\xff\x10", 3));
+}
+
+void TestNativeSqlite::testBindAndReset()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+
+    NativeStatement statement = connection.prepare(
+        "SELECT page_order FROM Content_Pages WHERE chapter_title = ? OR page_order = ?");
+    QVERIFY(statement.bindText(0, QString("Chapitre 7 été")));
+    QVERIFY(statement.bindInt64(1, 9));
+
+    QList<int> orders;
+    while (statement.step()) {
+        orders.append(statement.columnInt(0));
+    }
+    QCOMPARE(orders, QList<int>({7, 9}));
+
+    // Bindings survive reset(); only the changed one is rebound
+    QVERIFY(statement.reset());
+    QVERIFY(statement.bindNull(0));
+    orders.clear();
+    while (statement.step()) {
+        orders.append(statement.columnInt(0));
+    }
+    QCOMPARE(orders, QList<int>({9}));
+
+    NativeStatement invalid = connection.prepare("SELECT * FROM No_Such_Table");
+    QVERIFY(!invalid.isValid());
+    QVERIFY(!invalid.step());
+}
+
+void TestNativeSqlite::testReadOnlyModes()
+{
+    NativeConnection readOnly;
+    QVERIFY(readOnly.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QVERIFY(!readOnly.exec("INSERT INTO Resources VALUES ('x', x'00')"));
+
+    NativeConnection immutable;
+    QVERIFY(immutable.open(m_path, CartridgeOpenMode::Immutable, ConnectionRole::Reader));
+    NativeStatement count = immutable.prepare("SELECT COUNT(*) FROM Content_Pages");
+    QVERIFY(count.step());
+    QCOMPARE(count.columnInt(0), 2000);
+
+    NativeConnection missing;
+    QVERIFY(!missing.open(m_tempDir->filePath("missing.sqlite"), CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QVERIFY(!missing.isOpen());
+}
+
+void TestNativeSqlite::testAttachToQtSql()
+{
+    QSqlDatabase database = QSqlDatabase::database(m_connectionName, false);
+    QVERIFY(database.isOpen());
+    QVERIFY(database.transaction());
+    QSqlQuery insert(database);
+    QVERIFY(insert.exec("INSERT INTO Resources VALUES ('attached', x'0102')"));
+
+    // Same handle, so the open transaction is visible
+    NativeConnection attached;
+    QVERIFY(attached.attach(database));
+    QCOMPARE(attached.usesQtSql(), NativeConnection::qtSqlFallbackRequired());
+    QCOMPARE(attached.connectionName(), QString("native:") + m_connectionName);
+    NativeStatement statement = attached.prepare("SELECT length(resource_data) FROM Resources "
+                                                 "WHERE resource_id = 'attached'");
+    QVERIFY(statement.step());
+    QCOMPARE(statement.columnInt(0), 2);
+    statement = NativeStatement();
+
+    // Detaching leaves the QtSql connection open
+    attached.close();
+    QVERIFY(!attached.isOpen());
+    QVERIFY(database.rollback());
+    QSqlQuery check(database);
+    QVERIFY(check.exec("SELECT COUNT(*) FROM Resources WHERE resource_id = 'attached'"));
+    QVERIFY(check.next());
+    QCOMPARE(check.value(0).toInt(), 0);
+
+    NativeConnection closed;
+    QVERIFY(!closed.attach(QSqlDatabase()));
+}
+
+void TestNativeSqlite::testIncrementalBlob()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadWrite, ConnectionRole::Creator));
+
+    NativeStatement lookup = connection.prepare("SELECT rowid FROM Resources ORDER BY resource_id");
+    QVERIFY(lookup.step());
+    const qint64 coverRow = lookup.columnInt64(0);
+    QVERIFY(lookup.step());
+    const qint64 smallRow = lookup.columnInt64(0);
+    lookup.reset();
+
+    NativeBlob blob = connection.openBlob("Resources", "resource_data", coverRow);
+    QVERIFY(blob.isValid());
+    QCOMPARE(blob.size(), 64 * 1024);
+
+    const QByteArray all = blob.readAll();
+    QCOMPARE(all.size(), qsizetype(64 * 1024));
+    QCOMPARE(static_cast<uchar>(all.at(300)), uchar(300 % 251));
+
+    char chunk[4];
+    QVERIFY(blob.read(chunk, sizeof(chunk), 1000));
+    QCOMPARE(QByteArray(chunk, sizeof(chunk)), all.mid(1000, 4));
+    QVERIFY(!blob.read(chunk, sizeof(chunk), blob.size() - 2));  // Past the end
+
+    QVERIFY(blob.reopen(smallRow));
+    QCOMPARE(blob.readAll(), QByteArray("\x00\x01\x02\x03", 4));
+    blob.close();
+
+    if (connection.usesQtSql()) {
+        QSKIP("QSQLITE has its own SQLite library; BLOB writes need the sqlite3 path");
+    }
+
+    // In-place write, same size
+    NativeBlob writable = connection.openBlob("Resources", "resource_data", smallRow, true);
+    QVERIFY(writable.isValid());
+    QVERIFY(writable.write(QByteArray("\x09\x09", 2), 1));
+    QVERIFY(!writable.write(QByteArray("\x09\x09", 2), 3));  // Cannot grow
+    writable.close();
+
+    NativeStatement check = connection.prepare("SELECT resource_data FROM Resources WHERE rowid = ?");
+    QVERIFY(check.bindInt64(0, smallRow));
+    QVERIFY(check.step());
+    QCOMPARE(check.columnBytes(0), QByteArray("\x00\x09\x09\x03", 4));
+    check.reset();
+
+    // Restore for other tests
+    writable = connection.openBlob("Resources", "resource_data", smallRow, true);
+    QVERIFY(writable.write(QByteArray("\x01\x02", 2), 1));
+
+    NativeConnection readOnly;
+    QVERIFY(readOnly.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QVERIFY(!readOnly.openBlob("Resources", "resource_data", smallRow, true).isValid());
+    QVERIFY(!readOnly.openBlob("Resources", "resource_data", 9999).isValid());
+}
+
+QByteArray TestNativeSqlite::qtSqlContentHash(const QString& path)
+{
+    // The QVariant-based hash that earlier releases signed cartridges with
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "ReferenceHash");
+        database.setDatabaseName(path);
+        if (!database.open()) {
+            return QByteArray();
+        }
+
+        const QStringList tables = {"Content_Pages", "Content_Themes", "Embedded_Apps",
+                                    "Form_Definitions", "Metadata", "Settings"};
+        for (const QString& tableName : tables) {
+            QSqlQuery query(database);
+            if (!query.exec(QString("SELECT * FROM %1 ORDER BY rowid").arg(tableName))) {
+                continue;
+            }
+            while (query.next()) {
+                QByteArray rowData;
+                for (int i = 0; i < query.record().count(); ++i) {
+                    const QVariant value = query.value(i);
+                    if (value.isNull()) {
+                        rowData.append('\0');
+                    } else {
+                        rowData.append(value.toString().toUtf8());
+                    }
+                }
+                hash.addData(rowData);
+                hash.addData("\n");
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("ReferenceHash");
+    return hash.result();
+}
+
+void TestNativeSqlite::testContentHashMatchesQtSql()
+{
+    // Covers integer, real, text, NULL and blob values
+    SignatureVerifier verifier;
+    const QByteArray native = verifier.calculateContentHash(m_path);
+    QCOMPARE(native.size(), 32);
+    QCOMPARE(native, qtSqlContentHash(m_path));
+}
+
+void TestNativeSqlite::testRecordsQueryStats()
+{
+    QueryStats& stats = QueryStats::getInstance();
+    stats.setEnabled(true);
+    stats.reset();
+
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QCOMPARE(connection.connectionName(), QString("native:native.sqlite"));
+    {
+        NativeStatement statement = connection.prepare("SELECT resource_id FROM Resources");
+        while (statement.step()) {
+            statement.columnText(0);
+        }
+    }
+
+    const auto recorded = stats.statements();
+    QCOMPARE(recorded.size(), 1);
+    QCOMPARE(recorded.first().sql, QString("SELECT resource_id FROM Resources"));
+    QCOMPARE(recorded.first().calls, qint64(1));
+    QCOMPARE(recorded.first().rows, qint64(2));
+    QCOMPARE(recorded.first().bytes, qint64(QByteArray("cover.pngsmall.bin").size()));
+    stats.reset();
+}
+
+void TestNativeSqlite::testQtSqlFallback()
+{
+    // Forced fallback behaves like a plugin with its own SQLite library
+    qputenv("SMARTBOOK_NATIVE_SQLITE", "0");
+    QVERIFY(NativeConnection::qtSqlFallbackRequired());
+
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QVERIFY(connection.usesQtSql());
+    QVERIFY(!connection.exec("INSERT INTO Resources VALUES ('x', x'00')"));
+
+    NativeStatement statement = connection.prepare(
+        "SELECT page_id, page_order, chapter_title, associated_css, weight FROM Content_Pages "
+        "WHERE chapter_title = ? OR page_order = ? ORDER BY page_order");
+    QVERIFY(statement.isValid());
+    QCOMPARE(statement.columnCount(), 5);
+    QCOMPARE(statement.columnIndex("WEIGHT"), 4);
+    QVERIFY(statement.bindText(0, QString("Chapitre 2 été")));
+    QVERIFY(statement.bindInt64(1, 9));
+
+    QVERIFY(statement.step());
+    QCOMPARE(statement.columnType(0), NativeStatement::ColumnType::Integer);
+    QCOMPARE(statement.columnInt(1), 2);
+    QCOMPARE(statement.columnType(2), NativeStatement::ColumnType::Text);
+    QCOMPARE(statement.columnText(2).toString(), QString("Chapitre 2 été"));
+    QVERIFY(statement.isNull(3));
+    QVERIFY(statement.columnString(3).isNull());
+    QCOMPARE(statement.columnType(4), NativeStatement::ColumnType::Float);
+    QCOMPARE(statement.columnDouble(4), 2 / 3.0);
+    QVERIFY(statement.step());
+    QCOMPARE(statement.columnInt(1), 9);
+    QVERIFY(!statement.step());
+    QVERIFY(!statement.hasError());
+
+    // Rebinding runs the statement again
+    QVERIFY(statement.reset());
+    QVERIFY(statement.bindNull(0));
+    QVERIFY(statement.step());
+    QCOMPARE(statement.columnInt(1), 9);
+    QVERIFY(!statement.step());
+    statement = NativeStatement();
+
+    NativeStatement lookup = connection.prepare("SELECT rowid FROM Resources WHERE resource_id = 'small.bin'");
+    QVERIFY(lookup.step());
+    NativeBlob blob = connection.openBlob("Resources", "resource_data", lookup.columnInt64(0));
+    lookup = NativeStatement();
+    QVERIFY(blob.isValid());
+    QCOMPARE(blob.size(), 4);
+    char chunk[2];
+    QVERIFY(blob.read(chunk, sizeof(chunk), 2));
+    QCOMPARE(QByteArray(chunk, sizeof(chunk)), QByteArray("\x02\x03", 2));
+    QVERIFY(!blob.read(chunk, sizeof(chunk), 3));
+    QVERIFY(!connection.openBlob("Resources", "resource_data", 9999).isValid());
+    blob.close();
+
+    // Statements split where sqlite3_complete() says they end, not at every semicolon
+    NativeConnection writable;
+    QVERIFY(writable.open(m_tempDir->filePath("fallback.sqlite"), CartridgeOpenMode::ReadWrite,
+                          ConnectionRole::Creator));
+    QVERIFY(writable.usesQtSql());
+    QVERIFY(writable.exec("CREATE TABLE Log (entry TEXT); CREATE TABLE Items (name TEXT); "
+                          "CREATE TRIGGER items_log AFTER INSERT ON Items BEGIN "
+                          "INSERT INTO Log VALUES ('added;' || new.name); END;"));
+    QVERIFY(writable.exec("INSERT INTO Items VALUES ('one')"));
+    NativeStatement log = writable.prepare("SELECT entry FROM Log");
+    QVERIFY(log.step());
+    QCOMPARE(log.columnString(0), QString("added;one"));
+    log = NativeStatement();
+    writable.close();
+
+    // Same content hash as the sqlite3 path
+    SignatureVerifier verifier;
+    QCOMPARE(verifier.calculateContentHash(m_path), qtSqlContentHash(m_path));
+
+    connection.close();
+    qunsetenv("SMARTBOOK_NATIVE_SQLITE");
+}
+
+void TestNativeSqlite::benchmarkPageScan_data()
+{
+    QTest::addColumn<bool>("native");
+    QTest::newRow("qtsql") << false;
+    QTest::newRow("native") << true;
+}
+
+void TestNativeSqlite::benchmarkPageScan()
+{
+    // Same work as PageManager::refreshPageList: materialize every page
+    QFETCH(bool, native);
+    const QString sql = "SELECT page_id, page_order, chapter_title, html_content, associated_css "
+                        "FROM Content_Pages ORDER BY page_order";
+    QueryStats::getInstance().setEnabled(false);
+
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QSqlDatabase database = QSqlDatabase::database(m_connectionName, false);
+
+    qint64 total = 0;
+    QBENCHMARK {
+        total = 0;
+        if (native) {
+            NativeStatement statement = connection.prepare(sql);
+            while (statement.step()) {
+                total += statement.columnInt(1);
+                total += statement.columnString(3).size();
+                total += statement.columnString(4).size();
+            }
+        } else {
+            QSqlQuery query(database);
+            query.setForwardOnly(true);
+            QVERIFY(query.exec(sql));
+            while (query.next()) {
+                total += query.value(1).toInt();
+                total += query.value(3).toString().size();
+                total += query.value(4).toString().size();
+            }
+        }
+    }
+    QVERIFY(total > 0);
+    QueryStats::getInstance().setEnabled(true);
+}
+
+QTEST_MAIN(TestNativeSqlite)
+#include "test_nativesqlite.moc"
@@ -0,0 +1,243 @@
+#include <QtTest>
+#include "smartbook/reader/ui/NavigationModel.h"
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+using namespace smartbook::reader;
+
+class TestNavigationModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testGroupsOnly();
+    void testChildrenOnExpand();
+    void testTargets();
+    void testSingleGroupFlattened();
+    void testNoTable();
+
+private:
+    struct Item {
+        int navId;
+        QString group;
+        int groupOrder;
+        QString label;
+        int itemOrder;
+        QString targetType;
+        QString targetValue;
+        QVariant parentId;
+    };
+
+    QString createCartridge(const QString& name, const QList<Item>& items, bool withTable = true);
+
+    QTemporaryDir* m_tempDir;
+    QString m_path;
+    int m_connections = 0;
+};
+
+QString TestNavigationModel::createCartridge(const QString& name, const QList<Item>& items, bool withTable)
+{
+    const QString path = m_tempDir->filePath(name);
+    const QString connectionName = QString("NavigationModelTest%1").arg(++m_connections);
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(path);
+        if (!database.open()) {
+            return QString();
+        }
+
+        QSqlQuery query(database);
+        query.exec("CREATE TABLE Metadata (cartridge_guid TEXT PRIMARY KEY, title TEXT)");
+        if (withTable) {
+            query.exec(R"(
+                CREATE TABLE Navigation_Structure (
+                    nav_id INTEGER PRIMARY KEY AUTOINCREMENT,
+                    group_name TEXT NOT NULL,
+                    group_order INTEGER NOT NULL,
+                    item_label TEXT NOT NULL,
+                    item_order INTEGER NOT NULL,
+                    target_type TEXT NOT NULL,
+                    target_value TEXT NOT NULL,
+                    parent_item_id INTEGER,
+                    metadata_json TEXT
+                )
+            )");
+            query.prepare("INSERT INTO Navigation_Structure (nav_id, group_name, group_order, item_label, item_order, "
+                          "target_type, target_value, parent_item_id) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+            for (const Item& item : items) {
+                query.addBindValue(item.navId);
+                query.addBindValue(item.group);
+                query.addBindValue(item.groupOrder);
+                query.addBindValue(item.label);
+                query.addBindValue(item.itemOrder);
+                query.addBindValue(item.targetType);
+                query.addBindValue(item.targetValue);
+                query.addBindValue(item.parentId);
+                query.exec();
+            }
+        }
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return path;
+}
+
+void TestNavigationModel::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    // Inserted out of order: the model orders by group_order and item_order
+    const QVariant none;
+    m_path = createCartridge("toc.sqlite", {
+        {1, "Figures", 2, "Figure 1", 1, "page", "7", none},
+        {2, "Chapters", 1, "Part II", 2, "page", "20", none},
+        {3, "Chapters", 1, "Part I", 1, "page", "1", none},
+        {4, "Chapters", 1, "Section 2.2", 2, "page", "25", 2},
+        {5, "Chapters", 1, "Section 2.1", 1, "page", "21", 2},
+        {6, "Chapters", 1, "Section 2.1.1", 1, "chapter", "Details", 5},
+        {7, "Chapters", 1, "Index", 3, "url", "https://example.com", none},
+    });
+    QVERIFY(!m_path.isEmpty());
+}
+
+void TestNavigationModel::cleanupTestCase()
+{
+    delete m_tempDir;
+}
+
+void TestNavigationModel::testGroupsOnly()
+{
+    NavigationModel model;
+    QVERIFY(model.setCartridge(m_path));
+
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.columnCount(), 1);
+    QCOMPARE(model.index(0, 0).data().toString(), QString("Chapters"));
+    QCOMPARE(model.index(1, 0).data().toString(), QString("Figures"));
+
+    // Nothing below the groups is read until they are expanded
+    const QModelIndex chapters = model.index(0, 0);
+    QVERIFY(model.hasChildren(chapters));
+    QCOMPARE(model.rowCount(chapters), 0);
+    QVERIFY(model.canFetchMore(chapters));
+    QVERIFY(!model.parent(chapters).isValid());
+}
+
+void TestNavigationModel::testChildrenOnExpand()
+{
+    NavigationModel model;
+    QVERIFY(model.setCartridge(m_path));
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+
+    const QModelIndex chapters = model.index(0, 0);
+    model.fetchMore(chapters);
+    QCOMPARE(inserted.count(), 1);
+    QVERIFY(!model.canFetchMore(chapters));
+    QCOMPARE(model.rowCount(chapters), 3);
+    QCOMPARE(model.index(0, 0, chapters).data().toString(), QString("Part I"));
+    QCOMPARE(model.index(1, 0, chapters).data().toString(), QString("Part II"));
+    QCOMPARE(model.index(2, 0, chapters).data().toString(), QString("Index"));
+
+    // Expanders are known before fetching
+    const QModelIndex partOne = model.index(0, 0, chapters);
+    const QModelIndex partTwo = model.index(1, 0, chapters);
+    QVERIFY(!model.hasChildren(partOne));
+    QVERIFY(!model.canFetchMore(partOne));
+    QVERIFY(model.hasChildren(partTwo));
+    QVERIFY(model.canFetchMore(partTwo));
+    QCOMPARE(model.parent(partTwo), chapters);
+
+    model.fetchMore(partTwo);
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(model.rowCount(partTwo), 2);
+    const QModelIndex section = model.index(0, 0, partTwo);
+    QCOMPARE(section.data().toString(), QString("Section 2.1"));
+    QCOMPARE(model.parent(section), partTwo);
+
+    model.fetchMore(section);
+    QCOMPARE(model.rowCount(section), 1);
+    QCOMPARE(model.index(0, 0, section).data().toString(), QString("Section 2.1.1"));
+
+    // A second fetch adds nothing
+    model.fetchMore(partTwo);
+    QCOMPARE(model.rowCount(partTwo), 2);
+}
+
+void TestNavigationModel::testTargets()
+{
+    NavigationModel model;
+    QVERIFY(model.setCartridge(m_path));
+    const QModelIndex chapters = model.index(0, 0);
+    QCOMPARE(chapters.data(NavigationModel::PageIdRole).toInt(), -1);
+    QVERIFY(!chapters.data(NavigationModel::TargetTypeRole).isValid());
+
+    model.fetchMore(chapters);
+    const QModelIndex partTwo = model.index(1, 0, chapters);
+    QCOMPARE(partTwo.data(NavigationModel::PageIdRole).toInt(), 20);
+    QCOMPARE(partTwo.data(NavigationModel::TargetTypeRole).toString(), QString("page"));
+    QCOMPARE(partTwo.data(NavigationModel::TargetValueRole).toString(), QString("20"));
+
+    const QModelIndex index = model.index(2, 0, chapters);
+    QCOMPARE(index.data(NavigationModel::PageIdRole).toInt(), -1);
+    QCOMPARE(index.data(NavigationModel::TargetTypeRole).toString(), QString("url"));
+
+    model.fetchMore(partTwo);
+    const QModelIndex section = model.index(0, 0, partTwo);
+    model.fetchMore(section);
+    const QModelIndex details = model.index(0, 0, section);
+    QCOMPARE(details.data(NavigationModel::PageIdRole).toInt(), -1);
+    QCOMPARE(details.data(NavigationModel::TargetTypeRole).toString(), QString("chapter"));
+    QCOMPARE(details.data(NavigationModel::TargetValueRole).toString(), QString("Details"));
+}
+
+void TestNavigationModel::testSingleGroupFlattened()
+{
+    const QVariant none;
+    const QString path = createCartridge("single.sqlite", {
+        {1, "Contents", 1, "Introduction", 1, "page", "1", none},
+        {2, "Contents", 1, "Body", 2, "page", "2", none},
+        {3, "Contents", 1, "Body, part 2", 1, "page", "3", 2},
+    });
+
+    NavigationModel model;
+    QVERIFY(model.setCartridge(path));
+    QCOMPARE(model.rowCount(), 2);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    QCOMPARE(model.index(0, 0).data().toString(), QString("Introduction"));
+    QCOMPARE(model.index(0, 0).data(NavigationModel::PageIdRole).toInt(), 1);
+
+    const QModelIndex body = model.index(1, 0);
+    QVERIFY(model.hasChildren(body));
+    model.fetchMore(body);
+    QCOMPARE(model.rowCount(body), 1);
+    QVERIFY(!model.parent(body).isValid());
+
+    // Switching cartridges resets
+    QSignalSpy reset(&model, &QAbstractItemModel::modelReset);
+    QVERIFY(model.setCartridge(m_path));
+    QCOMPARE(reset.count(), 1);
+    QCOMPARE(model.rowCount(), 2);
+    QVERIFY(model.setCartridge(QString()));
+    QCOMPARE(model.rowCount(), 0);
+}
+
+void TestNavigationModel::testNoTable()
+{
+    const QString path = createCartridge("old.sqlite", {}, false);
+    NavigationModel model;
+    QVERIFY(model.setCartridge(path));
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(!model.hasChildren());
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+
+    QVERIFY(!model.setCartridge(m_tempDir->filePath("missing.sqlite")));
+    QCOMPARE(model.rowCount(), 0);
+}
+
+QTEST_MAIN(TestNavigationModel)
+#include "test_navigationmodel.moc"
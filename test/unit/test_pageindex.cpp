@@ -0,0 +1,199 @@
+#include <QtTest>
+#include "smartbook/common/database/PageIndex.h"
+#include "smartbook/common/database/NativeSqlite.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+using namespace smartbook::common::database;
+
+class TestPageIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testReadingOrder();
+    void testNeighbours();
+    void testPercent();
+    void testChapters();
+    void testEmptyAndMissing();
+    void benchmarkLoad();
+
+private:
+    QString createCartridge(const QString& name, int pages);
+
+    QTemporaryDir* m_tempDir;
+    QString m_path;
+    int m_connections = 0;
+};
+
+QString TestPageIndex::createCartridge(const QString& name, int pages)
+{
+    const QString path = m_tempDir->filePath(name);
+    const QString connectionName = QString("PageIndexTest%1").arg(++m_connections);
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        database.setDatabaseName(path);
+        if (!database.open()) {
+            return QString();
+        }
+
+        QSqlQuery query(database);
+        query.exec("CREATE TABLE Content_Pages (page_id INTEGER PRIMARY KEY, page_order INTEGER NOT NULL UNIQUE, "
+                   "chapter_title TEXT, html_content TEXT NOT NULL, associated_css TEXT)");
+
+        // page_id runs against page_order; ten pages per chapter, none for the last ones
+        database.transaction();
+        query.prepare("INSERT INTO Content_Pages (page_id, page_order, chapter_title, html_content) "
+                      "VALUES (?, ?, ?, ?)");
+        for (int i = 0; i < pages; ++i) {
+            query.addBindValue(pages - i);
+            query.addBindValue(i * 2);
+            query.addBindValue(i >= pages - 5 ? QVariant(QMetaType::fromType<QString>())
+                                              : QVariant(QString("Chapter %1").arg(i / 10 + 1)));
+            query.addBindValue(QString("<p>%1</p>").arg(i));
+            query.exec();
+        }
+        database.commit();
+        database.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return path;
+}
+
+void TestPageIndex::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+    m_path = createCartridge("pages.sqlite", 100);
+    QVERIFY(!m_path.isEmpty());
+}
+
+void TestPageIndex::cleanupTestCase()
+{
+    delete m_tempDir;
+}
+
+void TestPageIndex::testReadingOrder()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+
+    PageIndex index;
+    QVERIFY(index.load(connection));
+    QCOMPARE(index.size(), 100);
+    QCOMPARE(index.firstPage(), 100);
+    QCOMPARE(index.lastPage(), 1);
+    QCOMPARE(index.pageAt(1), 99);
+    QCOMPARE(index.pageAt(100), -1);
+    QCOMPARE(index.pageAt(-1), -1);
+    QCOMPARE(index.positionOf(100), 0);
+    QCOMPARE(index.positionOf(1), 99);
+    QCOMPARE(index.positionOf(101), -1);
+    QVERIFY(index.contains(50));
+    QVERIFY(!index.contains(0));
+}
+
+void TestPageIndex::testNeighbours()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    PageIndex index;
+    QVERIFY(index.load(connection));
+
+    QCOMPARE(index.neighbour(50, 1), 49);
+    QCOMPARE(index.neighbour(50, -1), 51);
+    QCOMPARE(index.neighbour(50, 10), 40);
+    QCOMPARE(index.neighbour(1, 1), -1);
+    QCOMPARE(index.neighbour(100, -1), -1);
+    QCOMPARE(index.neighbour(500, 1), -1);
+}
+
+void TestPageIndex::testPercent()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    PageIndex index;
+    QVERIFY(index.load(connection));
+
+    QCOMPARE(index.pageAtPercent(0), 100);
+    QCOMPARE(index.pageAtPercent(100), 1);
+    QCOMPARE(index.pageAtPercent(-20), 100);
+    QCOMPARE(index.pageAtPercent(250), 1);
+    QCOMPARE(index.pageAtPercent(50), index.pageAt(50));    // round(0.5 * 99)
+
+    QCOMPARE(index.percentOf(100), 0.0);
+    QCOMPARE(index.percentOf(1), 100.0);
+    QCOMPARE(index.percentOf(0), -1.0);
+    QCOMPARE(index.pageAtPercent(index.percentOf(37)), 37);
+}
+
+void TestPageIndex::testChapters()
+{
+    NativeConnection connection;
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    PageIndex index;
+    QVERIFY(index.load(connection));
+
+    QCOMPARE(index.chapterTitle(100), QString("Chapter 1"));
+    QCOMPARE(index.chapterTitle(91), QString("Chapter 1"));
+    QCOMPARE(index.chapterTitle(90), QString("Chapter 2"));
+    QVERIFY(index.chapterTitle(1).isEmpty());
+    QVERIFY(index.chapterTitle(0).isEmpty());
+
+    QCOMPARE(index.firstPageOfChapter("Chapter 3"), 80);
+    QCOMPARE(index.firstPageOfChapter("Appendix"), -1);
+}
+
+void TestPageIndex::testEmptyAndMissing()
+{
+    const QString empty = createCartridge("empty.sqlite", 0);
+    NativeConnection connection;
+    QVERIFY(connection.open(empty, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    PageIndex index;
+    QVERIFY(index.load(connection));
+    QVERIFY(index.isEmpty());
+    QCOMPARE(index.firstPage(), -1);
+    QCOMPARE(index.lastPage(), -1);
+    QCOMPARE(index.pageAtPercent(50), -1);
+    connection.close();
+
+    // No Content_Pages table
+    const QString other = m_tempDir->filePath("other.sqlite");
+    {
+        QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "PageIndexOther");
+        database.setDatabaseName(other);
+        QVERIFY(database.open());
+        QVERIFY(QSqlQuery(database).exec("CREATE TABLE Metadata (title TEXT)"));
+        database.close();
+    }
+    QSqlDatabase::removeDatabase("PageIndexOther");
+
+    QVERIFY(connection.open(m_path, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QVERIFY(index.load(connection));
+    QVERIFY(!index.isEmpty());
+    connection.close();
+
+    QVERIFY(connection.open(other, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+    QVERIFY(!index.load(connection));
+    QVERIFY(index.isEmpty());
+    QVERIFY(!index.contains(50));
+}
+
+void TestPageIndex::benchmarkLoad()
+{
+    const QString large = createCartridge("large.sqlite", 10000);
+    NativeConnection connection;
+    QVERIFY(connection.open(large, CartridgeOpenMode::ReadOnly, ConnectionRole::Reader));
+
+    PageIndex index;
+    QBENCHMARK {
+        index.load(connection);
+    }
+    QCOMPARE(index.size(), 10000);
+}
+
+QTEST_MAIN(TestPageIndex)
+#include "test_pageindex.moc"
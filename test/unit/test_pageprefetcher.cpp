@@ -0,0 +1,187 @@
+#include <QtTest>
+#include "smartbook/common/database/PagePrefetcher.h"
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+using namespace smartbook::common::database;
+
+class TestPagePrefetcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void testReferencedResources();
+    void testPrefetchAround();
+    void testMemoryBudget();
+    void testJumpCancels();
+    void testSetCartridgeClears();
+
+private:
+    QString pageHtml(int pageId) const;
+
+    QTemporaryDir* m_tempDir;
+    QString m_path;
+    QString m_connectionName = "PagePrefetcherTest";
+};
+
+QString TestPagePrefetcher::pageHtml(int pageId) const
+{
+    return QString("<p id=\"%1\">%2</p><img src=\"../resource/image%1\">").arg(pageId).arg(QString(1000, QChar('x')));
+}
+
+void TestPagePrefetcher::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+    m_path = m_tempDir->filePath("prefetch.sqlite");
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    database.setDatabaseName(m_path);
+    QVERIFY(database.open());
+
+    QSqlQuery setup(database);
+    QVERIFY(setup.exec("CREATE TABLE Content_Pages (page_id INTEGER PRIMARY KEY, page_order INTEGER NOT NULL UNIQUE, "
+                       "chapter_title TEXT, html_content TEXT NOT NULL, associated_css TEXT)"));
+    QVERIFY(setup.exec("CREATE TABLE Resources (resource_id TEXT PRIMARY KEY, resource_path TEXT NOT NULL, "
+                       "resource_type TEXT NOT NULL, resource_data BLOB NOT NULL, mime_type TEXT NOT NULL)"));
+
+    // page_order runs against page_id, so neighbours come from page_order
+    QSqlQuery insert(database);
+    QVERIFY(insert.prepare("INSERT INTO Content_Pages (page_id, page_order, chapter_title, html_content) "
+                           "VALUES (?, ?, ?, ?)"));
+    for (int pageId = 1; pageId <= 10; ++pageId) {
+        insert.addBindValue(pageId);
+        insert.addBindValue(100 - pageId * 10);
+        insert.addBindValue(QString("Chapter %1").arg(pageId));
+        insert.addBindValue(pageHtml(pageId));
+        QVERIFY(insert.exec());
+    }
+
+    QVERIFY(insert.prepare("INSERT INTO Resources (resource_id, resource_path, resource_type, resource_data, mime_type) "
+                           "VALUES (?, ?, ?, ?, ?)"));
+    for (int pageId = 1; pageId <= 10; ++pageId) {
+        insert.addBindValue(QString("image%1").arg(pageId));
+        insert.addBindValue(QString("images/%1.png").arg(pageId));
+        insert.addBindValue("image");
+        insert.addBindValue(QByteArray(200 * 1024, char(pageId)));
+        insert.addBindValue("image/png");
+        QVERIFY(insert.exec());
+    }
+
+    database.close();
+}
+
+void TestPagePrefetcher::cleanupTestCase()
+{
+    QSqlDatabase::removeDatabase(m_connectionName);
+    delete m_tempDir;
+}
+
+void TestPagePrefetcher::testReferencedResources()
+{
+    const QString html = R"(
+        <img src="../resource/cover.png">
+        <video poster='smartbook://resource/clip'></video>
+        <img src="smartbook://0f3a/resource/media/a%20b.png">
+        <a href="https://example.com/resource/x">web</a>
+        <a href="#top">top</a>
+        <img src="image.png">
+        <div style="background: url('../resource/bg.png')"></div>
+        <img src="../resource/cover.png">
+    )";
+    const QString css = "@font-face { src: url(../resource/font.woff); }";
+
+    const QStringList expected = {"cover.png", "clip", "media/a b.png", "bg.png", "font.woff"};
+    QCOMPARE(PagePrefetcher::referencedResources(html, css), expected);
+    QVERIFY(PagePrefetcher::referencedResources("<p>No references</p>").isEmpty());
+}
+
+void TestPagePrefetcher::testPrefetchAround()
+{
+    // Page 5 has page_order 50: page 4 follows it, page 6 precedes it
+    PagePrefetcher prefetcher;
+    prefetcher.setCartridge(m_path);
+    QSignalSpy ready(&prefetcher, &PagePrefetcher::pageReady);
+
+    prefetcher.prefetchAround(5);
+    QTRY_COMPARE(ready.count(), 3);
+
+    QVERIFY(prefetcher.contains(4));
+    QVERIFY(prefetcher.contains(3));
+    QVERIFY(prefetcher.contains(6));
+    QVERIFY(!prefetcher.contains(2));
+    QVERIFY(!prefetcher.contains(7));
+    QVERIFY(!prefetcher.contains(5));
+
+    const PagePrefetcher::Page next = prefetcher.page(4);
+    QCOMPARE(next.pageId, 4);
+    QCOMPARE(next.pageOrder, 60);
+    QCOMPARE(next.htmlContent, pageHtml(4).toUtf8());
+    QVERIFY(next.associatedCss.isEmpty());
+    QCOMPARE(next.resources, QStringList{"image4"});
+    QCOMPARE(prefetcher.page(7).pageId, -1);
+}
+
+void TestPagePrefetcher::testMemoryBudget()
+{
+    // Room for two pages: the one behind goes before the ones ahead
+    const qint64 cost = pageHtml(1).toUtf8().size();
+    PagePrefetcher prefetcher;
+    prefetcher.setCartridge(m_path);
+    prefetcher.setMemoryBudget(2 * cost + cost / 2);
+    QSignalSpy ready(&prefetcher, &PagePrefetcher::pageReady);
+
+    prefetcher.prefetchAround(5);
+    QTRY_VERIFY(prefetcher.contains(4));
+    QTRY_VERIFY(prefetcher.contains(3));
+    QVERIFY(!prefetcher.contains(6));
+
+    prefetcher.setMemoryBudget(0);
+    QVERIFY(!prefetcher.contains(4));
+    prefetcher.prefetchAround(5);
+    QTest::qWait(100);
+    QVERIFY(!prefetcher.contains(4));
+}
+
+void TestPagePrefetcher::testJumpCancels()
+{
+    PagePrefetcher prefetcher;
+    prefetcher.setCartridge(m_path);
+    prefetcher.setDepth(1, 1);
+
+    // The first request is cancelled before its result can be collected
+    prefetcher.prefetchAround(9);
+    prefetcher.prefetchAround(2);
+    QTRY_VERIFY(prefetcher.contains(1));
+    QTRY_VERIFY(prefetcher.contains(3));
+
+    QTest::qWait(100);
+    QVERIFY(!prefetcher.contains(8));
+    QVERIFY(!prefetcher.contains(10));
+}
+
+void TestPagePrefetcher::testSetCartridgeClears()
+{
+    PagePrefetcher prefetcher;
+    prefetcher.setCartridge(m_path);
+    prefetcher.prefetchAround(5);
+    QTRY_VERIFY(prefetcher.contains(4));
+
+    prefetcher.setCartridge(QString());
+    QVERIFY(!prefetcher.contains(4));
+    prefetcher.prefetchAround(5);
+    QTest::qWait(100);
+    QVERIFY(!prefetcher.contains(4));
+
+    prefetcher.setCartridge(m_tempDir->filePath("missing.sqlite"));
+    prefetcher.prefetchAround(5);
+    QTest::qWait(100);
+    QVERIFY(!prefetcher.contains(4));
+}
+
+QTEST_MAIN(TestPagePrefetcher)
+#include "test_pageprefetcher.moc"
@@ -0,0 +1,216 @@
+#include <QtTest>
+#include "smartbook/common/database/QueryStats.h"
+#include "smartbook/common/database/InstrumentedQuery.h"
+#include <QSqlDatabase>
+#include <QTemporaryDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QFile>
+
+using namespace smartbook::common::database;
+
+class TestQueryInstrumentation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void testNormalize();
+    void testRecordsRowsAndBytes();
+    void testWritesRecordedOnExec();
+    void testPercentiles();
+    void testSlowQueryCapturesPlan();
+    void testJsonDump();
+    void testDisabled();
+
+private:
+    const QueryStats::StatementStats* find(const QList<QueryStats::StatementStats>& stats, const QString& sql);
+
+    QTemporaryDir* m_tempDir;
+    QString m_connectionName = "QueryInstrumentationTest";
+};
+
+void TestQueryInstrumentation::initTestCase()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    database.setDatabaseName(":memory:");
+    QVERIFY(database.open());
+
+    QSqlQuery setup(database);
+    QVERIFY(setup.exec("CREATE TABLE Pages (page_id INTEGER PRIMARY KEY, page_order INTEGER, html TEXT)"));
+    QVERIFY(setup.exec("CREATE INDEX idx_pages_order ON Pages(page_order)"));
+    QVERIFY(setup.exec("INSERT INTO Pages (page_order, html) VALUES (1, 'one'), (2, 'two'), (3, 'three')"));
+}
+
+void TestQueryInstrumentation::cleanupTestCase()
+{
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+    QueryStats::getInstance().setSlowQueryThresholdMs(25);
+    delete m_tempDir;
+}
+
+void TestQueryInstrumentation::init()
+{
+    QueryStats& stats = QueryStats::getInstance();
+    stats.setEnabled(true);
+    stats.setSlowQueryThresholdMs(10000);
+    stats.reset();
+}
+
+const QueryStats::StatementStats* TestQueryInstrumentation::find(
+    const QList<QueryStats::StatementStats>& stats, const QString& sql)
+{
+    for (const QueryStats::StatementStats& entry : stats) {
+        if (entry.sql == sql) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void TestQueryInstrumentation::testNormalize()
+{
+    QCOMPARE(QueryStats::normalize("SELECT *\n  FROM Pages   WHERE page_id = 42"),
+             QString("SELECT * FROM Pages WHERE page_id = ?"));
+    QCOMPARE(QueryStats::normalize("SELECT 1 FROM t WHERE name = 'it''s' AND x = 1.5"),
+             QString("SELECT ? FROM t WHERE name = ? AND x = ?"));
+    QCOMPARE(QueryStats::normalize("DELETE FROM t WHERE id IN (?, ?, ?)"),
+             QString("DELETE FROM t WHERE id IN (?)"));
+    // Digits inside identifiers are kept
+    QCOMPARE(QueryStats::normalize("SELECT col_2 FROM table3"),
+             QString("SELECT col_2 FROM table3"));
+}
+
+void TestQueryInstrumentation::testRecordsRowsAndBytes()
+{
+    for (int i = 1; i <= 2; ++i) {
+        InstrumentedQuery query(QSqlDatabase::database(m_connectionName));
+        QVERIFY(query.exec(QString("SELECT html FROM Pages WHERE page_order >= %1 ORDER BY page_order").arg(i)));
+        while (query.next()) {
+            QVERIFY(!query.value(0).toString().isEmpty());
+        }
+    }
+
+    const auto stats = QueryStats::getInstance().statements();
+    const QueryStats::StatementStats* entry =
+        find(stats, "SELECT html FROM Pages WHERE page_order >= ? ORDER BY page_order");
+    QVERIFY(entry != nullptr);
+    QCOMPARE(entry->calls, qint64(2));
+    QCOMPARE(entry->rows, qint64(5));  // 3 rows, then 2 rows
+    QVERIFY(entry->bytes > 0);
+    QVERIFY(entry->totalNs > 0);
+    QVERIFY(entry->p50Ns <= entry->maxNs);
+}
+
+void TestQueryInstrumentation::testWritesRecordedOnExec()
+{
+    InstrumentedQuery query(QSqlDatabase::database(m_connectionName));
+    QVERIFY(query.prepare("UPDATE Pages SET html = ? WHERE page_id = ?"));
+    query.addBindValue("updated");
+    query.addBindValue(1);
+    QVERIFY(query.exec());
+
+    // Recorded immediately, without waiting for the query to be destroyed
+    const auto stats = QueryStats::getInstance().statements();
+    const QueryStats::StatementStats* entry = find(stats, "UPDATE Pages SET html = ? WHERE page_id = ?");
+    QVERIFY(entry != nullptr);
+    QCOMPARE(entry->calls, qint64(1));
+    QCOMPARE(entry->rows, qint64(0));
+}
+
+void TestQueryInstrumentation::testPercentiles()
+{
+    QueryStats& queryStats = QueryStats::getInstance();
+    for (int ms = 1; ms <= 100; ++ms) {
+        queryStats.record("SELECT synthetic", m_connectionName, qint64(ms) * 1000000, 1, 0);
+    }
+
+    const auto stats = queryStats.statements();
+    const QueryStats::StatementStats* entry = find(stats, "SELECT synthetic");
+    QVERIFY(entry != nullptr);
+    QCOMPARE(entry->calls, qint64(100));
+    QCOMPARE(entry->maxNs, qint64(100) * 1000000);
+
+    // Histogram buckets are at most ~19% wide
+    QVERIFY(entry->p50Ns >= qint64(50) * 1000000);
+    QVERIFY(entry->p50Ns <= qint64(60) * 1000000);
+    QVERIFY(entry->p95Ns >= qint64(95) * 1000000);
+    QVERIFY(entry->p99Ns >= entry->p95Ns);
+    QVERIFY(entry->p99Ns <= entry->maxNs);
+}
+
+void TestQueryInstrumentation::testSlowQueryCapturesPlan()
+{
+    QueryStats& queryStats = QueryStats::getInstance();
+    queryStats.setSlowQueryThresholdMs(0);
+
+    {
+        InstrumentedQuery query(QSqlDatabase::database(m_connectionName));
+        QVERIFY(query.prepare("SELECT page_id FROM Pages WHERE page_order = ?"));
+        query.addBindValue(2);
+        QVERIFY(query.exec());
+        QVERIFY(query.next());
+        QVERIFY(!query.next());
+    }
+
+    const QList<QueryStats::SlowQuery> slow = queryStats.slowQueries();
+    QCOMPARE(slow.size(), 1);
+    QCOMPARE(slow.first().sql, QString("SELECT page_id FROM Pages WHERE page_order = ?"));
+    QCOMPARE(slow.first().connectionName, m_connectionName);
+    QVERIFY(!slow.first().plan.isEmpty());
+    QVERIFY(slow.first().plan.join('\n').contains("idx_pages_order"));
+
+    const auto stats = queryStats.statements();
+    const QueryStats::StatementStats* entry = find(stats, "SELECT page_id FROM Pages WHERE page_order = ?");
+    QVERIFY(entry != nullptr);
+    QCOMPARE(entry->plan, slow.first().plan);
+}
+
+void TestQueryInstrumentation::testJsonDump()
+{
+    {
+        InstrumentedQuery query(QSqlDatabase::database(m_connectionName));
+        QVERIFY(query.exec("SELECT COUNT(*) FROM Pages"));
+        QVERIFY(query.next());
+    }
+
+    const QString path = m_tempDir->filePath("stats.json");
+    QVERIFY(QueryStats::getInstance().dumpJson(path));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonArray statements = root["statements"].toArray();
+    QCOMPARE(statements.size(), 1);
+
+    const QJsonObject entry = statements.first().toObject();
+    QCOMPARE(entry["sql"].toString(), QString("SELECT COUNT(*) FROM Pages"));
+    QCOMPARE(entry["calls"].toInt(), 1);
+    QCOMPARE(entry["rows"].toInt(), 1);
+    QVERIFY(entry.contains("p50_ms"));
+    QVERIFY(entry.contains("p95_ms"));
+    QVERIFY(entry.contains("p99_ms"));
+    QVERIFY(root["slow_queries"].toArray().isEmpty());
+}
+
+void TestQueryInstrumentation::testDisabled()
+{
+    QueryStats::getInstance().setEnabled(false);
+    {
+        InstrumentedQuery query(QSqlDatabase::database(m_connectionName));
+        QVERIFY(query.exec("SELECT html FROM Pages"));
+        while (query.next()) {
+            query.value(0);
+        }
+    }
+    QVERIFY(QueryStats::getInstance().statements().isEmpty());
+}
+
+QTEST_MAIN(TestQueryInstrumentation)
+#include "test_queryinstrumentation.moc"
@@ -1,8 +1,15 @@
 #include <QtTest>
 #include "smartbook/reader/ui/ReaderView.h"
+#include "smartbook/reader/CartridgeSchemeHandler.h"
+#include "smartbook/reader/ReaderProfile.h"
 #include "smartbook/common/database/CartridgeDBConnector.h"
 #include "smartbook/common/database/LocalDBManager.h"
 #include <QTemporaryDir>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QWebEngineProfile>
+#include <QWebEnginePage>
+#include <QWebEngineSettings>
 #include <QUuid>
 #include <QFile>
 #include <QSqlQuery>
@@ -22,6 +29,8 @@ private slots:
     void initTestCase();
     void cleanupTestCase();
     void testContentLoading();  // Test loading HTML from Content_Pages
+    void testSearchDoesNotWaitForIndex();
+    void testSharedProfile();
 
 private:
     QTemporaryDir* m_tempDir;
@@ -200,9 +209,64 @@ void TestReaderViewContent::testContentLoading()
     QApplication::processEvents();
 }
 
+// Cartridges without an index are searchable once the background build is done
+void TestReaderViewContent::testSearchDoesNotWaitForIndex()
+{
+    auto* readerView = new ReaderView();
+    QSignalSpy ready(readerView, &ReaderView::searchReady);
+    readerView->loadCartridge(m_cartridgePath);
+
+    // The sidecar is opened from the event loop, so nothing is ready yet
+    QVERIFY(!readerView->isSearchReady());
+    QVERIFY(readerView->search("second").isEmpty());
+
+    QTRY_COMPARE_WITH_TIMEOUT(ready.count(), 1, 10000);
+    QCOMPARE(ready.first().first().toBool(), true);
+    QVERIFY(readerView->isSearchReady());
+    const auto hits = readerView->search("second");
+    QCOMPARE(hits.size(), 1);
+    QCOMPARE(hits.first().pageId, 2);
+
+    delete readerView;
+    QApplication::processEvents();
+    QTest::qWait(300);
+}
+
+// Reader windows share one configured profile instead of the default one
+void TestReaderViewContent::testSharedProfile()
+{
+    QWebEngineProfile* profile = ReaderProfile::instance();
+    QVERIFY(profile);
+    QVERIFY(profile != QWebEngineProfile::defaultProfile());
+    QCOMPARE(ReaderProfile::instance(), profile);
+    QCOMPARE(profile->storageName(), QString(ReaderProfile::STORAGE_NAME));
+    QVERIFY(!profile->isOffTheRecord());
+    QCOMPARE(profile->httpCacheType(), QWebEngineProfile::DiskHttpCache);
+    QCOMPARE(profile->httpCacheMaximumSize(), ReaderProfile::options().httpCacheMiB * 1024 * 1024);
+    QVERIFY(qobject_cast<CartridgeSchemeHandler*>(profile->urlSchemeHandler(CartridgeSchemeHandler::SCHEME)));
+    QVERIFY(!profile->settings()->testAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls));
+    QVERIFY(!profile->settings()->testAttribute(QWebEngineSettings::LocalContentCanAccessFileUrls));
+
+    auto* first = new ReaderView();
+    auto* second = new ReaderView();
+    QWebEngineView* firstView = first->findChild<QWebEngineView*>();
+    QWebEngineView* secondView = second->findChild<QWebEngineView*>();
+    QVERIFY(firstView && secondView);
+    QCOMPARE(firstView->page()->profile(), profile);
+    QCOMPARE(secondView->page()->profile(), profile);
+
+    delete first;
+    delete second;
+    QApplication::processEvents();
+    QTest::qWait(300);
+}
+
 // Use custom main to ensure proper QApplication lifecycle
 int main(int argc, char *argv[])
 {
+    // Keep the reader profile's disk cache out of the user's
+    QStandardPaths::setTestModeEnabled(true);
+    CartridgeSchemeHandler::registerScheme();
     QApplication app(argc, argv);
     TestReaderViewContent tc;
     int result = QTest::qExec(&tc, argc, argv);
@@ -0,0 +1,245 @@
+#include <QtTest>
+#include "smartbook/common/database/SchemaMigrator.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+
+using namespace smartbook::common::database;
+
+class TestSchemaMigrator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void testAppliesInOrder();
+    void testFastPathWhenCurrent();
+    void testFailedMigrationRollsBack();
+    void testBlockingScopeDefersBackground();
+    void testRebuildTableReportsProgress();
+    void testForeignKeyViolationRejected();
+
+private:
+    QSqlDatabase database();
+    bool tableHasColumn(const QString& table, const QString& column);
+
+    QTemporaryDir* m_tempDir = nullptr;
+    QString m_connectionName = "SchemaMigratorTest";
+};
+
+void TestSchemaMigrator::init()
+{
+    m_tempDir = new QTemporaryDir();
+    QVERIFY(m_tempDir->isValid());
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    db.setDatabaseName(m_tempDir->filePath("migrations.sqlite"));
+    QVERIFY(db.open());
+    QSqlQuery query(db);
+    QVERIFY(query.exec("PRAGMA foreign_keys=ON"));
+}
+
+void TestSchemaMigrator::cleanup()
+{
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+    delete m_tempDir;
+    m_tempDir = nullptr;
+}
+
+QSqlDatabase TestSchemaMigrator::database()
+{
+    return QSqlDatabase::database(m_connectionName, false);
+}
+
+bool TestSchemaMigrator::tableHasColumn(const QString& table, const QString& column)
+{
+    QSqlQuery query(database());
+    query.exec(QString("PRAGMA table_info(%1)").arg(table));
+    while (query.next()) {
+        if (query.value(1).toString() == column) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TestSchemaMigrator::testAppliesInOrder()
+{
+    QStringList applied;
+    SchemaMigrator migrator;
+    // Registered out of order on purpose
+    migrator.addMigration(2, "Add column", [&](QSqlDatabase& db, const SchemaMigrator::Reporter&) {
+        applied.append("2");
+        return QSqlQuery(db).exec("ALTER TABLE Items ADD COLUMN label TEXT");
+    });
+    migrator.addMigration(1, "Create table", QStringList{"CREATE TABLE Items (id INTEGER PRIMARY KEY)"});
+    QCOMPARE(migrator.latestVersion(), 2);
+
+    QSqlDatabase db = database();
+    QCOMPARE(SchemaMigrator::currentVersion(db), 0);
+    QVERIFY(!migrator.isCurrent(db));
+
+    QList<int> versions;
+    QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::All, [&](const SchemaMigrator::Progress& progress) {
+        if (versions.isEmpty() || versions.last() != progress.version) {
+            versions.append(progress.version);
+        }
+    }));
+
+    QCOMPARE(versions, QList<int>({1, 2}));
+    QCOMPARE(applied, QStringList({"2"}));
+    QCOMPARE(SchemaMigrator::currentVersion(db), 2);
+    QVERIFY(tableHasColumn("Items", "label"));
+
+    // Foreign keys are switched back on afterwards
+    QSqlQuery query(db);
+    QVERIFY(query.exec("PRAGMA foreign_keys") && query.next());
+    QCOMPARE(query.value(0).toInt(), 1);
+}
+
+void TestSchemaMigrator::testFastPathWhenCurrent()
+{
+    int runs = 0;
+    SchemaMigrator migrator;
+    migrator.addMigration(1, "Create table", [&](QSqlDatabase& db, const SchemaMigrator::Reporter&) {
+        runs++;
+        return QSqlQuery(db).exec("CREATE TABLE Items (id INTEGER PRIMARY KEY)");
+    });
+
+    QSqlDatabase db = database();
+    QVERIFY(migrator.migrate(db));
+    QCOMPARE(runs, 1);
+
+    int progressCalls = 0;
+    QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::All, [&](const SchemaMigrator::Progress&) {
+        progressCalls++;
+    }));
+    QCOMPARE(runs, 1);
+    QCOMPARE(progressCalls, 0);
+
+    // A database from a newer build is left alone
+    QSqlQuery query(db);
+    QVERIFY(query.exec("PRAGMA user_version=7"));
+    QVERIFY(migrator.migrate(db));
+    QCOMPARE(SchemaMigrator::currentVersion(db), 7);
+}
+
+void TestSchemaMigrator::testFailedMigrationRollsBack()
+{
+    SchemaMigrator migrator;
+    migrator.addMigration(1, "Create table", QStringList{"CREATE TABLE Items (id INTEGER PRIMARY KEY)"});
+    migrator.addMigration(2, "Broken", QStringList{
+        "CREATE TABLE Partial (id INTEGER PRIMARY KEY)",
+        "ALTER TABLE Missing ADD COLUMN x TEXT"
+    });
+    migrator.addMigration(3, "Never reached", QStringList{"CREATE TABLE Later (id INTEGER)"});
+
+    QSqlDatabase db = database();
+    QVERIFY(!migrator.migrate(db));
+    QCOMPARE(SchemaMigrator::currentVersion(db), 1);
+
+    QSqlQuery query(db);
+    QVERIFY(query.exec("SELECT COUNT(*) FROM sqlite_master WHERE name IN ('Partial', 'Later')"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 0);
+}
+
+void TestSchemaMigrator::testBlockingScopeDefersBackground()
+{
+    SchemaMigrator migrator;
+    migrator.addMigration(1, "Create table", QStringList{"CREATE TABLE Items (id INTEGER PRIMARY KEY, name TEXT)"});
+    migrator.addMigration(2, "Index", QStringList{"CREATE INDEX idx_items_name ON Items(name)"},
+                          SchemaMigrator::Mode::Background);
+    migrator.addMigration(3, "Column", QStringList{"ALTER TABLE Items ADD COLUMN extra TEXT"});
+    migrator.addMigration(4, "Second index", QStringList{"CREATE INDEX idx_items_extra ON Items(extra)"},
+                          SchemaMigrator::Mode::Background);
+
+    // Version 2 is followed by a blocking migration, so only 4 is deferred
+    QSqlDatabase db = database();
+    QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::Blocking));
+    QCOMPARE(SchemaMigrator::currentVersion(db), 3);
+    QVERIFY(!migrator.isCurrent(db));
+
+    QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::Next));
+    QCOMPARE(SchemaMigrator::currentVersion(db), 4);
+    QVERIFY(migrator.isCurrent(db));
+
+    // Nothing pending
+    QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::All));
+    QCOMPARE(SchemaMigrator::currentVersion(db), 4);
+}
+
+void TestSchemaMigrator::testRebuildTableReportsProgress()
+{
+    QSqlDatabase db = database();
+    QSqlQuery setup(db);
+    QVERIFY(setup.exec("CREATE TABLE Items (id INTEGER PRIMARY KEY, name TEXT, obsolete TEXT)"));
+    QVERIFY(db.transaction());
+    QSqlQuery insert(db);
+    QVERIFY(insert.prepare("INSERT INTO Items (name, obsolete) VALUES (?, 'x')"));
+    for (int i = 0; i < 250; ++i) {
+        insert.addBindValue(QString("item %1").arg(i));
+        QVERIFY(insert.exec());
+    }
+    QVERIFY(db.commit());
+
+    SchemaMigrator migrator;
+    migrator.addMigration(1, "Drop obsolete column", [](QSqlDatabase& database, const SchemaMigrator::Reporter& report) {
+        return SchemaMigrator::rebuildTable(database, "Items",
+                                            "CREATE TABLE %1 (id INTEGER PRIMARY KEY, name TEXT NOT NULL)",
+                                            QStringList{"id", "name"}, report, 100);
+    });
+
+    QList<qint64> done;
+    qint64 total = 0;
+    QVERIFY(migrator.migrate(db, SchemaMigrator::Scope::All, [&](const SchemaMigrator::Progress& progress) {
+        if (progress.total > 0) {
+            done.append(progress.done);
+            total = progress.total;
+        }
+    }));
+
+    QCOMPARE(total, qint64(250));
+    QVERIFY(done.contains(100));
+    QVERIFY(done.contains(200));
+    QCOMPARE(done.last(), qint64(250));
+
+    QVERIFY(!tableHasColumn("Items", "obsolete"));
+    QSqlQuery query(db);
+    QVERIFY(query.exec("SELECT COUNT(*), MIN(id), MAX(id) FROM Items"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 250);
+    QCOMPARE(query.value(1).toInt(), 1);
+    QCOMPARE(query.value(2).toInt(), 250);
+}
+
+void TestSchemaMigrator::testForeignKeyViolationRejected()
+{
+    QSqlDatabase db = database();
+    QSqlQuery setup(db);
+    QVERIFY(setup.exec("CREATE TABLE Parents (id INTEGER PRIMARY KEY)"));
+    QVERIFY(setup.exec("CREATE TABLE Children (id INTEGER PRIMARY KEY, parent_id INTEGER REFERENCES Parents(id))"));
+    QVERIFY(setup.exec("INSERT INTO Parents (id) VALUES (1)"));
+    QVERIFY(setup.exec("INSERT INTO Children (parent_id) VALUES (1)"));
+
+    // Rebuilding the parent without the referenced row must not commit
+    SchemaMigrator migrator;
+    migrator.addMigration(1, "Lose parent rows", [](QSqlDatabase& database, const SchemaMigrator::Reporter& report) {
+        return SchemaMigrator::rebuildTable(database, "Parents", "CREATE TABLE %1 (id INTEGER PRIMARY KEY)",
+                                            QStringList{"id"}, report)
+            && QSqlQuery(database).exec("DELETE FROM Parents");
+    });
+
+    QVERIFY(!migrator.migrate(db));
+    QCOMPARE(SchemaMigrator::currentVersion(db), 0);
+
+    QSqlQuery query(db);
+    QVERIFY(query.exec("SELECT COUNT(*) FROM Parents"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 1);
+}
+
+QTEST_MAIN(TestSchemaMigrator)
+#include "test_schemamigrator.moc"
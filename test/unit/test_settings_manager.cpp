@@ -1,5 +1,7 @@
 #include <QtTest>
 #include "smartbook/common/settings/SettingsManager.h"
+#include "smartbook/common/settings/PageTemplate.h"
+#include <QSignalSpy>
 #include "smartbook/common/database/LocalDBManager.h"
 #include "smartbook/common/manifest/ManifestManager.h"
 #include <QTemporaryDir>
@@ -23,6 +25,8 @@ private slots:
     void testSettingsPriority();  // Test User > Author > App default priority
     void testUserOverride();
     void testResetToAuthorDefaults();
+    void testSettingsGeneration();
+    void testPageTemplate();
 
 private:
     QTemporaryDir* m_tempDir;
@@ -216,6 +220,75 @@ void TestSettingsManager::testResetToAuthorDefaults()
     QCOMPARE(fontSize, "14"); // Author default restored
 }
 
+void TestSettingsManager::testSettingsGeneration()
+{
+    SettingsManager manager(this);
+    QSignalSpy changed(&manager, &SettingsManager::settingsChanged);
+    const quint64 initial = manager.generation();
+
+    QVERIFY(manager.loadSettings(m_cartridgeGuid, m_cartridgePath));
+    QVERIFY(manager.generation() > initial);
+    QCOMPARE(changed.count(), 1);
+
+    // Only changes move the generation
+    const quint64 loaded = manager.generation();
+    QVERIFY(manager.setUserOverride("line_spacing", "2.0"));
+    QVERIFY(manager.generation() > loaded);
+    const quint64 overridden = manager.generation();
+    QVERIFY(manager.setUserOverride("line_spacing", "2.0"));
+    QCOMPARE(manager.generation(), overridden);
+    QCOMPARE(changed.count(), 2);
+
+    QVERIFY(manager.resetToAuthorDefaults());
+    QVERIFY(manager.generation() > overridden);
+    const quint64 reset = manager.generation();
+    QVERIFY(manager.resetToAuthorDefaults());
+    QCOMPARE(manager.generation(), reset);
+    QCOMPARE(changed.count(), 3);
+}
+
+void TestSettingsManager::testPageTemplate()
+{
+    SettingsManager manager(this);
+    QVERIFY(manager.loadSettings(m_cartridgeGuid, m_cartridgePath));
+
+    PageTemplate pageTemplate;
+    QVERIFY(!pageTemplate.isCurrent(manager));
+    pageTemplate = PageTemplate::compile(manager);
+    QVERIFY(pageTemplate.isCurrent(manager));
+    QVERIFY(pageTemplate.settingsCss().contains("--font-size: 14pt;"));
+    QVERIFY(pageTemplate.settingsCss().contains("--font-family: Georgia;"));
+    QVERIFY(pageTemplate.settingsCss().contains("--text-align: left;"));
+
+    // Page CSS, then settings CSS, then the page in the body
+    const QByteArray html("<h1>\xc3\x89t\xc3\xa9</h1><p>Page</p>");
+    const QByteArray css("h1 { color: blue; }");
+    const QByteArray document = pageTemplate.render(QUtf8StringView(html), QUtf8StringView(css));
+    QVERIFY(document.startsWith("<!DOCTYPE html>"));
+    QVERIFY(document.endsWith("</html>\n"));
+    const qsizetype cssAt = document.indexOf(css);
+    const qsizetype settingsAt = document.indexOf(pageTemplate.settingsCss());
+    const qsizetype bodyAt = document.indexOf("<body>");
+    const qsizetype htmlAt = document.indexOf(html);
+    QVERIFY(document.indexOf("<style>") < cssAt);
+    QVERIFY(cssAt < settingsAt);
+    QVERIFY(settingsAt < document.indexOf("</style>"));
+    QVERIFY(document.indexOf("</style>") < bodyAt);
+    QVERIFY(bodyAt < htmlAt);
+    QCOMPARE(document.count("<body>"), 1);
+
+    const QByteArray empty = pageTemplate.render(QUtf8StringView(html), QUtf8StringView());
+    QCOMPARE(empty.size(), document.size() - css.size());
+
+    // Stale after a change until compiled again
+    QVERIFY(manager.setUserOverride("default_font_size", "22"));
+    QVERIFY(!pageTemplate.isCurrent(manager));
+    pageTemplate = PageTemplate::compile(manager);
+    QVERIFY(pageTemplate.isCurrent(manager));
+    QVERIFY(pageTemplate.settingsCss().contains("--font-size: 22pt;"));
+    QVERIFY(manager.resetToAuthorDefaults());
+}
+
 // Use custom main to ensure proper QApplication lifecycle
 int main(int argc, char *argv[])
 {
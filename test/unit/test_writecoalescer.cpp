@@ -0,0 +1,328 @@
+#include <QtTest>
+#include "smartbook/common/database/WriteCoalescer.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QPromise>
+#include <memory>
+
+using namespace smartbook::common::database;
+
+class TestWriteCoalescer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void testLatestValueWins();
+    void testSingleTransactionPerFlush();
+    void testSizeThresholdFlushes();
+    void testTimerFlushes();
+    void testDiscardByPrefix();
+    void testFailedCommitKeepsWrites();
+    void testDurableFlushRestoresSynchronous();
+    void testDestructorFlushes();
+    void testSubmittedFlushDoesNotWait();
+    void testDurableFlushWaitsForSubmitted();
+
+private:
+    WriteCoalescer::Runner runner();
+    WriteCoalescer::Write upsert(const QString& key, const QString& value);
+    QString storedValue(const QString& key);
+    int rowCount();
+
+    QString m_connectionName = "WriteCoalescerTest";
+    int m_batches = 0;
+    bool m_failCommit = false;
+};
+
+void TestWriteCoalescer::initTestCase()
+{
+    QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    database.setDatabaseName(":memory:");
+    QVERIFY(database.open());
+
+    QSqlQuery query(database);
+    QVERIFY(query.exec("CREATE TABLE Data (data_key TEXT PRIMARY KEY, data_value TEXT NOT NULL)"));
+}
+
+void TestWriteCoalescer::cleanupTestCase()
+{
+    QSqlDatabase::database(m_connectionName, false).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+void TestWriteCoalescer::init()
+{
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+    QVERIFY(query.exec("DELETE FROM Data"));
+    m_batches = 0;
+    m_failCommit = false;
+}
+
+WriteCoalescer::Runner TestWriteCoalescer::runner()
+{
+    return [this](const WriteCoalescer::Write& batch) {
+        m_batches++;
+        QSqlDatabase database = QSqlDatabase::database(m_connectionName);
+        if (m_failCommit) {
+            // Simulate a commit failure: run nothing and report it
+            return false;
+        }
+        return batch(database);
+    };
+}
+
+WriteCoalescer::Write TestWriteCoalescer::upsert(const QString& key, const QString& value)
+{
+    return [key, value](QSqlDatabase& database) {
+        QSqlQuery query(database);
+        query.prepare("INSERT OR REPLACE INTO Data (data_key, data_value) VALUES (?, ?)");
+        query.addBindValue(key);
+        query.addBindValue(value);
+        return query.exec();
+    };
+}
+
+QString TestWriteCoalescer::storedValue(const QString& key)
+{
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+    query.prepare("SELECT data_value FROM Data WHERE data_key = ?");
+    query.addBindValue(key);
+    if (!query.exec() || !query.next()) {
+        return QString();
+    }
+    return query.value(0).toString();
+}
+
+int TestWriteCoalescer::rowCount()
+{
+    QSqlQuery query(QSqlDatabase::database(m_connectionName));
+    if (!query.exec("SELECT COUNT(*) FROM Data") || !query.next()) {
+        return -1;
+    }
+    return query.value(0).toInt();
+}
+
+void TestWriteCoalescer::testLatestValueWins()
+{
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+
+    for (int i = 0; i < 20; ++i) {
+        coalescer.enqueue("form/a", QString("draft %1").arg(i), upsert("form/a", QString("draft %1").arg(i)));
+    }
+
+    QCOMPARE(coalescer.pendingCount(), 1);
+    QCOMPARE(coalescer.pendingValue("form/a").toString(), QString("draft 19"));
+    QCOMPARE(rowCount(), 0);
+
+    QVERIFY(coalescer.flush());
+    QCOMPARE(storedValue("form/a"), QString("draft 19"));
+    QCOMPARE(coalescer.pendingCount(), 0);
+    QVERIFY(!coalescer.pendingValue("form/a").isValid());
+
+    const WriteCoalescer::Stats stats = coalescer.stats();
+    QCOMPARE(stats.enqueued, qint64(20));
+    QCOMPARE(stats.coalesced, qint64(19));
+    QCOMPARE(stats.written, qint64(1));
+    QCOMPARE(stats.flushes, qint64(1));
+}
+
+void TestWriteCoalescer::testSingleTransactionPerFlush()
+{
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+
+    for (int i = 0; i < 10; ++i) {
+        const QString key = QString("setting/%1").arg(i);
+        coalescer.enqueue(key, "v", upsert(key, "v"));
+    }
+    QVERIFY(coalescer.flush());
+
+    QCOMPARE(m_batches, 1);
+    QCOMPARE(rowCount(), 10);
+    QCOMPARE(coalescer.stats().written, qint64(10));
+}
+
+void TestWriteCoalescer::testSizeThresholdFlushes()
+{
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+    coalescer.setMaxPending(3);
+
+    coalescer.enqueue("a", "1", upsert("a", "1"));
+    coalescer.enqueue("b", "2", upsert("b", "2"));
+    QCOMPARE(rowCount(), 0);
+
+    coalescer.enqueue("c", "3", upsert("c", "3"));
+    QCOMPARE(rowCount(), 3);
+    QCOMPARE(coalescer.pendingCount(), 0);
+}
+
+void TestWriteCoalescer::testTimerFlushes()
+{
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(20);
+
+    coalescer.enqueue("timed", "yes", upsert("timed", "yes"));
+    QCOMPARE(rowCount(), 0);
+
+    QTRY_COMPARE(storedValue("timed"), QString("yes"));
+    QCOMPARE(coalescer.pendingCount(), 0);
+}
+
+void TestWriteCoalescer::testDiscardByPrefix()
+{
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+
+    coalescer.enqueue("setting/guid-1/font", "16", upsert("setting/guid-1/font", "16"));
+    coalescer.enqueue("setting/guid-1/theme", "dark", upsert("setting/guid-1/theme", "dark"));
+    coalescer.enqueue("setting/guid-2/font", "12", upsert("setting/guid-2/font", "12"));
+
+    const QHash<QString, QVariant> pending = coalescer.pendingWithPrefix("setting/guid-1/");
+    QCOMPARE(pending.size(), 2);
+    QCOMPARE(pending.value("theme").toString(), QString("dark"));
+
+    QCOMPARE(coalescer.discard("setting/guid-1/"), 2);
+    QVERIFY(coalescer.flush());
+    QCOMPARE(rowCount(), 1);
+    QCOMPARE(storedValue("setting/guid-2/font"), QString("12"));
+}
+
+void TestWriteCoalescer::testFailedCommitKeepsWrites()
+{
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+
+    coalescer.enqueue("retry", "old", upsert("retry", "old"));
+    m_failCommit = true;
+    QVERIFY(!coalescer.flush());
+    QCOMPARE(coalescer.pendingCount(), 1);
+    QCOMPARE(coalescer.pendingValue("retry").toString(), QString("old"));
+
+    // A newer value replaces the one that failed
+    coalescer.enqueue("retry", "new", upsert("retry", "new"));
+    m_failCommit = false;
+    QVERIFY(coalescer.flush());
+    QCOMPARE(storedValue("retry"), QString("new"));
+}
+
+void TestWriteCoalescer::testDurableFlushRestoresSynchronous()
+{
+    QSqlDatabase database = QSqlDatabase::database(m_connectionName);
+    QSqlQuery query(database);
+    QVERIFY(query.exec("PRAGMA synchronous=NORMAL"));
+
+    int syncDuringFlush = -1;
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+    coalescer.enqueue("durable", "1", [&](QSqlDatabase& db) {
+        QSqlQuery check(db);
+        if (check.exec("PRAGMA synchronous") && check.next()) {
+            syncDuringFlush = check.value(0).toInt();
+        }
+        return true;
+    });
+
+    QVERIFY(coalescer.flush(WriteCoalescer::Durability::Full));
+    QCOMPARE(syncDuringFlush, 2);  // FULL
+
+    QVERIFY(query.exec("PRAGMA synchronous"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 1);  // NORMAL again
+}
+
+void TestWriteCoalescer::testDestructorFlushes()
+{
+    {
+        WriteCoalescer coalescer(runner());
+        coalescer.setFlushInterval(60000);
+        coalescer.enqueue("closing", "saved", upsert("closing", "saved"));
+        QCOMPARE(rowCount(), 0);
+    }
+    QCOMPARE(storedValue("closing"), QString("saved"));
+}
+
+void TestWriteCoalescer::testSubmittedFlushDoesNotWait()
+{
+    // Batches handed to the submitter complete later, as on the executor
+    QList<WriteCoalescer::Write> submitted;
+    QList<std::shared_ptr<QPromise<bool>>> promises;
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+    coalescer.setSubmitter([&](const WriteCoalescer::Write& batch) {
+        auto promise = std::make_shared<QPromise<bool>>();
+        promise->start();
+        submitted.append(batch);
+        promises.append(promise);
+        return promise->future();
+    });
+
+    coalescer.enqueue("async", "1", upsert("async", "1"));
+    QVERIFY(coalescer.flush());
+    QCOMPARE(submitted.size(), 1);
+    QCOMPARE(m_batches, 0);
+    QCOMPARE(rowCount(), 0);
+    QCOMPARE(coalescer.pendingCount(), 0);
+    QCOMPARE(coalescer.pendingValue("async").toString(), QString("1"));  // Visible while in flight
+
+    // One batch in flight at a time
+    coalescer.enqueue("later", "2", upsert("later", "2"));
+    QVERIFY(coalescer.flush());
+    QCOMPARE(submitted.size(), 1);
+
+    // A failed batch is buffered again
+    promises.first()->addResult(false);
+    promises.first()->finish();
+    QTRY_COMPARE(coalescer.pendingCount(), 2);
+    QCOMPARE(coalescer.stats().flushes, qint64(0));
+
+    QVERIFY(coalescer.flush());
+    QCOMPARE(submitted.size(), 2);
+    QSqlDatabase database = QSqlDatabase::database(m_connectionName);
+    promises.last()->addResult(submitted.last()(database));
+    promises.last()->finish();
+    QTRY_COMPARE(coalescer.stats().flushes, qint64(1));
+    QCOMPARE(coalescer.stats().written, qint64(2));
+    QVERIFY(!coalescer.hasPending("async"));
+    QCOMPARE(storedValue("async"), QString("1"));
+    QCOMPARE(storedValue("later"), QString("2"));
+}
+
+void TestWriteCoalescer::testDurableFlushWaitsForSubmitted()
+{
+    auto promise = std::make_shared<QPromise<bool>>();
+    WriteCoalescer coalescer(runner());
+    coalescer.setFlushInterval(60000);
+    coalescer.setSubmitter([promise](const WriteCoalescer::Write&) {
+        promise->start();
+        return promise->future();
+    });
+
+    coalescer.enqueue("first", "1", upsert("first", "1"));
+    QVERIFY(coalescer.flush());
+    coalescer.enqueue("second", "2", upsert("second", "2"));
+
+    // The batch in flight completes on another thread while flush() waits
+    QThread* worker = QThread::create([promise]() {
+        QThread::msleep(50);
+        promise->addResult(true);
+        promise->finish();
+    });
+    worker->start();
+    QVERIFY(coalescer.flush(WriteCoalescer::Durability::Full));
+    QVERIFY(worker->wait(10000));
+    delete worker;
+
+    // Only the second batch went through the runner
+    QCOMPARE(m_batches, 1);
+    QCOMPARE(storedValue("second"), QString("2"));
+    QCOMPARE(coalescer.stats().flushes, qint64(2));
+    QVERIFY(!coalescer.hasPending("first"));
+}
+
+QTEST_MAIN(TestWriteCoalescer)
+#include "test_writecoalescer.moc"